@@ -0,0 +1,304 @@
+#include "bench.h"
+
+#include "core/allocators.h"
+#include "core/algorithms/sort.h"
+#include "core/algorithms/scan.h"
+#include "core/containers/array.h"
+#include "core/threading/jobs.h"
+
+#include <algorithm>
+#include <numeric>
+
+
+using namespace Veng;
+
+
+//key compared by sort, index checks stability and that nothing got lost or duplicated
+struct Item
+{
+	u32 key;
+	u32 index;
+};
+
+struct ItemLess
+{
+	bool operator()(const Item& a, const Item& b) const { return a.key < b.key; }
+};
+
+//reference for stable sorts, standard stable algorithms allocate through global new which engine forbids
+struct ItemStableLess
+{
+	bool operator()(const Item& a, const Item& b) const { return a.key < b.key || (a.key == b.key && a.index < b.index); }
+};
+
+
+template<class Type>
+static void Assign(Array<Type>& destination, const Array<Type>& source)
+{
+	destination.Clear();
+	destination.Reserve(source.GetSize());
+	for (const Type& value : source)
+		destination.PushBack(value);
+}
+
+template<class Type>
+static bool Equal(const Array<Type>& a, const Array<Type>& b)
+{
+	return a.GetSize() == b.GetSize() && std::equal(a.Begin(), a.End(), b.Begin());
+}
+
+
+enum class Pattern
+{
+	Random,
+	FewUnique,
+	Sorted,
+	Reversed,
+	NearlySorted,
+};
+
+static const Pattern PATTERNS[] = { Pattern::Random, Pattern::FewUnique, Pattern::Sorted, Pattern::Reversed, Pattern::NearlySorted };
+
+
+static void Generate(Array<Item>& items, size_t count, Pattern pattern, u64 seed)
+{
+	bench::Random random(seed);
+	items.Clear();
+	items.Reserve(count);
+	for (size_t i = 0; i < count; ++i)
+	{
+		u32 key;
+		switch (pattern)
+		{
+			case Pattern::Random: key = (u32)random.Next(); break;
+			case Pattern::FewUnique: key = random.Next(16); break;
+			case Pattern::Sorted: key = (u32)i; break;
+			case Pattern::Reversed: key = (u32)(count - i); break;
+			case Pattern::NearlySorted: key = (u32)i + random.Next(8); break;
+			default: key = 0; break;
+		}
+		items.PushBack({ key, (u32)i });
+	}
+}
+
+static void CheckSorted(Allocator& allocator, const Array<Item>& items, const Array<Item>& expected, bool stable)
+{
+	BENCH_CHECK(items.GetSize() == expected.GetSize());
+	for (size_t i = 0; i < items.GetSize(); ++i)
+	{
+		BENCH_CHECK(items[i].key == expected[i].key);
+		if (stable)
+			BENCH_CHECK(items[i].index == expected[i].index);
+	}
+
+	//unstable sort still has to keep every element exactly once
+	if (!stable)
+	{
+		Array<u8> seen(allocator);
+		seen.Resize(items.GetSize());
+		std::fill(seen.Begin(), seen.End(), (u8)0);
+		for (const Item& item : items)
+		{
+			BENCH_CHECK(item.index < items.GetSize() && seen[item.index] == 0);
+			seen[item.index] = 1;
+		}
+	}
+}
+
+static void CheckRadix(const Array<SortKey32>& keys, const Array<Item>& expected)
+{
+	BENCH_CHECK(keys.GetSize() == expected.GetSize());
+	for (size_t i = 0; i < keys.GetSize(); ++i)
+		BENCH_CHECK(keys[i].key == expected[i].key && keys[i].index == expected[i].index);
+}
+
+
+static void CheckSorts(JobSystem& jobSystem, Allocator& allocator, size_t count, Pattern pattern)
+{
+	Array<Item> source(allocator);
+	Generate(source, count, pattern, count + (u64)pattern);
+	Array<Item> expected(allocator);
+	Assign(expected, source);
+	std::sort(expected.Begin(), expected.End(), ItemStableLess());
+
+	Array<Item> items(allocator);
+	Assign(items, source);
+	Sort(items.Begin(), items.End(), ItemLess());
+	CheckSorted(allocator, items, expected, false);
+
+	Assign(items, source);
+	HeapSort(items.Begin(), items.End(), ItemLess());
+	CheckSorted(allocator, items, expected, false);
+
+	Assign(items, source);
+	StableSort(allocator, items.Begin(), items.End(), ItemLess());
+	CheckSorted(allocator, items, expected, true);
+
+	Assign(items, source);
+	ParallelSort(jobSystem, allocator, items.Begin(), items.End(), ItemLess());
+	CheckSorted(allocator, items, expected, true);
+
+	Array<SortKey32> keys(allocator);
+	keys.Reserve(count);
+	for (const Item& item : source)
+		keys.PushBack({ item.key, item.index });
+	RadixSort(allocator, keys.Begin(), keys.GetSize());
+	CheckRadix(keys, expected);
+
+	for (size_t i = 0; i < count; ++i)
+		keys[i] = { source[i].key, source[i].index };
+	ParallelRadixSort(jobSystem, allocator, keys.Begin(), keys.GetSize());
+	CheckRadix(keys, expected);
+
+	Array<SortKey64> keys64(allocator);
+	keys64.Reserve(count);
+	for (const Item& item : source)
+		keys64.PushBack({ ((u64)item.key << 32) | (item.key ^ 0x5555), item.index });
+	ParallelRadixSort(jobSystem, allocator, keys64.Begin(), keys64.GetSize());
+	for (size_t i = 0; i < count; ++i)
+		BENCH_CHECK((u32)(keys64[i].key >> 32) == expected[i].key && keys64[i].index == expected[i].index);
+}
+
+
+static void CheckScans(JobSystem& jobSystem, Allocator& allocator, size_t count)
+{
+	bench::Random random(count);
+	Array<i64> in(allocator);
+	in.Reserve(count);
+	for (size_t i = 0; i < count; ++i)
+		in.PushBack((i64)random.Next(1000) - 500);
+
+	Array<i64> expected(allocator);
+	expected.Resize(count);
+	std::exclusive_scan(in.Begin(), in.End(), expected.Begin(), (i64)7);
+	const i64 total = std::accumulate(in.Begin(), in.End(), (i64)7);
+
+	Array<i64> out(allocator);
+	out.Resize(count);
+	BENCH_CHECK(ExclusiveScan(in.Begin(), out.Begin(), count, (i64)7) == total);
+	BENCH_CHECK(Equal(out, expected));
+	BENCH_CHECK(ParallelExclusiveScan(jobSystem, in.Begin(), out.Begin(), count, (i64)7) == total);
+	BENCH_CHECK(Equal(out, expected));
+
+	std::inclusive_scan(in.Begin(), in.End(), expected.Begin(), Plus<i64>(), (i64)7);
+	BENCH_CHECK(InclusiveScan(in.Begin(), out.Begin(), count, (i64)7) == total);
+	BENCH_CHECK(Equal(out, expected));
+	BENCH_CHECK(ParallelInclusiveScan(jobSystem, in.Begin(), out.Begin(), count, (i64)7) == total);
+	BENCH_CHECK(Equal(out, expected));
+
+	BENCH_CHECK(Reduce(in.Begin(), in.End(), (i64)7) == total);
+	BENCH_CHECK(ParallelReduce(jobSystem, in.Begin(), in.End(), (i64)7) == total);
+
+	auto negative = [](const i64& value) { return value < 0; };
+	Array<i64> stable(allocator);
+	stable.Reserve(count);
+	for (i64 value : in)
+	{
+		if (negative(value))
+			stable.PushBack(value);
+	}
+	const size_t negatives = stable.GetSize();
+	for (i64 value : in)
+	{
+		if (!negative(value))
+			stable.PushBack(value);
+	}
+
+	Assign(out, in);
+	BENCH_CHECK(Partition(out.Begin(), out.End(), negative) == out.Begin() + negatives);
+	BENCH_CHECK(std::all_of(out.Begin(), out.Begin() + negatives, negative));
+	BENCH_CHECK(std::none_of(out.Begin() + negatives, out.End(), negative));
+
+	Assign(out, in);
+	BENCH_CHECK(ParallelPartition(jobSystem, allocator, out.Begin(), out.End(), negative) == out.Begin() + negatives);
+	BENCH_CHECK(Equal(out, stable));
+}
+
+
+template<class Function>
+static double Measure(Function function)
+{
+	bench::Timer timer;
+	function();
+	return timer.GetMilliseconds();
+}
+
+static void MeasureSorts(JobSystem& jobSystem, Allocator& allocator, size_t count)
+{
+	Array<Item> source(allocator);
+	Generate(source, count, Pattern::Random, 1);
+	Array<Item> items(allocator);
+	Array<SortKey32> keys(allocator);
+	keys.Resize(count);
+	auto reset = [&]() { Assign(items, source); };
+	auto resetKeys = [&]()
+	{
+		for (size_t i = 0; i < count; ++i)
+			keys[i] = { source[i].key, source[i].index };
+	};
+
+	printf("%zu random u32 keys, %u workers (ms):\n", count, jobSystem.GetWorkerCount());
+	reset();
+	printf("  std::sort          %8.2f\n", Measure([&]() { std::sort(items.Begin(), items.End(), ItemLess()); }));
+	reset();
+	printf("  Sort               %8.2f\n", Measure([&]() { Sort(items.Begin(), items.End(), ItemLess()); }));
+	reset();
+	printf("  StableSort         %8.2f\n", Measure([&]() { StableSort(allocator, items.Begin(), items.End(), ItemLess()); }));
+	reset();
+	printf("  ParallelSort       %8.2f\n", Measure([&]() { ParallelSort(jobSystem, allocator, items.Begin(), items.End(), ItemLess()); }));
+	resetKeys();
+	printf("  RadixSort          %8.2f\n", Measure([&]() { RadixSort(allocator, keys.Begin(), count); }));
+	resetKeys();
+	printf("  ParallelRadixSort  %8.2f\n", Measure([&]() { ParallelRadixSort(jobSystem, allocator, keys.Begin(), count); }));
+}
+
+static void MeasureScans(JobSystem& jobSystem, Allocator& allocator, size_t count)
+{
+	Array<i64> in(allocator);
+	in.Resize(count);
+	std::fill(in.Begin(), in.End(), (i64)1);
+	Array<i64> out(allocator);
+	out.Resize(count);
+	std::fill(out.Begin(), out.End(), (i64)0);//first measured function would pay for page faults otherwise
+
+	printf("%zu i64 values (ms):\n", count);
+	printf("  std::exclusive_scan    %8.2f\n", Measure([&]() { std::exclusive_scan(in.Begin(), in.End(), out.Begin(), (i64)0); }));
+	printf("  ExclusiveScan          %8.2f\n", Measure([&]() { ExclusiveScan(in.Begin(), out.Begin(), count, (i64)0); }));
+	printf("  ParallelExclusiveScan  %8.2f\n", Measure([&]() { ParallelExclusiveScan(jobSystem, in.Begin(), out.Begin(), count, (i64)0); }));
+	printf("  std::accumulate        %8.2f\n", Measure([&]() { BENCH_CHECK(std::accumulate(in.Begin(), in.End(), (i64)0) == (i64)count); }));
+	printf("  ParallelReduce         %8.2f\n", Measure([&]() { BENCH_CHECK(ParallelReduce(jobSystem, in.Begin(), in.End(), (i64)0) == (i64)count); }));
+}
+
+
+int main(int argc, char** argv)
+{
+	const bool quick = bench::IsQuick(argc, argv);
+
+	MainAllocator allocator;
+	//parallel paths have to be checked even on machine with single core
+	JobSystem* jobSystem = JobSystem::Create(allocator, 3);
+
+	static const size_t SIZES[] = { 0, 1, 2, 3, 16, 17, 100, 1000, 4097, 65536, 300'000 };
+	for (size_t count : SIZES)
+	{
+		if (quick && count > 65536)
+			continue;
+		for (size_t p = 0; p < sizeof(PATTERNS) / sizeof(PATTERNS[0]); ++p)
+			CheckSorts(*jobSystem, allocator, count, PATTERNS[p]);
+		CheckScans(*jobSystem, allocator, count);
+	}
+
+	JobSystem::Destroy(jobSystem, allocator);
+
+	//thread can own only one job system, measured one has worker per core
+	if (!quick)
+	{
+		jobSystem = JobSystem::Create(allocator);
+		MeasureSorts(*jobSystem, allocator, 2'000'000);
+		MeasureScans(*jobSystem, allocator, 16'000'000);
+		JobSystem::Destroy(jobSystem, allocator);
+	}
+
+	printf("algorithms: ok\n");
+	return 0;
+}
@@ -0,0 +1,130 @@
+#include "bench.h"
+
+#include "core/allocators.h"
+#include "core/threading/os_utils.h"
+
+
+using namespace Veng;
+
+
+static const u32 WRITER_COUNT = 4;
+static const i64 SPIKE_SIZE = 1024 * 1024;
+static const size_t SPIKE_BLOCK = 4096;
+
+
+struct WriterData
+{
+	AllocatorStats* stats;
+	size_t pairs;
+};
+
+static u32 Writer(void* data)
+{
+	const WriterData& writer = *static_cast<WriterData*>(data);
+	for (size_t i = 0; i < writer.pairs; ++i)
+	{
+		const size_t size = 16 + (i & 1023);
+		writer.stats->OnAllocate(size);
+		writer.stats->OnDeallocate(size);
+	}
+
+	//short spike, it's gone before anyone reads summary, only peak remembers it
+	for (i64 i = 0; i < SPIKE_SIZE / (i64)SPIKE_BLOCK; ++i)
+		writer.stats->OnAllocate(SPIKE_BLOCK);
+	for (i64 i = 0; i < SPIKE_SIZE / (i64)SPIKE_BLOCK; ++i)
+		writer.stats->OnDeallocate(SPIKE_BLOCK);
+	return 0;
+}
+
+
+static double StatsPairs(AllocatorStats& stats, size_t pairs)
+{
+	bench::Timer timer;
+	for (size_t i = 0; i < pairs; ++i)
+	{
+		const size_t size = 16 + (i & 1023);
+		stats.OnAllocate(size);
+		stats.OnDeallocate(size);
+	}
+	return timer.GetMilliseconds();
+}
+
+static double AllocatorPairs(Allocator& allocator, size_t pairs)
+{
+	bench::Timer timer;
+	for (size_t i = 0; i < pairs; ++i)
+		allocator.Deallocate(allocator.Allocate(16 + (i & 1023), 8));
+	return timer.GetMilliseconds();
+}
+
+
+int main(int argc, char** argv)
+{
+	const bool quick = bench::IsQuick(argc, argv);
+	const size_t pairs = quick ? 100'000 : 10'000'000;
+
+	//summary is read while writers run, it has to add up once they are done
+	{
+		static AllocatorStats stats;
+		WriterData data = { &stats, pairs };
+		threadHandle threads[WRITER_COUNT];
+		for (threadHandle& thread : threads)
+			thread = StartThread(&Writer, &data);
+
+		i64 lastTotal = 0;
+		for (u32 i = 0; i < 1000; ++i)
+		{
+			const AllocatorStats::Summary summary = stats.GetSummary();
+			BENCH_CHECK(summary.totalCount >= lastTotal);
+			lastTotal = summary.totalCount;
+		}
+
+		for (threadHandle thread : threads)
+			JoinThread(thread);
+
+		const AllocatorStats::Summary summary = stats.GetSummary();
+		BENCH_CHECK(summary.allocCount == 0);
+		BENCH_CHECK(summary.allocSize == 0);
+		const i64 spikeCount = SPIKE_SIZE / (i64)SPIKE_BLOCK;
+		BENCH_CHECK(summary.totalCount == (i64)(pairs + spikeCount) * WRITER_COUNT);
+		//only size 16 falls into first class
+		BENCH_CHECK(summary.histogram[0] == (i64)(((pairs - 1) / 1024 + 1) * WRITER_COUNT));
+		BENCH_CHECK(summary.histogram[AllocatorStats::HISTOGRAM_SIZE - 1] == 0);
+		//spikes may overlap, every thread can hold back up to one batch either way
+		BENCH_CHECK(summary.peakSize >= SPIKE_SIZE - (i64)WRITER_COUNT * AllocatorStats::PEAK_BATCH_SIZE);
+		BENCH_CHECK(summary.peakSize <= (SPIKE_SIZE + AllocatorStats::PEAK_BATCH_SIZE) * (i64)WRITER_COUNT);
+	}
+
+	//peak inside frame is seen, not just sizes at frame ends
+	{
+		static AllocatorStats stats;
+		stats.OnAllocate(1000);
+		stats.NewFrame();
+		for (i64 i = 0; i < SPIKE_SIZE / (i64)SPIKE_BLOCK; ++i)
+			stats.OnAllocate(SPIKE_BLOCK);
+		for (i64 i = 0; i < SPIKE_SIZE / (i64)SPIKE_BLOCK; ++i)
+			stats.OnDeallocate(SPIKE_BLOCK);
+		stats.OnDeallocate(1000);
+		stats.OnAllocate(10);
+		stats.NewFrame();
+		const AllocatorStats::Summary summary = stats.GetSummary();
+		BENCH_CHECK(summary.peakSize > SPIKE_SIZE + 1000 - AllocatorStats::PEAK_BATCH_SIZE);
+		BENCH_CHECK(summary.peakSize <= SPIKE_SIZE + 1000);
+		BENCH_CHECK(summary.allocSize == 10);
+		BENCH_CHECK(summary.lastFrameCount == SPIKE_SIZE / (i64)SPIKE_BLOCK + 1);
+	}
+
+	if (!quick)
+	{
+		static AllocatorStats stats;
+		MainAllocator mainAllocator;
+		const double statsTime = StatsPairs(stats, pairs);
+		const double allocatorTime = AllocatorPairs(mainAllocator, pairs);
+		printf("%zu allocate/deallocate pairs on one thread\n", pairs);
+		printf("  stats update  %6.2f ns per pair\n", statsTime * 1e6 / (double)pairs);
+		printf("  MainAllocator %6.2f ns per pair, without stats\n", allocatorTime * 1e6 / (double)pairs);
+	}
+
+	printf("allocator_stats: ok\n");
+	return 0;
+}
@@ -0,0 +1,205 @@
+#include "bench.h"
+
+#include "core/allocators.h"
+#include "core/entity.h"
+#include "core/containers/array.h"
+#include "core/containers/associative_array.h"
+#include "core/file/blob.h"
+#include "core/file/path.h"
+
+
+using namespace Veng;
+
+
+//same as render scene keeps, handle stands for model reference taken by load
+struct ModelItem
+{
+	Entity entity;
+	u32 model;
+};
+
+
+//batches with unsorted, repeated and already present keys have to end like inserting them one by one
+static void CheckBulkInsert(Allocator& allocator, u32 keyRange, u32 batches)
+{
+	AssociativeArray<u32, u32> bulk(allocator);
+	AssociativeArray<u32, u32> single(allocator);
+	Array<u32> keys(allocator);
+	Array<u32> values(allocator);
+	Array<bool> inserted(allocator);
+
+	bench::Random random(keyRange);
+	for (u32 batch = 0; batch < batches; ++batch)
+	{
+		const u32 count = random.Next(64);
+		keys.Clear();
+		values.Clear();
+		for (u32 i = 0; i < count; ++i)
+		{
+			keys.PushBack(random.Next(keyRange));
+			values.PushBack(batch * 64 + i);
+		}
+		//every few batches comes in order, like serialized scene does
+		if (batch % 4 == 0)
+			Sort(keys.Begin(), keys.End());
+
+		inserted.Resize(count);
+		size_t expected = 0;
+		for (u32 i = 0; i < count; ++i)
+			expected += single.Insert(keys[i], values[i]) != nullptr ? 1 : 0;
+		BENCH_CHECK(bulk.BulkInsert(keys.Begin(), values.Begin(), count, inserted.Begin()) == expected);
+
+		//first occurrence of key wins, which is exactly the one whose value got in
+		for (u32 i = 0; i < count; ++i)
+		{
+			u32* value;
+			BENCH_CHECK(bulk.Find(keys[i], value));
+			BENCH_CHECK(inserted[i] == (*value == values[i]));
+		}
+
+		BENCH_CHECK(bulk.GetSize() == single.GetSize());
+		for (size_t i = 0; i < bulk.GetSize(); ++i)
+		{
+			BENCH_CHECK(bulk.GetKeys()[i] == single.GetKeys()[i]);
+			BENCH_CHECK(bulk.GetValues()[i] == single.GetValues()[i]);
+			BENCH_CHECK(i == 0 || bulk.GetKeys()[i - 1] < bulk.GetKeys()[i]);
+		}
+
+		//erase some, so later batches hit holes as well as present keys
+		for (u32 i = 0; i < count / 2; ++i)
+		{
+			const u32 key = random.Next(keyRange);
+			BENCH_CHECK(bulk.Erase(key) == single.Erase(key));
+		}
+	}
+}
+
+
+//what RenderScene::SerializeModels writes
+static void WriteModels(OutputBlob& blob, u32 count)
+{
+	blob.Write((u64)count);
+	char path[Path::BUFFER_LENGTH];
+	for (u32 i = 0; i < count; ++i)
+	{
+		blob.Write((Entity)(i * 3));
+		snprintf(path, sizeof(path), "models/props/model_%u.model", i % 1000);
+		blob.Write(Path(path));
+	}
+}
+
+struct Models
+{
+	explicit Models(Allocator& allocator) : items(allocator) {}
+
+	AssociativeArray<Entity, ModelItem> items;
+	u32 loaded = 0;
+	u32 released = 0;
+};
+
+//scene keeps reference of every model it holds, loads and releases count them
+static u32 LoadModel(Models& models, const Path& path)
+{
+	return ++models.loaded;
+}
+
+//RenderScene::DeserializeModels before bulk insert
+static void ReadModelsOneByOne(Allocator& allocator, InputBlob& blob, Models& models)
+{
+	u64 count;
+	blob.Read(count);
+	for (u64 i = 0; i < count; ++i)
+	{
+		Entity entity;
+		blob.Read(entity);
+		Path path;
+		blob.Read(path);
+		const u32 model = LoadModel(models, path);
+		if (models.items.Insert(entity, { entity, model }) == nullptr)
+			models.released++;
+	}
+}
+
+//RenderScene::DeserializeModels
+static void ReadModels(Allocator& allocator, InputBlob& blob, Models& models)
+{
+	u64 count;
+	blob.Read(count);
+
+	Array<Entity> entities(allocator);
+	Array<ModelItem> items(allocator);
+	Array<bool> inserted(allocator);
+	entities.Reserve((size_t)count);
+	items.Reserve((size_t)count);
+	for (u64 i = 0; i < count; ++i)
+	{
+		Entity entity;
+		blob.Read(entity);
+		Path path;
+		blob.Read(path);
+		entities.PushBack(entity);
+		items.PushBack(ModelItem{ entity, LoadModel(models, path) });
+	}
+
+	inserted.Resize(entities.GetSize());
+	if (models.items.BulkInsert(entities.Begin(), items.Begin(), entities.GetSize(), inserted.Begin()) == items.GetSize())
+		return;
+	for (size_t i = 0; i < items.GetSize(); ++i)
+	{
+		if (!inserted[i])
+			models.released++;
+	}
+}
+
+//scene already holds some of entities, every reference taken for skipped one has to be given back
+template<class ReadFunction>
+static double Deserialize(Allocator& allocator, const OutputBlob& stream, u32 count, ReadFunction read)
+{
+	Models models(allocator);
+	for (u32 i = 0; i < count; i += 97)
+		models.items.Insert((Entity)(i * 3), { (Entity)(i * 3), ++models.loaded });
+
+	InputBlob blob(stream.GetData(), stream.GetSize());
+	bench::Timer timer;
+	read(allocator, blob, models);
+	const double time = timer.GetMilliseconds();
+
+	BENCH_CHECK(models.items.GetSize() == count);
+	BENCH_CHECK(models.loaded - models.released == count);
+	for (size_t i = 0; i < models.items.GetSize(); ++i)
+		BENCH_CHECK(models.items.GetKeys()[i] == (Entity)(i * 3) && models.items.GetValues()[i].entity == (Entity)(i * 3));
+	return time;
+}
+
+
+int main(int argc, char** argv)
+{
+	const bool quick = bench::IsQuick(argc, argv);
+
+	MainAllocator allocator;
+	CheckBulkInsert(allocator, 100, 2'000);
+	CheckBulkInsert(allocator, 10'000, quick ? 2'000 : 20'000);
+
+	const u32 count = quick ? 10'000 : 100'000;
+	OutputBlob stream(allocator);
+	WriteModels(stream, count);
+
+	const u32 runs = quick ? 1 : 5;
+	double oneByOne = Deserialize(allocator, stream, count, &ReadModelsOneByOne);
+	double bulk = Deserialize(allocator, stream, count, &ReadModels);
+	for (u32 i = 1; i < runs; ++i)
+	{
+		oneByOne = Min(oneByOne, Deserialize(allocator, stream, count, &ReadModelsOneByOne));
+		bulk = Min(bulk, Deserialize(allocator, stream, count, &ReadModels));
+	}
+
+	if (!quick)
+	{
+		printf("deserialize %u models (ms)\n", count);
+		printf("  insert one by one  %8.2f\n", oneByOne);
+		printf("  bulk insert        %8.2f\n", bulk);
+	}
+
+	printf("associative_array: ok\n");
+	return 0;
+}
@@ -0,0 +1,71 @@
+#pragma once
+
+#include "core/int.h"
+#include "core/os/os_utils.h"
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+
+namespace Veng
+{
+
+namespace bench
+{
+
+
+//ctest passes --quick, harness then keeps its checks but runs on small inputs
+inline bool IsQuick(int argc, char** argv)
+{
+	for (int i = 1; i < argc; ++i)
+	{
+		if (strcmp(argv[i], "--quick") == 0)
+			return true;
+	}
+	return false;
+}
+
+
+class Timer
+{
+public:
+	Timer() : m_start(os::GetTimerValue()) {}
+
+	double GetMilliseconds() const
+	{
+		return (double)(os::GetTimerValue() - m_start) * 1000.0 / (double)os::GetTimerFrequency();
+	}
+
+private:
+	u64 m_start;
+};
+
+
+//xorshift, same sequence on every platform
+class Random
+{
+public:
+	explicit Random(u64 seed) : m_state(seed * 0x9E3779B97F4A7C15ull + 1) {}
+
+	u64 Next()
+	{
+		m_state ^= m_state << 13;
+		m_state ^= m_state >> 7;
+		m_state ^= m_state << 17;
+		return m_state;
+	}
+
+	u32 Next(u32 range) { return (u32)(Next() % range); }
+
+private:
+	u64 m_state;
+};
+
+
+}
+
+}
+
+
+#define BENCH_CHECK(cond) do{ if(!(cond)) { printf("check failed: %s (%s:%d)\n", #cond, __FILE__, __LINE__); exit(1); } }while(0)
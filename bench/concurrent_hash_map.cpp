@@ -0,0 +1,236 @@
+#include "bench.h"
+
+#include "core/allocators.h"
+#include "core/containers/concurrent_hash_map.h"
+#include "core/containers/hash_map.h"
+#include "core/threading/os_utils.h"
+#include "core/threading/threads.h"
+
+#include <thread>
+
+
+using namespace Veng;
+
+
+static const u32 MAX_WORKERS = 16;
+static const u32 KEY_RANGE = 1 << 16;
+
+
+//odd multiplier makes it bijection, so keys from different indexes never collide
+static u32 KeyFromIndex(u32 index)
+{
+	return index * 0x9E3779B1u;
+}
+
+static u32 ValueFromKey(u32 key)
+{
+	return ~key;
+}
+
+
+//what registries used before, whole map behind one lock
+class LockedHashMap
+{
+public:
+	explicit LockedHashMap(Allocator& allocator) : m_map(allocator) {}
+
+	bool Find(const u32& key, u32& value) const
+	{
+		ScopeLock<Mutex> lock(m_mutex);
+		u32* found;
+		if (!m_map.Find(key, found))
+			return false;
+		value = *found;
+		return true;
+	}
+
+	bool Insert(const u32& key, const u32& value)
+	{
+		ScopeLock<Mutex> lock(m_mutex);
+		return m_map.Insert(key, value) != nullptr;
+	}
+
+	bool Erase(const u32& key)
+	{
+		ScopeLock<Mutex> lock(m_mutex);
+		return m_map.Erase(key);
+	}
+
+	size_t GetSize() const
+	{
+		ScopeLock<Mutex> lock(m_mutex);
+		return m_map.GetSize();
+	}
+
+private:
+	mutable Mutex m_mutex;
+	HashMap<u32, u32> m_map;
+};
+
+
+//threads can outnumber cores, spinning alone would burn whole time slice of the thread we wait for
+static void Backoff(u32& spins)
+{
+	if (++spins < 64)
+		CpuRelax();
+	else
+		std::this_thread::yield();
+}
+
+
+template<class MapType>
+struct SharedData
+{
+	MapType* map;
+	MainAllocator* allocator;
+	u32 workers;
+	u32 operations;//per worker
+	volatile i32 started;
+};
+
+//worker is the only one inserting and erasing keys with index % workers == worker, so it knows which of them
+//are present; keys of other workers can be there or not, but when found they carry their value
+template<class MapType>
+struct Worker
+{
+	SharedData<MapType>* data;
+	u32 index;
+	u8 present[KEY_RANGE];
+	i64 size;//own keys present at the end
+};
+
+//9 of 10 operations are lookups, like registries see them
+template<class MapType>
+static u32 RunWorker(void* arg)
+{
+	Worker<MapType>& worker = *static_cast<Worker<MapType>*>(arg);
+	SharedData<MapType>& data = *worker.data;
+	MapType& map = *data.map;
+
+	AtomicAdd(&data.started, 1);
+	u32 spins = 0;
+	while (AtomicLoad(&data.started) < (i32)data.workers)
+		Backoff(spins);
+
+	bench::Random random(worker.index + 1);
+	for (u32 i = 0; i < data.operations; ++i)
+	{
+		const u32 operation = random.Next(10);
+		if (operation < 9)
+		{
+			const u32 index = random.Next(KEY_RANGE);
+			const u32 key = KeyFromIndex(index);
+			u32 value;
+			const bool found = map.Find(key, value);
+			BENCH_CHECK(!found || value == ValueFromKey(key));
+			if (index % data.workers == worker.index)
+				BENCH_CHECK(found == (worker.present[index] != 0));
+			continue;
+		}
+
+		const u32 index = random.Next(KEY_RANGE / data.workers) * data.workers + worker.index;
+		const u32 key = KeyFromIndex(index);
+		if (worker.present[index] != 0)
+		{
+			BENCH_CHECK(map.Erase(key));
+			worker.present[index] = 0;
+			worker.size--;
+		}
+		else
+		{
+			BENCH_CHECK(map.Insert(key, ValueFromKey(key)));
+			worker.present[index] = 1;
+			worker.size++;
+		}
+	}
+
+	data.allocator->FlushThreadCache();
+	return 0;
+}
+
+//half of keys is inserted up front, so map doesn't grow while workers run
+template<class MapType>
+static double Run(MainAllocator& allocator, MapType& map, u32 workers, u32 operations)
+{
+	SharedData<MapType> data = {};
+	data.map = &map;
+	data.allocator = &allocator;
+	data.workers = workers;
+	data.operations = operations;
+
+	Worker<MapType>* threads = static_cast<Worker<MapType>*>(allocator.Allocate(sizeof(Worker<MapType>) * workers, alignof(Worker<MapType>)));
+	for (u32 w = 0; w < workers; ++w)
+	{
+		threads[w].data = &data;
+		threads[w].index = w;
+		threads[w].size = 0;
+		memory::Set(threads[w].present, 0, sizeof(threads[w].present));
+	}
+	for (u32 index = 0; index < KEY_RANGE; index += 2)
+	{
+		const u32 key = KeyFromIndex(index);
+		BENCH_CHECK(map.Insert(key, ValueFromKey(key)));
+		threads[index % workers].present[index] = 1;
+		threads[index % workers].size++;
+	}
+
+	threadHandle handles[MAX_WORKERS];
+	bench::Timer timer;
+	for (u32 w = 0; w < workers; ++w)
+		handles[w] = StartThread(&RunWorker<MapType>, &threads[w]);
+	for (u32 w = 0; w < workers; ++w)
+		JoinThread(handles[w]);
+	const double time = timer.GetMilliseconds();
+
+	//every worker's view of its keys has to match what is left in map
+	i64 size = 0;
+	for (u32 w = 0; w < workers; ++w)
+		size += threads[w].size;
+	BENCH_CHECK(map.GetSize() == (size_t)size);
+	for (u32 w = 0; w < workers; ++w)
+	{
+		for (u32 index = w; index < KEY_RANGE; index += workers)
+		{
+			const u32 key = KeyFromIndex(index);
+			u32 value;
+			BENCH_CHECK(map.Find(key, value) == (threads[w].present[index] != 0));
+			if (threads[w].present[index] != 0)
+				BENCH_CHECK(map.Erase(key));
+		}
+	}
+	BENCH_CHECK(map.GetSize() == 0);
+
+	allocator.Deallocate(threads);
+	return time;
+}
+
+
+int main(int argc, char** argv)
+{
+	const bool quick = bench::IsQuick(argc, argv);
+	const u32 operations = quick ? 100'000 : 4'000'000;//split between workers
+
+	MainAllocator allocator;
+
+	if (!quick)
+		printf("threads  concurrent  mutex+HashMap (M operations/s)\n");
+	for (u32 workers = 1; workers <= MAX_WORKERS; workers *= 2)
+	{
+		const u32 perWorker = operations / workers;
+
+		ConcurrentHashMap<u32, u32> concurrent(allocator);
+		const double concurrentTime = Run(allocator, concurrent, workers, perWorker);
+
+		LockedHashMap locked(allocator);
+		const double lockedTime = Run(allocator, locked, workers, perWorker);
+
+		if (!quick)
+		{
+			const double total = (double)(perWorker * workers) / 1000.0;
+			printf("%7u  %10.2f  %13.2f\n", workers, total / concurrentTime, total / lockedTime);
+		}
+	}
+
+	printf("concurrent_hash_map: ok\n");
+	return 0;
+}
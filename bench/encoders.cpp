@@ -0,0 +1,126 @@
+#include "bench.h"
+
+#include "core/allocators.h"
+#include "core/math/math.h"
+#include "core/threading/jobs.h"
+#include "core/threading/os_utils.h"
+
+#include <bgfx/bgfx.h>
+
+
+using namespace Veng;
+
+
+//same split RenderSystem::SubmitDraws does, keep them in sync
+static const u32 MIN_DRAWS_PER_ENCODER = 256;
+static const bgfx::ViewId VIEW = 0;
+
+
+struct FrameCounters
+{
+	volatile i32 activeEncoders;
+	volatile i32 maxActiveEncoders;
+	volatile i64 submitted;
+	volatile i32 chunks;
+};
+
+
+static void SubmitDraws(JobSystem& jobSystem, u32 drawCount, FrameCounters& counters)
+{
+	static const float transform[16] = {
+		1.0f, 0.0f, 0.0f, 0.0f,
+		0.0f, 1.0f, 0.0f, 0.0f,
+		0.0f, 0.0f, 1.0f, 0.0f,
+		0.0f, 0.0f, 0.0f, 1.0f,
+	};
+
+	const u32 maxChunks = Max((u32)bgfx::getCaps()->limits.maxEncoders, 1U);
+	const u32 chunkCount = Min(maxChunks, (drawCount + MIN_DRAWS_PER_ENCODER - 1) / MIN_DRAWS_PER_ENCODER);
+	const size_t grain = (chunkCount > 1) ? (drawCount + chunkCount - 1) / chunkCount : drawCount;
+
+	ParallelFor(jobSystem, 0, drawCount, grain, [&](size_t begin, size_t end)
+	{
+		bgfx::Encoder* encoder = bgfx::begin();
+		while (encoder == nullptr)
+		{
+			CpuRelax();
+			encoder = bgfx::begin();
+		}
+
+		const i32 active = AtomicAdd(&counters.activeEncoders, 1) + 1;
+		i32 maxActive = AtomicLoad(&counters.maxActiveEncoders);
+		while (active > maxActive)
+		{
+			const i32 previous = AtomicCompareExchange(&counters.maxActiveEncoders, active, maxActive);
+			if (previous == maxActive)
+				break;
+			maxActive = previous;
+		}
+
+		//invalid program makes draw empty, it's still recorded and sorted like any other one
+		for (size_t i = begin; i < end; ++i)
+		{
+			encoder->setTransform(transform);
+			encoder->setState(BGFX_STATE_DEFAULT);
+			encoder->submit(VIEW, BGFX_INVALID_HANDLE);
+		}
+
+		AtomicAdd(&counters.activeEncoders, -1);
+		AtomicAdd(&counters.submitted, (i64)(end - begin));
+		AtomicAdd(&counters.chunks, 1);
+		bgfx::end(encoder);
+	});
+
+	BENCH_CHECK(counters.submitted == (i64)drawCount);
+	BENCH_CHECK(counters.chunks <= (i32)maxChunks);
+	BENCH_CHECK(counters.maxActiveEncoders <= (i32)maxChunks);
+}
+
+
+int main(int argc, char** argv)
+{
+	const bool quick = bench::IsQuick(argc, argv);
+	const u32 frames = quick ? 10 : 200;
+
+	//calling thread is api thread like engine's render thread, bgfx renders on its own thread
+	bgfx::Init init;
+	init.type = bgfx::RendererType::Noop;
+	init.resolution.width = 1280;
+	init.resolution.height = 720;
+	BENCH_CHECK(bgfx::init(init));
+	bgfx::setViewRect(VIEW, 0, 0, 1280, 720);
+
+	MainAllocator allocator;
+	JobSystem* jobSystem = JobSystem::Create(allocator);
+
+	printf("max encoders: %u, workers: %u\n", (u32)bgfx::getCaps()->limits.maxEncoders, jobSystem->GetWorkerCount());
+	static const u32 DRAW_COUNTS[] = { 100, 1000, 10000, 100000 };
+	for (u32 drawCount : DRAW_COUNTS)
+	{
+		u32 lastFrame = bgfx::frame();
+		bench::Timer timer;
+		for (u32 f = 0; f < frames; ++f)
+		{
+			FrameCounters counters = {};
+			SubmitDraws(*jobSystem, drawCount, counters);
+			const u32 frame = bgfx::frame();
+			BENCH_CHECK(frame == lastFrame + 1);
+			lastFrame = frame;
+		}
+		const double time = timer.GetMilliseconds();
+
+		if (!quick)
+		{
+			printf("%6u draws: %7.3f ms per frame, %u encoders in last frame\n"
+				, drawCount
+				, time / frames
+				, (u32)bgfx::getStats()->numEncoders);
+		}
+	}
+
+	JobSystem::Destroy(jobSystem, allocator);
+	bgfx::shutdown();
+
+	printf("encoders: ok\n");
+	return 0;
+}
@@ -0,0 +1,115 @@
+#include "bench.h"
+
+#include "core/allocators.h"
+#include "core/containers/array.h"
+#include "core/containers/small_array.h"
+
+
+using namespace Veng;
+
+
+//same size as command World::PlaybackCommands collects
+struct ScratchItem
+{
+	u64 key;
+	u32 order;
+	u32 value;
+};
+
+
+//per frame scratch the way engine uses it: many short lived arrays growing from nothing, read once and dropped;
+//allocator is the one array is bound to, generic arrays see it only through base class
+template<class ArrayType, class AllocatorType>
+static u64 RunFrames(AllocatorType& allocator, FrameAllocator* frameAllocator, u32 frames, u32 arraysPerFrame)
+{
+	bench::Random random(7);
+	u64 checksum = 0;
+	for (u32 frame = 0; frame < frames; ++frame)
+	{
+		if (frameAllocator != nullptr)
+			frameAllocator->NewFrame();
+
+		for (u32 a = 0; a < arraysPerFrame; ++a)
+		{
+			ArrayType items(allocator);
+			const u32 count = 1 + random.Next(256);
+			for (u32 i = 0; i < count; ++i)
+			{
+				ScratchItem& item = items.PushBack();
+				item.key = (u64)frame * arraysPerFrame + a;
+				item.order = i;
+				item.value = random.Next(1000);
+			}
+			for (const ScratchItem& item : items)
+				checksum += item.key + item.order + item.value;
+		}
+	}
+	return checksum;
+}
+
+//what generic array would pass down, compiler can't see which allocator is behind it
+static Allocator& Opaque(Allocator& allocator)
+{
+	Allocator* volatile opaque = &allocator;
+	return *opaque;
+}
+
+
+int main(int argc, char** argv)
+{
+	const bool quick = bench::IsQuick(argc, argv);
+	const u32 frames = quick ? 50 : 2'000;
+	const u32 arraysPerFrame = 256;
+
+	MainAllocator mainAllocator;
+	FrameAllocator frameAllocator(mainAllocator);
+
+	const u32 runs = quick ? 1 : 5;
+	double mainTime = 0;
+	double genericTime = 0;
+	double concreteTime = 0;
+	u64 expected = 0;
+	for (u32 run = 0; run < runs; ++run)
+	{
+		bench::Timer timer;
+		const u64 mainSum = RunFrames<Array<ScratchItem>>(Opaque(mainAllocator), nullptr, frames, arraysPerFrame);
+		const double mainRun = timer.GetMilliseconds();
+
+		timer = bench::Timer();
+		const u64 genericSum = RunFrames<Array<ScratchItem>>(Opaque(frameAllocator), &frameAllocator, frames, arraysPerFrame);
+		const double genericRun = timer.GetMilliseconds();
+
+		timer = bench::Timer();
+		const u64 concreteSum = RunFrames<Array<ScratchItem, FrameAllocator>>(frameAllocator, &frameAllocator, frames, arraysPerFrame);
+		const double concreteRun = timer.GetMilliseconds();
+
+		//same random sequence, so every variant has to see the same items
+		if (run == 0)
+			expected = mainSum;
+		BENCH_CHECK(mainSum == expected && genericSum == expected && concreteSum == expected);
+
+		mainTime = (run == 0) ? mainRun : Min(mainTime, mainRun);
+		genericTime = (run == 0) ? genericRun : Min(genericTime, genericRun);
+		concreteTime = (run == 0) ? concreteRun : Min(concreteTime, concreteRun);
+	}
+
+	//small array spills to frame allocator the same way
+	{
+		frameAllocator.NewFrame();
+		SmallArray<u32, 16, FrameAllocator> small(frameAllocator);
+		for (u32 i = 0; i < 100; ++i)
+			small.PushBack(i);
+		BENCH_CHECK(small.GetSize() == 100 && small[0] == 0 && small[99] == 99);
+	}
+
+	if (!quick)
+	{
+		printf("%u frames, %u scratch arrays per frame (ms)\n", frames, arraysPerFrame);
+		printf("  Array<T> on MainAllocator              %8.2f\n", mainTime);
+		printf("  Array<T> on FrameAllocator             %8.2f\n", genericTime);
+		printf("  Array<T, FrameAllocator>               %8.2f\n", concreteTime);
+	}
+
+	printf("frame_array: ok\n");
+	return 0;
+}
@@ -0,0 +1,175 @@
+#include "bench.h"
+
+#include "core/allocators.h"
+#include "core/containers/array.h"
+#include "core/containers/hash_map.h"
+#include "core/algorithms/sort.h"
+
+
+using namespace Veng;
+
+
+//odd multiplier makes it bijection, so keys from different indexes never collide
+static u32 KeyFromIndex(u32 index)
+{
+	return index * 0x9E3779B1u;
+}
+
+
+//random operations checked against flags of keys which should be present
+static void CheckOperations(Allocator& allocator, u32 keyRange, u32 operations)
+{
+	HashMap<u32, u32> map(allocator);
+	Array<u8> present(allocator);
+	present.Resize(keyRange);
+	for (u8& value : present)
+		value = 0;
+
+	bench::Random random(keyRange);
+	size_t size = 0;
+	for (u32 i = 0; i < operations; ++i)
+	{
+		const u32 index = random.Next(keyRange);
+		const u32 key = KeyFromIndex(index);
+		u32* value;
+		switch (random.Next(3))
+		{
+			case 0:
+				BENCH_CHECK((map.Insert(key, index) != nullptr) == (present[index] == 0));
+				size += present[index] == 0 ? 1 : 0;
+				present[index] = 1;
+				break;
+			case 1:
+				BENCH_CHECK(map.Erase(key) == (present[index] != 0));
+				size -= present[index] != 0 ? 1 : 0;
+				present[index] = 0;
+				break;
+			default:
+				BENCH_CHECK(map.Find(key, value) == (present[index] != 0));
+				BENCH_CHECK(present[index] == 0 || *value == index);
+				break;
+		}
+		BENCH_CHECK(map.GetSize() == size);
+	}
+
+	//iteration visits every present key exactly once
+	size_t visited = 0;
+	for (const auto& node : map)
+	{
+		BENCH_CHECK(node.key == KeyFromIndex(node.value) && present[node.value] == 1);
+		present[node.value] = 2;
+		++visited;
+	}
+	BENCH_CHECK(visited == size);
+
+	HashMap<u32, u32> moved(Utils::Move(map));
+	BENCH_CHECK(moved.GetSize() == size && map.GetSize() == 0);
+	for (u32 index = 0; index < keyRange; ++index)
+	{
+		u32* value;
+		BENCH_CHECK(moved.Find(KeyFromIndex(index), value) == (present[index] != 0));
+	}
+}
+
+
+struct Timings
+{
+	double insert;
+	double find;
+	double erase;
+};
+
+//shared machines are noisy, best of several runs is the one to compare
+static void KeepBest(Timings& best, const Timings& timings)
+{
+	best.insert = Min(best.insert, timings.insert);
+	best.find = Min(best.find, timings.find);
+	best.erase = Min(best.erase, timings.erase);
+}
+
+static Timings Measure(Allocator& allocator, const Array<u32>& keys, u32 finds)
+{
+	Timings timings;
+	HashMap<u32, u32> map(allocator);
+
+	bench::Timer insertTimer;
+	for (size_t i = 0; i < keys.GetSize(); ++i)
+		map.Insert(keys[i], (u32)i);
+	timings.insert = insertTimer.GetMilliseconds();
+	BENCH_CHECK(map.GetSize() == keys.GetSize());
+
+	//every other lookup misses
+	bench::Random random(finds);
+	u32 found = 0;
+	bench::Timer findTimer;
+	for (u32 i = 0; i < finds; ++i)
+	{
+		const u32 key = keys[random.Next((u32)keys.GetSize())];
+		u32* value;
+		found += map.Find((i & 1) ? key : ~key, value) ? 1 : 0;
+	}
+	timings.find = findTimer.GetMilliseconds();
+	BENCH_CHECK(found >= finds / 2);
+
+	bench::Timer eraseTimer;
+	for (size_t i = 0; i < keys.GetSize(); ++i)
+		map.Erase(keys[i]);
+	timings.erase = eraseTimer.GetMilliseconds();
+	BENCH_CHECK(map.GetSize() == 0);
+
+	return timings;
+}
+
+
+int main(int argc, char** argv)
+{
+	const bool quick = bench::IsQuick(argc, argv);
+
+	MainAllocator allocator;
+	CheckOperations(allocator, 1000, 100'000);
+	CheckOperations(allocator, 100'000, quick ? 200'000 : 2'000'000);
+
+	const u32 count = quick ? 100'000 : 1'000'000;
+	const u32 finds = count * 4;
+
+	Array<u32> keys(allocator);
+	keys.Reserve(count);
+	bench::Random random(7);
+	for (u32 i = 0; i < count; ++i)
+		keys.PushBack(KeyFromIndex(i) ^ (u32)random.Next());
+	//random xor can make duplicates, map has to see each key once
+	Sort(keys.Begin(), keys.End());
+	size_t unique = 0;
+	for (size_t i = 0; i < keys.GetSize(); ++i)
+	{
+		if (unique == 0 || keys[unique - 1] != keys[i])
+			keys[unique++] = keys[i];
+	}
+	keys.Resize(unique);
+	for (size_t i = keys.GetSize(); i > 1; --i)
+		keys.Swap(i - 1, random.Next((u32)i));
+
+	const u32 runs = quick ? 1 : 5;
+	Timings randomKeys = Measure(allocator, keys, finds);
+	for (u32 i = 1; i < runs; ++i)
+		KeepBest(randomKeys, Measure(allocator, keys, finds));
+
+	//keys differing only in high bits, they all fell into one bucket with former identity hash
+	const u32 strided = count / 10;
+	keys.Clear();
+	for (u32 i = 0; i < strided; ++i)
+		keys.PushBack(i * 4096);
+	Timings stridedKeys = Measure(allocator, keys, strided * 4);
+	for (u32 i = 1; i < runs; ++i)
+		KeepBest(stridedKeys, Measure(allocator, keys, strided * 4));
+
+	if (!quick)
+	{
+		printf("                      insert      find     erase (ms)\n");
+		printf("%7u random keys  %8.2f  %8.2f  %8.2f\n", (u32)unique, randomKeys.insert, randomKeys.find, randomKeys.erase);
+		printf("%7u keys i*4096  %8.2f  %8.2f  %8.2f\n", strided, stridedKeys.insert, stridedKeys.find, stridedKeys.erase);
+	}
+
+	printf("hash_map: ok\n");
+	return 0;
+}
@@ -0,0 +1,118 @@
+#include "bench.h"
+
+#include "core/allocators.h"
+#include "core/threading/jobs.h"
+#include "core/threading/os_utils.h"
+#include "core/os/os_utils.h"
+
+
+using namespace Veng;
+
+
+static const u32 EXTERNAL_THREADS = 3;
+static const u32 JOBS_PER_RUN = 3000;
+
+
+struct ExternalData
+{
+	JobSystem* jobSystem;
+	u32 iterations;
+	volatile i32 executed;
+};
+
+
+static void CountJob(void* data)
+{
+	AtomicAdd(&static_cast<ExternalData*>(data)->executed, 1);
+}
+
+static void ParallelSum(JobSystem& jobSystem, size_t count, size_t grain)
+{
+	volatile i64 sum = 0;
+	ParallelFor(jobSystem, 0, count, grain, [&sum](size_t begin, size_t end)
+	{
+		AtomicAdd(&sum, (i64)(end - begin));
+	});
+	BENCH_CHECK(sum == (i64)count);
+}
+
+//thread which is not part of job system, like render thread, runs and waits on its own jobs
+static u32 ExternalThread(void* arg)
+{
+	ExternalData& data = *static_cast<ExternalData*>(arg);
+	Job jobs[JOBS_PER_RUN];
+	for (Job& job : jobs)
+	{
+		job.function = &CountJob;
+		job.data = &data;
+	}
+
+	for (u32 i = 0; i < data.iterations; ++i)
+	{
+		ParallelSum(*data.jobSystem, 100'000, 100);
+
+		JobCounter counter;
+		data.jobSystem->Run(jobs, JOBS_PER_RUN, &counter);
+		data.jobSystem->Wait(&counter);
+		BENCH_CHECK(AtomicLoad(&counter.value) == 0);
+	}
+	return 0;
+}
+
+
+//owner thread keeps using job system while external threads inject their jobs into it
+static double Run(Allocator& allocator, u32 workers, u32 iterations)
+{
+	JobSystem* jobSystem = JobSystem::Create(allocator, workers);
+	BENCH_CHECK(jobSystem->GetWorkerCount() == workers);
+
+	ExternalData data[EXTERNAL_THREADS];
+	threadHandle threads[EXTERNAL_THREADS];
+	bench::Timer timer;
+	for (u32 i = 0; i < EXTERNAL_THREADS; ++i)
+	{
+		data[i].jobSystem = jobSystem;
+		data[i].iterations = iterations;
+		data[i].executed = 0;
+		threads[i] = StartThread(&ExternalThread, &data[i]);
+	}
+
+	for (u32 i = 0; i < iterations; ++i)
+		ParallelSum(*jobSystem, 50'000, 50);
+
+	for (u32 i = 0; i < EXTERNAL_THREADS; ++i)
+		JoinThread(threads[i]);
+	const double time = timer.GetMilliseconds();
+
+	for (const ExternalData& external : data)
+		BENCH_CHECK(external.executed == (i32)(iterations * JOBS_PER_RUN));
+
+	JobSystem::Destroy(jobSystem, allocator);
+	return time;
+}
+
+
+int main(int argc, char** argv)
+{
+	const bool quick = bench::IsQuick(argc, argv);
+	const u32 iterations = quick ? 30 : 300;
+
+	MainAllocator allocator;
+
+	//default is one worker per core besides calling thread, explicit zero means none
+	const u32 processors = os::GetSystemInfo().numberOfProcessors;
+	JobSystem* defaultJobSystem = JobSystem::Create(allocator);
+	BENCH_CHECK(defaultJobSystem->GetWorkerCount() == Min((processors > 1) ? processors - 1 : 0, JobSystem::MAX_WORKERS));
+	JobSystem::Destroy(defaultJobSystem, allocator);
+
+	static const u32 WORKER_COUNTS[] = { 0, 1, 3 };
+	for (u32 workers : WORKER_COUNTS)
+	{
+		const double time = Run(allocator, workers, iterations);
+		if (!quick)
+			printf("%u workers, %u external threads: %8.2f ms\n", workers, EXTERNAL_THREADS, time);
+	}
+
+	printf("jobs: ok\n");
+	return 0;
+}
@@ -0,0 +1,127 @@
+#include "bench.h"
+
+#include "core/allocators.h"
+#include "core/threading/os_utils.h"
+
+
+using namespace Veng;
+
+
+static const size_t LIVE_COUNT = 4096;
+static const u32 THREAD_COUNT = 4;
+
+
+//sizes are spread evenly over size classes, not over bytes, like small engine objects are
+static size_t RandomSize(bench::Random& random)
+{
+	const size_t shift = 4 + random.Next(9);
+	return ((size_t)1 << shift) - random.Next((u32)1 << (shift - 1));
+}
+
+
+//every step frees random live block and allocates new one of random size in its place
+static double MixedPairs(Allocator& allocator, size_t pairs, bool check, u64 seed = 1)
+{
+	void* live[LIVE_COUNT] = {};
+	size_t sizes[LIVE_COUNT] = {};
+	bench::Random random(seed);
+
+	bench::Timer timer;
+	for (size_t i = 0; i < pairs; ++i)
+	{
+		const size_t slot = random.Next((u32)LIVE_COUNT);
+		if (live[slot] != nullptr)
+		{
+			if (check)
+			{
+				const u8* bytes = static_cast<const u8*>(live[slot]);
+				BENCH_CHECK(bytes[0] == (u8)slot && bytes[sizes[slot] - 1] == (u8)slot);
+			}
+			allocator.Deallocate(live[slot]);
+		}
+
+		sizes[slot] = RandomSize(random);
+		live[slot] = allocator.Allocate(sizes[slot], 8);
+		if (check)
+		{
+			BENCH_CHECK(((uintptr)live[slot] & 7) == 0);
+			BENCH_CHECK(allocator.GetSize(live[slot]) >= sizes[slot]);
+			memset(live[slot], (u8)slot, sizes[slot]);
+		}
+	}
+	const double time = timer.GetMilliseconds();
+
+	for (void* ptr : live)
+	{
+		if (ptr != nullptr)
+			allocator.Deallocate(ptr);
+	}
+	return time;
+}
+
+
+struct ThreadData
+{
+	Allocator* allocator;
+	size_t pairs;
+	u32 index;
+};
+
+static u32 MixedPairsThread(void* arg)
+{
+	const ThreadData& data = *static_cast<ThreadData*>(arg);
+	MixedPairs(*data.allocator, data.pairs, true, data.index + 2);
+	return 0;
+}
+
+//threads share slabs of same classes, block of one thread must never show up in another
+static void CheckThreads(Allocator& allocator, size_t pairs)
+{
+	ThreadData data[THREAD_COUNT];
+	threadHandle threads[THREAD_COUNT];
+	for (u32 i = 0; i < THREAD_COUNT; ++i)
+	{
+		data[i] = { &allocator, pairs, i };
+		threads[i] = StartThread(&MixedPairsThread, &data[i]);
+	}
+	for (threadHandle thread : threads)
+		JoinThread(thread);
+}
+
+
+int main(int argc, char** argv)
+{
+	const bool quick = bench::IsQuick(argc, argv);
+	const size_t pairs = quick ? 100'000 : 1'000'000;
+
+	MainAllocator mainAllocator;
+	{
+		PoolAllocator pool(mainAllocator);
+		MixedPairs(pool, pairs, true);
+		BENCH_CHECK(pool.GetAllocCount() == 0);
+		//kept are only last slab of every size class and one empty chunk
+		BENCH_CHECK(pool.GetBlocksSize() <= 10);
+
+		//alignment bigger than block forces bigger class
+		void* aligned = pool.Allocate(24, 256);
+		BENCH_CHECK(((uintptr)aligned & 255) == 0);
+		aligned = pool.Reallocate(aligned, 8000, 16);
+		BENCH_CHECK(pool.GetSize(aligned) >= 8000);
+		pool.Deallocate(aligned);
+
+		CheckThreads(pool, pairs / THREAD_COUNT);
+		BENCH_CHECK(pool.GetAllocCount() == 0);
+
+		if (!quick)
+		{
+			const double poolTime = MixedPairs(pool, pairs, false);
+			const double mainTime = MixedPairs(mainAllocator, pairs, false);
+			printf("%zu mixed-size alloc/free pairs, 16B-4KB\n", pairs);
+			printf("  MainAllocator %8.1f ms\n", mainTime);
+			printf("  PoolAllocator %8.1f ms\n", poolTime);
+		}
+	}
+
+	printf("pool_allocator: ok\n");
+	return 0;
+}
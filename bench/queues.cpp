@@ -0,0 +1,209 @@
+#include "bench.h"
+
+#include "core/allocators.h"
+#include "core/containers/circular_buffer.h"
+#include "core/threading/os_utils.h"
+
+#include <thread>
+
+
+using namespace Veng;
+
+
+static const size_t CAPACITY = 1024;
+static const u32 MAX_PRODUCERS = 8;
+
+
+//threads can outnumber cores, spinning alone would burn whole time slice of the thread we wait for
+static void Backoff(u32& spins)
+{
+	if (++spins < 64)
+		CpuRelax();
+	else
+		std::this_thread::yield();
+}
+
+
+struct SPSCData
+{
+	SPSCQueue<u64>* queue;
+	u64 count;
+};
+
+static u32 SPSCProducer(void* data)
+{
+	const SPSCData& spsc = *static_cast<SPSCData*>(data);
+	for (u64 i = 0; i < spsc.count; ++i)
+	{
+		u32 spins = 0;
+		while (!spsc.queue->Push(i))
+			Backoff(spins);
+	}
+	return 0;
+}
+
+//consumer runs on calling thread, values have to come in order
+static double SPSC(Allocator& allocator, u64 count)
+{
+	SPSCQueue<u64> queue(allocator, CAPACITY);
+	SPSCData data = { &queue, count };
+
+	bench::Timer timer;
+	threadHandle producer = StartThread(&SPSCProducer, &data);
+	for (u64 i = 0; i < count; ++i)
+	{
+		u64 value;
+		u32 spins = 0;
+		while (!queue.Pop(value))
+			Backoff(spins);
+		BENCH_CHECK(value == i);
+	}
+	JoinThread(producer);
+	const double time = timer.GetMilliseconds();
+
+	u64 value;
+	BENCH_CHECK(!queue.Pop(value));
+	return time;
+}
+
+
+//value is producer in high half and its sequence number in low half
+struct MPMCData
+{
+	MPMCQueue<u64>* queue;
+	u64 count;//per producer
+	u32 producers;
+	volatile i32 started;
+	volatile i64 consumed;
+	//written by consumers once they finish, each one sums what it got
+	volatile i64 sums[MAX_PRODUCERS];
+	volatile i64 counts[MAX_PRODUCERS];
+};
+
+struct MPMCThread
+{
+	MPMCData* data;
+	u32 index;
+};
+
+static void WaitForStart(MPMCData& data)
+{
+	AtomicAdd(&data.started, 1);
+	u32 spins = 0;
+	while (AtomicLoad(&data.started) < (i32)data.producers * 2)
+		Backoff(spins);
+}
+
+static u32 MPMCProducer(void* arg)
+{
+	const MPMCThread& thread = *static_cast<MPMCThread*>(arg);
+	MPMCData& data = *thread.data;
+	WaitForStart(data);
+	for (u64 i = 0; i < data.count; ++i)
+	{
+		u32 spins = 0;
+		while (!data.queue->Push(((u64)thread.index << 32) | i))
+			Backoff(spins);
+	}
+	return 0;
+}
+
+//single consumer gets values of one producer in the order they were pushed
+static u32 MPMCConsumer(void* arg)
+{
+	MPMCData& data = *static_cast<MPMCThread*>(arg)->data;
+	WaitForStart(data);
+
+	i64 last[MAX_PRODUCERS];
+	i64 sums[MAX_PRODUCERS] = {};
+	i64 counts[MAX_PRODUCERS] = {};
+	for (i64& value : last)
+		value = -1;
+
+	const i64 total = (i64)(data.count * data.producers);
+	u32 spins = 0;
+	for (;;)
+	{
+		u64 value;
+		if (!data.queue->Pop(value))
+		{
+			if (AtomicLoad(&data.consumed) == total)
+				break;
+			Backoff(spins);
+			continue;
+		}
+		spins = 0;
+
+		const u32 producer = (u32)(value >> 32);
+		const i64 sequence = (i64)(value & 0xffffffff);
+		BENCH_CHECK(producer < data.producers);
+		BENCH_CHECK(sequence > last[producer]);
+		last[producer] = sequence;
+		sums[producer] += sequence;
+		counts[producer]++;
+		AtomicAdd(&data.consumed, (i64)1);
+	}
+
+	for (u32 i = 0; i < data.producers; ++i)
+	{
+		AtomicAdd(&data.sums[i], sums[i]);
+		AtomicAdd(&data.counts[i], counts[i]);
+	}
+	return 0;
+}
+
+//as many consumers as producers, every value has to be popped exactly once
+static double MPMC(Allocator& allocator, u32 producers, u64 count)
+{
+	MPMCQueue<u64> queue(allocator, CAPACITY);
+	MPMCData data = {};
+	data.queue = &queue;
+	data.count = count;
+	data.producers = producers;
+
+	MPMCThread threads[MAX_PRODUCERS * 2];
+	threadHandle handles[MAX_PRODUCERS * 2];
+	bench::Timer timer;
+	for (u32 i = 0; i < producers; ++i)
+	{
+		threads[i] = { &data, i };
+		handles[i] = StartThread(&MPMCProducer, &threads[i]);
+		threads[producers + i] = { &data, i };
+		handles[producers + i] = StartThread(&MPMCConsumer, &threads[producers + i]);
+	}
+	for (u32 i = 0; i < producers * 2; ++i)
+		JoinThread(handles[i]);
+	const double time = timer.GetMilliseconds();
+
+	for (u32 i = 0; i < producers; ++i)
+	{
+		BENCH_CHECK(data.counts[i] == (i64)count);
+		BENCH_CHECK(data.sums[i] == (i64)(count * (count - 1) / 2));
+	}
+	BENCH_CHECK(queue.IsEmpty());
+	return time;
+}
+
+
+int main(int argc, char** argv)
+{
+	const bool quick = bench::IsQuick(argc, argv);
+	const u64 count = quick ? 50'000 : 2'000'000;
+
+	MainAllocator allocator;
+
+	const double spscTime = SPSC(allocator, count);
+	if (!quick)
+		printf("SPSC, 1 producer 1 consumer: %6.1f M values/s\n", (double)count / spscTime / 1000.0);
+
+	for (u32 producers = 1; producers <= MAX_PRODUCERS; producers *= 2)
+	{
+		const u64 perProducer = count / producers;
+		const double time = MPMC(allocator, producers, perProducer);
+		if (!quick)
+			printf("MPMC, %u producers %u consumers: %6.1f M values/s\n", producers, producers, (double)(perProducer * producers) / time / 1000.0);
+	}
+
+	printf("queues: ok\n");
+	return 0;
+}
@@ -0,0 +1,460 @@
+#include "bench.h"
+
+#include "core/allocators.h"
+#include "core/system.h"
+#include "core/algorithms/sort.h"
+#include "core/containers/array.h"
+#include "core/math/matrix.h"
+#include "core/threading/os_utils.h"
+#include "core/threading/threads.h"
+#include "core/world/entity_commands.h"
+#include "core/world/world.h"
+
+
+using namespace Veng;
+
+
+static const u32 COMPONENT_SLOTS = 2;
+
+
+class StubScene;
+
+//every batch scenes got, in order of arrival
+struct Batch
+{
+	StubScene* scene;
+	u32 type;
+	bool add;
+	u32 first;//index to entities
+	u32 count;
+};
+
+struct BatchLog
+{
+	explicit BatchLog(Allocator& allocator) : batches(allocator), entities(allocator) {}
+
+	Array<Batch> batches;
+	Array<Entity> entities;
+};
+
+
+struct StubComponent : ComponentBase
+{
+	StubComponent(const char* name, u32 slot) : ComponentBase(name), slot(slot) {}
+
+	//playback hands components to scene in batches only
+	void Create(Scene& scene, Entity entity) const override { BENCH_CHECK(false); }
+	void Destroy(Scene& scene, Entity entity) const override { BENCH_CHECK(false); }
+	bool Has(Scene& scene, Entity entity) const override;
+
+	u32 slot;
+};
+
+
+//keeps sorted entities of each component, checks every batch the way real scene relies on it
+class StubScene : public Scene
+{
+public:
+	StubScene(Allocator& allocator, World& world, BatchLog& log)
+		: m_world(world)
+		, m_log(log)
+		, m_components{ Array<Entity>(allocator), Array<Entity>(allocator) }
+	{}
+
+	void Serialize(OutputBlob& serializer) const override {}
+	void Deserialize(InputBlob& serializer) override {}
+	void Clear() override {}
+	void Update(float deltaTime) override {}
+
+	void AddComponents(const ComponentBase& component, const Entity* entities, size_t count) override
+	{
+		Log(component, entities, count, true);
+		Array<Entity>& owners = m_components[static_cast<const StubComponent&>(component).slot];
+		for (size_t i = 0; i < count; ++i)
+		{
+			BENCH_CHECK(!Has(owners, entities[i]));
+			owners.PushBack(entities[i]);
+		}
+		Sort(owners.Begin(), owners.End());
+	}
+
+	void RemoveComponents(const ComponentBase& component, const Entity* entities, size_t count) override
+	{
+		Log(component, entities, count, false);
+		Array<Entity>& owners = m_components[static_cast<const StubComponent&>(component).slot];
+		for (size_t i = 0; i < count; ++i)
+		{
+			size_t index;
+			BENCH_CHECK(owners.Find(entities[i], index));
+			owners.EraseOrdered(index);
+		}
+	}
+
+	//components set up before commands are recorded
+	void Attach(u32 slot, Entity entity)
+	{
+		m_components[slot].PushBack(entity);
+		Sort(m_components[slot].Begin(), m_components[slot].End());
+	}
+
+	bool Has(u32 slot, Entity entity) const { return Has(m_components[slot], entity); }
+	const Array<Entity>& GetOwners(u32 slot) const { return m_components[slot]; }
+
+private:
+	static bool Has(const Array<Entity>& owners, Entity entity)
+	{
+		size_t begin = 0;
+		size_t end = owners.GetSize();
+		while (begin < end)
+		{
+			const size_t middle = begin + (end - begin) / 2;
+			if (owners[middle] < entity)
+				begin = middle + 1;
+			else
+				end = middle;
+		}
+		return begin < owners.GetSize() && owners[begin] == entity;
+	}
+
+	//entities are sorted, unique and alive, so creations went first and destructions haven't run yet
+	void Log(const ComponentBase& component, const Entity* entities, size_t count, bool add)
+	{
+		BENCH_CHECK(count > 0);
+		for (size_t i = 0; i < count; ++i)
+		{
+			BENCH_CHECK(!IsProvisionalEntity(entities[i]) && m_world.ExistsEntity(entities[i]));
+			BENCH_CHECK(i == 0 || (u64)entities[i - 1] < (u64)entities[i]);
+		}
+
+		Batch& batch = m_log.batches.PushBack();
+		batch.scene = this;
+		batch.type = component.type;
+		batch.add = add;
+		batch.first = (u32)m_log.entities.GetSize();
+		batch.count = (u32)count;
+		for (size_t i = 0; i < count; ++i)
+			m_log.entities.PushBack(entities[i]);
+	}
+
+private:
+	World& m_world;
+	BatchLog& m_log;
+	Array<Entity> m_components[COMPONENT_SLOTS];
+};
+
+bool StubComponent::Has(Scene& scene, Entity entity) const
+{
+	return static_cast<StubScene&>(scene).Has(slot, entity);
+}
+
+
+static Transform MakeTransform(float position)
+{
+	return Transform(Quaternion::IDENTITY, Vector3(position, 0.0f, 0.0f), 1.0f);
+}
+
+
+static const u32 RECORDERS = 3;
+static const u32 PRESENT_ENTITIES = 6;
+
+//what recorders see, each of them records from its own thread into its own buffer
+struct Scenario
+{
+	World* world;
+	StubScene* scene1;
+	StubScene* scene2;
+	const StubComponent* a;
+	const StubComponent* b;
+	const StubComponent* bAlias;//another description of component b
+	Entity present[PRESENT_ENTITIES];//e0..e5 made directly, e0 and e1 have a in scene1, e2 has b in scene2
+
+	volatile i32 turn;
+	u32 thread[RECORDERS];//index of thread which recorded, it decides order of buffers
+	u32 created[RECORDERS];
+	Entity p00, p01, p10, p20;//provisional ids, first digit is recorder
+};
+
+static void Record0(Scenario& s, EntityCommandBuffer& buffer)
+{
+	const Entity* e = s.present;
+
+	//last transform wins
+	s.p00 = buffer.CreateEntity();
+	buffer.SetEntityTransform(s.p00, MakeTransform(1.0f));
+	buffer.SetEntityTransform(s.p00, MakeTransform(2.0f));
+	buffer.AddComponent(*s.a, *s.scene1, s.p00);
+
+	//added and removed in the same batch, scene never hears of it
+	s.p01 = buffer.CreateEntity();
+	buffer.AddComponent(*s.a, *s.scene1, s.p01);
+	buffer.RemoveComponent(*s.a, *s.scene1, s.p01);
+
+	//last component command wins
+	buffer.AddComponent(*s.a, *s.scene1, e[3]);
+	buffer.RemoveComponent(*s.a, *s.scene1, e[3]);
+	buffer.AddComponent(*s.a, *s.scene1, e[3]);
+	buffer.RemoveComponent(*s.a, *s.scene1, e[0]);
+	buffer.AddComponent(*s.a, *s.scene1, e[0]);
+	buffer.RemoveComponent(*s.a, *s.scene1, e[0]);
+}
+
+static void Record1(Scenario& s, EntityCommandBuffer& buffer)
+{
+	const Entity* e = s.present;
+
+	//entity of another buffer
+	buffer.AddComponent(*s.bAlias, *s.scene2, s.p00);
+
+	//created, given components and destroyed in the same batch, components arrive before destruction
+	s.p10 = buffer.CreateEntity();
+	buffer.SetEntityTransform(s.p10, MakeTransform(10.0f));
+	buffer.AddComponent(*s.b, *s.scene2, s.p10);
+	buffer.AddComponent(*s.a, *s.scene1, s.p10);
+	buffer.DestroyEntity(s.p10);
+
+	buffer.RemoveComponent(*s.b, *s.scene2, e[2]);
+	buffer.DestroyEntity(e[4]);
+}
+
+static void Record2(Scenario& s, EntityCommandBuffer& buffer)
+{
+	const Entity* e = s.present;
+
+	buffer.SetEntityTransform(e[5], MakeTransform(5.0f));
+	buffer.AddComponent(*s.b, *s.scene2, e[5]);
+	//component added to entity destroyed later in the same batch
+	buffer.DestroyEntity(e[3]);
+
+	s.p20 = buffer.CreateEntity();
+	buffer.AddComponent(*s.b, *s.scene2, s.p20);
+	buffer.SetEntityTransform(s.p00, MakeTransform(20.0f));
+}
+
+typedef void (*RecordFunction)(Scenario& s, EntityCommandBuffer& buffer);
+static const RecordFunction RECORD_FUNCTIONS[RECORDERS] = { &Record0, &Record1, &Record2 };
+
+struct Recorder
+{
+	Scenario* scenario;
+	MainAllocator* allocator;
+	u32 index;
+};
+
+//recorders take turns, so later ones can use provisional ids of earlier ones; none exits before all recorded,
+//so each keeps its own thread index and buffer
+static u32 RunRecorder(void* data)
+{
+	Recorder& recorder = *static_cast<Recorder*>(data);
+	Scenario& s = *recorder.scenario;
+
+	while (AtomicLoad(&s.turn) != (i32)recorder.index)
+		YieldThread();
+
+	EntityCommandBuffer& buffer = s.world->GetCommandBuffer();
+	BENCH_CHECK(buffer.GetThread() == GetThreadIndex());
+	RECORD_FUNCTIONS[recorder.index](s, buffer);
+	s.thread[recorder.index] = buffer.GetThread();
+	s.created[recorder.index] = buffer.GetCreatedCount();
+	AtomicAdd(&s.turn, 1);
+
+	while (AtomicLoad(&s.turn) != (i32)RECORDERS)
+		YieldThread();
+	recorder.allocator->FlushThreadCache();
+	return 0;
+}
+
+
+//creations are numbered in order of buffers, which is order of their threads
+static Entity Resolve(const Scenario& s, u32 recorder, u32 index)
+{
+	u32 first = PRESENT_ENTITIES;
+	for (u32 r = 0; r < RECORDERS; ++r)
+	{
+		if (s.thread[r] < s.thread[recorder])
+			first += s.created[r];
+	}
+	return (Entity)(first + index);
+}
+
+static const Batch* FindBatch(const BatchLog& log, const StubScene* scene, u32 type, bool add)
+{
+	const Batch* found = nullptr;
+	for (const Batch& batch : log.batches)
+	{
+		if (batch.scene == scene && batch.type == type && batch.add == add)
+		{
+			BENCH_CHECK(found == nullptr);//one batch per scene and component
+			found = &batch;
+		}
+	}
+	return found;
+}
+
+static void CheckBatch(const BatchLog& log, const StubScene* scene, u32 type, bool add, Entity* expected, u32 count)
+{
+	const Batch* batch = FindBatch(log, scene, type, add);
+	if (count == 0)
+	{
+		BENCH_CHECK(batch == nullptr);
+		return;
+	}
+
+	Sort(expected, expected + count, [](Entity a, Entity b) { return (u64)a < (u64)b; });
+	BENCH_CHECK(batch != nullptr && batch->count == count);
+	for (u32 i = 0; i < count; ++i)
+		BENCH_CHECK(log.entities[batch->first + i] == expected[i]);
+}
+
+static void CheckOwners(const StubScene& scene, u32 slot, Entity* expected, u32 count)
+{
+	Sort(expected, expected + count, [](Entity a, Entity b) { return (u64)a < (u64)b; });
+	const Array<Entity>& owners = scene.GetOwners(slot);
+	BENCH_CHECK(owners.GetSize() == count);
+	for (u32 i = 0; i < count; ++i)
+		BENCH_CHECK(owners[i] == expected[i]);
+}
+
+static void CheckPlayback(MainAllocator& allocator)
+{
+	FrameAllocator scratch(allocator);
+	World world(allocator, (worldId)0);
+	BatchLog log(allocator);
+	StubScene scene1(allocator, world, log);
+	StubScene scene2(allocator, world, log);
+	const StubComponent a("a", 0);
+	const StubComponent b("b", 1);
+	const StubComponent bAlias("b", 1);
+
+	Scenario s = {};
+	s.world = &world;
+	s.scene1 = &scene1;
+	s.scene2 = &scene2;
+	s.a = &a;
+	s.b = &b;
+	s.bAlias = &bAlias;
+	for (Entity& entity : s.present)
+		entity = world.CreateEntity();
+	const Entity* e = s.present;
+	scene1.Attach(0, e[0]);
+	scene1.Attach(0, e[1]);
+	scene2.Attach(1, e[2]);
+
+	Recorder recorders[RECORDERS];
+	threadHandle threads[RECORDERS];
+	for (u32 r = 0; r < RECORDERS; ++r)
+	{
+		recorders[r] = { &s, &allocator, r };
+		threads[r] = StartThread(&RunRecorder, &recorders[r]);
+	}
+	for (u32 r = 0; r < RECORDERS; ++r)
+		JoinThread(threads[r]);
+
+	scratch.NewFrame();
+	world.PlaybackCommands(scratch);
+
+	const Entity p00 = Resolve(s, 0, 0);
+	const Entity p01 = Resolve(s, 0, 1);
+	const Entity p10 = Resolve(s, 1, 0);
+	const Entity p20 = Resolve(s, 2, 0);
+
+	//destructions ran last
+	BENCH_CHECK(world.ExistsEntity(e[0]) && world.ExistsEntity(e[1]) && world.ExistsEntity(e[2]) && world.ExistsEntity(e[5]));
+	BENCH_CHECK(!world.ExistsEntity(e[3]) && !world.ExistsEntity(e[4]));
+	BENCH_CHECK(world.ExistsEntity(p00) && world.ExistsEntity(p01) && world.ExistsEntity(p20));
+	BENCH_CHECK(!world.ExistsEntity(p10));
+
+	//buffers go in order of threads, within buffer last transform wins
+	const u32 lastSetter = (s.thread[2] > s.thread[0]) ? 2 : 0;
+	BENCH_CHECK(world.GetEntityTransform(p00).position.x == (lastSetter == 2 ? 20.0f : 2.0f));
+	BENCH_CHECK(world.GetEntityTransform(e[5]).position.x == 5.0f);
+
+	//removals first, every batch sorted, unique and one per scene and component
+	bool adding = false;
+	for (const Batch& batch : log.batches)
+	{
+		BENCH_CHECK(!adding || batch.add);
+		adding = batch.add;
+	}
+	BENCH_CHECK(log.batches.GetSize() == 4);
+
+	Entity removedA[] = { e[0] };
+	Entity removedB[] = { e[2] };
+	Entity addedA[] = { e[3], p00, p10 };
+	Entity addedB[] = { e[5], p00, p10, p20 };
+	CheckBatch(log, &scene1, a.type, false, removedA, 1);
+	CheckBatch(log, &scene2, b.type, false, removedB, 1);
+	CheckBatch(log, &scene1, a.type, true, addedA, 3);
+	CheckBatch(log, &scene2, b.type, true, addedB, 4);
+	CheckBatch(log, &scene1, b.type, true, nullptr, 0);
+	CheckBatch(log, &scene2, a.type, true, nullptr, 0);
+
+	//destroyed entities keep their components, scenes drop them on their own
+	Entity ownersA[] = { e[1], e[3], p00, p10 };
+	Entity ownersB[] = { e[5], p00, p10, p20 };
+	CheckOwners(scene1, 0, ownersA, 4);
+	CheckOwners(scene2, 1, ownersB, 4);
+	BENCH_CHECK(!scene1.Has(0, p01));
+
+	//buffers are emptied, ids of destroyed entities are reused by next playback
+	const u32 batches = (u32)log.batches.GetSize();
+	EntityCommandBuffer& buffer = world.GetCommandBuffer();
+	BENCH_CHECK(buffer.IsEmpty());
+	const Entity reused = buffer.CreateEntity();
+	buffer.AddComponent(b, scene1, reused);
+	scratch.NewFrame();
+	world.PlaybackCommands(scratch);
+	BENCH_CHECK(log.batches.GetSize() == batches + 1);
+	const Batch& last = log.batches[batches];
+	const Entity reusedEntity = log.entities[last.first];
+	BENCH_CHECK(last.add && last.count == 1 && (reusedEntity == e[3] || reusedEntity == e[4] || reusedEntity == p10));
+	BENCH_CHECK(world.ExistsEntity(reusedEntity));
+}
+
+
+//spawning many entities with two components, playback merges them into one batch per component
+static double MeasurePlayback(MainAllocator& allocator, u32 count)
+{
+	FrameAllocator scratch(allocator);
+	World world(allocator, (worldId)0);
+	BatchLog log(allocator);
+	StubScene scene(allocator, world, log);
+	const StubComponent a("a", 0);
+	const StubComponent b("b", 1);
+
+	EntityCommandBuffer& buffer = world.GetCommandBuffer();
+	for (u32 i = 0; i < count; ++i)
+	{
+		const Entity entity = buffer.CreateEntity();
+		buffer.SetEntityTransform(entity, MakeTransform((float)i));
+		buffer.AddComponent(a, scene, entity);
+		buffer.AddComponent(b, scene, entity);
+	}
+
+	scratch.NewFrame();
+	bench::Timer timer;
+	world.PlaybackCommands(scratch);
+	const double time = timer.GetMilliseconds();
+
+	BENCH_CHECK(log.batches.GetSize() == 2);
+	BENCH_CHECK(scene.GetOwners(0).GetSize() == count && scene.GetOwners(1).GetSize() == count);
+	return time;
+}
+
+
+int main(int argc, char** argv)
+{
+	const bool quick = bench::IsQuick(argc, argv);
+
+	MainAllocator allocator;
+	const u32 rounds = quick ? 5 : 50;
+	for (u32 i = 0; i < rounds; ++i)
+		CheckPlayback(allocator);
+
+	const u32 count = quick ? 10'000 : 200'000;
+	const double time = MeasurePlayback(allocator, count);
+	if (!quick)
+		printf("playback of %u created entities with 2 components: %8.2f ms\n", count, time);
+
+	printf("world_playback: ok\n");
+	return 0;
+}
@@ -56,6 +56,12 @@ solution "NewEngine"
 		targetdir(BINARY_DIR .. "Release")
 		defines { "RELEASE" }
 		flags { "Optimize" }
+	
+	--coroutines need c++20
+	configuration "vs*"
+		buildoptions { "/std:c++latest" }
+	configuration "linux"
+		buildoptions_cpp { "-std=c++20" }
 		
 	configuration {}
 	
@@ -72,6 +78,16 @@ project "core"
 		SRC_DIR .. "core/**.cpp",
 	}
 	
+	configuration "windows"
+		excludes {
+			SRC_DIR .. "core/**/linux/**",
+		}
+	
+	configuration "linux"
+		excludes {
+			SRC_DIR .. "core/**/win/**",
+		}
+	
 	configuration {}
 	
 	
@@ -146,6 +162,10 @@ project "main"
 		links { "bgfxDebug", "bimgDebug", "bxDebug" }
 	configuration { "Release", "x64" }
 		links { "bgfxRelease", "bimgRelease", "bxRelease" }
+	configuration "windows"
+		links { "Synchronization" }
+	configuration "linux"
+		links { "pthread" }
 	configuration {}
 	
 	
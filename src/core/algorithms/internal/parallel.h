@@ -0,0 +1,36 @@
+#pragma once
+
+#include "core/int.h"
+#include "core/math/math.h"
+#include "core/threading/jobs.h"
+
+
+namespace Veng
+{
+
+
+namespace AlgorithmsInternal
+{
+
+
+//bounds per chunk arrays kept on stack
+static const u32 MAX_CHUNKS = 64;
+
+//one chunk per thread at most, ranges shorter than grain aren't worth a job
+inline u32 GetChunkCount(JobSystem& jobSystem, size_t count, size_t grain)
+{
+	const size_t byGrain = (count + grain - 1) / grain;
+	const size_t byThreads = Min((size_t)jobSystem.GetWorkerCount() + 1, (size_t)MAX_CHUNKS);
+	return (u32)Max(Min(byGrain, byThreads), (size_t)1);
+}
+
+inline size_t GetChunkBegin(size_t count, u32 chunkCount, u32 chunk)
+{
+	return (size_t)((u64)count * chunk / chunkCount);
+}
+
+
+}
+
+
+}
@@ -0,0 +1,212 @@
+#include "core/utility.h"
+#include "core/threading/jobs.h"
+#include "parallel.h"
+
+
+namespace Veng
+{
+
+
+namespace ScanInternal
+{
+
+
+static const size_t PARALLEL_SCAN_GRAIN = 16384;
+
+
+template<class Type, class OpType, bool inclusive>
+Type ParallelScan(JobSystem& jobSystem, const Type* in, Type* out, size_t count, Type init, OpType& op)
+{
+	const u32 chunkCount = AlgorithmsInternal::GetChunkCount(jobSystem, count, PARALLEL_SCAN_GRAIN);
+	if (chunkCount == 1)
+		return inclusive ? InclusiveScan(in, out, count, init, op) : ExclusiveScan(in, out, count, init, op);
+
+	//chunk totals first, chunk prefix is then folded in order on calling thread
+	Type totals[AlgorithmsInternal::MAX_CHUNKS];
+	ParallelFor(jobSystem, 0, chunkCount, 1, [&](size_t first, size_t last)
+	{
+		for (size_t chunk = first; chunk < last; ++chunk)
+		{
+			const size_t begin = AlgorithmsInternal::GetChunkBegin(count, chunkCount, (u32)chunk);
+			const size_t end = AlgorithmsInternal::GetChunkBegin(count, chunkCount, (u32)chunk + 1);
+			Type total = in[begin];
+			for (size_t i = begin + 1; i < end; ++i)
+				total = op(total, in[i]);
+			totals[chunk] = total;
+		}
+	});
+
+	Type prefix = init;
+	for (u32 chunk = 0; chunk < chunkCount; ++chunk)
+	{
+		const Type total = totals[chunk];
+		totals[chunk] = prefix;
+		prefix = op(prefix, total);
+	}
+
+	ParallelFor(jobSystem, 0, chunkCount, 1, [&](size_t first, size_t last)
+	{
+		for (size_t chunk = first; chunk < last; ++chunk)
+		{
+			const size_t begin = AlgorithmsInternal::GetChunkBegin(count, chunkCount, (u32)chunk);
+			const size_t end = AlgorithmsInternal::GetChunkBegin(count, chunkCount, (u32)chunk + 1);
+			if (inclusive)
+				InclusiveScan(in + begin, out + begin, end - begin, totals[chunk], op);
+			else
+				ExclusiveScan(in + begin, out + begin, end - begin, totals[chunk], op);
+		}
+	});
+	return prefix;
+}
+
+
+}
+
+
+template<class Type, class OpType>
+Type Reduce(const Type* begin, const Type* end, Type init, OpType op)
+{
+	for (const Type* it = begin; it < end; ++it)
+		init = op(init, *it);
+	return init;
+}
+
+
+template<class Type, class OpType>
+Type ExclusiveScan(const Type* in, Type* out, size_t count, Type init, OpType op)
+{
+	for (size_t i = 0; i < count; ++i)
+	{
+		const Type value = in[i];
+		out[i] = init;
+		init = op(init, value);
+	}
+	return init;
+}
+
+
+template<class Type, class OpType>
+Type InclusiveScan(const Type* in, Type* out, size_t count, Type init, OpType op)
+{
+	for (size_t i = 0; i < count; ++i)
+	{
+		init = op(init, in[i]);
+		out[i] = init;
+	}
+	return init;
+}
+
+
+template<class Type, class PredicateType>
+Type* Partition(Type* begin, Type* end, PredicateType predicate)
+{
+	for (;;)
+	{
+		while (begin < end && predicate(*begin))
+			++begin;
+		do
+		{
+			if (begin == end)
+				return begin;
+			--end;
+		} while (!predicate(*end));
+
+		Utils::Swap(*begin, *end);
+		++begin;
+	}
+}
+
+
+template<class Type, class OpType>
+Type ParallelReduce(JobSystem& jobSystem, const Type* begin, const Type* end, Type init, OpType op)
+{
+	const size_t count = end - begin;
+	const u32 chunkCount = AlgorithmsInternal::GetChunkCount(jobSystem, count, ScanInternal::PARALLEL_SCAN_GRAIN);
+	if (chunkCount == 1)
+		return Reduce(begin, end, init, op);
+
+	Type totals[AlgorithmsInternal::MAX_CHUNKS];
+	ParallelFor(jobSystem, 0, chunkCount, 1, [&](size_t first, size_t last)
+	{
+		for (size_t chunk = first; chunk < last; ++chunk)
+		{
+			const size_t chunkBegin = AlgorithmsInternal::GetChunkBegin(count, chunkCount, (u32)chunk);
+			const size_t chunkEnd = AlgorithmsInternal::GetChunkBegin(count, chunkCount, (u32)chunk + 1);
+			totals[chunk] = Reduce(begin + chunkBegin + 1, begin + chunkEnd, begin[chunkBegin], op);
+		}
+	});
+
+	for (u32 chunk = 0; chunk < chunkCount; ++chunk)
+		init = op(init, totals[chunk]);
+	return init;
+}
+
+
+template<class Type, class OpType>
+Type ParallelExclusiveScan(JobSystem& jobSystem, const Type* in, Type* out, size_t count, Type init, OpType op)
+{
+	return ScanInternal::ParallelScan<Type, OpType, false>(jobSystem, in, out, count, init, op);
+}
+
+
+template<class Type, class OpType>
+Type ParallelInclusiveScan(JobSystem& jobSystem, const Type* in, Type* out, size_t count, Type init, OpType op)
+{
+	return ScanInternal::ParallelScan<Type, OpType, true>(jobSystem, in, out, count, init, op);
+}
+
+
+//chunks count their selected elements, scan of the counts gives every chunk its place in buffer
+template<class Type, class PredicateType>
+Type* ParallelPartition(JobSystem& jobSystem, Allocator& allocator, Type* begin, Type* end, PredicateType predicate)
+{
+	const size_t count = end - begin;
+	if (count == 0)
+		return begin;
+
+	const u32 chunkCount = AlgorithmsInternal::GetChunkCount(jobSystem, count, ScanInternal::PARALLEL_SCAN_GRAIN);
+	size_t selected[AlgorithmsInternal::MAX_CHUNKS];
+	ParallelFor(jobSystem, 0, chunkCount, 1, [&](size_t first, size_t last)
+	{
+		for (size_t chunk = first; chunk < last; ++chunk)
+		{
+			const size_t chunkEnd = AlgorithmsInternal::GetChunkBegin(count, chunkCount, (u32)chunk + 1);
+			size_t chunkSelected = 0;
+			for (size_t i = AlgorithmsInternal::GetChunkBegin(count, chunkCount, (u32)chunk); i < chunkEnd; ++i)
+				chunkSelected += predicate(begin[i]) ? 1 : 0;
+			selected[chunk] = chunkSelected;
+		}
+	});
+	const size_t selectedCount = ExclusiveScan(selected, selected, chunkCount, (size_t)0);
+
+	Type* buffer = static_cast<Type*>(allocator.Allocate(count * sizeof(Type), alignof(Type)));
+	ParallelFor(jobSystem, 0, chunkCount, 1, [&](size_t first, size_t last)
+	{
+		for (size_t chunk = first; chunk < last; ++chunk)
+		{
+			const size_t chunkBegin = AlgorithmsInternal::GetChunkBegin(count, chunkCount, (u32)chunk);
+			const size_t chunkEnd = AlgorithmsInternal::GetChunkBegin(count, chunkCount, (u32)chunk + 1);
+			size_t selectedPos = selected[chunk];
+			size_t restPos = selectedCount + chunkBegin - selected[chunk];
+			for (size_t i = chunkBegin; i < chunkEnd; ++i)
+			{
+				const size_t pos = predicate(begin[i]) ? selectedPos++ : restPos++;
+				NEW_PLACEMENT(buffer + pos, Type)(Utils::Move(begin[i]));
+			}
+		}
+	});
+
+	ParallelFor(jobSystem, 0, count, ScanInternal::PARALLEL_SCAN_GRAIN, [&](size_t first, size_t last)
+	{
+		for (size_t i = first; i < last; ++i)
+		{
+			begin[i] = Utils::Move(buffer[i]);
+			DELETE_PLACEMENT(buffer + i);
+		}
+	});
+	allocator.Deallocate(buffer);
+	return begin + selectedCount;
+}
+
+
+}
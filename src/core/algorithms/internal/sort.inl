@@ -0,0 +1,309 @@
+#include "core/utility.h"
+#include "core/math/math.h"
+#include "core/threading/jobs.h"
+#include "parallel.h"
+
+
+namespace Veng
+{
+
+
+namespace SortInternal
+{
+
+
+static const size_t INSERTION_SORT_MAX = 16;
+static const size_t PARALLEL_SORT_GRAIN = 4096;
+
+
+template<class Type, class LessType>
+void InsertionSort(Type* begin, Type* end, LessType& less)
+{
+	if (end - begin < 2)
+		return;
+
+	for (Type* it = begin + 1; it < end; ++it)
+	{
+		if (!less(*it, *(it - 1)))
+			continue;
+
+		Type value = Utils::Move(*it);
+		Type* hole = it;
+		do
+		{
+			*hole = Utils::Move(*(hole - 1));
+			--hole;
+		} while (hole > begin && less(value, *(hole - 1)));
+		*hole = Utils::Move(value);
+	}
+}
+
+
+template<class Type, class LessType>
+void SiftDown(Type* data, size_t root, size_t count, LessType& less)
+{
+	for (;;)
+	{
+		size_t child = root * 2 + 1;
+		if (child >= count)
+			return;
+		if (child + 1 < count && less(data[child], data[child + 1]))
+			++child;
+		if (!less(data[root], data[child]))
+			return;
+		Utils::Swap(data[root], data[child]);
+		root = child;
+	}
+}
+
+template<class Type, class LessType>
+void HeapSortRange(Type* begin, Type* end, LessType& less)
+{
+	const size_t count = end - begin;
+	for (size_t i = count / 2; i > 0; --i)
+		SiftDown(begin, i - 1, count, less);
+	for (size_t last = count; last > 1; --last)
+	{
+		Utils::Swap(begin[0], begin[last - 1]);
+		SiftDown(begin, 0, last - 1, less);
+	}
+}
+
+
+//median of three becomes pivot, smallest of them ends at mid and largest at the end, so both scans
+//below stop without bound checks; returns final position of pivot
+template<class Type, class LessType>
+Type* PartitionByPivot(Type* begin, Type* end, LessType& less)
+{
+	Type* mid = begin + (end - begin) / 2;
+	Type* last = end - 1;
+	if (less(*mid, *begin))
+		Utils::Swap(*mid, *begin);
+	if (less(*last, *mid))
+	{
+		Utils::Swap(*last, *mid);
+		if (less(*mid, *begin))
+			Utils::Swap(*mid, *begin);
+	}
+	Utils::Swap(*begin, *mid);
+
+	Type* i = begin;
+	Type* j = end;
+	for (;;)
+	{
+		do ++i; while (less(*i, *begin));
+		do --j; while (less(*begin, *j));
+		if (i >= j)
+			break;
+		Utils::Swap(*i, *j);
+	}
+	Utils::Swap(*begin, *j);
+	return j;
+}
+
+//smaller side is recursed into and bigger one looped on, so stack stays logarithmic even before depth runs out
+template<class Type, class LessType>
+void IntroSort(Type* begin, Type* end, u32 depth, LessType& less)
+{
+	while ((size_t)(end - begin) > INSERTION_SORT_MAX)
+	{
+		if (depth == 0)
+		{
+			HeapSortRange(begin, end, less);
+			return;
+		}
+		--depth;
+
+		Type* pivot = PartitionByPivot(begin, end, less);
+		if (pivot - begin < end - pivot)
+		{
+			IntroSort(begin, pivot, depth, less);
+			begin = pivot + 1;
+		}
+		else
+		{
+			IntroSort(pivot + 1, end, depth, less);
+			end = pivot;
+		}
+	}
+	InsertionSort(begin, end, less);
+}
+
+
+//ties are taken from a, which keeps merge stable
+template<class Type, class LessType>
+void Merge(Type* a, Type* aEnd, Type* b, Type* bEnd, Type* out, LessType& less)
+{
+	while (a < aEnd && b < bEnd)
+		*out++ = less(*b, *a) ? Utils::Move(*b++) : Utils::Move(*a++);
+	while (a < aEnd)
+		*out++ = Utils::Move(*a++);
+	while (b < bEnd)
+		*out++ = Utils::Move(*b++);
+}
+
+//how many of first diagonal merged elements come from a
+template<class Type, class LessType>
+size_t MergePathSplit(const Type* a, size_t aCount, const Type* b, size_t bCount, size_t diagonal, LessType& less)
+{
+	size_t low = (diagonal > bCount) ? diagonal - bCount : 0;
+	size_t high = Min(diagonal, aCount);
+	while (low < high)
+	{
+		const size_t i = (low + high) / 2;
+		if (!less(b[diagonal - i - 1], a[i]))
+			low = i + 1;
+		else
+			high = i;
+	}
+	return low;
+}
+
+
+//buffer is raw memory, it's left constructed with moved-from elements and sorted result ends in data
+template<class Type, class LessType>
+void StableSortWithBuffer(Type* data, Type* buffer, size_t count, LessType& less)
+{
+	for (size_t i = 0; i < count; i += INSERTION_SORT_MAX)
+		InsertionSort(data + i, data + Min(i + INSERTION_SORT_MAX, count), less);
+
+	for (size_t i = 0; i < count; ++i)
+		NEW_PLACEMENT(buffer + i, Type)(Utils::Move(data[i]));
+
+	Type* from = buffer;
+	Type* to = data;
+	for (size_t width = INSERTION_SORT_MAX; width < count; width *= 2)
+	{
+		for (size_t i = 0; i < count; i += 2 * width)
+		{
+			const size_t middle = Min(i + width, count);
+			const size_t last = Min(i + 2 * width, count);
+			Merge(from + i, from + middle, from + middle, from + last, to + i, less);
+		}
+		Utils::Swap(from, to);
+	}
+
+	if (from != data)
+	{
+		for (size_t i = 0; i < count; ++i)
+			data[i] = Utils::Move(from[i]);
+	}
+}
+
+//merges pairs of neighbouring runs, only output in [outBegin, outEnd) is produced
+template<class Type, class LessType>
+void MergeRuns(Type* from, Type* to, const size_t* bounds, u32 runCount, size_t outBegin, size_t outEnd, LessType& less)
+{
+	for (u32 run = 0; run < runCount; run += 2)
+	{
+		const size_t pairBegin = bounds[run];
+		const size_t middle = bounds[run + 1];
+		const size_t pairEnd = (run + 2 <= runCount) ? bounds[run + 2] : middle;
+		if (pairEnd <= outBegin || pairBegin >= outEnd)
+			continue;
+
+		Type* a = from + pairBegin;
+		Type* b = from + middle;
+		const size_t aCount = middle - pairBegin;
+		const size_t bCount = pairEnd - middle;
+		const size_t first = Max(outBegin, pairBegin) - pairBegin;
+		const size_t last = Min(outEnd, pairEnd) - pairBegin;
+		const size_t aFirst = MergePathSplit(a, aCount, b, bCount, first, less);
+		const size_t aLast = MergePathSplit(a, aCount, b, bCount, last, less);
+		Merge(a + aFirst, a + aLast, b + (first - aFirst), b + (last - aLast), to + pairBegin + first, less);
+	}
+}
+
+
+}
+
+
+template<class Type, class LessType>
+void Sort(Type* begin, Type* end, LessType less)
+{
+	const size_t count = end - begin;
+	if (count < 2)
+		return;
+
+	SortInternal::IntroSort(begin, end, 2 * (HighestBitIndex(count) + 1), less);
+}
+
+
+template<class Type, class LessType>
+void HeapSort(Type* begin, Type* end, LessType less)
+{
+	SortInternal::HeapSortRange(begin, end, less);
+}
+
+
+template<class Type, class LessType>
+void StableSort(Allocator& allocator, Type* begin, Type* end, LessType less)
+{
+	const size_t count = end - begin;
+	if (count <= SortInternal::INSERTION_SORT_MAX)
+	{
+		SortInternal::InsertionSort(begin, end, less);
+		return;
+	}
+
+	Type* buffer = static_cast<Type*>(allocator.Allocate(count * sizeof(Type), alignof(Type)));
+	SortInternal::StableSortWithBuffer(begin, buffer, count, less);
+	for (size_t i = 0; i < count; ++i)
+		DELETE_PLACEMENT(buffer + i);
+	allocator.Deallocate(buffer);
+}
+
+
+template<class Type, class LessType>
+void ParallelSort(JobSystem& jobSystem, Allocator& allocator, Type* begin, Type* end, LessType less)
+{
+	const size_t count = end - begin;
+	const u32 chunkCount = AlgorithmsInternal::GetChunkCount(jobSystem, count, SortInternal::PARALLEL_SORT_GRAIN);
+	if (chunkCount == 1)
+	{
+		StableSort(allocator, begin, end, less);
+		return;
+	}
+
+	size_t bounds[AlgorithmsInternal::MAX_CHUNKS + 1];
+	for (u32 i = 0; i <= chunkCount; ++i)
+		bounds[i] = AlgorithmsInternal::GetChunkBegin(count, chunkCount, i);
+
+	Type* buffer = static_cast<Type*>(allocator.Allocate(count * sizeof(Type), alignof(Type)));
+	ParallelFor(jobSystem, 0, chunkCount, 1, [&](size_t first, size_t last)
+	{
+		for (size_t chunk = first; chunk < last; ++chunk)
+			SortInternal::StableSortWithBuffer(begin + bounds[chunk], buffer + bounds[chunk], bounds[chunk + 1] - bounds[chunk], less);
+	});
+
+	//every round splits output evenly between chunk jobs regardless of how many runs are left
+	Type* from = begin;
+	Type* to = buffer;
+	for (u32 runCount = chunkCount; runCount > 1; runCount = (runCount + 1) / 2)
+	{
+		ParallelFor(jobSystem, 0, chunkCount, 1, [&](size_t first, size_t last)
+		{
+			const size_t outBegin = AlgorithmsInternal::GetChunkBegin(count, chunkCount, (u32)first);
+			const size_t outEnd = AlgorithmsInternal::GetChunkBegin(count, chunkCount, (u32)last);
+			SortInternal::MergeRuns(from, to, bounds, runCount, outBegin, outEnd, less);
+		});
+		Utils::Swap(from, to);
+
+		for (u32 i = 0; i <= (runCount + 1) / 2; ++i)
+			bounds[i] = bounds[Min(2 * i, runCount)];
+	}
+
+	ParallelFor(jobSystem, 0, count, SortInternal::PARALLEL_SORT_GRAIN, [&](size_t first, size_t last)
+	{
+		for (size_t i = first; i < last; ++i)
+		{
+			if (from != begin)
+				begin[i] = Utils::Move(from[i]);
+			DELETE_PLACEMENT(buffer + i);
+		}
+	});
+	allocator.Deallocate(buffer);
+}
+
+
+}
@@ -0,0 +1,55 @@
+#pragma once
+
+#include "core/allocator.h"
+#include "core/int.h"
+
+
+namespace Veng
+{
+
+class JobSystem;
+
+
+template<class Type>
+struct Plus
+{
+	Type operator()(const Type& a, const Type& b) const { return a + b; }
+};
+
+
+//op has to be associative for parallel variants, they combine chunks in order so it needn't be commutative
+template<class Type, class OpType = Plus<Type>>
+Type Reduce(const Type* begin, const Type* end, Type init, OpType op = OpType());
+
+//out[i] = init op in[0] op ... op in[i - 1], out may be the same as in; returns total
+template<class Type, class OpType = Plus<Type>>
+Type ExclusiveScan(const Type* in, Type* out, size_t count, Type init, OpType op = OpType());
+
+//out[i] = init op in[0] op ... op in[i], out may be the same as in; returns total
+template<class Type, class OpType = Plus<Type>>
+Type InclusiveScan(const Type* in, Type* out, size_t count, Type init, OpType op = OpType());
+
+//moves elements which satisfy predicate in front of the rest and returns end of them, not stable
+template<class Type, class PredicateType>
+Type* Partition(Type* begin, Type* end, PredicateType predicate);
+
+
+template<class Type, class OpType = Plus<Type>>
+Type ParallelReduce(JobSystem& jobSystem, const Type* begin, const Type* end, Type init, OpType op = OpType());
+
+//reads every element twice, once for chunk totals and once for the scan itself
+template<class Type, class OpType = Plus<Type>>
+Type ParallelExclusiveScan(JobSystem& jobSystem, const Type* in, Type* out, size_t count, Type init, OpType op = OpType());
+
+template<class Type, class OpType = Plus<Type>>
+Type ParallelInclusiveScan(JobSystem& jobSystem, const Type* in, Type* out, size_t count, Type init, OpType op = OpType());
+
+//stable unlike Partition; predicate is called twice per element and elements go through buffer taken from allocator
+template<class Type, class PredicateType>
+Type* ParallelPartition(JobSystem& jobSystem, Allocator& allocator, Type* begin, Type* end, PredicateType predicate);
+
+
+}
+
+
+#include "internal/scan.inl"
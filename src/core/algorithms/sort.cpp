@@ -0,0 +1,166 @@
+#include "sort.h"
+
+#include "core/memory.h"
+
+
+namespace Veng
+{
+
+
+static const size_t RADIX_BUCKETS = 256;
+static const size_t PARALLEL_RADIX_GRAIN = 16384;
+
+
+template<class KeyType>
+static u32 GetRadixByte(const KeyType& key, u32 pass)
+{
+	return (u32)(key.key >> (pass * 8)) & 0xff;
+}
+
+//histogram turns into first output position of each bucket, returns false when whole range falls into one bucket
+static bool HistogramToOffsets(size_t* histogram, size_t count, u32 firstKeyByte)
+{
+	if (histogram[firstKeyByte] == count)
+		return false;
+
+	size_t offset = 0;
+	for (size_t bucket = 0; bucket < RADIX_BUCKETS; ++bucket)
+	{
+		const size_t bucketCount = histogram[bucket];
+		histogram[bucket] = offset;
+		offset += bucketCount;
+	}
+	return true;
+}
+
+
+//histograms of all passes are counted in one read of keys
+template<class KeyType>
+static void RadixSortKeys(Allocator& allocator, KeyType* keys, size_t count)
+{
+	static const u32 PASS_COUNT = sizeof(keys->key);
+	if (count < 2)
+		return;
+
+	size_t histograms[PASS_COUNT][RADIX_BUCKETS] = {};
+	for (size_t i = 0; i < count; ++i)
+	{
+		for (u32 pass = 0; pass < PASS_COUNT; ++pass)
+			++histograms[pass][GetRadixByte(keys[i], pass)];
+	}
+
+	KeyType* buffer = static_cast<KeyType*>(allocator.Allocate(count * sizeof(KeyType), alignof(KeyType)));
+	KeyType* from = keys;
+	KeyType* to = buffer;
+	for (u32 pass = 0; pass < PASS_COUNT; ++pass)
+	{
+		size_t* offsets = histograms[pass];
+		if (!HistogramToOffsets(offsets, count, GetRadixByte(from[0], pass)))
+			continue;
+
+		for (size_t i = 0; i < count; ++i)
+			to[offsets[GetRadixByte(from[i], pass)]++] = from[i];
+		KeyType* tmp = from;
+		from = to;
+		to = tmp;
+	}
+
+	if (from != keys)
+		memory::Copy(keys, from, count * sizeof(KeyType));
+	allocator.Deallocate(buffer);
+}
+
+
+//every pass counts and scatters chunks in parallel; within bucket, chunks write in their order, so sort stays stable
+template<class KeyType>
+static void ParallelRadixSortKeys(JobSystem& jobSystem, Allocator& allocator, KeyType* keys, size_t count)
+{
+	static const u32 PASS_COUNT = sizeof(keys->key);
+	const u32 chunkCount = AlgorithmsInternal::GetChunkCount(jobSystem, count, PARALLEL_RADIX_GRAIN);
+	if (chunkCount == 1)
+	{
+		RadixSortKeys(allocator, keys, count);
+		return;
+	}
+
+	size_t* offsets = static_cast<size_t*>(allocator.Allocate(chunkCount * RADIX_BUCKETS * sizeof(size_t), alignof(size_t)));
+	KeyType* buffer = static_cast<KeyType*>(allocator.Allocate(count * sizeof(KeyType), alignof(KeyType)));
+	KeyType* from = keys;
+	KeyType* to = buffer;
+	for (u32 pass = 0; pass < PASS_COUNT; ++pass)
+	{
+		ParallelFor(jobSystem, 0, chunkCount, 1, [&](size_t first, size_t last)
+		{
+			for (size_t chunk = first; chunk < last; ++chunk)
+			{
+				size_t* histogram = offsets + chunk * RADIX_BUCKETS;
+				memory::Set(histogram, 0, RADIX_BUCKETS * sizeof(size_t));
+				const size_t end = AlgorithmsInternal::GetChunkBegin(count, chunkCount, (u32)chunk + 1);
+				for (size_t i = AlgorithmsInternal::GetChunkBegin(count, chunkCount, (u32)chunk); i < end; ++i)
+					++histogram[GetRadixByte(from[i], pass)];
+			}
+		});
+
+		const u32 firstKeyByte = GetRadixByte(from[0], pass);
+		size_t firstKeyBucketCount = 0;
+		for (u32 chunk = 0; chunk < chunkCount; ++chunk)
+			firstKeyBucketCount += offsets[chunk * RADIX_BUCKETS + firstKeyByte];
+		if (firstKeyBucketCount == count)
+			continue;
+
+		size_t offset = 0;
+		for (size_t bucket = 0; bucket < RADIX_BUCKETS; ++bucket)
+		{
+			for (u32 chunk = 0; chunk < chunkCount; ++chunk)
+			{
+				size_t& chunkOffset = offsets[chunk * RADIX_BUCKETS + bucket];
+				const size_t bucketCount = chunkOffset;
+				chunkOffset = offset;
+				offset += bucketCount;
+			}
+		}
+
+		ParallelFor(jobSystem, 0, chunkCount, 1, [&](size_t first, size_t last)
+		{
+			for (size_t chunk = first; chunk < last; ++chunk)
+			{
+				size_t* chunkOffsets = offsets + chunk * RADIX_BUCKETS;
+				const size_t end = AlgorithmsInternal::GetChunkBegin(count, chunkCount, (u32)chunk + 1);
+				for (size_t i = AlgorithmsInternal::GetChunkBegin(count, chunkCount, (u32)chunk); i < end; ++i)
+					to[chunkOffsets[GetRadixByte(from[i], pass)]++] = from[i];
+			}
+		});
+		KeyType* tmp = from;
+		from = to;
+		to = tmp;
+	}
+
+	if (from != keys)
+		memory::Copy(keys, from, count * sizeof(KeyType));
+	allocator.Deallocate(buffer);
+	allocator.Deallocate(offsets);
+}
+
+
+void RadixSort(Allocator& allocator, SortKey32* keys, size_t count)
+{
+	RadixSortKeys(allocator, keys, count);
+}
+
+void RadixSort(Allocator& allocator, SortKey64* keys, size_t count)
+{
+	RadixSortKeys(allocator, keys, count);
+}
+
+void ParallelRadixSort(JobSystem& jobSystem, Allocator& allocator, SortKey32* keys, size_t count)
+{
+	ParallelRadixSortKeys(jobSystem, allocator, keys, count);
+}
+
+void ParallelRadixSort(JobSystem& jobSystem, Allocator& allocator, SortKey64* keys, size_t count)
+{
+	ParallelRadixSortKeys(jobSystem, allocator, keys, count);
+}
+
+
+}
@@ -0,0 +1,60 @@
+#pragma once
+
+#include "core/allocator.h"
+#include "core/int.h"
+
+
+namespace Veng
+{
+
+class JobSystem;
+
+
+template<class Type>
+struct Less
+{
+	bool operator()(const Type& a, const Type& b) const { return a < b; }
+};
+
+
+//in place and not stable; quick sort which falls back to heap sort when pivots go bad, so worst case is O(n log n)
+template<class Type, class LessType = Less<Type>>
+void Sort(Type* begin, Type* end, LessType less = LessType());
+
+template<class Type, class LessType = Less<Type>>
+void HeapSort(Type* begin, Type* end, LessType less = LessType());
+
+//bottom-up merge sort, temporary buffer of the same size is taken from allocator
+template<class Type, class LessType = Less<Type>>
+void StableSort(Allocator& allocator, Type* begin, Type* end, LessType less = LessType());
+
+//stable; chunks are sorted by separate jobs and merged in rounds, each merge is split along merge path
+//so every round keeps all threads busy
+template<class Type, class LessType = Less<Type>>
+void ParallelSort(JobSystem& jobSystem, Allocator& allocator, Type* begin, Type* end, LessType less = LessType());
+
+
+//key with index of element it belongs to, radix sort orders these instead of elements themselves
+struct SortKey32
+{
+	u32 key;
+	u32 index;
+};
+
+struct SortKey64
+{
+	u64 key;
+	u32 index;
+};
+
+//stable LSD radix sort by key, byte per pass; passes in which all keys share the byte are skipped
+void RadixSort(Allocator& allocator, SortKey32* keys, size_t count);
+void RadixSort(Allocator& allocator, SortKey64* keys, size_t count);
+void ParallelRadixSort(JobSystem& jobSystem, Allocator& allocator, SortKey32* keys, size_t count);
+void ParallelRadixSort(JobSystem& jobSystem, Allocator& allocator, SortKey64* keys, size_t count);
+
+
+}
+
+
+#include "internal/sort.inl"
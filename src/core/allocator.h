@@ -31,7 +31,10 @@ struct AllocationDebugData
 #endif
 
 
-void* AlignPointer(void* ptr, size_t alignment);
+inline void* AlignPointer(void* ptr, size_t alignment)
+{
+	return (void*)(((uintptr)ptr + (uintptr)alignment - 1) & ~(uintptr)(alignment - 1));
+}
 
 
 class Allocator
@@ -43,6 +46,8 @@ public:
 	virtual void* Reallocate(void* ptr, size_t size, size_t alignment) = 0;
 	virtual void Deallocate(void* ptr) = 0;
 	virtual size_t GetSize(void* ptr) const = 0;
+	//grows allocation to at least size bytes without moving it, fails when memory behind it is not free
+	virtual bool TryExpand(void* ptr, size_t size) { return false; }
 
 	#if DEBUG_ALLOCATORS
 	virtual void SetDebugName(const char* name) = 0;
@@ -55,9 +60,11 @@ public:
 	virtual size_t GetBlocksSize() const = 0;
 	virtual void* const* GetBlocks() const = 0;
 	virtual size_t GetBlockSize() const = 0;
+	//refreshes views returned by GetAllocations and GetBlocks, for allocators which build them on demand
+	virtual void UpdateDebugView() const {}
 	#else
-	void SetDebugName(const char* name) {}
-	const char* GetDebugName() const { return ""; }
+	virtual void SetDebugName(const char* name) {}
+	virtual const char* GetDebugName() const { return ""; }
 	size_t GetAllocCount() const { return 0; }
 	size_t GetAllocSize() const { return 0; }
 
@@ -66,6 +73,7 @@ public:
 	size_t GetBlocksSize() const { return 0; }
 	void* const* GetBlocks() const { return nullptr; }
 	size_t GetBlockSize() const { return 0; }
+	void UpdateDebugView() const {}
 	#endif
 };
 
@@ -1,25 +1,18 @@
 #include "allocators.h"
 
-#include <cstdlib>
-
+#include "algorithms/sort.h"
 #include "math/math.h"
+#include "memory.h"
+#include "file/clob.h"
+#include "string.h"
 #include "core/os/os_utils.h"
+#include "core/threading/os_utils.h"
 
 
 namespace Veng
 {
 
 
-#if DEBUG_ALLOCATORS
-
-struct AllocHeader
-{
-	size_t size;
-	size_t allSize;
-	void* ptr;
-};
-
-
 struct AllocInfo
 {
 	AllocInfo()
@@ -45,6 +38,9 @@ const AllocInfo& GetAllocInfo()
 	return s_allocInfo;
 }
 
+
+#if DEBUG_ALLOCATORS
+
 static const size_t MAX_ALLOCATORS = 1000;
 static StackAllocator<(1000 + 1) * sizeof(AllocatorDebugData)> s_allocatorsAllocator;
 static Array<AllocatorDebugData> s_allocators(s_allocatorsAllocator);
@@ -55,20 +51,156 @@ const Array<AllocatorDebugData>& GetAllocators()
 }
 
 
+static size_t SumAllocCount(const ThreadAllocCounters* counters)
+{
+	i64 sum = 0;
+	for (size_t i = 0; i < MAX_THREADS; ++i)
+		sum += counters[i].allocCount;
+	return (size_t)sum;
+}
+
+static size_t SumAllocSize(const ThreadAllocCounters* counters)
+{
+	i64 sum = 0;
+	for (size_t i = 0; i < MAX_THREADS; ++i)
+		sum += counters[i].allocSize;
+	return (size_t)sum;
+}
+
+
 #endif
 
 
-void* AlignPointer(void* ptr, size_t alignment)
+// ---------------- ALLOCATOR STATS ----------------
+
+
+//shard is emptied before live size takes its part, reader in between sees less, never the same bytes twice
+void AllocatorStats::FlushSize(Shard& shard, i64 unflushedSize)
 {
-	return (void*)(((uintptr)ptr + (uintptr)alignment - 1) & ~(uintptr)(alignment - 1));
+	StoreShard(&shard.unflushedSize, 0);
+	const i64 liveSize = AtomicAdd(&m_liveSize, unflushedSize) + unflushedSize;
+
+	i64 peakSize = AtomicLoad(&m_peakSize, MemoryOrder::Relaxed);
+	while (liveSize > peakSize)
+	{
+		const i64 previous = AtomicCompareExchange64(&m_peakSize, liveSize, peakSize);
+		if (previous == peakSize)
+			break;
+		peakSize = previous;
+	}
 }
 
+void AllocatorStats::NewFrame()
+{
+	const Summary summary = GetSummary();
+	m_lastFrameCount = summary.totalCount - m_frameStartCount;
+	m_frameStartCount = summary.totalCount;
+}
 
-// ---------------- MAIN ALLOCATOR ----------------
+AllocatorStats::Summary AllocatorStats::GetSummary() const
+{
+	Summary summary;
+	summary.allocSize = AtomicLoad(&m_liveSize, MemoryOrder::Relaxed);
+	i64 freeCount = 0;
+	for (const Shard& shard : m_shards)
+	{
+		summary.allocSize += LoadShard(&shard.unflushedSize);
+		freeCount += LoadShard(&shard.freeCount);
+		for (size_t i = 0; i < HISTOGRAM_SIZE; ++i)
+		{
+			const i64 count = LoadShard(&shard.histogram[i]);
+			summary.histogram[i] += count;
+			summary.totalCount += count;
+		}
+	}
+	summary.allocCount = summary.totalCount - freeCount;
+	summary.peakSize = Max(AtomicLoad(&m_peakSize, MemoryOrder::Relaxed), summary.allocSize);
+	summary.lastFrameCount = m_lastFrameCount;
+	return summary;
+}
 
 
-MainAllocator::MainAllocator()
+static const size_t MAX_STATS_ALLOCATORS = 256;
+static Mutex s_statsLock;
+static ProxyAllocator* s_statsAllocators[MAX_STATS_ALLOCATORS];
+static size_t s_statsAllocatorsCount = 0;
+
+static void RegisterStats(ProxyAllocator* allocator)
+{
+	ScopeLock<Mutex> lock(s_statsLock);
+	ASSERT2(s_statsAllocatorsCount < MAX_STATS_ALLOCATORS, "Too many allocators");
+	s_statsAllocators[s_statsAllocatorsCount++] = allocator;
+}
+
+static void UnregisterStats(ProxyAllocator* allocator)
+{
+	ScopeLock<Mutex> lock(s_statsLock);
+	for (size_t i = 0; i < s_statsAllocatorsCount; ++i)
+	{
+		if (s_statsAllocators[i] == allocator)
+		{
+			s_statsAllocators[i] = s_statsAllocators[--s_statsAllocatorsCount];
+			return;
+		}
+	}
+	ASSERT2(false, "Allocator is not registered");
+}
+
+
+void NewAllocatorStatsFrame()
+{
+	ScopeLock<Mutex> lock(s_statsLock);
+	for (size_t i = 0; i < s_statsAllocatorsCount; ++i)
+		s_statsAllocators[i]->GetStats().NewFrame();
+}
+
+static void WriteText(OutputClob& clob, const char* text)
+{
+	clob.Write(text, string::Length(text));//WriteString would also store the terminator
+}
+
+void WriteAllocatorStats(OutputClob& clob)
+{
+	ScopeLock<Mutex> lock(s_statsLock);
+
+	WriteText(clob, "[");
+	for (size_t i = 0; i < s_statsAllocatorsCount; ++i)
+	{
+		const ProxyAllocator* allocator = s_statsAllocators[i];
+		const AllocatorStats::Summary summary = allocator->GetStats().GetSummary();
+
+		WriteText(clob, (i == 0) ? "\n\t{\"name\": \"" : ",\n\t{\"name\": \"");
+		WriteText(clob, allocator->GetDebugName());
+		WriteText(clob, "\", \"allocCount\": ");
+		clob.Write((u64)Max(summary.allocCount, (i64)0));
+		WriteText(clob, ", \"allocSize\": ");
+		clob.Write((u64)Max(summary.allocSize, (i64)0));
+		WriteText(clob, ", \"peakSize\": ");
+		clob.Write((u64)summary.peakSize);
+		WriteText(clob, ", \"totalCount\": ");
+		clob.Write((u64)summary.totalCount);
+		WriteText(clob, ", \"lastFrameCount\": ");
+		clob.Write((u64)summary.lastFrameCount);
+		WriteText(clob, ", \"histogram\": [");
+		for (size_t j = 0; j < AllocatorStats::HISTOGRAM_SIZE; ++j)
+		{
+			if (j > 0)
+				WriteText(clob, ", ");
+			clob.Write((u64)summary.histogram[j]);
+		}
+		WriteText(clob, "]}");
+	}
+	WriteText(clob, "\n]\n");
+}
+
+
+// ---------------- HEAP ALLOCATOR ----------------
+
+
+HeapAllocator::HeapAllocator()
 {
+	static_assert(sizeof(Pool) % ALIGN_SIZE == 0 && 2 * sizeof(void*) % ALIGN_SIZE == 0, "Heap blocks would not be aligned");
+
 #if DEBUG_ALLOCATORS
 	s_allocators.Reserve(MAX_ALLOCATORS);
 	AllocatorDebugData data;
@@ -77,7 +209,7 @@ MainAllocator::MainAllocator()
 #endif
 }
 
-MainAllocator::~MainAllocator()
+HeapAllocator::~HeapAllocator()
 {
 #if DEBUG_ALLOCATORS
 	ASSERT2(m_allocCount == 0, "Memory leak");
@@ -87,331 +219,397 @@ MainAllocator::~MainAllocator()
 	data.allocator = this;
 	s_allocators.Erase(data);
 #endif
-}
 
-void* MainAllocator::Allocate(size_t size, size_t alignment)
-{
-	ScopeLock<SpinLock> lock(m_lock);
+	while (m_pools != nullptr)
+	{
+		Pool* pool = m_pools;
+		m_pools = pool->next;
+		os::ReleaseMemory(pool, pool->size);
+	}
+}
 
-#if DEBUG_ALLOCATORS
-	size_t allocAlign = Max(alignment, alignof(AllocHeader));
-	size_t allocSize = allocAlign + sizeof(AllocHeader) + alignment + size;
-	void* ptr = malloc(allocSize);
-	void* data = AlignPointer((char*)ptr + sizeof(AllocHeader), allocAlign);
-	ASSERT2((uintptr)data % alignment == 0, "Invalid alignment");
-	AllocHeader* header = static_cast<AllocHeader*>((void*)((char*)data - sizeof(AllocHeader)));
-	ASSERT2((uintptr)header % alignof(AllocHeader) == 0, "Invalid alignment");
-	header->size = size;
-	header->allSize = allocSize;
-	header->ptr = ptr;
 
-	m_allocCount++;
-	m_allocSize += allocSize;
-#else
-	void* ptr = malloc(alignment + size);
-	void* data = AlignPointer((char*)ptr + 1, alignment);
-	*((char*)data - 1) = (char)((ptrdiff_t)data - (ptrdiff_t)ptr);
-#endif
+static const size_t HEAP_FREE_BIT = 1;
+static const size_t HEAP_BLOCK_HEADER_SIZE = 2 * sizeof(void*);//prevPhys and size, rest of header is payload
+static const size_t HEAP_MIN_BLOCK_SIZE = 2 * sizeof(void*);//free list links must fit into payload
 
-	return data;
-}
 
-void* MainAllocator::Reallocate(void* ptr, size_t size, size_t alignment)
+void* HeapAllocator::Allocate(size_t size, size_t alignment)
 {
-	ScopeLock<SpinLock> lock(m_lock);
+	ScopeLock<Mutex> lock(m_lock);
 
-#if DEBUG_ALLOCATORS
-	if (ptr != nullptr)
-	{
-		AllocHeader origHeader = *static_cast<AllocHeader*>((void*)((char*)ptr - sizeof(AllocHeader)));
-		m_allocCount--;
-		m_allocSize -= origHeader.allSize;
-		ptr = (void*)origHeader.ptr;
-	}
+	return AllocateLocked(size, alignment);
+}
 
-	size_t allocAlign = Max(alignment, alignof(AllocHeader));
-	size_t allocSize = allocAlign + sizeof(AllocHeader) + alignment + size;
-	void* newPtr = realloc(ptr, allocSize);
-	//if realloc returns memory pointer with different alignment as malloc, whole universe will explode (data pointer would points to wrong memory)
+void* HeapAllocator::Reallocate(void* ptr, size_t size, size_t alignment)
+{
+	if (ptr == nullptr)
+		return Allocate(size, alignment);
 
-	if (newPtr != nullptr)
-	{
-		void* data = AlignPointer((char*)newPtr + sizeof(AllocHeader), allocAlign);
-		ASSERT2((uintptr)data % alignment == 0, "Invalid alignment");
-		AllocHeader* header = static_cast<AllocHeader*>((void*)((char*)data - sizeof(AllocHeader)));
-		ASSERT2((uintptr)header % alignof(AllocHeader) == 0, "Invalid alignment");
-		header->size = size;
-		header->allSize = allocSize;
-		header->ptr = newPtr;
+	ScopeLock<Mutex> lock(m_lock);
 
-		m_allocCount++;
-		m_allocSize += allocSize;
+	Block* block = (Block*)((u8*)ptr - HEAP_BLOCK_HEADER_SIZE);
+	const size_t oldSize = block->size;
+	if (((uintptr)ptr & (alignment - 1)) == 0 && ExpandBlock(block, size))
+		return ptr;
 
-		newPtr = data;
-	}
-#else
-	if (ptr != nullptr)
-	{
-		void* origPtr = (char*)ptr - *((char*)ptr - 1);
-		ptr = origPtr;
-	}
-	void* newPtr = realloc(ptr, alignment + size);
-	//if realloc returns memory pointer with different alignment as malloc, whole universe will explode (data pointer would points to wrong memory)
-	if (newPtr != nullptr)
+	void* data = AllocateLocked(size, alignment);
+	if (data != nullptr)
 	{
-		void* data = AlignPointer((char*)newPtr + 1, alignment);
-		*((char*)data - 1) = (char)((ptrdiff_t)data - (ptrdiff_t)newPtr);
-		newPtr = data;
+		memory::Copy(data, ptr, Min(size, oldSize));
+		DeallocateLocked(ptr);
 	}
-#endif
-
-	return newPtr;
+	return data;
 }
 
-void MainAllocator::Deallocate(void* ptr)
+void HeapAllocator::Deallocate(void* ptr)
 {
 	ASSERT(ptr != nullptr);
 
-	ScopeLock<SpinLock> lock(m_lock);
+	ScopeLock<Mutex> lock(m_lock);
 
-#if DEBUG_ALLOCATORS
-	AllocHeader* header = static_cast<AllocHeader*>((void*)((char*)ptr - sizeof(AllocHeader)));
-	m_allocCount--;
-	m_allocSize -= header->allSize;
-	free(header->ptr);
-#else
-	void* origPtr = (char*)ptr - *((char*)ptr - 1);
-	free(origPtr);
-#endif
+	DeallocateLocked(ptr);
 }
 
-size_t MainAllocator::GetSize(void* ptr) const
+size_t HeapAllocator::GetSize(void* ptr) const
 {
-#if DEBUG_ALLOCATORS
-	AllocHeader* info = static_cast<AllocHeader*>((void*)((char*)ptr - sizeof(AllocHeader)));
-	return info->size;
-#else
-	return 0;
-#endif
+	return ((Block*)((u8*)ptr - HEAP_BLOCK_HEADER_SIZE))->size;
 }
 
-#if DEBUG_ALLOCATORS
-
-size_t MainAllocator::GetAllocCount() const
+bool HeapAllocator::TryExpand(void* ptr, size_t size)
 {
-	return m_allocCount;
-}
+	ScopeLock<Mutex> lock(m_lock);
 
-size_t MainAllocator::GetAllocSize() const
-{
-	return m_allocSize;
+	return ExpandBlock((Block*)((u8*)ptr - HEAP_BLOCK_HEADER_SIZE), size);
 }
 
-#endif
-
-
-// ---------------- PROXY ALLOCATOR ----------------
-
 
-ProxyAllocator::ProxyAllocator(Allocator& allocator)
-	: m_source(allocator)
-#if DEBUG_ALLOCATORS
-	, m_allocations(allocator)
-	, m_pages(allocator)
-#endif
+size_t HeapAllocator::AllocateBatch(size_t size, void** ptrs, size_t count)
 {
-#if DEBUG_ALLOCATORS
-	AllocatorDebugData data;
-	data.parent = &allocator;
-	data.allocator = this;
-	s_allocators.PushBack(data);
-#endif
+	ScopeLock<Mutex> lock(m_lock);
+
+	for (size_t i = 0; i < count; ++i)
+	{
+		ptrs[i] = AllocateLocked(size, ALIGN_SIZE);
+		if (ptrs[i] == nullptr)
+			return i;
+	}
+	return count;
 }
 
-ProxyAllocator::~ProxyAllocator()
+void HeapAllocator::DeallocateBatch(void* const* ptrs, size_t count)
 {
-#if DEBUG_ALLOCATORS
-	ASSERT2(m_pages.GetSize() == 0, "Memory leak");
-	ASSERT2(m_allocations.GetSize() == 0, "Memory leak");
+	ScopeLock<Mutex> lock(m_lock);
 
-	ASSERT2(m_allocCount == 0, "Memory leak");
-	ASSERT2(m_allocSize == 0, "Memory leak");
+	for (size_t i = 0; i < count; ++i)
+		DeallocateLocked(ptrs[i]);
+}
 
-	AllocatorDebugData data;
-	data.allocator = this;
-	s_allocators.Erase(data);
-#endif
+
+void HeapAllocator::MappingInsert(size_t size, size_t& fl, size_t& sl)
+{
+	if (size < SMALL_BLOCK_SIZE)
+	{
+		fl = 0;
+		sl = size >> ALIGN_SHIFT;
+	}
+	else
+	{
+		const size_t highBit = HighestBitIndex(size);
+		sl = (size >> (highBit - SL_SHIFT)) ^ SL_COUNT;
+		fl = highBit - FL_SHIFT + 1;
+	}
 }
 
-void* ProxyAllocator::Allocate(size_t size, size_t alignment)
+void HeapAllocator::MappingSearch(size_t size, size_t& fl, size_t& sl)
 {
-	ScopeLock<SpinLock> lock(m_lock);
+	//round up to next list, so any block in found list is big enough
+	if (size >= SMALL_BLOCK_SIZE)
+		size += ((size_t)1 << (HighestBitIndex(size) - SL_SHIFT)) - 1;
+	MappingInsert(size, fl, sl);
+}
 
-	void* data = m_source.Allocate(size, alignment);
-#if DEBUG_ALLOCATORS
-	m_allocCount++;
-	m_allocSize += size;
 
-	AllocationDebugData allocData;
-	allocData.allocation = data;
-	os::GetCallStack(0, 16, allocData.callstack);
-	m_allocations.AddOrdered(allocData);
+void* HeapAllocator::AllocateLocked(size_t size, size_t alignment)
+{
+	const size_t blockSize = Max((size + ALIGN_SIZE - 1) & ~(ALIGN_SIZE - 1), HEAP_MIN_BLOCK_SIZE);
+	//bigger alignment needs space in front of block for free block with at least minimal size
+	const size_t searchSize = (alignment > ALIGN_SIZE) ? blockSize + alignment + HEAP_BLOCK_HEADER_SIZE : blockSize;
 
-	void* pagePtr = (void*)(((uintptr)data / GetAllocInfo().pageSize) * GetAllocInfo().pageSize);//TODO: bit operations
-	size_t* count;
-	if (m_pages.Find(pagePtr, count))
+	Block* block = FindFreeBlock(searchSize);
+	if (block == nullptr)
 	{
-		(*count)++;
+		if (!AddPool(searchSize))
+			return nullptr;
+		block = FindFreeBlock(searchSize);
+		ASSERT(block != nullptr);
 	}
-	else
+
+	u8* data = (u8*)block + HEAP_BLOCK_HEADER_SIZE;
+	if (((uintptr)data & (alignment - 1)) != 0)
 	{
-		m_pages.Insert(pagePtr, 1);
+		u8* aligned = (u8*)AlignPointer(data + HEAP_BLOCK_HEADER_SIZE + HEAP_MIN_BLOCK_SIZE, alignment);
+		const size_t gap = aligned - data;
+		Block* alignedBlock = (Block*)(aligned - HEAP_BLOCK_HEADER_SIZE);
+		alignedBlock->prevPhys = block;
+		alignedBlock->size = (block->size & ~HEAP_FREE_BIT) - gap;
+		((Block*)(aligned + alignedBlock->size))->prevPhys = alignedBlock;
+		block->size = (gap - HEAP_BLOCK_HEADER_SIZE) | HEAP_FREE_BIT;
+		InsertFreeBlock(block);//previous block is used, free blocks are always merged
+
+		block = alignedBlock;
+		data = aligned;
 	}
+
+	block->size &= ~HEAP_FREE_BIT;
+	TrimBlock(block, blockSize);
+
+#if DEBUG_ALLOCATORS
+	m_allocCount++;
+	m_allocSize += block->size;
 #endif
 	return data;
 }
 
-void* ProxyAllocator::Reallocate(void* ptr, size_t size, size_t alignment)
+void HeapAllocator::DeallocateLocked(void* ptr)
 {
-	ScopeLock<SpinLock> lock(m_lock);
+	Block* block = (Block*)((u8*)ptr - HEAP_BLOCK_HEADER_SIZE);
+	ASSERT2((block->size & HEAP_FREE_BIT) == 0, "Double free");
 
 #if DEBUG_ALLOCATORS
-	if (ptr != nullptr)
-	{
-		m_allocCount--;
-		m_allocSize -= m_source.GetSize(ptr);
-
-		AllocationDebugData allocData;
-		allocData.allocation = ptr;
-		size_t idx;
-		ASSERT(m_allocations.Find(allocData, idx));
-		allocData = m_allocations[idx];
+	m_allocCount--;
+	m_allocSize -= block->size;
+#endif
 
-		m_allocations.EraseOrdered(idx);
+	Block* prev = block->prevPhys;
+	if (prev != nullptr && (prev->size & HEAP_FREE_BIT) != 0)
+	{
+		RemoveFreeBlock(prev);
+		prev->size = (prev->size & ~HEAP_FREE_BIT) + HEAP_BLOCK_HEADER_SIZE + block->size;
+		block = prev;
+	}
 
-		void* oldPagePtr = (void*)(((uintptr)ptr / GetAllocInfo().pageSize) * GetAllocInfo().pageSize);
-		size_t* oldCount;
-		if (m_pages.Find(oldPagePtr, oldCount))
-		{
-			(*oldCount)--;
-			if (*oldCount == 0)
-				m_pages.Erase(oldPagePtr);
-		}
-		else
-		{
-			ASSERT2(false, "There must be record of page for given allocation");
-		}
+	Block* next = (Block*)((u8*)block + HEAP_BLOCK_HEADER_SIZE + (block->size & ~HEAP_FREE_BIT));
+	if ((next->size & HEAP_FREE_BIT) != 0)
+	{
+		RemoveFreeBlock(next);
+		block->size = (block->size & ~HEAP_FREE_BIT) + HEAP_BLOCK_HEADER_SIZE + (next->size & ~HEAP_FREE_BIT);
+		next = (Block*)((u8*)block + HEAP_BLOCK_HEADER_SIZE + block->size);
 	}
-#endif
+	next->prevPhys = block;
+	block->size |= HEAP_FREE_BIT;
 
-	void* data = m_source.Reallocate(ptr, size, alignment);
+	//oversized pools are given back to system as soon as they are empty
+	Pool* pool = (Pool*)((u8*)block - sizeof(Pool));
+	if (block->prevPhys == nullptr && next->size == 0 && pool->size > POOL_SIZE)
+		ReleasePool(pool);
+	else
+		InsertFreeBlock(block);
+}
 
-#if DEBUG_ALLOCATORS
-	if (data != nullptr)
-	{
-		m_allocCount++;
-		m_allocSize += size;
+HeapAllocator::Block* HeapAllocator::FindFreeBlock(size_t size)
+{
+	size_t fl, sl;
+	MappingSearch(size, fl, sl);
+	if (fl >= FL_COUNT)
+		return nullptr;
 
-		AllocationDebugData allocData;
-		allocData.allocation = data;
-		m_allocations.AddOrdered(allocData);
+	u32 slMap = m_slBitmap[fl] & (~0u << sl);
+	if (slMap == 0)
+	{
+		const u32 flMap = (fl + 1 < FL_COUNT) ? m_flBitmap & (~0u << (fl + 1)) : 0;
+		if (flMap == 0)
+			return nullptr;
 
-		void* pagePtr = (void*)(((uintptr)data / GetAllocInfo().pageSize) * GetAllocInfo().pageSize);
-		size_t* count;
-		if (m_pages.Find(pagePtr, count))
-		{
-			(*count)++;
-		}
-		else
-		{
-			m_pages.Insert(pagePtr, 1);
-		}
+		fl = LowestBitIndex(flMap);
+		slMap = m_slBitmap[fl];
 	}
-#endif
+	sl = LowestBitIndex(slMap);
 
-	return data;
+	Block* block = m_freeBlocks[fl][sl];
+	RemoveFreeBlock(block);
+	return block;
 }
 
-void ProxyAllocator::Deallocate(void* ptr)
+void HeapAllocator::InsertFreeBlock(Block* block)
 {
-	ASSERT(ptr != nullptr);
+	size_t fl, sl;
+	MappingInsert(block->size & ~HEAP_FREE_BIT, fl, sl);
+
+	Block* head = m_freeBlocks[fl][sl];
+	block->nextFree = head;
+	block->prevFree = nullptr;
+	if (head != nullptr)
+		head->prevFree = block;
+	m_freeBlocks[fl][sl] = block;
+
+	m_flBitmap |= 1u << fl;
+	m_slBitmap[fl] |= 1u << sl;
+}
 
-	ScopeLock<SpinLock> lock(m_lock);
+void HeapAllocator::RemoveFreeBlock(Block* block)
+{
+	size_t fl, sl;
+	MappingInsert(block->size & ~HEAP_FREE_BIT, fl, sl);
 
-#if DEBUG_ALLOCATORS
-	m_allocCount--;
-	m_allocSize -= m_source.GetSize(ptr);
+	if (block->prevFree != nullptr)
+		block->prevFree->nextFree = block->nextFree;
+	else
+		m_freeBlocks[fl][sl] = block->nextFree;
+	if (block->nextFree != nullptr)
+		block->nextFree->prevFree = block->prevFree;
 
-	AllocationDebugData allocData;
-	allocData.allocation = ptr;
-	size_t idx;
-	ASSERT(m_allocations.Find(allocData, idx));
-	allocData = m_allocations[idx];
-#endif
+	if (m_freeBlocks[fl][sl] == nullptr)
+	{
+		m_slBitmap[fl] &= ~(1u << sl);
+		if (m_slBitmap[fl] == 0)
+			m_flBitmap &= ~(1u << fl);
+	}
+}
 
-	m_source.Deallocate(ptr);
+//splits end of used block to new free block if it is big enough
+void HeapAllocator::TrimBlock(Block* block, size_t size)
+{
+	if (block->size < size + HEAP_BLOCK_HEADER_SIZE + HEAP_MIN_BLOCK_SIZE)
+		return;
 
-#if DEBUG_ALLOCATORS
-	m_allocations.EraseOrdered(idx);
+	Block* rest = (Block*)((u8*)block + HEAP_BLOCK_HEADER_SIZE + size);
+	rest->prevPhys = block;
+	rest->size = block->size - size - HEAP_BLOCK_HEADER_SIZE;
+	block->size = size;
 
-	void* pagePtr = (void*)(((uintptr)ptr / GetAllocInfo().pageSize) * GetAllocInfo().pageSize);
-	size_t* count;
-	if (m_pages.Find(pagePtr, count))
+	Block* next = (Block*)((u8*)rest + HEAP_BLOCK_HEADER_SIZE + rest->size);
+	if ((next->size & HEAP_FREE_BIT) != 0)
 	{
-		(*count)--;
-		if (*count == 0)
-			m_pages.Erase(pagePtr);
+		RemoveFreeBlock(next);
+		rest->size += HEAP_BLOCK_HEADER_SIZE + (next->size & ~HEAP_FREE_BIT);
+		next = (Block*)((u8*)rest + HEAP_BLOCK_HEADER_SIZE + rest->size);
 	}
-	else
+	next->prevPhys = rest;
+	rest->size |= HEAP_FREE_BIT;
+	InsertFreeBlock(rest);
+}
+
+//absorbs following free block if needed and trims the rest, block is left untouched when it can't hold size
+bool HeapAllocator::ExpandBlock(Block* block, size_t size)
+{
+	const size_t blockSize = Max((size + ALIGN_SIZE - 1) & ~(ALIGN_SIZE - 1), HEAP_MIN_BLOCK_SIZE);
+	const size_t oldSize = block->size;
+
+	Block* next = (Block*)((u8*)block + HEAP_BLOCK_HEADER_SIZE + oldSize);
+	if (oldSize < blockSize && (next->size & HEAP_FREE_BIT) != 0
+		&& oldSize + HEAP_BLOCK_HEADER_SIZE + (next->size & ~HEAP_FREE_BIT) >= blockSize)
 	{
-		ASSERT2(false, "There must be record of page for given allocation");
+		RemoveFreeBlock(next);
+		block->size += HEAP_BLOCK_HEADER_SIZE + (next->size & ~HEAP_FREE_BIT);
+		((Block*)((u8*)block + HEAP_BLOCK_HEADER_SIZE + block->size))->prevPhys = block;
 	}
+
+	if (block->size < blockSize)
+		return false;
+
+	TrimBlock(block, blockSize);
+#if DEBUG_ALLOCATORS
+	m_allocSize -= oldSize;
+	m_allocSize += block->size;
 #endif
+	return true;
 }
 
-size_t ProxyAllocator::GetSize(void* ptr) const
+bool HeapAllocator::AddPool(size_t size)
 {
-	return m_source.GetSize(ptr);
+	//search rounds size up to next list, pool's block has to be big enough to land in it
+	if (size >= SMALL_BLOCK_SIZE)
+		size += ((size_t)1 << (HighestBitIndex(size) - SL_SHIFT)) - 1;
+
+	const size_t granularity = GetAllocInfo().allocationGranularity;
+	const size_t overhead = sizeof(Pool) + 2 * HEAP_BLOCK_HEADER_SIZE;
+	const size_t poolSize = Max((size_t)POOL_SIZE, (size + overhead + granularity - 1) / granularity * granularity);
+
+	void* memory = os::ReserveMemory(poolSize);
+	if (memory == nullptr)
+		return false;
+	if (!os::CommitMemory(memory, poolSize, false))
+	{
+		os::ReleaseMemory(memory, poolSize);
+		return false;
+	}
+
+	Pool* pool = (Pool*)memory;
+	pool->prev = nullptr;
+	pool->next = m_pools;
+	pool->size = poolSize;
+	if (m_pools != nullptr)
+		m_pools->prev = pool;
+	m_pools = pool;
+
+	Block* block = (Block*)((u8*)memory + sizeof(Pool));
+	block->prevPhys = nullptr;
+	block->size = (poolSize - overhead) | HEAP_FREE_BIT;
+
+	Block* sentinel = (Block*)((u8*)memory + poolSize - HEAP_BLOCK_HEADER_SIZE);
+	sentinel->prevPhys = block;
+	sentinel->size = 0;
+
+	InsertFreeBlock(block);
+	return true;
 }
 
+void HeapAllocator::ReleasePool(Pool* pool)
+{
+	if (pool->prev != nullptr)
+		pool->prev->next = pool->next;
+	else
+		m_pools = pool->next;
+	if (pool->next != nullptr)
+		pool->next->prev = pool->prev;
 
-#if DEBUG_ALLOCATORS
+	os::ReleaseMemory(pool, pool->size);
+}
 
-void ProxyAllocator::SetDebugName(const char* name) { m_name = name; }
-const char* ProxyAllocator::GetDebugName() const { return m_name; }
 
-size_t ProxyAllocator::GetAllocCount() const { return m_allocCount; }
-size_t ProxyAllocator::GetAllocSize() const { return m_allocSize; }
+#if DEBUG_ALLOCATORS
+
+void HeapAllocator::SetDebugName(const char* name) { m_name = name; }
+const char* HeapAllocator::GetDebugName() const { return m_name; }
 
-size_t ProxyAllocator::GetAllocationsSize() const { return m_allocations.GetSize(); }
-AllocationDebugData const* ProxyAllocator::GetAllocations() const { return m_allocations.Begin(); }
-size_t ProxyAllocator::GetBlocksSize() const { return m_pages.GetSize(); }
-void* const* ProxyAllocator::GetBlocks() const { return m_pages.GetKeys(); }
-size_t ProxyAllocator::GetBlockSize() const { return GetAllocInfo().pageSize; }
+size_t HeapAllocator::GetAllocCount() const { return m_allocCount; }
+size_t HeapAllocator::GetAllocSize() const { return m_allocSize; }
 
+size_t HeapAllocator::GetAllocationsSize() const { return 0; }
+AllocationDebugData const* HeapAllocator::GetAllocations() const { return nullptr; }
+size_t HeapAllocator::GetBlocksSize() const { return 0; }
+void* const* HeapAllocator::GetBlocks() const { return nullptr; }
+size_t HeapAllocator::GetBlockSize() const { return 0; }
 
 #endif
 
 
-// ---------------- FRAME ALLOCATOR ----------------
+// ---------------- MAIN ALLOCATOR ----------------
 
 
-/*FrameAllocator::FrameAllocator(Allocator& allocator)
-	: m_source(allocator)
+MainAllocator::MainAllocator()
 {
 #if DEBUG_ALLOCATORS
+	s_allocators.Reserve(MAX_ALLOCATORS);
 	AllocatorDebugData data;
-	data.parent = &allocator;
+	data.parent = &m_heap;
 	data.allocator = this;
 	s_allocators.PushBack(data);
 #endif
 }
 
-FrameAllocator::~FrameAllocator()
+MainAllocator::~MainAllocator()
 {
+	for (ThreadCache& cache : m_caches)
+	{
+		for (size_t i = 0; i < CACHE_CLASS_COUNT; ++i)
+			Flush(cache, i, cache.counts[i]);
+	}
+
 #if DEBUG_ALLOCATORS
-	ASSERT2(m_allocCount == 0, "Memory leak");
-	ASSERT2(m_allocSize == 0, "Memory leak");
+	ASSERT2(GetAllocCount() == 0, "Memory leak");
+	ASSERT2(GetAllocSize() == 0, "Memory leak");
 
 	AllocatorDebugData data;
 	data.allocator = this;
@@ -419,54 +617,1449 @@ FrameAllocator::~FrameAllocator()
 #endif
 }
 
+void* MainAllocator::Allocate(size_t size, size_t alignment)
+{
+	void* data;
+	if (size <= CACHE_MAX_SIZE && alignment <= ((size_t)1 << CACHE_CLASS_SHIFT))
+	{
+		//class of n holds blocks with at least (n + 1) << CACHE_CLASS_SHIFT bytes
+		const size_t sizeClass = (size == 0) ? 0 : (size - 1) >> CACHE_CLASS_SHIFT;
+		ThreadCache& cache = m_caches[GetThreadIndex()];
+		if (cache.blocks[sizeClass] == nullptr)
+		{
+			Refill(cache, sizeClass);
+			if (cache.blocks[sizeClass] == nullptr)
+				return nullptr;
+		}
+		CachedBlock* block = cache.blocks[sizeClass];
+		cache.blocks[sizeClass] = block->next;
+		cache.counts[sizeClass]--;
+		data = block;
+	}
+	else
+	{
+		data = m_heap.Allocate(size, alignment);
+		if (data == nullptr)
+			return nullptr;
+	}
 
-void* FrameAllocator::Allocate(size_t size, size_t alignment)
-{}
+#if DEBUG_ALLOCATORS
+	ThreadAllocCounters& counters = m_counters[GetThreadIndex()];
+	counters.allocCount++;
+	counters.allocSize += m_heap.GetSize(data);
+#endif
 
-void* FrameAllocator::Reallocate(void* ptr, size_t size, size_t alignment)
-{}
+	return data;
+}
 
-void FrameAllocator::Deallocate(void* ptr)
-{}
+void* MainAllocator::Reallocate(void* ptr, size_t size, size_t alignment)
+{
+	if (ptr == nullptr)
+		return Allocate(size, alignment);
 
-size_t FrameAllocator::GetSize(void* ptr) const
-{}
+#if DEBUG_ALLOCATORS
+	const size_t oldSize = m_heap.GetSize(ptr);
+#endif
 
-void FrameAllocator::NewFrame()
-{}
+	void* data = m_heap.Reallocate(ptr, size, alignment);
+
+#if DEBUG_ALLOCATORS
+	if (data != nullptr)
+	{
+		ThreadAllocCounters& counters = m_counters[GetThreadIndex()];
+		counters.allocSize -= oldSize;
+		counters.allocSize += m_heap.GetSize(data);
+	}
+#endif
+
+	return data;
+}
+
+void MainAllocator::Deallocate(void* ptr)
+{
+	ASSERT(ptr != nullptr);
+
+	const size_t size = m_heap.GetSize(ptr);
+
+#if DEBUG_ALLOCATORS
+	ThreadAllocCounters& counters = m_counters[GetThreadIndex()];
+	counters.allocCount--;
+	counters.allocSize -= size;
+#endif
+
+	if (size > CACHE_MAX_SIZE)
+	{
+		m_heap.Deallocate(ptr);
+		return;
+	}
+
+	//block may be bigger than size of class it was allocated from, it's cached in biggest class it fits
+	const size_t sizeClass = (size >> CACHE_CLASS_SHIFT) - 1;
+	ThreadCache& cache = m_caches[GetThreadIndex()];
+	CachedBlock* block = static_cast<CachedBlock*>(ptr);
+	block->next = cache.blocks[sizeClass];
+	cache.blocks[sizeClass] = block;
+	if (++cache.counts[sizeClass] > 2 * CACHE_BATCH)
+		Flush(cache, sizeClass, CACHE_BATCH);
+}
+
+size_t MainAllocator::GetSize(void* ptr) const
+{
+	return m_heap.GetSize(ptr);
+}
+
+bool MainAllocator::TryExpand(void* ptr, size_t size)
+{
+	//cached blocks are returned to class matching their size, so expanded block needs no special care
+#if DEBUG_ALLOCATORS
+	const size_t oldSize = m_heap.GetSize(ptr);
+#endif
+
+	if (!m_heap.TryExpand(ptr, size))
+		return false;
+
+#if DEBUG_ALLOCATORS
+	ThreadAllocCounters& counters = m_counters[GetThreadIndex()];
+	counters.allocSize -= oldSize;
+	counters.allocSize += m_heap.GetSize(ptr);
+#endif
+	return true;
+}
+
+
+void MainAllocator::FlushThreadCache()
+{
+	ThreadCache& cache = m_caches[GetThreadIndex()];
+	for (size_t i = 0; i < CACHE_CLASS_COUNT; ++i)
+		Flush(cache, i, cache.counts[i]);
+}
+
+
+void MainAllocator::Refill(ThreadCache& cache, size_t sizeClass)
+{
+	void* ptrs[CACHE_BATCH];
+	const size_t count = m_heap.AllocateBatch((sizeClass + 1) << CACHE_CLASS_SHIFT, ptrs, CACHE_BATCH);
+	for (size_t i = 0; i < count; ++i)
+	{
+		CachedBlock* block = static_cast<CachedBlock*>(ptrs[i]);
+		block->next = cache.blocks[sizeClass];
+		cache.blocks[sizeClass] = block;
+	}
+	cache.counts[sizeClass] += (u32)count;
+}
+
+void MainAllocator::Flush(ThreadCache& cache, size_t sizeClass, size_t count)
+{
+	void* ptrs[CACHE_BATCH];
+	while (count > 0)
+	{
+		const size_t batch = Min(count, CACHE_BATCH);
+		for (size_t i = 0; i < batch; ++i)
+		{
+			ptrs[i] = cache.blocks[sizeClass];
+			cache.blocks[sizeClass] = cache.blocks[sizeClass]->next;
+		}
+		cache.counts[sizeClass] -= (u32)batch;
+		m_heap.DeallocateBatch(ptrs, batch);
+		count -= batch;
+	}
+}
+
+
+#if DEBUG_ALLOCATORS
+
+size_t MainAllocator::GetAllocCount() const
+{
+	return SumAllocCount(m_counters);
+}
+
+size_t MainAllocator::GetAllocSize() const
+{
+	return SumAllocSize(m_counters);
+}
+
+#endif
+
+
+// ---------------- PROXY ALLOCATOR ----------------
+
+
+#if DEBUG_ALLOCATORS
+
+static size_t HashPointer(const void* ptr)
+{
+	u64 h = (u64)(uintptr)ptr >> 4;
+	h *= 0x9E3779B97F4A7C15ull;
+	return (size_t)(h ^ (h >> 32));
+}
+
+static u32 HashCallstack(void* const* frames)
+{
+	u64 h = 0xcbf29ce484222325ull;
+	for (size_t i = 0; i < AllocationDebugData::CALLSTACK_SIZE; ++i)
+	{
+		h ^= (u64)(uintptr)frames[i];
+		h *= 0x100000001b3ull;
+	}
+	return (u32)(h ^ (h >> 32));
+}
+
+
+#endif
+
+
+ProxyAllocator::ProxyAllocator(Allocator& allocator)
+	: m_source(allocator)
+#if DEBUG_ALLOCATORS
+	, m_callstacks(allocator)
+	, m_view(allocator)
+	, m_viewPages(allocator)
+#endif
+{
+	RegisterStats(this);
+
+#if DEBUG_ALLOCATORS
+	AllocatorDebugData data;
+	data.parent = &allocator;
+	data.allocator = this;
+	s_allocators.PushBack(data);
+#endif
+}
+
+ProxyAllocator::~ProxyAllocator()
+{
+	UnregisterStats(this);
+
+#if DEBUG_ALLOCATORS
+	ASSERT2(m_liveCount == 0, "Memory leak");
+
+	ASSERT2(GetAllocCount() == 0, "Memory leak");
+	ASSERT2(GetAllocSize() == 0, "Memory leak");
+
+	if (m_live != nullptr)
+		m_source.Deallocate(m_live);
+	if (m_callstackIndex != nullptr)
+		m_source.Deallocate(m_callstackIndex);
+
+	AllocatorDebugData data;
+	data.allocator = this;
+	s_allocators.Erase(data);
+#endif
+}
+
+void* ProxyAllocator::Allocate(size_t size, size_t alignment)
+{
+	void* data = m_source.Allocate(size, alignment);
+	if (data == nullptr)
+		return nullptr;
+
+	m_stats.OnAllocate(m_source.GetSize(data));
+
+#if DEBUG_ALLOCATORS
+	//callstack is captured outside of lock, it's the most expensive part
+	const bool sampled = Sample(size);
+	void* frames[AllocationDebugData::CALLSTACK_SIZE] = { 0 };
+	if (sampled)
+		os::GetCallStack(0, AllocationDebugData::CALLSTACK_SIZE, frames);
+
+	ScopeLock<Mutex> lock(m_lock);
+	AddLive(data, sampled ? AddCallstack(frames) : NO_CALLSTACK);
+#endif
+	return data;
+}
+
+void* ProxyAllocator::Reallocate(void* ptr, size_t size, size_t alignment)
+{
+	if (ptr == nullptr)
+		return Allocate(size, alignment);
+
+	const size_t oldSize = m_source.GetSize(ptr);
+
+#if DEBUG_ALLOCATORS
+	//record has to be removed before memory is released, other thread could get the same address
+	u32 callstack;
+	{
+		ScopeLock<Mutex> lock(m_lock);
+		callstack = RemoveLive(ptr);
+	}
+#endif
+
+	void* data = m_source.Reallocate(ptr, size, alignment);
+	if (data != nullptr)
+	{
+		m_stats.OnDeallocate(oldSize);
+		m_stats.OnAllocate(m_source.GetSize(data));
+	}
+
+#if DEBUG_ALLOCATORS
+	ScopeLock<Mutex> lock(m_lock);
+	AddLive((data != nullptr) ? data : ptr, callstack);
+#endif
+	return data;
+}
+
+void ProxyAllocator::Deallocate(void* ptr)
+{
+	ASSERT(ptr != nullptr);
+
+	m_stats.OnDeallocate(m_source.GetSize(ptr));
+
+#if DEBUG_ALLOCATORS
+	{
+		ScopeLock<Mutex> lock(m_lock);
+		RemoveLive(ptr);
+	}
+#endif
+
+	m_source.Deallocate(ptr);
+}
+
+size_t ProxyAllocator::GetSize(void* ptr) const
+{
+	return m_source.GetSize(ptr);
+}
+
+bool ProxyAllocator::TryExpand(void* ptr, size_t size)
+{
+	const size_t oldSize = m_source.GetSize(ptr);
+	if (!m_source.TryExpand(ptr, size))
+		return false;
+
+	m_stats.OnResize(oldSize, m_source.GetSize(ptr));
+	return true;
+}
+
+
+void ProxyAllocator::SetDebugName(const char* name) { m_name = name; }
+const char* ProxyAllocator::GetDebugName() const { return m_name; }
+
+
+#if DEBUG_ALLOCATORS
+
+void ProxyAllocator::SetSampling(u32 allocationInterval, size_t byteInterval)
+{
+	m_allocationInterval = allocationInterval;
+	m_byteInterval = byteInterval;
+}
+
+
+bool ProxyAllocator::Sample(size_t size)
+{
+	ThreadSampler& sampler = m_samplers[GetThreadIndex()];
+	bool sampled = false;
+	if (m_allocationInterval != 0 && ++sampler.allocations >= m_allocationInterval)
+	{
+		sampler.allocations = 0;
+		sampled = true;
+	}
+	if (m_byteInterval != 0)
+	{
+		sampler.bytes += size;
+		if (sampler.bytes >= m_byteInterval)
+		{
+			sampler.bytes %= m_byteInterval;
+			sampled = true;
+		}
+	}
+	return sampled;
+}
+
+u32 ProxyAllocator::AddCallstack(void* const* frames)
+{
+	const u32 hash = HashCallstack(frames);
+
+	if ((m_callstacks.GetSize() + 1) * 2 > m_callstackIndexCapacity)
+	{
+		const size_t capacity = (m_callstackIndexCapacity == 0) ? 256 : m_callstackIndexCapacity * 2;
+		u32* index = static_cast<u32*>(m_source.Allocate(capacity * sizeof(u32), alignof(u32)));
+		memory::Set(index, 0, capacity * sizeof(u32));
+		for (size_t i = 0; i < m_callstacks.GetSize(); ++i)
+		{
+			size_t slot = m_callstacks[i].hash & (capacity - 1);
+			while (index[slot] != 0)
+				slot = (slot + 1) & (capacity - 1);
+			index[slot] = (u32)i + 1;
+		}
+		if (m_callstackIndex != nullptr)
+			m_source.Deallocate(m_callstackIndex);
+		m_callstackIndex = index;
+		m_callstackIndexCapacity = capacity;
+	}
+
+	const size_t mask = m_callstackIndexCapacity - 1;
+	size_t slot = hash & mask;
+	while (m_callstackIndex[slot] != 0)
+	{
+		const Callstack& callstack = m_callstacks[m_callstackIndex[slot] - 1];
+		if (callstack.hash == hash && memory::Compare(callstack.frames, frames, sizeof(callstack.frames)) == 0)
+			return m_callstackIndex[slot] - 1;
+		slot = (slot + 1) & mask;
+	}
+
+	Callstack& callstack = m_callstacks.PushBack();
+	memory::Copy(callstack.frames, frames, sizeof(callstack.frames));
+	callstack.hash = hash;
+	m_callstackIndex[slot] = (u32)m_callstacks.GetSize();
+	return (u32)m_callstacks.GetSize() - 1;
+}
+
+void ProxyAllocator::AddLive(void* ptr, u32 callstack)
+{
+	if ((m_liveCount + 1) * 4 > m_liveCapacity * 3)
+	{
+		const size_t capacity = (m_liveCapacity == 0) ? 1024 : m_liveCapacity * 2;
+		LiveAllocation* live = static_cast<LiveAllocation*>(m_source.Allocate(capacity * sizeof(LiveAllocation), alignof(LiveAllocation)));
+		memory::Set(live, 0, capacity * sizeof(LiveAllocation));
+		for (size_t i = 0; i < m_liveCapacity; ++i)
+		{
+			if (m_live[i].allocation == nullptr)
+				continue;
+			size_t slot = HashPointer(m_live[i].allocation) & (capacity - 1);
+			while (live[slot].allocation != nullptr)
+				slot = (slot + 1) & (capacity - 1);
+			live[slot] = m_live[i];
+		}
+		if (m_live != nullptr)
+			m_source.Deallocate(m_live);
+		m_live = live;
+		m_liveCapacity = capacity;
+	}
+
+	const size_t mask = m_liveCapacity - 1;
+	size_t slot = HashPointer(ptr) & mask;
+	while (m_live[slot].allocation != nullptr)
+	{
+		ASSERT2(m_live[slot].allocation != ptr, "Allocation is already tracked");
+		slot = (slot + 1) & mask;
+	}
+	m_live[slot].allocation = ptr;
+	m_live[slot].callstack = callstack;
+	m_liveCount++;
+}
+
+u32 ProxyAllocator::RemoveLive(void* ptr)
+{
+	ASSERT2(m_liveCapacity > 0, "Allocation is not tracked");
+
+	const size_t mask = m_liveCapacity - 1;
+	size_t slot = HashPointer(ptr) & mask;
+	while (m_live[slot].allocation != ptr)
+	{
+		ASSERT2(m_live[slot].allocation != nullptr, "Allocation is not tracked");
+		slot = (slot + 1) & mask;
+	}
+	const u32 callstack = m_live[slot].callstack;
+	m_liveCount--;
+
+	//backward shift deletion, keeps probe sequences intact without tombstones
+	size_t next = slot;
+	for (;;)
+	{
+		next = (next + 1) & mask;
+		if (m_live[next].allocation == nullptr)
+			break;
+		const size_t home = HashPointer(m_live[next].allocation) & mask;
+		if (((next - home) & mask) >= ((next - slot) & mask))
+		{
+			m_live[slot] = m_live[next];
+			slot = next;
+		}
+	}
+	m_live[slot].allocation = nullptr;
+	return callstack;
+}
+
+
+size_t ProxyAllocator::GetAllocCount() const { return (size_t)m_stats.GetSummary().allocCount; }
+size_t ProxyAllocator::GetAllocSize() const { return (size_t)m_stats.GetSummary().allocSize; }
+
+size_t ProxyAllocator::GetAllocationsSize() const { return m_view.GetSize(); }
+AllocationDebugData const* ProxyAllocator::GetAllocations() const { return m_view.Begin(); }
+size_t ProxyAllocator::GetBlocksSize() const { return m_viewPages.GetSize(); }
+void* const* ProxyAllocator::GetBlocks() const { return m_viewPages.Begin(); }
+size_t ProxyAllocator::GetBlockSize() const { return GetAllocInfo().pageSize; }
+
+void ProxyAllocator::UpdateDebugView() const
+{
+	m_view.Clear();
+	{
+		ScopeLock<Mutex> lock(m_lock);
+
+		m_view.Reserve(m_liveCount);
+		for (size_t i = 0; i < m_liveCapacity; ++i)
+		{
+			const LiveAllocation& live = m_live[i];
+			if (live.allocation == nullptr)
+				continue;
+
+			AllocationDebugData& allocData = m_view.PushBack();
+			allocData.allocation = live.allocation;
+			if (live.callstack != NO_CALLSTACK)
+				memory::Copy(allocData.callstack, m_callstacks[live.callstack].frames, sizeof(allocData.callstack));
+		}
+	}
+
+	//in place, snapshot must not need extra memory
+	Sort(m_view.Begin(), m_view.End());
+
+	const uintptr pageMask = ~(uintptr)(GetAllocInfo().pageSize - 1);
+	m_viewPages.Clear();
+	for (const AllocationDebugData& allocData : m_view)
+	{
+		void* page = (void*)((uintptr)allocData.allocation & pageMask);
+		if (m_viewPages.GetSize() == 0 || m_viewPages[m_viewPages.GetSize() - 1] != page)
+			m_viewPages.PushBack(page);
+	}
+}
+
+#endif
+
+
+// ---------------- FRAME ALLOCATOR ----------------
+
+
+FrameAllocator::FrameAllocator(Allocator& allocator)
+	: m_source(allocator)
+#if DEBUG_ALLOCATORS
+	, m_blocks(allocator)
+#endif
+{
+#if DEBUG_ALLOCATORS
+	AllocatorDebugData data;
+	data.parent = &allocator;
+	data.allocator = this;
+	s_allocators.PushBack(data);
+#endif
+}
+
+FrameAllocator::~FrameAllocator()
+{
+	for (ThreadArena& arena : m_arenas)
+	{
+		Block* block = arena.first;
+		while (block != nullptr)
+		{
+			Block* next = block->next;
+			m_source.Deallocate(block);
+			block = next;
+		}
+	}
+
+#if DEBUG_ALLOCATORS
+	AllocatorDebugData data;
+	data.allocator = this;
+	s_allocators.Erase(data);
+#endif
+}
+
+
+void* FrameAllocator::Reallocate(void* ptr, size_t size, size_t alignment)
+{
+	if (ptr == nullptr)
+		return Allocate(size, alignment);
+
+	if ((uintptr)ptr % alignment == 0 && TryExpand(ptr, size))
+		return ptr;
+
+	void* data = Allocate(size, alignment);
+	memory::Copy(data, ptr, Min(size, GetSize(ptr)));
+	return data;
+}
+
+void FrameAllocator::NewFrame()
+{
+	size_t frameSize = 0;
+	size_t frameCount = 0;
+	for (ThreadArena& arena : m_arenas)
+	{
+		frameSize += arena.frameSize;
+		frameCount += arena.frameCount;
+
+		arena.current = arena.first;
+		arena.ptr = (arena.first != nullptr) ? (u8*)(arena.first + 1) : nullptr;
+		arena.end = (arena.first != nullptr) ? (u8*)arena.first + arena.first->size : nullptr;
+		arena.frameSize = 0;
+		arena.frameCount = 0;
+	}
+
+#if DEBUG_ALLOCATORS
+	m_allocCount = frameCount;
+	m_allocSize = frameSize;
+#endif
+}
+
+
+void* FrameAllocator::NextBlock(ThreadArena& arena, size_t size, size_t alignment)
+{
+	const size_t requiredSize = sizeof(Block) + sizeof(size_t) + alignment + size;
+
+	Block* block = (arena.current != nullptr) ? arena.current->next : arena.first;
+	if (block == nullptr || block->size < requiredSize)
+	{
+		const size_t blockSize = Max(BLOCK_SIZE, requiredSize);
+		Block* newBlock = static_cast<Block*>(m_source.Allocate(blockSize, alignof(Block)));
+		newBlock->size = blockSize;
+		newBlock->next = block;
+
+		if (arena.current != nullptr)
+			arena.current->next = newBlock;
+		else
+			arena.first = newBlock;
+		block = newBlock;
+
+#if DEBUG_ALLOCATORS
+		ScopeLock<Mutex> lock(m_lock);
+		m_blocks.PushBack(newBlock);
+#endif
+	}
+
+	arena.current = block;
+	arena.ptr = (u8*)(block + 1);
+	arena.end = (u8*)block + block->size;
+	return AlignPointer(arena.ptr + sizeof(size_t), Max(alignment, alignof(size_t)));
+}
+
+
+#if DEBUG_ALLOCATORS
+
+void FrameAllocator::SetDebugName(const char* name) { m_name = name; }
+const char* FrameAllocator::GetDebugName() const { return m_name; }
+
+size_t FrameAllocator::GetAllocCount() const { return m_allocCount; }
+size_t FrameAllocator::GetAllocSize() const { return m_allocSize; }
+
+size_t FrameAllocator::GetAllocationsSize() const { return 0; }
+AllocationDebugData const* FrameAllocator::GetAllocations() const { return nullptr; }
+size_t FrameAllocator::GetBlocksSize() const { return m_blocks.GetSize(); }
+void* const* FrameAllocator::GetBlocks() const { return m_blocks.Begin(); }
+size_t FrameAllocator::GetBlockSize() const { return BLOCK_SIZE; }
+
+#endif
+
+
+// ---------------- POOL ALLOCATOR ----------------
+
+
+PoolAllocator::PoolAllocator(Allocator& allocator, size_t reserveSize)
+	: m_source(allocator)
+	, m_chunkPages(reserveSize)
+	, m_chunks(allocator)
+	, m_chunkUsedSlabs(allocator)
+{
+#if DEBUG_ALLOCATORS
+	m_chunkPages.SetDebugName("Pool chunks");
+
+	AllocatorDebugData data;
+	data.parent = &allocator;
+	data.allocator = this;
+	s_allocators.PushBack(data);
+#endif
+}
+
+PoolAllocator::~PoolAllocator()
+{
+#if DEBUG_ALLOCATORS
+	ASSERT2(GetAllocCount() == 0, "Memory leak");
+	ASSERT2(GetAllocSize() == 0, "Memory leak");
+
+	AllocatorDebugData data;
+	data.allocator = this;
+	s_allocators.Erase(data);
+#endif
+
+	for (void* chunk : m_chunks)
+		m_chunkPages.Deallocate(chunk);
+}
+
+
+void* PoolAllocator::Allocate(size_t size, size_t alignment)
+{
+	const size_t blockSize = Max(size, alignment);
+	if (blockSize > ((size_t)1 << MAX_SIZE_SHIFT))
+	{
+		void* data = m_source.Allocate(size, alignment);
+#if DEBUG_ALLOCATORS
+		ScopeLock<Mutex> lock(m_lock);
+		m_allocCount++;
+		m_allocSize += m_source.GetSize(data);
+#endif
+		return data;
+	}
+
+	const size_t sizeClass = GetSizeClass(blockSize);
+	const size_t classSize = (size_t)1 << (sizeClass + MIN_SIZE_SHIFT);
+
+	SizeClass& sc = m_classes[sizeClass];
+	ScopeLock<Mutex> lock(sc.lock);
+
+	if (sc.slabs == nullptr)
+		AddSlab(sizeClass);
+
+	Slab* slab = sc.slabs;
+	void* data;
+	if (slab->freeList != nullptr)
+	{
+		data = slab->freeList;
+		slab->freeList = slab->freeList->next;
+	}
+	else
+	{
+		data = slab->slabPtr;
+		slab->slabPtr += classSize;
+	}
+	slab->allocCount++;
+	if (IsFull(slab))
+		UnlinkSlab(sc.slabs, slab);
+
+#if DEBUG_ALLOCATORS
+	sc.allocCount++;
+#endif
+	return data;
+}
+
+void* PoolAllocator::Reallocate(void* ptr, size_t size, size_t alignment)
+{
+	if (ptr == nullptr)
+		return Allocate(size, alignment);
+
+	const size_t blockSize = Max(size, alignment);
+	size_t oldSize;
+	const Slab* slab = FindSlab(ptr);
+	if (slab != nullptr)
+	{
+		if (blockSize <= ((size_t)1 << MAX_SIZE_SHIFT) && GetSizeClass(blockSize) == slab->sizeClass)
+			return ptr;
+		oldSize = (size_t)1 << (slab->sizeClass + MIN_SIZE_SHIFT);
+	}
+	else
+	{
+		oldSize = m_source.GetSize(ptr);
+	}
+
+	if (oldSize > ((size_t)1 << MAX_SIZE_SHIFT) && blockSize > ((size_t)1 << MAX_SIZE_SHIFT))
+	{
+		void* data = m_source.Reallocate(ptr, size, alignment);
+#if DEBUG_ALLOCATORS
+		ScopeLock<Mutex> lock(m_lock);
+		m_allocSize -= oldSize;
+		m_allocSize += m_source.GetSize(data);
+#endif
+		return data;
+	}
+
+	void* data = Allocate(size, alignment);
+	memory::Copy(data, ptr, Min(size, oldSize));
+	Deallocate(ptr);
+	return data;
+}
+
+void PoolAllocator::Deallocate(void* ptr)
+{
+	ASSERT(ptr != nullptr);
+
+	Slab* slab = FindSlab(ptr);
+	if (slab != nullptr)
+	{
+		SizeClass& sc = m_classes[slab->sizeClass];
+		ScopeLock<Mutex> lock(sc.lock);
+
+		const bool wasFull = IsFull(slab);
+		FreeNode* node = static_cast<FreeNode*>(ptr);
+		node->next = slab->freeList;
+		slab->freeList = node;
+		slab->allocCount--;
+
+#if DEBUG_ALLOCATORS
+		sc.allocCount--;
+#endif
+
+		if (wasFull)
+			LinkSlab(sc.slabs, slab);
+		//last slab of class is kept, so single block allocated and freed over and over doesn't move slabs
+		if (slab->allocCount == 0 && (sc.slabs != slab || slab->next != nullptr))
+		{
+			UnlinkSlab(sc.slabs, slab);
+			ReleaseSlab(slab);
+		}
+		return;
+	}
+
+#if DEBUG_ALLOCATORS
+	{
+		ScopeLock<Mutex> lock(m_lock);
+		m_allocCount--;
+		m_allocSize -= m_source.GetSize(ptr);
+	}
+#endif
+
+	m_source.Deallocate(ptr);
+}
+
+size_t PoolAllocator::GetSize(void* ptr) const
+{
+	const Slab* slab = FindSlab(ptr);
+	if (slab != nullptr)
+		return (size_t)1 << (slab->sizeClass + MIN_SIZE_SHIFT);
+	return m_source.GetSize(ptr);
+}
+
+bool PoolAllocator::TryExpand(void* ptr, size_t size)
+{
+	//pooled block can only grow to size of its class
+	const Slab* slab = FindSlab(ptr);
+	if (slab != nullptr)
+		return size <= ((size_t)1 << (slab->sizeClass + MIN_SIZE_SHIFT));
+
+#if DEBUG_ALLOCATORS
+	const size_t oldSize = m_source.GetSize(ptr);
+#endif
+	if (!m_source.TryExpand(ptr, size))
+		return false;
+
+#if DEBUG_ALLOCATORS
+	ScopeLock<Mutex> lock(m_lock);
+	m_allocSize -= oldSize;
+	m_allocSize += m_source.GetSize(ptr);
+#endif
+	return true;
+}
+
+
+size_t PoolAllocator::GetSizeClass(size_t size)
+{
+	size_t sizeClass = 0;
+	size_t classSize = (size_t)1 << MIN_SIZE_SHIFT;
+	while (classSize < size)
+	{
+		classSize <<= 1;
+		sizeClass++;
+	}
+	return sizeClass;
+}
+
+//block size divides SLAB_SIZE, so slab is full exactly when it has no free block and no space left after slabPtr
+bool PoolAllocator::IsFull(const Slab* slab)
+{
+	return slab->freeList == nullptr && slab->slabPtr == (const u8*)slab + SLAB_SIZE;
+}
+
+void PoolAllocator::LinkSlab(Slab*& list, Slab* slab)
+{
+	slab->prev = nullptr;
+	slab->next = list;
+	if (list != nullptr)
+		list->prev = slab;
+	list = slab;
+}
+
+void PoolAllocator::UnlinkSlab(Slab*& list, Slab* slab)
+{
+	if (slab->prev != nullptr)
+		slab->prev->next = slab->next;
+	else
+		list = slab->next;
+	if (slab->next != nullptr)
+		slab->next->prev = slab->prev;
+}
+
+//only chunks live in reserved range and they are SLAB_SIZE aligned
+PoolAllocator::Slab* PoolAllocator::FindSlab(void* ptr) const
+{
+	if (!m_chunkPages.Owns(ptr))
+		return nullptr;
+	return (Slab*)((uintptr)ptr & ~(uintptr)(SLAB_SIZE - 1));
+}
+
+void PoolAllocator::AddSlab(size_t sizeClass)
+{
+	Slab* slab;
+	{
+		ScopeLock<Mutex> lock(m_lock);
+		if (m_unusedSlabs == nullptr)
+			AddChunk();
+
+		slab = m_unusedSlabs;
+		UnlinkSlab(m_unusedSlabs, slab);
+		m_unusedSlabCount--;
+		m_chunkUsedSlabs[slab->chunk]++;
+	}
+
+	//header takes as many blocks as it needs, rest of slab is whole blocks
+	const size_t classSize = (size_t)1 << (sizeClass + MIN_SIZE_SHIFT);
+	slab->freeList = nullptr;
+	slab->slabPtr = (u8*)slab + ((sizeof(Slab) + classSize - 1) & ~(classSize - 1));
+	slab->sizeClass = (u32)sizeClass;
+	slab->allocCount = 0;
+
+	LinkSlab(m_classes[sizeClass].slabs, slab);
+}
+
+void PoolAllocator::ReleaseSlab(Slab* slab)
+{
+	ScopeLock<Mutex> lock(m_lock);
+	LinkSlab(m_unusedSlabs, slab);
+	m_unusedSlabCount++;
+
+	//empty chunk is kept while it's the only one with unused slabs
+	const u32 chunk = slab->chunk;
+	if (--m_chunkUsedSlabs[chunk] == 0 && m_unusedSlabCount > SLABS_PER_CHUNK)
+		ReleaseChunk(chunk);
+}
+
+void PoolAllocator::AddChunk()
+{
+	void* chunk = m_chunkPages.Allocate(CHUNK_SIZE, SLAB_SIZE);
+	ASSERT2(chunk != nullptr, "Pool reserve is exhausted");
+	const u32 index = (u32)m_chunks.GetSize();
+	m_chunks.PushBack(chunk);
+	m_chunkUsedSlabs.PushBack(0);
+
+	for (size_t i = 0; i < SLABS_PER_CHUNK; ++i)
+	{
+		Slab* slab = (Slab*)((u8*)chunk + i * SLAB_SIZE);
+		slab->chunk = index;
+		LinkSlab(m_unusedSlabs, slab);
+	}
+	m_unusedSlabCount += SLABS_PER_CHUNK;
+}
+
+//last chunk takes place of released one, its slabs learn new index
+void PoolAllocator::ReleaseChunk(size_t index)
+{
+	u8* slabs = static_cast<u8*>(m_chunks[index]);
+	for (size_t i = 0; i < SLABS_PER_CHUNK; ++i)
+		UnlinkSlab(m_unusedSlabs, (Slab*)(slabs + i * SLAB_SIZE));
+	m_unusedSlabCount -= SLABS_PER_CHUNK;
+
+	m_chunkPages.Deallocate(m_chunks[index]);
+	m_chunks.Erase(index);
+	m_chunkUsedSlabs.Erase(index);
+
+	if (index < m_chunks.GetSize())
+	{
+		u8* moved = static_cast<u8*>(m_chunks[index]);
+		for (size_t i = 0; i < SLABS_PER_CHUNK; ++i)
+			((Slab*)(moved + i * SLAB_SIZE))->chunk = (u32)index;
+	}
+}
 
 
 #if DEBUG_ALLOCATORS
 
-void FrameAllocator::SetDebugName(const char* name)
-{}
+void PoolAllocator::SetDebugName(const char* name) { m_name = name; }
+const char* PoolAllocator::GetDebugName() const { return m_name; }
 
-const char* FrameAllocator::GetDebugName() const
-{}
+size_t PoolAllocator::GetAllocCount() const
+{
+	size_t count = m_allocCount;
+	for (const SizeClass& sc : m_classes)
+		count += sc.allocCount;
+	return count;
+}
 
-size_t FrameAllocator::GetAllocCount() const
-{}
+size_t PoolAllocator::GetAllocSize() const
+{
+	size_t size = m_allocSize;
+	for (size_t i = 0; i < SIZE_CLASS_COUNT; ++i)
+		size += m_classes[i].allocCount << (i + MIN_SIZE_SHIFT);
+	return size;
+}
 
-size_t FrameAllocator::GetAllocSize() const
-{}
+size_t PoolAllocator::GetAllocationsSize() const { return 0; }
+AllocationDebugData const* PoolAllocator::GetAllocations() const { return nullptr; }
+size_t PoolAllocator::GetBlocksSize() const { return m_chunks.GetSize(); }
+void* const* PoolAllocator::GetBlocks() const { return m_chunks.Begin(); }
+size_t PoolAllocator::GetBlockSize() const { return CHUNK_SIZE; }
 
+#endif
 
-size_t FrameAllocator::GetAllocationsSize() const
-{}
 
-AllocationDebugData const* FrameAllocator::GetAllocations() const
-{}
+// ---------------- PAGE ALLOCATOR ----------------
 
-size_t FrameAllocator::GetBlocksSize() const
-{}
 
-void* const* FrameAllocator::GetBlocks() const
-{}
+PageAllocator::PageAllocator(size_t reserveSize, bool hugePages)
+	: m_hugePages(hugePages)
+{
+	const os::SystemInfo sysInfo = os::GetSystemInfo();
+	m_pageSize = sysInfo.pageSize;
+	const size_t granularity = Max((size_t)sysInfo.allocationGranularity, m_pageSize);
+	m_reserveSize = (reserveSize + granularity - 1) / granularity * granularity;
+
+	const size_t totalPages = m_reserveSize / m_pageSize;
+	const size_t tablePages = GetPageCount(totalPages * sizeof(u32));
+	ASSERT2(totalPages > tablePages, "Reserved size is too small");
+	m_pageCount = totalPages - tablePages;
+
+	m_memory = static_cast<u8*>(os::ReserveMemory(m_reserveSize));
+	ASSERT(m_memory != nullptr);
+	//freshly committed memory is zeroed, so all pages start as FREE_PAGE
+	os::CommitMemory(m_memory, tablePages * m_pageSize, false);
+	m_pageTable = (u32*)m_memory;
+	m_pages = m_memory + tablePages * m_pageSize;
+
+#if DEBUG_ALLOCATORS
+	AllocatorDebugData data;
+	data.allocator = this;
+	s_allocators.PushBack(data);
+#endif
+}
+
+PageAllocator::~PageAllocator()
+{
+#if DEBUG_ALLOCATORS
+	ASSERT2(m_allocCount == 0, "Memory leak");
+	ASSERT2(m_allocSize == 0, "Memory leak");
+
+	AllocatorDebugData data;
+	data.allocator = this;
+	s_allocators.Erase(data);
+#endif
+
+	os::ReleaseMemory(m_memory, m_reserveSize);
+}
+
+
+void* PageAllocator::Allocate(size_t size, size_t alignment)
+{
+	const size_t pageCount = GetPageCount(size);
+
+	ScopeLock<Mutex> lock(m_lock);
+
+	const size_t first = FindFreePages(pageCount, alignment);
+	if (first == m_pageCount)
+	{
+		ASSERT2(false, "Out of reserved memory");
+		return nullptr;
+	}
+
+	u8* data = m_pages + first * m_pageSize;
+	if (!os::CommitMemory(data, pageCount * m_pageSize, m_hugePages))
+		return nullptr;
+	MarkPages(first, pageCount);
+	if (first == m_firstFree)
+		m_firstFree = first + pageCount;
+
+#if DEBUG_ALLOCATORS
+	m_allocCount++;
+	m_allocSize += pageCount * m_pageSize;
+#endif
+	return data;
+}
+
+void* PageAllocator::Reallocate(void* ptr, size_t size, size_t alignment)
+{
+	if (ptr == nullptr)
+		return Allocate(size, alignment);
+
+	const size_t pageCount = GetPageCount(size);
+	const size_t first = GetPageIndex(ptr);
+	{
+		ScopeLock<Mutex> lock(m_lock);
+
+		const size_t oldCount = m_pageTable[first];
+		ASSERT2(oldCount != FREE_PAGE && oldCount != CONTINUATION_PAGE, "Pointer is not start of allocation");
+
+		if (pageCount <= oldCount)
+		{
+			const size_t tailCount = oldCount - pageCount;
+			if (tailCount > 0)
+			{
+				os::DecommitMemory(m_pages + (first + pageCount) * m_pageSize, tailCount * m_pageSize);
+				for (size_t i = first + pageCount; i < first + oldCount; ++i)
+					m_pageTable[i] = FREE_PAGE;
+				m_pageTable[first] = (u32)pageCount;
+				m_firstFree = Min(m_firstFree, first + pageCount);
+#if DEBUG_ALLOCATORS
+				m_allocSize -= tailCount * m_pageSize;
+#endif
+			}
+			return ptr;
+		}
+	}
+
+	if (((uintptr)ptr & (alignment - 1)) == 0 && TryExpand(ptr, size))
+		return ptr;
+
+	void* data = Allocate(size, alignment);
+	if (data == nullptr)
+		return nullptr;
+	memory::Copy(data, ptr, Min(size, GetSize(ptr)));
+	Deallocate(ptr);
+	return data;
+}
+
+void PageAllocator::Deallocate(void* ptr)
+{
+	ASSERT(ptr != nullptr);
+
+	const size_t first = GetPageIndex(ptr);
+
+	ScopeLock<Mutex> lock(m_lock);
+
+	const size_t pageCount = m_pageTable[first];
+	ASSERT2(pageCount != FREE_PAGE && pageCount != CONTINUATION_PAGE, "Pointer is not start of allocation");
+
+	os::DecommitMemory(ptr, pageCount * m_pageSize);
+	for (size_t i = first; i < first + pageCount; ++i)
+		m_pageTable[i] = FREE_PAGE;
+	m_firstFree = Min(m_firstFree, first);
+
+#if DEBUG_ALLOCATORS
+	m_allocCount--;
+	m_allocSize -= pageCount * m_pageSize;
+#endif
+}
+
+size_t PageAllocator::GetSize(void* ptr) const
+{
+	return m_pageTable[GetPageIndex(ptr)] * m_pageSize;
+}
+
+bool PageAllocator::TryExpand(void* ptr, size_t size)
+{
+	const size_t pageCount = GetPageCount(size);
+	const size_t first = GetPageIndex(ptr);
+
+	ScopeLock<Mutex> lock(m_lock);
+
+	const size_t oldCount = m_pageTable[first];
+	ASSERT2(oldCount != FREE_PAGE && oldCount != CONTINUATION_PAGE, "Pointer is not start of allocation");
+	if (pageCount <= oldCount)
+		return true;
+
+	const size_t growCount = pageCount - oldCount;
+	if (!ArePagesFree(first + oldCount, growCount))
+		return false;
+	if (!os::CommitMemory(m_pages + (first + oldCount) * m_pageSize, growCount * m_pageSize, m_hugePages))
+		return false;
+
+	MarkPages(first, pageCount);
+	if (m_firstFree >= first + oldCount && m_firstFree < first + pageCount)
+		m_firstFree = first + pageCount;
+#if DEBUG_ALLOCATORS
+	m_allocSize += growCount * m_pageSize;
+#endif
+	return true;
+}
+
+bool PageAllocator::Owns(void* ptr) const
+{
+	return ptr >= m_pages && ptr < m_pages + m_pageCount * m_pageSize;
+}
+
+
+size_t PageAllocator::GetPageIndex(void* ptr) const
+{
+	ASSERT2(Owns(ptr), "Pointer was not allocated by this allocator");
+	return ((u8*)ptr - m_pages) / m_pageSize;
+}
+
+size_t PageAllocator::GetPageCount(size_t size) const
+{
+	return Max((size + m_pageSize - 1) / m_pageSize, (size_t)1);
+}
+
+size_t PageAllocator::FindFreePages(size_t pageCount, size_t alignment) const
+{
+	size_t i = m_firstFree;
+	while (i + pageCount <= m_pageCount)
+	{
+		const u32 page = m_pageTable[i];
+		if (page != FREE_PAGE)
+		{
+			i += (page == CONTINUATION_PAGE) ? 1 : page;
+			continue;
+		}
+		if (((uintptr)(m_pages + i * m_pageSize) & (alignment - 1)) != 0)
+		{
+			++i;
+			continue;
+		}
+
+		size_t j = i + 1;
+		while (j < i + pageCount && m_pageTable[j] == FREE_PAGE)
+			++j;
+		if (j == i + pageCount)
+			return i;
+		i = j;
+	}
+	return m_pageCount;
+}
+
+bool PageAllocator::ArePagesFree(size_t first, size_t count) const
+{
+	if (first + count > m_pageCount)
+		return false;
+
+	for (size_t i = first; i < first + count; ++i)
+	{
+		if (m_pageTable[i] != FREE_PAGE)
+			return false;
+	}
+	return true;
+}
+
+void PageAllocator::MarkPages(size_t first, size_t count)
+{
+	m_pageTable[first] = (u32)count;
+	for (size_t i = first + 1; i < first + count; ++i)
+		m_pageTable[i] = CONTINUATION_PAGE;
+}
+
+
+#if DEBUG_ALLOCATORS
+
+void PageAllocator::SetDebugName(const char* name) { m_name = name; }
+const char* PageAllocator::GetDebugName() const { return m_name; }
+
+size_t PageAllocator::GetAllocCount() const { return m_allocCount; }
+size_t PageAllocator::GetAllocSize() const { return m_allocSize; }
+
+size_t PageAllocator::GetAllocationsSize() const { return 0; }
+AllocationDebugData const* PageAllocator::GetAllocations() const { return nullptr; }
+size_t PageAllocator::GetBlocksSize() const { return 1; }
+void* const* PageAllocator::GetBlocks() const { return (void* const*)&m_pages; }
+size_t PageAllocator::GetBlockSize() const { return m_pageCount * m_pageSize; }
+
+#endif
+
+
+// ---------------- TEMP ALLOCATOR ----------------
+
+
+TempAllocator::TempAllocator()
+{
+#if DEBUG_ALLOCATORS
+	s_allocators.Reserve(MAX_ALLOCATORS);
+	AllocatorDebugData data;
+	data.allocator = this;
+	s_allocators.PushBack(data);
+#endif
+}
+
+TempAllocator::~TempAllocator()
+{
+	for (ThreadArena& arena : m_arenas)
+	{
+		Block* block = arena.first;
+		while (block != nullptr)
+		{
+			Block* next = block->next;
+			os::ReleaseMemory(block, block->size);
+			block = next;
+		}
+	}
+
+#if DEBUG_ALLOCATORS
+	AllocatorDebugData data;
+	data.allocator = this;
+	s_allocators.Erase(data);
+#endif
+}
+
+
+void* TempAllocator::Allocate(size_t size, size_t alignment)
+{
+	ThreadArena& arena = m_arenas[GetThreadIndex()];
+
+	u8* data = (u8*)AlignPointer(arena.ptr + sizeof(size_t), Max(alignment, alignof(size_t)));
+	if (arena.ptr == nullptr || data + size > arena.end)
+	{
+		data = (u8*)NextBlock(arena, size, alignment);
+		if (data == nullptr)
+			return nullptr;
+	}
+
+	*((size_t*)data - 1) = size;
+	arena.ptr = data + size;
+
+#if DEBUG_ALLOCATORS
+	arena.allocCount++;
+	arena.allocSize += size;
+#endif
+	return data;
+}
+
+void* TempAllocator::Reallocate(void* ptr, size_t size, size_t alignment)
+{
+	if (ptr == nullptr)
+		return Allocate(size, alignment);
+
+	if ((uintptr)ptr % alignment == 0 && TryExpand(ptr, size))
+		return ptr;
+
+	void* data = Allocate(size, alignment);
+	if (data != nullptr)
+		memory::Copy(data, ptr, Min(size, GetSize(ptr)));
+	return data;
+}
+
+void TempAllocator::Deallocate(void* ptr)
+{
+	ASSERT(ptr != nullptr);
+
+	ThreadArena& arena = m_arenas[GetThreadIndex()];
+	size_t* header = (size_t*)ptr - 1;
+	if ((u8*)ptr + *header == arena.ptr)
+	{
+#if DEBUG_ALLOCATORS
+		arena.allocCount--;
+		arena.allocSize -= *header;
+#endif
+		arena.ptr = (u8*)header;
+	}
+}
+
+size_t TempAllocator::GetSize(void* ptr) const
+{
+	return *((size_t*)ptr - 1);
+}
+
+bool TempAllocator::TryExpand(void* ptr, size_t size)
+{
+	ThreadArena& arena = m_arenas[GetThreadIndex()];
+	size_t* header = (size_t*)ptr - 1;
+
+	//only last allocation of this thread can grow in place
+	if ((u8*)ptr + *header != arena.ptr || (u8*)ptr + size > arena.end)
+		return false;
+
+#if DEBUG_ALLOCATORS
+	arena.allocSize += (i64)size - (i64)*header;
+#endif
+	arena.ptr = (u8*)ptr + size;
+	*header = size;
+	return true;
+}
+
+
+TempAllocator::Marker TempAllocator::GetMarker()
+{
+	const u32 thread = GetThreadIndex();
+	ThreadArena& arena = m_arenas[thread];
+
+	Marker marker;
+	marker.block = arena.current;
+	marker.ptr = arena.ptr;
+	marker.thread = thread;
+#if DEBUG_ALLOCATORS
+	marker.allocCount = arena.allocCount;
+	marker.allocSize = arena.allocSize;
+#endif
+	return marker;
+}
+
+void TempAllocator::Rewind(const Marker& marker)
+{
+	ASSERT2(marker.thread == GetThreadIndex(), "Marker belongs to other thread");
+
+	ThreadArena& arena = m_arenas[marker.thread];
+	arena.current = static_cast<Block*>(marker.block);
+	arena.ptr = marker.ptr;
+	arena.end = (arena.current != nullptr) ? (u8*)arena.current + arena.current->size : nullptr;
+#if DEBUG_ALLOCATORS
+	arena.allocCount = marker.allocCount;
+	arena.allocSize = marker.allocSize;
+#endif
+
+	//oversized blocks are not kept for later use
+	Block** link = (arena.current != nullptr) ? &arena.current->next : &arena.first;
+	while (*link != nullptr)
+	{
+		Block* block = *link;
+		if (block->size > BLOCK_SIZE)
+		{
+			*link = block->next;
+			os::ReleaseMemory(block, block->size);
+		}
+		else
+		{
+			link = &block->next;
+		}
+	}
+}
 
-size_t FrameAllocator::GetBlockSize() const
+
+void* TempAllocator::NextBlock(ThreadArena& arena, size_t size, size_t alignment)
+{
+	const size_t requiredSize = sizeof(Block) + sizeof(size_t) + alignment + size;
+
+	Block* block = (arena.current != nullptr) ? arena.current->next : arena.first;
+	if (block == nullptr || block->size < requiredSize)
+	{
+		const size_t granularity = GetAllocInfo().allocationGranularity;
+		const size_t blockSize = Max(BLOCK_SIZE, (requiredSize + granularity - 1) / granularity * granularity);
+		Block* newBlock = static_cast<Block*>(os::ReserveMemory(blockSize));
+		if (newBlock == nullptr)
+			return nullptr;
+		if (!os::CommitMemory(newBlock, blockSize, false))
+		{
+			os::ReleaseMemory(newBlock, blockSize);
+			return nullptr;
+		}
+		newBlock->size = blockSize;
+		newBlock->next = block;
+
+		if (arena.current != nullptr)
+			arena.current->next = newBlock;
+		else
+			arena.first = newBlock;
+		block = newBlock;
+	}
+
+	arena.current = block;
+	arena.ptr = (u8*)(block + 1);
+	arena.end = (u8*)block + block->size;
+	return AlignPointer(arena.ptr + sizeof(size_t), Max(alignment, alignof(size_t)));
+}
+
+
+#if DEBUG_ALLOCATORS
+
+void TempAllocator::SetDebugName(const char* name) { m_name = name; }
+const char* TempAllocator::GetDebugName() const { return m_name; }
+
+size_t TempAllocator::GetAllocCount() const
+{
+	i64 count = 0;
+	for (const ThreadArena& arena : m_arenas)
+		count += arena.allocCount;
+	return (size_t)count;
+}
+
+size_t TempAllocator::GetAllocSize() const
+{
+	i64 size = 0;
+	for (const ThreadArena& arena : m_arenas)
+		size += arena.allocSize;
+	return (size_t)size;
+}
+
+size_t TempAllocator::GetAllocationsSize() const { return 0; }
+AllocationDebugData const* TempAllocator::GetAllocations() const { return nullptr; }
+size_t TempAllocator::GetBlocksSize() const { return 0; }
+void* const* TempAllocator::GetBlocks() const { return nullptr; }
+size_t TempAllocator::GetBlockSize() const { return 0; }
+
+#endif
+
+
+TempAllocator& GetTempAllocator()
+{
+	static TempAllocator s_tempAllocator;
+	return s_tempAllocator;
+}
+
+
+TempScope::TempScope()
+	: m_allocator(GetTempAllocator())
+	, m_marker(m_allocator.GetMarker())
 {}
 
-#endif*/
+TempScope::~TempScope()
+{
+	m_allocator.Rewind(m_marker);
+}
 
 
 }
@@ -3,16 +3,138 @@
 #include "allocator.h"
 #include "asserts.h"
 #include "threading/threads.h"
+#include "core/containers/array.h"
+#include "core/math/math.h"
 
 
-#if DEBUG_ALLOCATORS
-#	include "core/containers/array.h"
-#	include "core/containers/associative_array.h"
+
+namespace Veng
+{
+
+
+class OutputClob;
+
+
+//always-on statistics; every thread updates only its own shard, readers sum them
+class AllocatorStats
+{
+public:
+	static const size_t HISTOGRAM_SIZE = 16;//power of two size classes from 16B, last one holds everything bigger
+	static const i64 PEAK_BATCH_SIZE = 16 * 1024;
+
+	struct Summary
+	{
+		i64 allocCount = 0;
+		i64 allocSize = 0;
+		i64 peakSize = 0;//highest allocSize so far, can miss up to PEAK_BATCH_SIZE per thread
+		i64 totalCount = 0;
+		i64 lastFrameCount = 0;//allocations made during last frame
+		i64 histogram[HISTOGRAM_SIZE] = {};
+	};
+
+public:
+	void OnAllocate(size_t size);
+	void OnDeallocate(size_t size);
+	void OnResize(size_t oldSize, size_t newSize);
+	void NewFrame();//must not be called concurrently with GetSummary
+
+	Summary GetSummary() const;
+
+private:
+	//written only by owning thread and read by others, so all accesses are relaxed atomics; allocation count
+	//is sum of histogram, live count is that minus frees, so every update touches only two fields. Size
+	//changes gather in shard until they reach PEAK_BATCH_SIZE either way, then go to shared live size, which
+	//is the only place peak is compared with
+	struct alignas(64) Shard
+	{
+		volatile i64 unflushedSize = 0;
+		volatile i64 freeCount = 0;
+		volatile i64 histogram[HISTOGRAM_SIZE] = {};
+	};
+
+private:
+	static i64 LoadShard(const volatile i64* value);
+	static void StoreShard(volatile i64* value, i64 amount);
+	static void AddToShard(volatile i64* value, i64 amount);
+	static size_t GetHistogramIndex(size_t size);
+	void AddSize(Shard& shard, i64 amount);
+	void FlushSize(Shard& shard, i64 unflushedSize);
+
+private:
+	Shard m_shards[MAX_THREADS];
+	alignas(64) volatile i64 m_liveSize = 0;
+	volatile i64 m_peakSize = 0;
+	alignas(64) i64 m_frameStartCount = 0;
+	i64 m_lastFrameCount = 0;
+};
+
+
+//updates are inline, they run on every allocation of every proxy allocator
+
+//relaxed load and store are plain moves, on x64 aligned ones are atomic and volatile keeps them whole and in place
+inline i64 AllocatorStats::LoadShard(const volatile i64* value)
+{
+#if defined(_MSC_VER)
+	return *value;
+#else
+	return __atomic_load_n(value, __ATOMIC_RELAXED);
 #endif
+}
 
+inline void AllocatorStats::StoreShard(volatile i64* value, i64 amount)
+{
+#if defined(_MSC_VER)
+	*value = amount;
+#else
+	__atomic_store_n(value, amount, __ATOMIC_RELAXED);
+#endif
+}
 
-namespace Veng
+//single writer doesn't need locked add
+inline void AllocatorStats::AddToShard(volatile i64* value, i64 amount)
 {
+	StoreShard(value, LoadShard(value) + amount);
+}
+
+inline size_t AllocatorStats::GetHistogramIndex(size_t size)
+{
+	if (size <= 16)
+		return 0;
+	return Min((size_t)HighestBitIndex(size - 1) - 3, HISTOGRAM_SIZE - 1);
+}
+
+inline void AllocatorStats::AddSize(Shard& shard, i64 amount)
+{
+	const i64 unflushedSize = LoadShard(&shard.unflushedSize) + amount;
+	if (unflushedSize >= PEAK_BATCH_SIZE || unflushedSize <= -PEAK_BATCH_SIZE)
+		FlushSize(shard, unflushedSize);
+	else
+		StoreShard(&shard.unflushedSize, unflushedSize);
+}
+
+inline void AllocatorStats::OnAllocate(size_t size)
+{
+	Shard& shard = m_shards[GetThreadIndex()];
+	AddToShard(&shard.histogram[GetHistogramIndex(size)], 1);
+	AddSize(shard, (i64)size);
+}
+
+inline void AllocatorStats::OnDeallocate(size_t size)
+{
+	Shard& shard = m_shards[GetThreadIndex()];
+	AddToShard(&shard.freeCount, 1);
+	AddSize(shard, -(i64)size);
+}
+
+inline void AllocatorStats::OnResize(size_t oldSize, size_t newSize)
+{
+	AddSize(m_shards[GetThreadIndex()], (i64)newSize - (i64)oldSize);
+}
+
+
+//statistics of all proxy allocators, available in every build
+void NewAllocatorStatsFrame();
+void WriteAllocatorStats(OutputClob& clob);//JSON array with one object per named allocator
 
 
 #if DEBUG_ALLOCATORS
@@ -32,12 +154,112 @@ struct AllocatorDebugData
 
 const Array<AllocatorDebugData>& GetAllocators();
 
+
+//counters of one thread, padded to cache line so threads don't share it; allocator sums them on request
+struct alignas(64) ThreadAllocCounters
+{
+	i64 allocCount = 0;
+	i64 allocSize = 0;
+};
+
 #endif
 
 //-----------------------------------------------
 
 
-class MainAllocator : public Allocator
+//two level segregated fit allocator over pools of virtual memory, allocation and deallocation are O(1)
+class HeapAllocator final : public Allocator
+{
+public:
+	HeapAllocator();
+	HeapAllocator(HeapAllocator&) = delete;
+	HeapAllocator(HeapAllocator&&) = delete;
+	HeapAllocator& operator=(HeapAllocator&) = delete;
+	HeapAllocator& operator=(HeapAllocator&&) = delete;
+	~HeapAllocator() override;
+
+	void* Allocate(size_t size, size_t alignment) override;
+	void* Reallocate(void* ptr, size_t size, size_t alignment) override;//grows in place when next block is free
+	void Deallocate(void* ptr) override;
+	size_t GetSize(void* ptr) const override;
+	bool TryExpand(void* ptr, size_t size) override;
+
+	//whole batch is served under one lock, returns number of allocated blocks
+	size_t AllocateBatch(size_t size, void** ptrs, size_t count);
+	void DeallocateBatch(void* const* ptrs, size_t count);
+
+#if DEBUG_ALLOCATORS
+	void SetDebugName(const char* name) override;
+	const char* GetDebugName() const override;
+	size_t GetAllocCount() const override;
+	size_t GetAllocSize() const override;
+
+	size_t GetAllocationsSize() const override;
+	AllocationDebugData const* GetAllocations() const override;
+	size_t GetBlocksSize() const override;
+	void* const* GetBlocks() const override;
+	size_t GetBlockSize() const override;
+#endif
+
+private:
+	static const size_t ALIGN_SHIFT = 4;
+	static const size_t ALIGN_SIZE = (size_t)1 << ALIGN_SHIFT;
+	static const size_t SL_SHIFT = 5;
+	static const size_t SL_COUNT = (size_t)1 << SL_SHIFT;
+	static const size_t FL_SHIFT = SL_SHIFT + ALIGN_SHIFT;
+	static const size_t FL_MAX = 36;//biggest block is 64GB
+	static const size_t FL_COUNT = FL_MAX - FL_SHIFT + 1;
+	static const size_t SMALL_BLOCK_SIZE = (size_t)1 << FL_SHIFT;
+	static const size_t POOL_SIZE = 16 * 1024 * 1024;
+
+	//header of every block, links to free list are stored in payload of free blocks
+	struct Block
+	{
+		Block* prevPhys;
+		size_t size;//size of payload, lowest bit is set for free blocks
+		Block* nextFree;
+		Block* prevFree;
+	};
+
+	//lives at the start of every pool, pool ends with zero sized used sentinel block
+	struct Pool
+	{
+		Pool* prev;
+		Pool* next;
+		size_t size;
+		size_t padding;
+	};
+
+private:
+	static void MappingInsert(size_t size, size_t& fl, size_t& sl);
+	static void MappingSearch(size_t size, size_t& fl, size_t& sl);
+
+	void* AllocateLocked(size_t size, size_t alignment);
+	void DeallocateLocked(void* ptr);
+	Block* FindFreeBlock(size_t size);
+	void InsertFreeBlock(Block* block);
+	void RemoveFreeBlock(Block* block);
+	void TrimBlock(Block* block, size_t size);
+	bool ExpandBlock(Block* block, size_t size);
+	bool AddPool(size_t size);
+	void ReleasePool(Pool* pool);
+
+private:
+	mutable Mutex m_lock;
+	u32 m_flBitmap = 0;
+	u32 m_slBitmap[FL_COUNT] = {};
+	Block* m_freeBlocks[FL_COUNT][SL_COUNT] = {};
+	Pool* m_pools = nullptr;
+#if DEBUG_ALLOCATORS
+	const char* m_name = "Heap";
+	size_t m_allocCount = 0;
+	size_t m_allocSize = 0;
+#endif
+};
+
+
+//small allocations are served from per-thread caches which refill from and flush to heap in batches
+class MainAllocator final : public Allocator
 {
 public:
 	MainAllocator();
@@ -51,6 +273,10 @@ public:
 	void* Reallocate(void* ptr, size_t size, size_t alignment) override;
 	void Deallocate(void* ptr) override;
 	size_t GetSize(void* ptr) const override;
+	bool TryExpand(void* ptr, size_t size) override;
+
+	//returns cached memory of calling thread to heap, should be called by threads before they exit
+	void FlushThreadCache();
 
 #if DEBUG_ALLOCATORS
 	void SetDebugName(const char* name) override {}
@@ -66,15 +292,36 @@ public:
 #endif
 
 private:
-	SpinLock m_lock;
+	static const size_t CACHE_CLASS_SHIFT = 4;
+	static const size_t CACHE_CLASS_COUNT = 16;
+	static const size_t CACHE_MAX_SIZE = CACHE_CLASS_COUNT << CACHE_CLASS_SHIFT;//256B
+	static const size_t CACHE_BATCH = 32;
+
+	struct CachedBlock
+	{
+		CachedBlock* next;
+	};
+
+	struct alignas(64) ThreadCache
+	{
+		CachedBlock* blocks[CACHE_CLASS_COUNT] = {};
+		u32 counts[CACHE_CLASS_COUNT] = {};
+	};
+
+private:
+	void Refill(ThreadCache& cache, size_t sizeClass);
+	void Flush(ThreadCache& cache, size_t sizeClass, size_t count);
+
+private:
+	HeapAllocator m_heap;
+	ThreadCache m_caches[MAX_THREADS];
 #if DEBUG_ALLOCATORS
-	i64 m_allocCount = 0;
-	size_t m_allocSize = 0;
+	ThreadAllocCounters m_counters[MAX_THREADS];
 #endif
 };
 
 
-class ProxyAllocator : public Allocator
+class ProxyAllocator final : public Allocator
 {
 public:
 	ProxyAllocator(Allocator& allocator);
@@ -88,10 +335,18 @@ public:
 	void* Reallocate(void* ptr, size_t size, size_t alignment) override;
 	void Deallocate(void* ptr) override;
 	size_t GetSize(void* ptr) const override;
+	bool TryExpand(void* ptr, size_t size) override;
 
-#if DEBUG_ALLOCATORS
 	void SetDebugName(const char* name) override;
 	const char* GetDebugName() const override;
+	AllocatorStats& GetStats() { return m_stats; }
+	const AllocatorStats& GetStats() const { return m_stats; }
+
+#if DEBUG_ALLOCATORS
+	//callstack is captured for every allocationInterval-th allocation and whenever byteInterval bytes were allocated
+	//since last sample, zero disables given trigger; by default every allocation is sampled
+	void SetSampling(u32 allocationInterval, size_t byteInterval);
+
 	size_t GetAllocCount() const override;
 	size_t GetAllocSize() const override;
 
@@ -100,24 +355,63 @@ public:
 	size_t GetBlocksSize() const override;
 	void* const* GetBlocks() const override;
 	size_t GetBlockSize() const override;
+	void UpdateDebugView() const override;
 #endif
 
 private:
-	Allocator& m_source;
-	SpinLock m_lock;
 #if DEBUG_ALLOCATORS
-	const char* m_name = "Heap";
-	i32 m_allocCount = 0;
-	size_t m_allocSize = 0;
+	static const u32 NO_CALLSTACK = 0xffffffff;
+
+	struct LiveAllocation
+	{
+		void* allocation;
+		u32 callstack;
+	};
+
+	struct Callstack
+	{
+		void* frames[AllocationDebugData::CALLSTACK_SIZE];
+		u32 hash;
+	};
+
+	struct alignas(64) ThreadSampler
+	{
+		u32 allocations = 0;
+		size_t bytes = 0;
+	};
 
-	Array<AllocationDebugData> m_allocations;
-	AssociativeArray<void*, size_t> m_pages;
+private:
+	bool Sample(size_t size);
+	u32 AddCallstack(void* const* frames);
+	void AddLive(void* ptr, u32 callstack);
+	u32 RemoveLive(void* ptr);
+#endif
+
+private:
+	Allocator& m_source;
+	const char* m_name = "Heap";
+	AllocatorStats m_stats;
+#if DEBUG_ALLOCATORS
+	mutable Mutex m_lock;//guards tracking of allocations
+	ThreadSampler m_samplers[MAX_THREADS];
+	u32 m_allocationInterval = 1;
+	size_t m_byteInterval = 0;
+
+	LiveAllocation* m_live = nullptr;//open addressing with linear probing, power of two capacity
+	size_t m_liveCapacity = 0;
+	size_t m_liveCount = 0;
+	Array<Callstack> m_callstacks;
+	u32* m_callstackIndex = nullptr;//open addressing, stores callstack index + 1, zero is empty slot
+	size_t m_callstackIndexCapacity = 0;
+
+	mutable Array<AllocationDebugData> m_view;//sorted by address, built by UpdateDebugView
+	mutable Array<void*> m_viewPages;
 #endif
 };
 
 
 template<int maxSize>
-class StackAllocator : public Allocator
+class StackAllocator final : public Allocator
 {
 public:
 	StackAllocator();
@@ -146,13 +440,14 @@ public:
 #endif
 
 private:
-	SpinLock m_lock;
+	Mutex m_lock;
 	u8 m_memory[maxSize];
 	u8* m_ptr = m_memory;
 };
 
 
-/*class FrameAllocator : public Allocator
+//linear per-frame arena; every thread bumps its own cursor, all memory is released at once by NewFrame
+class FrameAllocator final : public Allocator
 {
 public:
 	FrameAllocator(Allocator& allocator);
@@ -166,9 +461,126 @@ public:
 	void* Reallocate(void* ptr, size_t size, size_t alignment) override;
 	void Deallocate(void* ptr) override;
 	size_t GetSize(void* ptr) const override;
+	bool TryExpand(void* ptr, size_t size) override;
 
+	//must be called when no other thread allocates from this allocator
 	void NewFrame();
 
+#if DEBUG_ALLOCATORS
+	void SetDebugName(const char* name) override;
+	const char* GetDebugName() const override;
+	size_t GetAllocCount() const override;//allocations made during last frame
+	size_t GetAllocSize() const override;//peak usage of last frame
+
+	size_t GetAllocationsSize() const override;
+	AllocationDebugData const* GetAllocations() const override;
+	size_t GetBlocksSize() const override;
+	void* const* GetBlocks() const override;
+	size_t GetBlockSize() const override;
+#endif
+
+private:
+	static const size_t BLOCK_SIZE = 1'048'576;
+
+	struct Block
+	{
+		Block* next;
+		size_t size;
+	};
+
+	struct alignas(64) ThreadArena
+	{
+		Block* first = nullptr;
+		Block* current = nullptr;
+		u8* ptr = nullptr;
+		u8* end = nullptr;
+		size_t frameSize = 0;
+		size_t frameCount = 0;
+	};
+
+private:
+	void* NextBlock(ThreadArena& arena, size_t size, size_t alignment);
+
+private:
+	Allocator& m_source;
+	Mutex m_lock;//guards list of blocks, bump allocation itself is lock free
+	ThreadArena m_arenas[MAX_THREADS];
+#if DEBUG_ALLOCATORS
+	const char* m_name = "Frame";
+	size_t m_allocCount = 0;
+	size_t m_allocSize = 0;
+
+	Array<void*> m_blocks;
+#endif
+};
+
+
+//bump path is inline, containers naming FrameAllocator as their allocator type get it without any call
+
+inline void* FrameAllocator::Allocate(size_t size, size_t alignment)
+{
+	ThreadArena& arena = m_arenas[GetThreadIndex()];
+
+	u8* data = (u8*)AlignPointer(arena.ptr + sizeof(size_t), Max(alignment, alignof(size_t)));
+	if (arena.ptr == nullptr || data + size > arena.end)
+		data = (u8*)NextBlock(arena, size, alignment);
+
+	*((size_t*)data - 1) = size;
+
+	arena.frameSize += (data + size) - arena.ptr;
+	arena.frameCount++;
+	arena.ptr = data + size;
+	return data;
+}
+
+inline void FrameAllocator::Deallocate(void* ptr)
+{
+	ASSERT(ptr != nullptr);
+}
+
+inline size_t FrameAllocator::GetSize(void* ptr) const
+{
+	return *((size_t*)ptr - 1);
+}
+
+inline bool FrameAllocator::TryExpand(void* ptr, size_t size)
+{
+	ThreadArena& arena = m_arenas[GetThreadIndex()];
+	size_t* header = (size_t*)ptr - 1;
+	u8* dataEnd = (u8*)ptr + *header;
+
+	//only last allocation of this thread can grow in place
+	if (dataEnd != arena.ptr || (u8*)ptr + size > arena.end)
+		return false;
+
+	arena.frameSize += (u8*)ptr + size - dataEnd;
+	arena.ptr = (u8*)ptr + size;
+	*header = size;
+	return true;
+}
+
+
+//hands out whole pages of one virtual range reserved up front; pages are committed on allocation and
+//decommitted on deallocation, so addresses stay stable and freed memory goes back to system
+class PageAllocator final : public Allocator
+{
+public:
+	PageAllocator(size_t reserveSize, bool hugePages = false);
+	PageAllocator(PageAllocator&) = delete;
+	PageAllocator(PageAllocator&&) = delete;
+	PageAllocator& operator=(PageAllocator&) = delete;
+	PageAllocator& operator=(PageAllocator&&) = delete;
+	~PageAllocator() override;
+
+	void* Allocate(size_t size, size_t alignment) override;
+	void* Reallocate(void* ptr, size_t size, size_t alignment) override;//grows in place while following pages are free
+	void Deallocate(void* ptr) override;
+	size_t GetSize(void* ptr) const override;
+	bool TryExpand(void* ptr, size_t size) override;
+
+	size_t GetPageSize() const { return m_pageSize; }
+	bool Owns(void* ptr) const;
+
 #if DEBUG_ALLOCATORS
 	void SetDebugName(const char* name) override;
 	const char* GetDebugName() const override;
@@ -183,19 +595,235 @@ public:
 #endif
 
 private:
-	static const size_t BLOCK_SIZE = 1'048'576;
+	static const u32 FREE_PAGE = 0;
+	static const u32 CONTINUATION_PAGE = 0xffffffff;
+
+private:
+	size_t GetPageIndex(void* ptr) const;
+	size_t GetPageCount(size_t size) const;
+	size_t FindFreePages(size_t pageCount, size_t alignment) const;
+	bool ArePagesFree(size_t first, size_t count) const;
+	void MarkPages(size_t first, size_t count);
+
+private:
+	Mutex m_lock;
+	u8* m_memory = nullptr;//reserved range, starts with committed page table
+	u8* m_pages = nullptr;//first allocatable page
+	u32* m_pageTable = nullptr;//page count for first page of allocation, FREE_PAGE or CONTINUATION_PAGE for others
+	size_t m_reserveSize = 0;
+	size_t m_pageSize = 0;
+	size_t m_pageCount = 0;
+	size_t m_firstFree = 0;//no free page before this index
+	bool m_hugePages = false;
+#if DEBUG_ALLOCATORS
+	const char* m_name = "Page";
+	size_t m_allocCount = 0;
+	size_t m_allocSize = 0;
+#endif
+};
+
+
+//segregated fit allocator, power of two size classes are served from SLAB_SIZE aligned slabs carved from
+//chunks of one reserved range, so slab of block is its address masked down and no lookup is needed; bigger
+//allocations are forwarded to source allocator. Every class has its own lock, only moving slabs between
+//classes and chunks takes shared one. Slab which gets empty goes back to chunk and can serve any class, chunk
+//with no slab in use is decommitted
+class PoolAllocator final : public Allocator
+{
+public:
+	static const size_t DEFAULT_RESERVE_SIZE = (size_t)1 << 30;
+
+public:
+	//reserveSize bounds memory of pooled blocks, it's only address space until chunks are used
+	PoolAllocator(Allocator& allocator, size_t reserveSize = DEFAULT_RESERVE_SIZE);
+	PoolAllocator(PoolAllocator&) = delete;
+	PoolAllocator(PoolAllocator&&) = delete;
+	PoolAllocator& operator=(PoolAllocator&) = delete;
+	PoolAllocator& operator=(PoolAllocator&&) = delete;
+	~PoolAllocator() override;
+
+	void* Allocate(size_t size, size_t alignment) override;
+	void* Reallocate(void* ptr, size_t size, size_t alignment) override;
+	void Deallocate(void* ptr) override;
+	size_t GetSize(void* ptr) const override;
+	bool TryExpand(void* ptr, size_t size) override;
+
+#if DEBUG_ALLOCATORS
+	void SetDebugName(const char* name) override;
+	const char* GetDebugName() const override;
+	size_t GetAllocCount() const override;
+	size_t GetAllocSize() const override;
+
+	size_t GetAllocationsSize() const override;
+	AllocationDebugData const* GetAllocations() const override;
+	size_t GetBlocksSize() const override;
+	void* const* GetBlocks() const override;
+	size_t GetBlockSize() const override;
+#endif
+
+private:
+	static const size_t MIN_SIZE_SHIFT = 4;//16B
+	static const size_t MAX_SIZE_SHIFT = 12;//4KB
+	static const size_t SIZE_CLASS_COUNT = MAX_SIZE_SHIFT - MIN_SIZE_SHIFT + 1;
+	static const size_t SLAB_SIZE_SHIFT = 16;
+	static const size_t SLAB_SIZE = (size_t)1 << SLAB_SIZE_SHIFT;
+	static const size_t SLABS_PER_CHUNK = 16;
+	static const size_t CHUNK_SIZE = SLAB_SIZE * SLABS_PER_CHUNK;
+
+	struct FreeNode
+	{
+		FreeNode* next;
+	};
+
+	//lives at the start of every slab, blocks of slab follow it
+	struct Slab
+	{
+		Slab* prev;//neighbours in list of slabs of same class with free blocks, or in list of unused slabs
+		Slab* next;
+		FreeNode* freeList;
+		u8* slabPtr;//not yet used part of slab
+		u32 chunk;//index to m_chunks
+		u32 sizeClass;//doesn't change while slab has blocks in use, so it's read without lock
+		u32 allocCount;
+	};
+
+	struct alignas(64) SizeClass
+	{
+		Mutex lock;
+		Slab* slabs = nullptr;//slabs with at least one free block
+#if DEBUG_ALLOCATORS
+		size_t allocCount = 0;
+#endif
+	};
+
+private:
+	static size_t GetSizeClass(size_t size);
+	static bool IsFull(const Slab* slab);
+	static void LinkSlab(Slab*& list, Slab* slab);
+	static void UnlinkSlab(Slab*& list, Slab* slab);
+	//null for blocks of source allocator
+	Slab* FindSlab(void* ptr) const;
+	//lock of size class has to be held by caller, these take m_lock
+	void AddSlab(size_t sizeClass);
+	void ReleaseSlab(Slab* slab);
+	//m_lock has to be held by caller
+	void AddChunk();
+	void ReleaseChunk(size_t index);
 
 private:
 	Allocator& m_source;
-	SpinLock m_lock;
-	void* m_buffer;
+	PageAllocator m_chunkPages;
+	mutable SizeClass m_classes[SIZE_CLASS_COUNT];
+	Mutex m_lock;//unused slabs and chunks
+	Array<void*> m_chunks;
+	Array<u32> m_chunkUsedSlabs;//slabs given to size classes, for chunk of same index
+	Slab* m_unusedSlabs = nullptr;
+	size_t m_unusedSlabCount = 0;
 #if DEBUG_ALLOCATORS
-	const char* m_name = "Heap";
-	i32 m_allocCount = 0;
+	const char* m_name = "Pool";
+	size_t m_allocCount = 0;//only blocks of source allocator, pooled ones are counted by their classes
 	size_t m_allocSize = 0;
 #endif
-};*/
+};
+
+
+//scratch memory of calling thread, allocations are released all at once by TempScope going out of scope;
+//deallocation of last allocation rewinds it, others are no-op; use GetTempAllocator()
+class TempAllocator final : public Allocator
+{
+public:
+	struct Marker
+	{
+		void* block;
+		u8* ptr;
+		u32 thread;
+#if DEBUG_ALLOCATORS
+		i64 allocCount;
+		i64 allocSize;
+#endif
+	};
+
+public:
+	TempAllocator();
+	TempAllocator(TempAllocator&) = delete;
+	TempAllocator(TempAllocator&&) = delete;
+	TempAllocator& operator=(TempAllocator&) = delete;
+	TempAllocator& operator=(TempAllocator&&) = delete;
+	~TempAllocator() override;
+
+	void* Allocate(size_t size, size_t alignment) override;
+	void* Reallocate(void* ptr, size_t size, size_t alignment) override;//grows in place if ptr is last allocation
+	void Deallocate(void* ptr) override;
+	size_t GetSize(void* ptr) const override;
+	bool TryExpand(void* ptr, size_t size) override;
+
+	Marker GetMarker();
+	void Rewind(const Marker& marker);//releases everything allocated by calling thread since marker
+
+#if DEBUG_ALLOCATORS
+	void SetDebugName(const char* name) override;
+	const char* GetDebugName() const override;
+	size_t GetAllocCount() const override;
+	size_t GetAllocSize() const override;
+
+	size_t GetAllocationsSize() const override;
+	AllocationDebugData const* GetAllocations() const override;
+	size_t GetBlocksSize() const override;
+	void* const* GetBlocks() const override;
+	size_t GetBlockSize() const override;
+#endif
+
+private:
+	static const size_t BLOCK_SIZE = 1'048'576;
+
+	struct Block
+	{
+		Block* next;
+		size_t size;
+	};
+
+	struct alignas(64) ThreadArena
+	{
+		Block* first = nullptr;
+		Block* current = nullptr;
+		u8* ptr = nullptr;
+		u8* end = nullptr;
+#if DEBUG_ALLOCATORS
+		i64 allocCount = 0;
+		i64 allocSize = 0;
+#endif
+	};
+
+private:
+	void* NextBlock(ThreadArena& arena, size_t size, size_t alignment);
+
+private:
+	ThreadArena m_arenas[MAX_THREADS];
+#if DEBUG_ALLOCATORS
+	const char* m_name = "Temp";
+#endif
+};
+
+TempAllocator& GetTempAllocator();
+
+
+//rewinds temp allocator of calling thread to state from construction
+class TempScope
+{
+public:
+	TempScope();
+	TempScope(TempScope&) = delete;
+	TempScope(TempScope&&) = delete;
+	TempScope& operator=(TempScope&) = delete;
+	TempScope& operator=(TempScope&&) = delete;
+	~TempScope();
+
+	TempAllocator& GetAllocator() { return m_allocator; }
 
+private:
+	TempAllocator& m_allocator;
+	TempAllocator::Marker m_marker;
+};
 
 //-----------------------------------------------------------------------------
 
@@ -210,7 +838,7 @@ StackAllocator<maxSize>::~StackAllocator()
 template<int maxSize>
 void* StackAllocator<maxSize>::Allocate(size_t size, size_t alignment)
 {
-	ScopeLock<SpinLock> lock(m_lock);
+	ScopeLock<Mutex> lock(m_lock);
 
 	u8* data = (u8*)AlignPointer(m_ptr, alignment);
 	ASSERT2(data + size <= m_memory + maxSize, "Not enough memory");
@@ -218,11 +846,21 @@ void* StackAllocator<maxSize>::Allocate(size_t size, size_t alignment)
 	return data;
 }
 
+//old size isn't stored, but old block can't reach past top of stack, so everything up to it is copied
 template<int maxSize>
 void* StackAllocator<maxSize>::Reallocate(void* ptr, size_t size, size_t alignment)
 {
-	ASSERT2(false, "Can't use reallocate");
-	return ptr;
+	if (ptr == nullptr)
+		return Allocate(size, alignment);
+
+	ScopeLock<Mutex> lock(m_lock);
+
+	u8* data = (u8*)AlignPointer(m_ptr, alignment);
+	ASSERT2(data + size <= m_memory + maxSize, "Not enough memory");
+	const size_t copySize = (size_t)(m_ptr - (u8*)ptr);
+	memory::Copy(data, ptr, (copySize < size) ? copySize : size);
+	m_ptr = data + size;
+	return data;
 }
 
 template<int maxSize>
@@ -231,19 +869,7 @@ void StackAllocator<maxSize>::Deallocate(void* ptr)
 
 
 
-//PoolAllocator
-
-
-//PageAllocator
-
-
-//HeapAllocator
-
-
 //TraceAllocator
 
 
-//TempAllocator
-
-
 }
@@ -9,7 +9,11 @@ namespace Veng
 
 void MyDebugBreak()
 {
+#ifdef _MSC_VER
 	__debugbreak();
+#else
+	__builtin_trap();
+#endif
 }
 
 void MyOutputDebugString(const char* text)
@@ -10,11 +10,12 @@ namespace Veng
 {
 
 
-template<class Type>
+//AllocatorType may name a final allocator class, calls to it are then resolved at compile time
+template<class Type, class AllocatorType = Allocator>
 class Array final
 {
 public:
-	explicit Array(Allocator& allocator);
+	explicit Array(AllocatorType& allocator);
 	Array(Array&) = delete;
 	Array(Array&& other);
 	Array& operator =(Array&) = delete;
@@ -75,7 +76,7 @@ private:
 	void Enlarge();
 
 private:
-	Allocator& m_allocator;
+	AllocatorType& m_allocator;
 	size_t m_capacity = 0;
 	size_t m_size = 0;
 	Type* m_data = nullptr;
@@ -3,17 +3,18 @@
 #include "core/allocator.h"
 #include "core/asserts.h"
 #include "core/memory.h"
+#include "core/algorithms/sort.h"
 
 
 namespace Veng
 {
 
 
-template<class KeyType, class ValueType>
+template<class KeyType, class ValueType, class AllocatorType = Allocator>
 class AssociativeArray final
 {
 public:
-	explicit AssociativeArray(Allocator& allocator);
+	explicit AssociativeArray(AllocatorType& allocator);
 	AssociativeArray(AssociativeArray&) = delete;
 	AssociativeArray(AssociativeArray&& other);
 	AssociativeArray& operator =(AssociativeArray&) = delete;
@@ -32,6 +33,12 @@ public:
 
 	ValueType* Insert(const KeyType& key, const ValueType& value);
 
+	//keys don't have to be sorted, keys already present and repeated ones after their first occurrence
+	//are skipped; sorts batch once and merges it from back, so each present element moves at most once.
+	//Returns number of inserted elements, inserted gets flag for each batch element when it's given, so
+	//caller can release what skipped values own
+	size_t BulkInsert(const KeyType* keys, const ValueType* values, size_t count, bool* inserted = nullptr);
+
 	bool Erase(const KeyType& key);
 
 	const ValueType& operator[](const KeyType& key) const;
@@ -55,9 +62,10 @@ private:
 private:
 	void Enlarge();
 	size_t GetIndex(const KeyType& key) const;
+	size_t GetIndex(const KeyType& key, size_t size) const;
 
 private:
-	Allocator& m_allocator;
+	AllocatorType& m_allocator;
 	size_t m_capacity = 0;
 	size_t m_size = 0;
 	KeyType* m_keys = nullptr;
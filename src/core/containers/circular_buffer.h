@@ -0,0 +1,94 @@
+#pragma once
+
+#include "core/allocator.h"
+#include "core/asserts.h"
+#include "core/utility.h"
+#include "core/memory.h"
+#include "core/threading/os_utils.h"
+
+
+namespace Veng
+{
+
+
+//one producer and one consumer thread, capacity is rounded up to power of two
+template<class Type, class AllocatorType = Allocator>
+class SPSCQueue final
+{
+public:
+	SPSCQueue(AllocatorType& allocator, size_t capacity);
+	SPSCQueue(SPSCQueue&) = delete;
+	SPSCQueue& operator =(SPSCQueue&) = delete;
+
+	~SPSCQueue();
+
+	//producer only, returns false when queue is full
+	bool Push(const Type& value);
+	bool Push(Type&& value);
+	//consumer only, returns false when queue is empty
+	bool Pop(Type& value);
+
+	size_t GetCapacity() const;
+
+private:
+	template<class ValueType>
+	bool PushInternal(ValueType&& value);
+
+private:
+	AllocatorType& m_allocator;
+	Type* m_data;
+	i64 m_mask;
+
+	//each side keeps last seen index of the other one and reloads it only when queue looks full or empty
+	alignas(64) volatile i64 m_head = 0;
+	i64 m_cachedTail = 0;
+	alignas(64) volatile i64 m_tail = 0;
+	i64 m_cachedHead = 0;
+};
+
+
+//any number of producer and consumer threads, capacity is rounded up to power of two
+template<class Type, class AllocatorType = Allocator>
+class MPMCQueue final
+{
+public:
+	MPMCQueue(AllocatorType& allocator, size_t capacity);
+	MPMCQueue(MPMCQueue&) = delete;
+	MPMCQueue& operator =(MPMCQueue&) = delete;
+
+	~MPMCQueue();
+
+	//returns false when queue is full
+	bool Push(const Type& value);
+	bool Push(Type&& value);
+	//returns false when queue is empty
+	bool Pop(Type& value);
+
+	//only a hint while other threads push or pop
+	bool IsEmpty() const;
+	size_t GetCapacity() const;
+
+private:
+	struct Cell
+	{
+		volatile i64 sequence;
+		Type value;
+	};
+
+	template<class ValueType>
+	bool PushInternal(ValueType&& value);
+
+private:
+	AllocatorType& m_allocator;
+	Cell* m_cells;
+	i64 m_mask;
+
+	alignas(64) volatile i64 m_enqueuePos = 0;
+	alignas(64) volatile i64 m_dequeuePos = 0;
+};
+
+
+}
+
+
+#include "internal/circular_buffer.inl"
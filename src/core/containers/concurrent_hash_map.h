@@ -0,0 +1,118 @@
+#pragma once
+
+#include "core/int.h"
+#include "core/allocator.h"
+#include "core/asserts.h"
+#include "core/utility.h"
+#include "core/memory.h"
+#include "core/containers/hash_map.h"
+#include "core/threading/threads.h"
+
+
+namespace Veng
+{
+
+
+//chained buckets guarded by striped locks; readers take no lock and never retry, they only mark themselves
+//in per-thread sequence, writers wait for readers which could still see unlinked node before freeing it
+template<class KeyType, class ValueType, class Hasher = HashFunc<KeyType>, class AllocatorType = Allocator>
+class ConcurrentHashMap final
+{
+public:
+	explicit ConcurrentHashMap(AllocatorType& allocator);
+	ConcurrentHashMap(ConcurrentHashMap&) = delete;
+	ConcurrentHashMap& operator =(ConcurrentHashMap&) = delete;
+
+	//no other thread can use map while it's destroyed
+	~ConcurrentHashMap();
+
+	//wait-free, value is copied out since other thread can erase it right after
+	bool Find(const KeyType& key, ValueType& value) const;
+	bool Contains(const KeyType& key) const;
+
+	//returns false when key is already present
+	bool Insert(const KeyType& key, const ValueType& value);
+	bool Erase(const KeyType& key);
+	void Clear();
+
+	//holds all locks, function can call Find but must not modify map
+	template<class Function>
+	void ForEach(Function function) const;
+
+	//only a hint while other threads insert or erase
+	size_t GetSize() const;
+
+private:
+	enum
+	{
+		STRIPE_COUNT = 64,//power of two, not higher than INITIAL_BUCKETS so every bucket belongs to one stripe
+		INITIAL_BUCKETS = 64,
+		MAX_LOAD = 2,//average chain length before table grows
+		RETIRE_BATCH = 64,//erased nodes are freed in batches, see Retire
+		SPIN_COUNT = 64,//reader is waited for by spinning this many times before yielding
+	};
+
+	struct Node
+	{
+		Node(const KeyType& key, const ValueType& value, u32 hash, Node* next);
+
+		KeyType key;
+		ValueType value;
+		Node* volatile next;
+		Node* retired = nullptr;//next erased node waiting to be freed, readers still may follow next
+		u32 hash;
+	};
+
+	struct Table
+	{
+		Node* volatile* buckets;
+		u32 mask;
+	};
+
+	struct alignas(64) Stripe
+	{
+		Mutex mutex;
+	};
+
+	//odd while thread reads the map
+	struct alignas(64) ReaderSequence
+	{
+		volatile i64 value = 0;
+	};
+
+private:
+	static Node* LoadNext(Node* const volatile* next);
+	static void StoreNext(Node* volatile* next, Node* node);
+
+	Table* LoadTable() const;
+	Table* CreateTable(u32 bucketCount);
+	Node* FindNode(const Table* table, const KeyType& key, u32 hash) const;
+	void LockAll() const;
+	void UnlockAll() const;
+	void Grow(u32 bucketCount);
+	//returns once no reader can still see memory unlinked before the call
+	void Synchronize() const;
+	void SnapshotReaders(i64* sequences) const;
+	void WaitForReaders(const i64* sequences) const;
+	void Retire(Node* node);
+	void DestroyRetired(Node* node);
+	void DestroyChains(Table* table);
+
+private:
+	AllocatorType& m_allocator;
+	Table* volatile m_table;
+	volatile i64 m_size = 0;
+	Mutex m_retiredMutex;
+	Node* m_retired = nullptr;
+	u32 m_retiredCount = 0;
+	Node* m_sealed = nullptr;
+	i64 m_sealedSequences[MAX_THREADS];
+	mutable Stripe m_stripes[STRIPE_COUNT];
+	mutable ReaderSequence m_readers[MAX_THREADS];
+};
+
+
+}
+
+
+#include "internal/concurrent_hash_map.inl"
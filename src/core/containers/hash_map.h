@@ -4,12 +4,37 @@
 #include "core/allocator.h"
 #include "core/asserts.h"
 #include "core/utility.h"
+#include "core/memory.h"
+#include "core/math/math.h"
 
 
 namespace Veng
 {
 
 
+//murmur3 finalizers, every input bit affects every output bit; HashMap takes group from high bits
+//and control byte from low ones, so hashes must be mixed well
+inline u32 MixHash32(u32 h)
+{
+	h ^= h >> 16;
+	h *= 0x85ebca6b;
+	h ^= h >> 13;
+	h *= 0xc2b2ae35;
+	h ^= h >> 16;
+	return h;
+}
+
+inline u32 MixHash64(u64 h)
+{
+	h ^= h >> 33;
+	h *= 0xff51afd7ed558ccdULL;
+	h ^= h >> 33;
+	h *= 0xc4ceb9fe1a85ec53ULL;
+	h ^= h >> 33;
+	return (u32)h;
+}
+
+
 template <class Key>
 struct HashFunc
 {
@@ -21,25 +46,32 @@ struct HashFunc<u32>
 {
 	static u32 get(const u32& key)
 	{
-		//TODO: just dummy value to test
-		return key;
+		return MixHash32(key);
+	}
+};
+
+template <>
+struct HashFunc<u64>
+{
+	static u32 get(const u64& key)
+	{
+		return MixHash64(key);
 	}
 };
 
 template <>
 struct HashFunc<char*>
 {
+	//FNV-1a, its low bits are weak so it's mixed at the end
 	static u32 get(const char* key)
 	{
-		const char* k = key;
-		//TODO: just dummy value to test
-		u32 result = 1;
-		while (*k != '\0')
+		u32 result = 0x811c9dc5;
+		for (const char* k = key; *k != '\0'; ++k)
 		{
-			result *= *k;
-			k++;
+			result ^= (u8)*k;
+			result *= 0x01000193;
 		}
-		return result;
+		return MixHash32(result);
 	}
 };
 
@@ -48,25 +80,23 @@ struct HashFunc<T*>
 {
 	static u32 get(const void* ptr)
 	{
-		uintptr p = (uintptr)ptr;
-		return (u32)(p >> 32) * (u32)(p);
+		return MixHash64((u64)(uintptr)ptr);
 	}
 };
 
 
-template<class KeyType, class ValueType, class Hasher = HashFunc<KeyType>>
+//open addressing with one control byte per slot, slots are probed in groups of 16 control bytes at once;
+//nodes are kept dense in insertion order, erase moves last node into the hole
+template<class KeyType, class ValueType, class Hasher = HashFunc<KeyType>, class AllocatorType = Allocator>
 class HashMap final
 {
 public:
-	using Map = HashMap<KeyType, ValueType>;
+	using Map = HashMap<KeyType, ValueType, Hasher, AllocatorType>;
 	using HashFunction = u32(*)(KeyType const&);
 
 	struct HashNode
 	{
-		friend Map;
-
 		HashNode(const KeyType& key, const ValueType& value);
-		HashNode(const KeyType& key, const ValueType& value, int next);
 		HashNode(const HashNode&) = delete;
 		HashNode(HashNode&& other);
 		HashNode& operator=(const HashNode&) = delete;
@@ -74,12 +104,10 @@ public:
 
 		KeyType key;
 		ValueType value;
-	private:
-		int next;
 	};
 
 public:
-	explicit HashMap(Allocator& allocator);
+	explicit HashMap(AllocatorType& allocator);
 	HashMap(HashMap&) = delete;
 	HashMap(HashMap&& other);
 	HashMap& operator =(HashMap&) = delete;
@@ -96,10 +124,12 @@ public:
 
 	bool Find(const KeyType& key, ValueType*& value) const;
 
+	//returns null when key is already present
 	ValueType* Insert(const KeyType& key, const ValueType& value);
 
 	bool Erase(const KeyType& key);
 
+	//makes room for at least bucketSize slots, it also drops slots left behind by erased keys
 	void Rehash(unsigned bucketSize);
 
 	size_t GetBucketsSize() const;
@@ -110,25 +140,39 @@ public:
 private:
 	enum
 	{
-		MAX_FACTOR = 70,
-		INITIAL_SIZE = 8,
+		GROUP_SIZE = 16,
+		MAX_FACTOR = 87,//percent of slots which can be full or erased before table grows
+		INITIAL_SIZE = 16,
 		ENLARGE_MULTIPLIER = 2,
 		INVALID_INDEX = -1,
 	};
 
-private:
-	ValueType* Insert(unsigned bucketIdx, const KeyType& key, const ValueType& value);
+	static const i8 CONTROL_EMPTY = -128;
+	static const i8 CONTROL_ERASED = -2;
 
-	unsigned GetIndex(const KeyType& key) const;
+	//node indexes sit next to control bytes which select them, so probe and node lookup share cache lines
+	struct Group
+	{
+		i8 control[GROUP_SIZE];//empty, erased or low 7 bits of hash of key in slot
+		u32 slots[GROUP_SIZE];//index of node in full slot
+	};
+
+private:
+	static unsigned GetMaxLoad(unsigned slotCount);
+	static i8 GetControl(u32 hash);
 
-	HashNode* GetNode(unsigned index);
+	unsigned FindSlot(const KeyType& key, u32 hash) const;
+	unsigned FindFreeSlot(u32 hash) const;
+	void Rebuild(unsigned slotCount);
 
 private:
-	Allocator& m_allocator;
-	int* m_buckets = nullptr;
-	unsigned m_bucketSize = 0;
+	AllocatorType& m_allocator;
+	Group* m_groups = nullptr;
+	u32* m_nodeSlots = nullptr;//slot of each node, erase repoints node moved into the hole without probing
 	HashNode* m_table = nullptr;
+	unsigned m_slotCount = 0;
 	unsigned m_size = 0;
+	unsigned m_erased = 0;
 };
 
 
@@ -2,14 +2,14 @@ namespace Veng
 {
 
 
-template<class Type>
-Array<Type>::Array(Allocator& allocator)
+template<class Type, class AllocatorType>
+Array<Type, AllocatorType>::Array(AllocatorType& allocator)
 	: m_allocator(allocator)
 {
 }
 
-template<class Type>
-Array<Type>::Array(Array&& other)
+template<class Type, class AllocatorType>
+Array<Type, AllocatorType>::Array(Array&& other)
 	: m_allocator(other.m_allocator)
 	, m_capacity(other.m_capacity)
 	, m_size(other.m_size)
@@ -20,8 +20,8 @@ Array<Type>::Array(Array&& other)
 	other.m_data = nullptr;
 }
 
-template<class Type>
-Array<Type>& Array<Type>::operator =(Array&& other)
+template<class Type, class AllocatorType>
+Array<Type, AllocatorType>& Array<Type, AllocatorType>::operator =(Array&& other)
 {
 	size_t capacity = m_capacity;
 	size_t size = m_size;
@@ -40,8 +40,8 @@ Array<Type>& Array<Type>::operator =(Array&& other)
 	return *this;
 }
 
-template<class Type>
-Array<Type>::~Array()
+template<class Type, class AllocatorType>
+Array<Type, AllocatorType>::~Array()
 {
 	for (size_t i = 0; i < m_size; ++i)
 	{
@@ -51,8 +51,8 @@ Array<Type>::~Array()
 		m_allocator.Deallocate(m_data);
 }
 
-template<class Type>
-void Array<Type>::Clear()
+template<class Type, class AllocatorType>
+void Array<Type, AllocatorType>::Clear()
 {
 	for (size_t i = 0; i < m_size; ++i)
 	{
@@ -61,21 +61,21 @@ void Array<Type>::Clear()
 	m_size = 0;
 }
 
-template<class Type>
-Type* Array<Type>::Begin() { return m_data; }
+template<class Type, class AllocatorType>
+Type* Array<Type, AllocatorType>::Begin() { return m_data; }
 
-template<class Type>
-Type* Array<Type>::End() { return m_data + m_size; }
+template<class Type, class AllocatorType>
+Type* Array<Type, AllocatorType>::End() { return m_data + m_size; }
 
-template<class Type>
-const Type* Array<Type>::Begin() const { return m_data; }
+template<class Type, class AllocatorType>
+const Type* Array<Type, AllocatorType>::Begin() const { return m_data; }
 
-template<class Type>
-const Type* Array<Type>::End() const { return m_data + m_size; }
+template<class Type, class AllocatorType>
+const Type* Array<Type, AllocatorType>::End() const { return m_data + m_size; }
 
 
-template<class Type>
-Type& Array<Type>::PushBack()
+template<class Type, class AllocatorType>
+Type& Array<Type, AllocatorType>::PushBack()
 {
 	if (m_size == m_capacity)
 		Enlarge();
@@ -85,8 +85,8 @@ Type& Array<Type>::PushBack()
 	return m_data[m_size++];
 }
 
-template<class Type>
-Type& Array<Type>::PushBack(const Type& value)
+template<class Type, class AllocatorType>
+Type& Array<Type, AllocatorType>::PushBack(const Type& value)
 {
 	if (m_size == m_capacity)
 		Enlarge();
@@ -96,8 +96,8 @@ Type& Array<Type>::PushBack(const Type& value)
 	return m_data[m_size++];
 }
 
-template<class Type>
-Type& Array<Type>::PushBack(Type&& value)
+template<class Type, class AllocatorType>
+Type& Array<Type, AllocatorType>::PushBack(Type&& value)
 {
 	if (m_size == m_capacity)
 		Enlarge();
@@ -107,8 +107,8 @@ Type& Array<Type>::PushBack(Type&& value)
 	return m_data[m_size++];
 }
 
-template<class Type>
-Type& Array<Type>::AddOrdered(const Type& value)
+template<class Type, class AllocatorType>
+Type& Array<Type, AllocatorType>::AddOrdered(const Type& value)
 {
 	if (m_size == m_capacity)
 		Enlarge();
@@ -117,20 +117,20 @@ Type& Array<Type>::AddOrdered(const Type& value)
 	{
 		if (m_data[i] > value)
 		{
-			memory::Move(m_data + i + 1, m_data + i, (m_size - i) * sizeof(Type));
-			m_data[i] = value;
+			memory::Relocate(m_data + i + 1, m_data + i, m_size - i);
+			NEW_PLACEMENT(m_data + i, Type)(value);
 			m_size++;
 			return m_data[i];
 		}
 	}
-	m_data[m_size++] = value;
-	return m_data[m_size - 1];
+	NEW_PLACEMENT(m_data + m_size, Type)(value);
+	return m_data[m_size++];
 }
 
 
-template<class Type>
+template<class Type, class AllocatorType>
 template<class... Args>
-Type& Array<Type>::EmplaceBack(Args&&... args)
+Type& Array<Type, AllocatorType>::EmplaceBack(Args&&... args)
 {
 	if (m_size == m_capacity)
 		Enlarge();
@@ -139,8 +139,8 @@ Type& Array<Type>::EmplaceBack(Args&&... args)
 }
 
 
-template<class Type>
-Type Array<Type>::PopBack()
+template<class Type, class AllocatorType>
+Type Array<Type, AllocatorType>::PopBack()
 {
 	ASSERT(m_size > 0);
 	m_size--;
@@ -149,8 +149,8 @@ Type Array<Type>::PopBack()
 	return result;
 }
 
-template<class Type>
-bool Array<Type>::Erase(const Type& value)
+template<class Type, class AllocatorType>
+bool Array<Type, AllocatorType>::Erase(const Type& value)
 {
 	for (size_t i = 0; i < m_size; ++i)
 	{
@@ -163,32 +163,32 @@ bool Array<Type>::Erase(const Type& value)
 	return false;
 }
 
-template<class Type>
-void Array<Type>::Erase(size_t index)
+template<class Type, class AllocatorType>
+void Array<Type, AllocatorType>::Erase(size_t index)
 {
 	ASSERT2(index < m_size, "Index out of bounds");
 	DELETE_PLACEMENT(m_data + index);
 
 	m_size--;
 
-	NEW_PLACEMENT(m_data + index, Type)(Utils::Move(m_data[m_size]));
-	//DELETE_PLACEMENT(m_data + m_size);
+	if (index < m_size)
+		memory::Relocate(m_data + index, m_data + m_size, 1);
 }
 
 
-template<class Type>
-void Array<Type>::EraseOrdered(size_t index)
+template<class Type, class AllocatorType>
+void Array<Type, AllocatorType>::EraseOrdered(size_t index)
 {
 	ASSERT2(index < m_size, "Index out of bounds");
 
-	if (index < m_size - 1)
-		memory::Move(m_data + index, m_data + index + 1, (m_size - index) * sizeof(Type));
+	DELETE_PLACEMENT(m_data + index);
+	memory::Relocate(m_data + index, m_data + index + 1, m_size - index - 1);
 	m_size--;
 }
 
 
-template<class Type>
-bool Array<Type>::Find(const Type& value, size_t& index)
+template<class Type, class AllocatorType>
+bool Array<Type, AllocatorType>::Find(const Type& value, size_t& index)
 {
 	for (size_t i = 0; i < m_size; ++i)
 	{
@@ -201,8 +201,8 @@ bool Array<Type>::Find(const Type& value, size_t& index)
 	return false;
 }
 
-template<class Type>
-void Array<Type>::Swap(size_t index1, size_t index2)
+template<class Type, class AllocatorType>
+void Array<Type, AllocatorType>::Swap(size_t index1, size_t index2)
 {
 	ASSERT2(index1 < m_size, "Index 1 out of bounds");
 	ASSERT2(index2 < m_size, "Index 2 out of bounds");
@@ -215,76 +215,104 @@ void Array<Type>::Swap(size_t index1, size_t index2)
 	NEW_PLACEMENT(m_data + index2, Type)(Utils::Move(tmp));
 }
 
-template<class Type>
-const Type& Array<Type>::operator[](size_t index) const
+template<class Type, class AllocatorType>
+const Type& Array<Type, AllocatorType>::operator[](size_t index) const
 {
 	ASSERT2(index < m_size, "Index out of bounds");
 	return m_data[index];
 }
 
 
-template<class Type>
-Type& Array<Type>::operator[](size_t index)
+template<class Type, class AllocatorType>
+Type& Array<Type, AllocatorType>::operator[](size_t index)
 {
 	ASSERT2(index < m_size, "Index out of bounds");
 	return m_data[index];
 }
 
 
-template<class Type>
-void Array<Type>::Reserve(size_t capacity)
+template<class Type, class AllocatorType>
+void Array<Type, AllocatorType>::Reserve(size_t capacity)
 {
 	if (capacity <= m_capacity) return;
 
+	if (m_data != nullptr && m_allocator.TryExpand(m_data, capacity * sizeof(Type)))
+	{
+		m_capacity = capacity;
+		return;
+	}
+
 	m_capacity = capacity;
-	Type* newData = static_cast<Type*>(m_allocator.Allocate(m_capacity * sizeof(Type), alignof(Type)));
 
-	for (size_t i = 0; i < m_size; ++i)
+	//allocator can often grow block in place, otherwise it copies bytes, which is all such types need
+	if constexpr (memory::IsTriviallyRelocatable<Type>::value)
 	{
-		NEW_PLACEMENT(newData + i, Type)(Utils::Move(m_data[i]));
+		m_data = static_cast<Type*>(m_allocator.Reallocate(m_data, m_capacity * sizeof(Type), alignof(Type)));
+		ASSERT(m_data != nullptr);
+		return;
 	}
 
+	Type* newData = static_cast<Type*>(m_allocator.Allocate(m_capacity * sizeof(Type), alignof(Type)));
+	memory::Relocate(newData, m_data, m_size);
+
 	if (m_data != nullptr)
 		m_allocator.Deallocate(m_data);
 	m_data = newData;
 }
 
 
-template<class Type>
-void Array<Type>::Resize(size_t size)
+template<class Type, class AllocatorType>
+void Array<Type, AllocatorType>::Resize(size_t size)
 {
 	if (size == m_size && size == m_capacity) return;
 
-	Type* newData = static_cast<Type*>(m_allocator.Allocate(size * sizeof(Type), alignof(Type)));
+	for (size_t i = size; i < m_size; ++i)
+	{
+		DELETE_PLACEMENT(m_data + i);
+	}
 
-	size_t sizeMin = (size < m_size) ? size : m_size;
-	for (size_t i = 0; i < sizeMin; ++i)
+	if constexpr (memory::IsTriviallyRelocatable<Type>::value)
 	{
-		NEW_PLACEMENT(newData + i, Type)(Utils::Move(m_data[i]));
+		if (size == 0)
+		{
+			if (m_data != nullptr)
+				m_allocator.Deallocate(m_data);
+			m_data = nullptr;
+		}
+		else
+		{
+			m_data = static_cast<Type*>(m_allocator.Reallocate(m_data, size * sizeof(Type), alignof(Type)));
+			ASSERT(m_data != nullptr);
+		}
+		m_capacity = m_size = size;
+		return;
 	}
 
+	Type* newData = static_cast<Type*>(m_allocator.Allocate(size * sizeof(Type), alignof(Type)));
+	memory::Relocate(newData, m_data, (size < m_size) ? size : m_size);
+
 	if (m_data != nullptr)
 		m_allocator.Deallocate(m_data);
 	m_data = newData;
 	m_capacity = m_size = size;
 }
 
-template<class Type>
-void Array<Type>::Compact()
+template<class Type, class AllocatorType>
+void Array<Type, AllocatorType>::Compact()
 {
 	Resize(m_size);
 }
 
 
-template<class Type>
-size_t Array<Type>::GetSize() const { return m_size; }
+template<class Type, class AllocatorType>
+size_t Array<Type, AllocatorType>::GetSize() const { return m_size; }
 
-template<class Type>
-size_t Array<Type>::GetCapacity() const { return m_capacity; }
+template<class Type, class AllocatorType>
+size_t Array<Type, AllocatorType>::GetCapacity() const { return m_capacity; }
 
 
-template<class Type>
-void Array<Type>::Enlarge()
+template<class Type, class AllocatorType>
+void Array<Type, AllocatorType>::Enlarge()
 {
 	size_t newCapacity = (m_capacity == 0) ? INITIAL_SIZE : m_capacity * ENLARGE_MULTIPLIER;
 	Reserve(newCapacity);
@@ -294,29 +322,29 @@ void Array<Type>::Enlarge()
 // hack to make interface clear
 
 
-template<class Type>
-inline Type* begin(Array<Type>& a)
+template<class Type, class AllocatorType>
+inline Type* begin(Array<Type, AllocatorType>& a)
 {
 	return a.Begin();
 }
 
 
-template<class Type>
-inline Type* end(Array<Type>& a)
+template<class Type, class AllocatorType>
+inline Type* end(Array<Type, AllocatorType>& a)
 {
 	return a.End();
 }
 
 
-template<class Type>
-inline const Type* begin(const Array<Type>& a)
+template<class Type, class AllocatorType>
+inline const Type* begin(const Array<Type, AllocatorType>& a)
 {
 	return a.Begin();
 }
 
 
-template<class Type>
-inline const Type* end(const Array<Type>& a)
+template<class Type, class AllocatorType>
+inline const Type* end(const Array<Type, AllocatorType>& a)
 {
 	return a.End();
 }
@@ -2,14 +2,14 @@ namespace Veng
 {
 
 
-template<class KeyType, class ValueType>
-AssociativeArray<KeyType, ValueType>::AssociativeArray(Allocator& allocator)
+template<class KeyType, class ValueType, class AllocatorType>
+AssociativeArray<KeyType, ValueType, AllocatorType>::AssociativeArray(AllocatorType& allocator)
 	: m_allocator(allocator)
 {
 }
 
-template<class KeyType, class ValueType>
-AssociativeArray<KeyType, ValueType>::AssociativeArray(AssociativeArray&& other)
+template<class KeyType, class ValueType, class AllocatorType>
+AssociativeArray<KeyType, ValueType, AllocatorType>::AssociativeArray(AssociativeArray&& other)
 	: m_allocator(other.m_allocator)
 	, m_capacity(other.m_capacity)
 	, m_size(other.m_size)
@@ -22,8 +22,8 @@ AssociativeArray<KeyType, ValueType>::AssociativeArray(AssociativeArray&& other)
 	other.m_values = nullptr;
 }
 
-template<class KeyType, class ValueType>
-AssociativeArray<KeyType, ValueType>& AssociativeArray<KeyType, ValueType>::operator =(AssociativeArray&& other)
+template<class KeyType, class ValueType, class AllocatorType>
+AssociativeArray<KeyType, ValueType, AllocatorType>& AssociativeArray<KeyType, ValueType, AllocatorType>::operator =(AssociativeArray&& other)
 {
 	size_t capacity = m_capacity;
 	size_t size = m_size;
@@ -44,8 +44,8 @@ AssociativeArray<KeyType, ValueType>& AssociativeArray<KeyType, ValueType>::oper
 	return *this;
 }
 
-template<class KeyType, class ValueType>
-AssociativeArray<KeyType, ValueType>::~AssociativeArray()
+template<class KeyType, class ValueType, class AllocatorType>
+AssociativeArray<KeyType, ValueType, AllocatorType>::~AssociativeArray()
 {
 	for (size_t i = 0; i < m_size; ++i)
 	{
@@ -57,8 +57,8 @@ AssociativeArray<KeyType, ValueType>::~AssociativeArray()
 }
 
 
-template<class KeyType, class ValueType>
-void AssociativeArray<KeyType, ValueType>::Clear()
+template<class KeyType, class ValueType, class AllocatorType>
+void AssociativeArray<KeyType, ValueType, AllocatorType>::Clear()
 {
 	for (size_t i = 0; i < m_size; ++i)
 	{
@@ -68,14 +68,14 @@ void AssociativeArray<KeyType, ValueType>::Clear()
 	m_size = 0;
 }
 
-template<class KeyType, class ValueType>
-bool AssociativeArray<KeyType, ValueType>::Find(const KeyType& key, ValueType*& value) const
+template<class KeyType, class ValueType, class AllocatorType>
+bool AssociativeArray<KeyType, ValueType, AllocatorType>::Find(const KeyType& key, ValueType*& value) const
 {
 	if(m_size == 0) return false;
 
 	size_t idx = GetIndex(key);
 	//idx = (idx == 0) ? idx : idx - 1;
-	if (m_keys[idx] == key)
+	if (idx < m_size && m_keys[idx] == key)
 	{
 		value = &m_values[idx];
 		return true;
@@ -85,35 +85,29 @@ bool AssociativeArray<KeyType, ValueType>::Find(const KeyType& key, ValueType*&
 }
 
 
-template<class KeyType, class ValueType>
-ValueType* AssociativeArray<KeyType, ValueType>::Begin() { return m_values; }
+template<class KeyType, class ValueType, class AllocatorType>
+ValueType* AssociativeArray<KeyType, ValueType, AllocatorType>::Begin() { return m_values; }
 
-template<class KeyType, class ValueType>
-ValueType* AssociativeArray<KeyType, ValueType>::End() { return m_values + m_size; }
+template<class KeyType, class ValueType, class AllocatorType>
+ValueType* AssociativeArray<KeyType, ValueType, AllocatorType>::End() { return m_values + m_size; }
 
-template<class KeyType, class ValueType>
-const ValueType* AssociativeArray<KeyType, ValueType>::Begin() const { return m_values; }
+template<class KeyType, class ValueType, class AllocatorType>
+const ValueType* AssociativeArray<KeyType, ValueType, AllocatorType>::Begin() const { return m_values; }
 
-template<class KeyType, class ValueType>
-const ValueType* AssociativeArray<KeyType, ValueType>::End() const { return m_values + m_size; }
+template<class KeyType, class ValueType, class AllocatorType>
+const ValueType* AssociativeArray<KeyType, ValueType, AllocatorType>::End() const { return m_values + m_size; }
 
 
-template<class KeyType, class ValueType>
-ValueType* AssociativeArray<KeyType, ValueType>::Insert(const KeyType& key, const ValueType& value)
+template<class KeyType, class ValueType, class AllocatorType>
+ValueType* AssociativeArray<KeyType, ValueType, AllocatorType>::Insert(const KeyType& key, const ValueType& value)
 {
 	size_t idx = GetIndex(key);
-	if (m_size == 0 || m_keys[idx] != key)
+	if (idx == m_size || m_keys[idx] != key)
 	{
 		if (m_size == m_capacity) Enlarge();
 
-		for (size_t i = m_size; i > idx; --i)
-		{
-			auto& t = m_keys[i - 1];
-			NEW_PLACEMENT(m_keys + i, KeyType)(t);
-			DELETE_PLACEMENT(m_keys + i - 1);
-			NEW_PLACEMENT(m_values + i, ValueType)(m_values[i - 1]);
-			DELETE_PLACEMENT(m_values + i - 1);
-		}
+		memory::Relocate(m_keys + idx + 1, m_keys + idx, m_size - idx);
+		memory::Relocate(m_values + idx + 1, m_values + idx, m_size - idx);
 
 		++m_size;
 		NEW_PLACEMENT(m_keys + idx, KeyType)(key);
@@ -123,24 +117,88 @@ ValueType* AssociativeArray<KeyType, ValueType>::Insert(const KeyType& key, cons
 	return nullptr;
 }
 
-template<class KeyType, class ValueType>
-bool AssociativeArray<KeyType, ValueType>::Erase(const KeyType& key)
+template<class KeyType, class ValueType, class AllocatorType>
+size_t AssociativeArray<KeyType, ValueType, AllocatorType>::BulkInsert(const KeyType* keys, const ValueType* values, size_t count, bool* inserted)
+{
+	if (count == 0) return 0;
+
+	//order of batch by key, ties keep batch order so first occurrence of repeated key wins
+	size_t* order = static_cast<size_t*>(m_allocator.Allocate(count * sizeof(size_t), alignof(size_t)));
+	bool sorted = true;
+	for (size_t i = 0; i < count; ++i)
+	{
+		order[i] = i;
+		sorted = sorted && (i == 0 || keys[i - 1] < keys[i]);
+	}
+	if (!sorted)
+	{
+		Sort(order, order + count, [keys](size_t a, size_t b) {
+			return keys[a] < keys[b] || (!(keys[b] < keys[a]) && a < b);
+		});
+	}
+
+	size_t kept = 0;
+	for (size_t i = 0; i < count; ++i)
+	{
+		const KeyType& key = keys[order[i]];
+		if (kept > 0 && !(keys[order[kept - 1]] < key))
+			continue;
+		const size_t idx = GetIndex(key);
+		if (idx < m_size && m_keys[idx] == key)
+			continue;
+		order[kept++] = order[i];
+	}
+
+	if (inserted != nullptr)
+	{
+		for (size_t i = 0; i < count; ++i)
+			inserted[i] = false;
+		for (size_t i = 0; i < kept; ++i)
+			inserted[order[i]] = true;
+	}
+
+	if (m_size + kept > m_capacity)
+	{
+		const size_t enlarged = (m_capacity == 0) ? INITIAL_SIZE : m_capacity * ENLARGE_MULTIPLIER;
+		Reserve(m_size + kept > enlarged ? m_size + kept : enlarged);
+	}
+
+	//from back, elements greater than next new key move right by number of new keys still to place
+	size_t end = m_size;
+	size_t out = m_size + kept;
+	for (size_t i = kept; i > 0; --i)
+	{
+		const size_t source = order[i - 1];
+		const size_t idx = GetIndex(keys[source], end);
+		const size_t run = end - idx;
+		out -= run;
+		memory::Relocate(m_keys + out, m_keys + idx, run);
+		memory::Relocate(m_values + out, m_values + idx, run);
+		end = idx;
+
+		--out;
+		NEW_PLACEMENT(m_keys + out, KeyType)(keys[source]);
+		NEW_PLACEMENT(m_values + out, ValueType)(values[source]);
+	}
+
+	m_size += kept;
+	m_allocator.Deallocate(order);
+	return kept;
+}
+
+template<class KeyType, class ValueType, class AllocatorType>
+bool AssociativeArray<KeyType, ValueType, AllocatorType>::Erase(const KeyType& key)
 {
 	if (m_size == 0) return false;
 
 	size_t idx = GetIndex(key);
-	if (m_keys[idx] == key)
+	if (idx < m_size && m_keys[idx] == key)
 	{
 		DELETE_PLACEMENT(m_keys + idx);
 		DELETE_PLACEMENT(m_values + idx);
 
-		for (size_t i = idx; i < m_size; ++i)
-		{
-			NEW_PLACEMENT(m_keys + i, KeyType)(m_keys[i + 1]);
-			DELETE_PLACEMENT(m_keys + i + 1);
-			NEW_PLACEMENT(m_values + i, ValueType)(m_values[i + 1]);
-			DELETE_PLACEMENT(m_values + i + 1);
-		}
+		memory::Relocate(m_keys + idx, m_keys + idx + 1, m_size - idx - 1);
+		memory::Relocate(m_values + idx, m_values + idx + 1, m_size - idx - 1);
 		m_size--;
 		return true;
 	}
@@ -149,8 +207,8 @@ bool AssociativeArray<KeyType, ValueType>::Erase(const KeyType& key)
 }
 
 
-template<class KeyType, class ValueType>
-const ValueType& AssociativeArray<KeyType, ValueType>::operator[](const KeyType& key) const
+template<class KeyType, class ValueType, class AllocatorType>
+const ValueType& AssociativeArray<KeyType, ValueType, AllocatorType>::operator[](const KeyType& key) const
 {
 	ValueType* value;
 	if (Find(key, value))
@@ -164,8 +222,8 @@ const ValueType& AssociativeArray<KeyType, ValueType>::operator[](const KeyType&
 	}
 }
 
-template<class KeyType, class ValueType>
-ValueType& AssociativeArray<KeyType, ValueType>::operator[](const KeyType& key)
+template<class KeyType, class ValueType, class AllocatorType>
+ValueType& AssociativeArray<KeyType, ValueType, AllocatorType>::operator[](const KeyType& key)
 {
 	ValueType* value;
 	if (Find(key, value))
@@ -180,8 +238,8 @@ ValueType& AssociativeArray<KeyType, ValueType>::operator[](const KeyType& key)
 }
 
 
-template<class KeyType, class ValueType>
-void AssociativeArray<KeyType, ValueType>::Reserve(size_t capacity)
+template<class KeyType, class ValueType, class AllocatorType>
+void AssociativeArray<KeyType, ValueType, AllocatorType>::Reserve(size_t capacity)
 {
 	if (capacity <= m_capacity) return;
 
@@ -190,15 +248,8 @@ void AssociativeArray<KeyType, ValueType>::Reserve(size_t capacity)
 	KeyType* newKeys = static_cast<KeyType*>(data);
 	ValueType* newValues = static_cast<ValueType*>(AlignPointer(newKeys + m_capacity, alignof(ValueType)));
 
-
-
-	for (size_t i = 0; i < m_size; ++i)
-	{
-		NEW_PLACEMENT(newKeys + i, KeyType)(m_keys[i]);
-		DELETE_PLACEMENT(m_keys + i);
-		NEW_PLACEMENT(newValues + i, ValueType)(m_values[i]);
-		DELETE_PLACEMENT(m_values + i);
-	}
+	memory::Relocate(newKeys, m_keys, m_size);
+	memory::Relocate(newValues, m_values, m_size);
 
 	if (m_keys != nullptr)
 		m_allocator.Deallocate(m_keys);
@@ -207,78 +258,77 @@ void AssociativeArray<KeyType, ValueType>::Reserve(size_t capacity)
 }
 
 
-template<class KeyType, class ValueType>
-size_t AssociativeArray<KeyType, ValueType>::GetSize() const { return m_size; }
+template<class KeyType, class ValueType, class AllocatorType>
+size_t AssociativeArray<KeyType, ValueType, AllocatorType>::GetSize() const { return m_size; }
 
-template<class KeyType, class ValueType>
-size_t AssociativeArray<KeyType, ValueType>::GetCapacity() const { return m_capacity; }
+template<class KeyType, class ValueType, class AllocatorType>
+size_t AssociativeArray<KeyType, ValueType, AllocatorType>::GetCapacity() const { return m_capacity; }
 
-template<class KeyType, class ValueType>
-const KeyType* AssociativeArray<KeyType, ValueType>::GetKeys() const { return m_keys; }
+template<class KeyType, class ValueType, class AllocatorType>
+const KeyType* AssociativeArray<KeyType, ValueType, AllocatorType>::GetKeys() const { return m_keys; }
 
-template<class KeyType, class ValueType>
-const ValueType* AssociativeArray<KeyType, ValueType>::GetValues() const { return m_values; }
+template<class KeyType, class ValueType, class AllocatorType>
+const ValueType* AssociativeArray<KeyType, ValueType, AllocatorType>::GetValues() const { return m_values; }
 
 
-template<class KeyType, class ValueType>
-void AssociativeArray<KeyType, ValueType>::Enlarge()
+template<class KeyType, class ValueType, class AllocatorType>
+void AssociativeArray<KeyType, ValueType, AllocatorType>::Enlarge()
 {
 	size_t newCapacity = (m_capacity == 0) ? INITIAL_SIZE : m_capacity * ENLARGE_MULTIPLIER;
 	Reserve(newCapacity);
 }
 
-template<class KeyType, class ValueType>
-size_t AssociativeArray<KeyType, ValueType>::GetIndex(const KeyType& key) const
+template<class KeyType, class ValueType, class AllocatorType>
+size_t AssociativeArray<KeyType, ValueType, AllocatorType>::GetIndex(const KeyType& key) const
+{
+	return GetIndex(key, m_size);
+}
+
+//lower bound in first size keys; range is halved by conditional move instead of branch, so there are
+//no mispredictions and loop count depends only on size
+template<class KeyType, class ValueType, class AllocatorType>
+size_t AssociativeArray<KeyType, ValueType, AllocatorType>::GetIndex(const KeyType& key, size_t size) const
 {
-	//binary search: O(log n)
-	size_t low = 0;
-	size_t high = m_size;
-	size_t i;
-	const KeyType* mkey;
+	if (size == 0) return 0;
 
-	while (low < high)
+	const KeyType* base = m_keys;
+	while (size > 1)
 	{
-		i = (low + high) >> 1;
-		mkey = &m_keys[i];
-
-		if (*mkey < key)
-			low = i + 1;
-		else if (key < *mkey)
-			high = i;
-		else
-			return i;
+		const size_t half = size >> 1;
+		base = (base[half] < key) ? base + half : base;
+		size -= half;
 	}
 
-	return low;// (low == 0) ? low : low - 1;
+	return (size_t)(base - m_keys) + (*base < key ? 1 : 0);
 }
 
 
 // hack to make interface clear
 
 
-template<class KeyType, class ValueType>
-inline ValueType* begin(AssociativeArray<KeyType, ValueType>& a)
+template<class KeyType, class ValueType, class AllocatorType>
+inline ValueType* begin(AssociativeArray<KeyType, ValueType, AllocatorType>& a)
 {
 	return a.Begin();
 }
 
 
-template<class KeyType, class ValueType>
-inline ValueType* end(AssociativeArray<KeyType, ValueType>& a)
+template<class KeyType, class ValueType, class AllocatorType>
+inline ValueType* end(AssociativeArray<KeyType, ValueType, AllocatorType>& a)
 {
 	return a.End();
 }
 
 
-template<class KeyType, class ValueType>
-inline const ValueType* begin(const AssociativeArray<KeyType, ValueType>& a)
+template<class KeyType, class ValueType, class AllocatorType>
+inline const ValueType* begin(const AssociativeArray<KeyType, ValueType, AllocatorType>& a)
 {
 	return a.Begin();
 }
 
 
-template<class KeyType, class ValueType>
-inline const ValueType* end(const AssociativeArray<KeyType, ValueType>& a)
+template<class KeyType, class ValueType, class AllocatorType>
+inline const ValueType* end(const AssociativeArray<KeyType, ValueType, AllocatorType>& a)
 {
 	return a.End();
 }
@@ -0,0 +1,208 @@
+namespace Veng
+{
+
+
+namespace CircularBufferInternal
+{
+
+inline i64 RoundCapacity(size_t capacity)
+{
+	ASSERT2(capacity > 0, "Queue needs capacity of at least one element");
+	i64 rounded = 1;
+	while (rounded < (i64)capacity)
+		rounded <<= 1;
+	return rounded;
+}
+
+}
+
+
+// ---------------- SPSC QUEUE ----------------
+
+template<class Type, class AllocatorType>
+SPSCQueue<Type, AllocatorType>::SPSCQueue(AllocatorType& allocator, size_t capacity)
+	: m_allocator(allocator)
+{
+	const i64 rounded = CircularBufferInternal::RoundCapacity(capacity);
+	m_mask = rounded - 1;
+	m_data = static_cast<Type*>(m_allocator.Allocate(rounded * sizeof(Type), alignof(Type)));
+}
+
+template<class Type, class AllocatorType>
+SPSCQueue<Type, AllocatorType>::~SPSCQueue()
+{
+	for (i64 i = m_head; i != m_tail; ++i)
+	{
+		DELETE_PLACEMENT(m_data + (i & m_mask));
+	}
+	m_allocator.Deallocate(m_data);
+}
+
+template<class Type, class AllocatorType>
+bool SPSCQueue<Type, AllocatorType>::Push(const Type& value)
+{
+	return PushInternal(value);
+}
+
+template<class Type, class AllocatorType>
+bool SPSCQueue<Type, AllocatorType>::Push(Type&& value)
+{
+	return PushInternal(Utils::Move(value));
+}
+
+template<class Type, class AllocatorType>
+template<class ValueType>
+bool SPSCQueue<Type, AllocatorType>::PushInternal(ValueType&& value)
+{
+	const i64 tail = AtomicLoad(&m_tail, MemoryOrder::Relaxed);
+	if (tail - m_cachedHead > m_mask)
+	{
+		m_cachedHead = AtomicLoad(&m_head, MemoryOrder::Acquire);
+		if (tail - m_cachedHead > m_mask)
+			return false;
+	}
+
+	NEW_PLACEMENT(m_data + (tail & m_mask), Type)(Utils::Forward<ValueType>(value));
+	AtomicStore(&m_tail, tail + 1, MemoryOrder::Release);
+	return true;
+}
+
+template<class Type, class AllocatorType>
+bool SPSCQueue<Type, AllocatorType>::Pop(Type& value)
+{
+	const i64 head = AtomicLoad(&m_head, MemoryOrder::Relaxed);
+	if (head == m_cachedTail)
+	{
+		m_cachedTail = AtomicLoad(&m_tail, MemoryOrder::Acquire);
+		if (head == m_cachedTail)
+			return false;
+	}
+
+	Type* element = m_data + (head & m_mask);
+	value = Utils::Move(*element);
+	DELETE_PLACEMENT(element);
+	AtomicStore(&m_head, head + 1, MemoryOrder::Release);//slot can be reused only after element is moved out
+	return true;
+}
+
+template<class Type, class AllocatorType>
+size_t SPSCQueue<Type, AllocatorType>::GetCapacity() const
+{
+	return (size_t)(m_mask + 1);
+}
+
+
+// ---------------- MPMC QUEUE ----------------
+
+//every cell has sequence number telling which lap of producers or consumers may use it next
+template<class Type, class AllocatorType>
+MPMCQueue<Type, AllocatorType>::MPMCQueue(AllocatorType& allocator, size_t capacity)
+	: m_allocator(allocator)
+{
+	const i64 rounded = CircularBufferInternal::RoundCapacity(capacity);
+	m_mask = rounded - 1;
+	m_cells = static_cast<Cell*>(m_allocator.Allocate(rounded * sizeof(Cell), alignof(Cell)));
+	for (i64 i = 0; i < rounded; ++i)
+		m_cells[i].sequence = i;
+}
+
+template<class Type, class AllocatorType>
+MPMCQueue<Type, AllocatorType>::~MPMCQueue()
+{
+	for (i64 i = m_dequeuePos; i != m_enqueuePos; ++i)
+	{
+		DELETE_PLACEMENT(&m_cells[i & m_mask].value);
+	}
+	m_allocator.Deallocate(m_cells);
+}
+
+template<class Type, class AllocatorType>
+bool MPMCQueue<Type, AllocatorType>::Push(const Type& value)
+{
+	return PushInternal(value);
+}
+
+template<class Type, class AllocatorType>
+bool MPMCQueue<Type, AllocatorType>::Push(Type&& value)
+{
+	return PushInternal(Utils::Move(value));
+}
+
+template<class Type, class AllocatorType>
+template<class ValueType>
+bool MPMCQueue<Type, AllocatorType>::PushInternal(ValueType&& value)
+{
+	i64 pos = AtomicLoad(&m_enqueuePos, MemoryOrder::Relaxed);
+	Cell* cell;
+	for (;;)
+	{
+		cell = &m_cells[pos & m_mask];
+		const i64 diff = AtomicLoad(&cell->sequence, MemoryOrder::Acquire) - pos;
+		if (diff == 0)
+		{
+			const i64 current = AtomicCompareExchange64(&m_enqueuePos, pos + 1, pos);
+			if (current == pos)
+				break;
+			pos = current;
+		}
+		else if (diff < 0)
+		{
+			return false;//cell still holds value from previous lap
+		}
+		else
+		{
+			pos = AtomicLoad(&m_enqueuePos, MemoryOrder::Relaxed);
+		}
+	}
+
+	NEW_PLACEMENT(&cell->value, Type)(Utils::Forward<ValueType>(value));
+	AtomicStore(&cell->sequence, pos + 1, MemoryOrder::Release);
+	return true;
+}
+
+template<class Type, class AllocatorType>
+bool MPMCQueue<Type, AllocatorType>::Pop(Type& value)
+{
+	i64 pos = AtomicLoad(&m_dequeuePos, MemoryOrder::Relaxed);
+	Cell* cell;
+	for (;;)
+	{
+		cell = &m_cells[pos & m_mask];
+		const i64 diff = AtomicLoad(&cell->sequence, MemoryOrder::Acquire) - (pos + 1);
+		if (diff == 0)
+		{
+			const i64 current = AtomicCompareExchange64(&m_dequeuePos, pos + 1, pos);
+			if (current == pos)
+				break;
+			pos = current;
+		}
+		else if (diff < 0)
+		{
+			return false;//producer of this lap hasn't finished yet
+		}
+		else
+		{
+			pos = AtomicLoad(&m_dequeuePos, MemoryOrder::Relaxed);
+		}
+	}
+
+	value = Utils::Move(cell->value);
+	DELETE_PLACEMENT(&cell->value);
+	AtomicStore(&cell->sequence, pos + m_mask + 1, MemoryOrder::Release);//free for producers of next lap
+	return true;
+}
+
+template<class Type, class AllocatorType>
+bool MPMCQueue<Type, AllocatorType>::IsEmpty() const
+{
+	return AtomicLoad(&m_dequeuePos, MemoryOrder::Relaxed) >= AtomicLoad(&m_enqueuePos, MemoryOrder::Relaxed);
+}
+
+template<class Type, class AllocatorType>
+size_t MPMCQueue<Type, AllocatorType>::GetCapacity() const
+{
+	return (size_t)(m_mask + 1);
+}
+
+
+}
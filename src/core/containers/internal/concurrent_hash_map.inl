@@ -0,0 +1,366 @@
+#include "core/threading/os_utils.h"
+
+
+namespace Veng
+{
+
+
+template<class KeyType, class ValueType, class Hasher, class AllocatorType>
+ConcurrentHashMap<KeyType, ValueType, Hasher, AllocatorType>::Node::Node(const KeyType& key, const ValueType& value, u32 hash, Node* next)
+	: key(key)
+	, value(value)
+	, next(next)
+	, hash(hash)
+{}
+
+
+template<class KeyType, class ValueType, class Hasher, class AllocatorType>
+ConcurrentHashMap<KeyType, ValueType, Hasher, AllocatorType>::ConcurrentHashMap(AllocatorType& allocator)
+	: m_allocator(allocator)
+{
+	m_table = CreateTable(INITIAL_BUCKETS);
+	for (i64& sequence : m_sealedSequences)
+		sequence = 0;
+}
+
+
+template<class KeyType, class ValueType, class Hasher, class AllocatorType>
+ConcurrentHashMap<KeyType, ValueType, Hasher, AllocatorType>::~ConcurrentHashMap()
+{
+	DestroyRetired(m_retired);
+	DestroyRetired(m_sealed);
+	DestroyChains(m_table);
+	m_allocator.Deallocate(m_table);
+}
+
+
+template<class KeyType, class ValueType, class Hasher, class AllocatorType>
+bool ConcurrentHashMap<KeyType, ValueType, Hasher, AllocatorType>::Find(const KeyType& key, ValueType& value) const
+{
+	const u32 hash = Hasher::get(key);
+
+	//locked add is full barrier, table can't be read before sequence is odd; only this thread writes
+	//its sequence, so leaving needs just release store
+	volatile i64* sequence = &m_readers[GetThreadIndex()].value;
+	const i64 entered = AtomicAdd(sequence, (i64)1) + 1;
+
+	const Node* node = FindNode(LoadTable(), key, hash);
+	if (node != nullptr)
+		value = node->value;
+
+	AtomicStore(sequence, entered + 1, MemoryOrder::Release);
+	return node != nullptr;
+}
+
+
+template<class KeyType, class ValueType, class Hasher, class AllocatorType>
+bool ConcurrentHashMap<KeyType, ValueType, Hasher, AllocatorType>::Contains(const KeyType& key) const
+{
+	const u32 hash = Hasher::get(key);
+
+	volatile i64* sequence = &m_readers[GetThreadIndex()].value;
+	const i64 entered = AtomicAdd(sequence, (i64)1) + 1;
+	const bool found = FindNode(LoadTable(), key, hash) != nullptr;
+	AtomicStore(sequence, entered + 1, MemoryOrder::Release);
+	return found;
+}
+
+
+template<class KeyType, class ValueType, class Hasher, class AllocatorType>
+bool ConcurrentHashMap<KeyType, ValueType, Hasher, AllocatorType>::Insert(const KeyType& key, const ValueType& value)
+{
+	const u32 hash = Hasher::get(key);
+	Stripe& stripe = m_stripes[hash & (STRIPE_COUNT - 1)];
+
+	//table is swapped only with all stripes held, it can't change under stripe lock
+	stripe.mutex.Lock();
+	Table* table = m_table;
+	if (FindNode(table, key, hash) != nullptr)
+	{
+		stripe.mutex.Unlock();
+		return false;
+	}
+
+	//node is complete before release store makes it reachable
+	Node* volatile* bucket = &table->buckets[hash & table->mask];
+	Node* node = NEW_OBJECT(m_allocator, Node)(key, value, hash, *bucket);
+	StoreNext(bucket, node);
+	const u32 bucketCount = table->mask + 1;
+	stripe.mutex.Unlock();
+
+	const i64 size = AtomicAdd(&m_size, (i64)1) + 1;
+	if (size > (i64)bucketCount * MAX_LOAD)
+		Grow(bucketCount * 2);
+
+	return true;
+}
+
+
+template<class KeyType, class ValueType, class Hasher, class AllocatorType>
+bool ConcurrentHashMap<KeyType, ValueType, Hasher, AllocatorType>::Erase(const KeyType& key)
+{
+	const u32 hash = Hasher::get(key);
+	Stripe& stripe = m_stripes[hash & (STRIPE_COUNT - 1)];
+
+	stripe.mutex.Lock();
+	Table* table = m_table;
+	Node* volatile* link = &table->buckets[hash & table->mask];
+	Node* node = *link;
+	while (node != nullptr && !(node->hash == hash && node->key == key))
+	{
+		link = &node->next;
+		node = *link;
+	}
+
+	if (node == nullptr)
+	{
+		stripe.mutex.Unlock();
+		return false;
+	}
+
+	//readers standing on node still see rest of chain through its next
+	StoreNext(link, node->next);
+	stripe.mutex.Unlock();
+	AtomicAdd(&m_size, (i64)-1);
+
+	Retire(node);
+	return true;
+}
+
+
+template<class KeyType, class ValueType, class Hasher, class AllocatorType>
+void ConcurrentHashMap<KeyType, ValueType, Hasher, AllocatorType>::Clear()
+{
+	Table* empty = CreateTable(INITIAL_BUCKETS);
+
+	LockAll();
+	Table* old = m_table;
+	AtomicStore(reinterpret_cast<void* volatile*>(&m_table), empty, MemoryOrder::Release);
+	AtomicStore(&m_size, (i64)0, MemoryOrder::Relaxed);
+	UnlockAll();
+
+	Synchronize();
+	DestroyChains(old);
+	m_allocator.Deallocate(old);
+}
+
+
+template<class KeyType, class ValueType, class Hasher, class AllocatorType>
+template<class Function>
+void ConcurrentHashMap<KeyType, ValueType, Hasher, AllocatorType>::ForEach(Function function) const
+{
+	LockAll();
+	const Table* table = m_table;
+	for (u32 i = 0; i <= table->mask; ++i)
+	{
+		for (const Node* node = table->buckets[i]; node != nullptr; node = node->next)
+			function(node->key, node->value);
+	}
+	UnlockAll();
+}
+
+
+template<class KeyType, class ValueType, class Hasher, class AllocatorType>
+size_t ConcurrentHashMap<KeyType, ValueType, Hasher, AllocatorType>::GetSize() const
+{
+	return (size_t)AtomicLoad(&m_size, MemoryOrder::Relaxed);
+}
+
+
+template<class KeyType, class ValueType, class Hasher, class AllocatorType>
+typename ConcurrentHashMap<KeyType, ValueType, Hasher, AllocatorType>::Node*
+ConcurrentHashMap<KeyType, ValueType, Hasher, AllocatorType>::LoadNext(Node* const volatile* next)
+{
+	return static_cast<Node*>(AtomicLoad(reinterpret_cast<void* const volatile*>(next), MemoryOrder::Acquire));
+}
+
+
+template<class KeyType, class ValueType, class Hasher, class AllocatorType>
+void ConcurrentHashMap<KeyType, ValueType, Hasher, AllocatorType>::StoreNext(Node* volatile* next, Node* node)
+{
+	AtomicStore(reinterpret_cast<void* volatile*>(next), node, MemoryOrder::Release);
+}
+
+
+template<class KeyType, class ValueType, class Hasher, class AllocatorType>
+typename ConcurrentHashMap<KeyType, ValueType, Hasher, AllocatorType>::Table*
+ConcurrentHashMap<KeyType, ValueType, Hasher, AllocatorType>::LoadTable() const
+{
+	return static_cast<Table*>(AtomicLoad(reinterpret_cast<void* const volatile*>(&m_table), MemoryOrder::Acquire));
+}
+
+
+//buckets are placed right after table header in one allocation
+template<class KeyType, class ValueType, class Hasher, class AllocatorType>
+typename ConcurrentHashMap<KeyType, ValueType, Hasher, AllocatorType>::Table*
+ConcurrentHashMap<KeyType, ValueType, Hasher, AllocatorType>::CreateTable(u32 bucketCount)
+{
+	ASSERT(bucketCount >= STRIPE_COUNT && (bucketCount & (bucketCount - 1)) == 0);
+	void* memory = m_allocator.Allocate(sizeof(Table) + bucketCount * sizeof(Node*), alignof(Table));
+	Table* table = static_cast<Table*>(memory);
+	table->buckets = reinterpret_cast<Node* volatile*>(table + 1);
+	table->mask = bucketCount - 1;
+	for (u32 i = 0; i < bucketCount; ++i)
+		table->buckets[i] = nullptr;
+	return table;
+}
+
+
+template<class KeyType, class ValueType, class Hasher, class AllocatorType>
+typename ConcurrentHashMap<KeyType, ValueType, Hasher, AllocatorType>::Node*
+ConcurrentHashMap<KeyType, ValueType, Hasher, AllocatorType>::FindNode(const Table* table, const KeyType& key, u32 hash) const
+{
+	Node* node = LoadNext(&table->buckets[hash & table->mask]);
+	while (node != nullptr)
+	{
+		if (node->hash == hash && node->key == key)
+			return node;
+		node = LoadNext(&node->next);
+	}
+	return nullptr;
+}
+
+
+//always in same order, so two threads locking all stripes can't deadlock
+template<class KeyType, class ValueType, class Hasher, class AllocatorType>
+void ConcurrentHashMap<KeyType, ValueType, Hasher, AllocatorType>::LockAll() const
+{
+	for (Stripe& stripe : m_stripes)
+		stripe.mutex.Lock();
+}
+
+
+template<class KeyType, class ValueType, class Hasher, class AllocatorType>
+void ConcurrentHashMap<KeyType, ValueType, Hasher, AllocatorType>::UnlockAll() const
+{
+	for (i32 i = STRIPE_COUNT - 1; i >= 0; --i)
+		m_stripes[i].mutex.Unlock();
+}
+
+
+//old chains stay intact for readers which still walk them, new table gets its own copies of nodes
+template<class KeyType, class ValueType, class Hasher, class AllocatorType>
+void ConcurrentHashMap<KeyType, ValueType, Hasher, AllocatorType>::Grow(u32 bucketCount)
+{
+	LockAll();
+	Table* old = m_table;
+	if (old->mask + 1 >= bucketCount)
+	{
+		UnlockAll();//other thread grew it first
+		return;
+	}
+
+	Table* table = CreateTable(bucketCount);
+	for (u32 i = 0; i <= old->mask; ++i)
+	{
+		for (Node* node = old->buckets[i]; node != nullptr; node = node->next)
+		{
+			Node* volatile* bucket = &table->buckets[node->hash & table->mask];
+			*bucket = NEW_OBJECT(m_allocator, Node)(node->key, node->value, node->hash, *bucket);
+		}
+	}
+	AtomicStore(reinterpret_cast<void* volatile*>(&m_table), table, MemoryOrder::Release);
+	UnlockAll();
+
+	Synchronize();
+	DestroyChains(old);
+	m_allocator.Deallocate(old);
+}
+
+
+template<class KeyType, class ValueType, class Hasher, class AllocatorType>
+void ConcurrentHashMap<KeyType, ValueType, Hasher, AllocatorType>::Synchronize() const
+{
+	i64 sequences[MAX_THREADS];
+	SnapshotReaders(sequences);
+	WaitForReaders(sequences);
+}
+
+
+//fence keeps unlink from being reordered after sequence loads
+template<class KeyType, class ValueType, class Hasher, class AllocatorType>
+void ConcurrentHashMap<KeyType, ValueType, Hasher, AllocatorType>::SnapshotReaders(i64* sequences) const
+{
+	MemoryFence();
+	for (u32 i = 0; i < MAX_THREADS; ++i)
+		sequences[i] = AtomicLoad(&m_readers[i].value, MemoryOrder::Acquire);
+}
+
+
+//reader which was outside when memory got unlinked can't reach it anymore, so it's enough to wait
+//until every reader seen inside leaves once; reader can be preempted inside, so spinning turns into yielding
+template<class KeyType, class ValueType, class Hasher, class AllocatorType>
+void ConcurrentHashMap<KeyType, ValueType, Hasher, AllocatorType>::WaitForReaders(const i64* sequences) const
+{
+	for (u32 i = 0; i < MAX_THREADS; ++i)
+	{
+		if ((sequences[i] & 1) == 0)
+			continue;
+
+		u32 spins = 0;
+		while (AtomicLoad(&m_readers[i].value, MemoryOrder::Acquire) == sequences[i])
+		{
+			if (++spins < SPIN_COUNT)
+				CpuRelax();
+			else
+				YieldThread();
+		}
+	}
+}
+
+
+//full batch is sealed with snapshot of readers and freed only when next one fills up, readers are
+//long gone by then, so erase almost never has to wait
+template<class KeyType, class ValueType, class Hasher, class AllocatorType>
+void ConcurrentHashMap<KeyType, ValueType, Hasher, AllocatorType>::Retire(Node* node)
+{
+	m_retiredMutex.Lock();
+	node->retired = m_retired;
+	m_retired = node;
+	if (++m_retiredCount < RETIRE_BATCH)
+	{
+		m_retiredMutex.Unlock();
+		return;
+	}
+
+	WaitForReaders(m_sealedSequences);
+	Node* sealed = m_sealed;
+	m_sealed = m_retired;
+	SnapshotReaders(m_sealedSequences);
+	m_retired = nullptr;
+	m_retiredCount = 0;
+	m_retiredMutex.Unlock();
+
+	DestroyRetired(sealed);
+}
+
+
+template<class KeyType, class ValueType, class Hasher, class AllocatorType>
+void ConcurrentHashMap<KeyType, ValueType, Hasher, AllocatorType>::DestroyRetired(Node* node)
+{
+	while (node != nullptr)
+	{
+		Node* next = node->retired;
+		DELETE_OBJECT(m_allocator, node);
+		node = next;
+	}
+}
+
+
+template<class KeyType, class ValueType, class Hasher, class AllocatorType>
+void ConcurrentHashMap<KeyType, ValueType, Hasher, AllocatorType>::DestroyChains(Table* table)
+{
+	for (u32 i = 0; i <= table->mask; ++i)
+	{
+		Node* node = table->buckets[i];
+		while (node != nullptr)
+		{
+			Node* next = node->next;
+			DELETE_OBJECT(m_allocator, node);
+			node = next;
+		}
+	}
+}
+
+
+}
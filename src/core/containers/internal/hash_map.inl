@@ -1,325 +1,380 @@
+#if defined(_M_X64) || defined(_M_IX86) || defined(__SSE2__)
+	#include <emmintrin.h>
+	#define HASH_MAP_SSE2 1
+#else
+	#define HASH_MAP_SSE2 0
+#endif
+
 
 namespace Veng
 {
 
 
-template<class KeyType, class ValueType, class Hasher>
-HashMap<KeyType, ValueType, Hasher>::HashNode::HashNode(const KeyType& key, const ValueType& value)
-	: key(key)
-	, value(value)
-	, next(INVALID_INDEX)
-{}
+namespace HashMapInternal
+{
 
-template<class KeyType, class ValueType, class Hasher>
-HashMap<KeyType, ValueType, Hasher>::HashNode::HashNode(const KeyType& key, const ValueType& value, int next)
-	: key(key)
-	, value(value)
-	, next(next)
-{}
 
-template<class KeyType, class ValueType, class Hasher>
-HashMap<KeyType, ValueType, Hasher>::HashNode::HashNode(HashNode&& other)
-	: key(other.key)
-	, value(other.value)
-	, next(other.next)
+//bit i is set when control byte i of group equals value
+inline u32 MatchGroup(const i8* group, i8 value)
 {
-	other.next = INVALID_INDEX;
+#if HASH_MAP_SSE2
+	const __m128i control = _mm_load_si128(reinterpret_cast<const __m128i*>(group));
+	return (u32)_mm_movemask_epi8(_mm_cmpeq_epi8(control, _mm_set1_epi8(value)));
+#else
+	u32 mask = 0;
+	for (u32 i = 0; i < 16; ++i)
+		mask |= (group[i] == value) ? (1U << i) : 0;
+	return mask;
+#endif
 }
 
-template<class KeyType, class ValueType, class Hasher>
-typename HashMap<KeyType, ValueType, Hasher>::HashNode& HashMap<KeyType, ValueType, Hasher>::HashNode::operator=(typename HashMap<KeyType, ValueType, Hasher>::HashNode&& other)
+//empty and erased control bytes are the only negative ones
+inline u32 MatchGroupFree(const i8* group)
 {
-	KeyType k = key;
-	ValueType v = value;
+#if HASH_MAP_SSE2
+	return (u32)_mm_movemask_epi8(_mm_load_si128(reinterpret_cast<const __m128i*>(group)));
+#else
+	u32 mask = 0;
+	for (u32 i = 0; i < 16; ++i)
+		mask |= (group[i] < 0) ? (1U << i) : 0;
+	return mask;
+#endif
+}
+
 
-	key = other.key;
-	value = other.value;
-	next = other.next;
+}
+
+
+template<class KeyType, class ValueType, class Hasher, class AllocatorType>
+HashMap<KeyType, ValueType, Hasher, AllocatorType>::HashNode::HashNode(const KeyType& key, const ValueType& value)
+	: key(key)
+	, value(value)
+{}
 
-	other.key = k;
-	other.value = v;
-	other.next = INVALID_INDEX;
+template<class KeyType, class ValueType, class Hasher, class AllocatorType>
+HashMap<KeyType, ValueType, Hasher, AllocatorType>::HashNode::HashNode(HashNode&& other)
+	: key(Utils::Move(other.key))
+	, value(Utils::Move(other.value))
+{}
 
+template<class KeyType, class ValueType, class Hasher, class AllocatorType>
+typename HashMap<KeyType, ValueType, Hasher, AllocatorType>::HashNode& HashMap<KeyType, ValueType, Hasher, AllocatorType>::HashNode::operator=(HashNode&& other)
+{
+	key = Utils::Move(other.key);
+	value = Utils::Move(other.value);
 	return *this;
 }
 
 
-template<class KeyType, class ValueType, class Hasher>
-HashMap<KeyType, ValueType, Hasher>::HashMap(Allocator& allocator)
+template<class KeyType, class ValueType, class Hasher, class AllocatorType>
+HashMap<KeyType, ValueType, Hasher, AllocatorType>::HashMap(AllocatorType& allocator)
 	: m_allocator(allocator)
 {}
 
-template<class KeyType, class ValueType, class Hasher>
-HashMap<KeyType, ValueType, Hasher>::HashMap(HashMap<KeyType, ValueType, Hasher>&& other)
+template<class KeyType, class ValueType, class Hasher, class AllocatorType>
+HashMap<KeyType, ValueType, Hasher, AllocatorType>::HashMap(HashMap<KeyType, ValueType, Hasher, AllocatorType>&& other)
 	: m_allocator(other.m_allocator)
-	, m_buckets(other.m_buckets)
-	, m_bucketSize(other.m_bucketSize)
+	, m_groups(other.m_groups)
+	, m_nodeSlots(other.m_nodeSlots)
 	, m_table(other.m_table)
+	, m_slotCount(other.m_slotCount)
 	, m_size(other.m_size)
+	, m_erased(other.m_erased)
 {
-	other.m_buckets = nullptr;
-	other.m_bucketSize = 0;
+	other.m_groups = nullptr;
+	other.m_nodeSlots = nullptr;
 	other.m_table = nullptr;
+	other.m_slotCount = 0;
 	other.m_size = 0;
+	other.m_erased = 0;
 }
 
-template<class KeyType, class ValueType, class Hasher>
-HashMap<KeyType, ValueType, Hasher>& HashMap<KeyType, ValueType, Hasher>::operator=(HashMap<KeyType, ValueType, Hasher>&& other)
+template<class KeyType, class ValueType, class Hasher, class AllocatorType>
+HashMap<KeyType, ValueType, Hasher, AllocatorType>& HashMap<KeyType, ValueType, Hasher, AllocatorType>::operator=(HashMap<KeyType, ValueType, Hasher, AllocatorType>&& other)
 {
-	int* buckets = m_buckets;
-	unsigned bucketSize = m_bucketSize;
+	Group* groups = m_groups;
+	u32* nodeSlots = m_nodeSlots;
 	HashNode* table = m_table;
+	unsigned slotCount = m_slotCount;
 	unsigned size = m_size;
+	unsigned erased = m_erased;
 
 	m_allocator = other.m_allocator;
-	m_buckets = other.m_buckets;
-	m_bucketSize = other.m_bucketSize;
+	m_groups = other.m_groups;
+	m_nodeSlots = other.m_nodeSlots;
 	m_table = other.m_table;
+	m_slotCount = other.m_slotCount;
 	m_size = other.m_size;
+	m_erased = other.m_erased;
 
-	other.m_buckets = buckets;
-	other.m_bucketSize = bucketSize;
+	other.m_groups = groups;
+	other.m_nodeSlots = nodeSlots;
 	other.m_table = table;
+	other.m_slotCount = slotCount;
 	other.m_size = size;
+	other.m_erased = erased;
 
 	return *this;
 }
 
-template<class KeyType, class ValueType, class Hasher>
-HashMap<KeyType, ValueType, Hasher>::~HashMap()
+template<class KeyType, class ValueType, class Hasher, class AllocatorType>
+HashMap<KeyType, ValueType, Hasher, AllocatorType>::~HashMap()
 {
 	for (unsigned i = 0; i < m_size; ++i)
 	{
 		DELETE_PLACEMENT(m_table + i);
 	}
-	if (m_buckets != nullptr)
-		m_allocator.Deallocate(m_buckets);
+	if (m_groups != nullptr)
+		m_allocator.Deallocate(m_groups);
 }
 
 
-template<class KeyType, class ValueType, class Hasher>
-void HashMap<KeyType, ValueType, Hasher>::Clear()
+template<class KeyType, class ValueType, class Hasher, class AllocatorType>
+void HashMap<KeyType, ValueType, Hasher, AllocatorType>::Clear()
 {
-	for (unsigned i = 0; i < m_bucketSize; ++i)
-	{
-		m_buckets[i] = INVALID_INDEX;
-	}
 	for (unsigned i = 0; i < m_size; ++i)
 	{
 		DELETE_PLACEMENT(m_table + i);
 	}
+	for (unsigned i = 0; i < m_slotCount / GROUP_SIZE; ++i)
+		memory::Set(m_groups[i].control, (u8)CONTROL_EMPTY, GROUP_SIZE);
 	m_size = 0;
+	m_erased = 0;
 }
 
 
-template<class KeyType, class ValueType, class Hasher>
-typename HashMap<KeyType, ValueType, Hasher>::HashNode* HashMap<KeyType, ValueType, Hasher>::Begin() { return m_table; }
+template<class KeyType, class ValueType, class Hasher, class AllocatorType>
+typename HashMap<KeyType, ValueType, Hasher, AllocatorType>::HashNode* HashMap<KeyType, ValueType, Hasher, AllocatorType>::Begin() { return m_table; }
 
-template<class KeyType, class ValueType, class Hasher>
-typename HashMap<KeyType, ValueType, Hasher>::HashNode* HashMap<KeyType, ValueType, Hasher>::End() { return m_table + m_size; }
+template<class KeyType, class ValueType, class Hasher, class AllocatorType>
+typename HashMap<KeyType, ValueType, Hasher, AllocatorType>::HashNode* HashMap<KeyType, ValueType, Hasher, AllocatorType>::End() { return m_table + m_size; }
 
-template<class KeyType, class ValueType, class Hasher>
-typename const HashMap<KeyType, ValueType, Hasher>::HashNode* HashMap<KeyType, ValueType, Hasher>::Begin() const { return m_table; }
+template<class KeyType, class ValueType, class Hasher, class AllocatorType>
+const typename HashMap<KeyType, ValueType, Hasher, AllocatorType>::HashNode* HashMap<KeyType, ValueType, Hasher, AllocatorType>::Begin() const { return m_table; }
 
-template<class KeyType, class ValueType, class Hasher>
-typename const HashMap<KeyType, ValueType, Hasher>::HashNode* HashMap<KeyType, ValueType, Hasher>::End() const { return m_table + m_size; }
+template<class KeyType, class ValueType, class Hasher, class AllocatorType>
+const typename HashMap<KeyType, ValueType, Hasher, AllocatorType>::HashNode* HashMap<KeyType, ValueType, Hasher, AllocatorType>::End() const { return m_table + m_size; }
 
 
-template<class KeyType, class ValueType, class Hasher>
-bool HashMap<KeyType, ValueType, Hasher>::Find(const KeyType& key, ValueType*& value) const
+template<class KeyType, class ValueType, class Hasher, class AllocatorType>
+bool HashMap<KeyType, ValueType, Hasher, AllocatorType>::Find(const KeyType& key, ValueType*& value) const
 {
 	if (m_size == 0)
 		return false;
 
-	unsigned bucketIdx = GetIndex(key);
-
-	if (m_buckets[bucketIdx] == INVALID_INDEX)
+	const unsigned slot = FindSlot(key, Hasher::get(key));
+	if (slot == (unsigned)INVALID_INDEX)
 		return false;
 
-	HashNode* node = &m_table[m_buckets[bucketIdx]];
-	while (node->next != INVALID_INDEX && node->key != key)
-	{
-		node = &m_table[node->next];
-	}
-
-	if (node->key == key)
-	{
-		value = &node->value;
-		return true;
-	}
-	else
-	{
-		return false;
-	}
+	value = &m_table[m_groups[slot / GROUP_SIZE].slots[slot % GROUP_SIZE]].value;
+	return true;
 }
 
 
-template<class KeyType, class ValueType, class Hasher>
-ValueType* HashMap<KeyType, ValueType, Hasher>::Insert(const KeyType& key, const ValueType& value)
+template<class KeyType, class ValueType, class Hasher, class AllocatorType>
+ValueType* HashMap<KeyType, ValueType, Hasher, AllocatorType>::Insert(const KeyType& key, const ValueType& value)
 {
-	if (m_bucketSize == 0)
-		Rehash(INITIAL_SIZE);
-	if ((m_size / (float)m_bucketSize) * 100 > MAX_FACTOR)
-		Rehash(m_bucketSize * ENLARGE_MULTIPLIER);
+	if (m_slotCount == 0)
+		Rebuild(INITIAL_SIZE);
+
+	const u32 hash = Hasher::get(key);
+	if (FindSlot(key, hash) != (unsigned)INVALID_INDEX)
+		return nullptr;
 
-	unsigned bucketIdx = GetIndex(key);
-	return Insert(bucketIdx, key, value);
+	//erased slots count as full, so probing always reaches empty one; when they make up most of load,
+	//rebuild in place is enough
+	if (m_size + m_erased >= GetMaxLoad(m_slotCount))
+		Rebuild(m_size >= GetMaxLoad(m_slotCount) / 2 ? m_slotCount * ENLARGE_MULTIPLIER : m_slotCount);
+
+	const unsigned slot = FindFreeSlot(hash);
+	Group& group = m_groups[slot / GROUP_SIZE];
+	if (group.control[slot % GROUP_SIZE] == CONTROL_ERASED)
+		--m_erased;
+	group.control[slot % GROUP_SIZE] = GetControl(hash);
+	group.slots[slot % GROUP_SIZE] = m_size;
+	m_nodeSlots[m_size] = slot;
+
+	HashNode* node = NEW_PLACEMENT(m_table + m_size, HashNode)(key, value);
+	++m_size;
+	return &node->value;
 }
 
-template<class KeyType, class ValueType, class Hasher>
-bool HashMap<KeyType, ValueType, Hasher>::Erase(const KeyType& key)
+template<class KeyType, class ValueType, class Hasher, class AllocatorType>
+bool HashMap<KeyType, ValueType, Hasher, AllocatorType>::Erase(const KeyType& key)
 {
-	unsigned bucketIdx = GetIndex(key);
+	if (m_size == 0)
+		return false;
 
-	if (m_buckets[bucketIdx] == INVALID_INDEX)
+	const unsigned slot = FindSlot(key, Hasher::get(key));
+	if (slot == (unsigned)INVALID_INDEX)
 		return false;
 
-	int* pointingIdx = &m_buckets[bucketIdx];
-	HashNode* node = &m_table[*pointingIdx];
-	while (node->next != INVALID_INDEX && node->key != key)
+	//probing stops at group with empty slot, so if there is one no probe went past this group
+	Group& group = m_groups[slot / GROUP_SIZE];
+	if (HashMapInternal::MatchGroup(group.control, CONTROL_EMPTY) != 0)
 	{
-		pointingIdx = &node->next;
-		node = &m_table[node->next];
+		group.control[slot % GROUP_SIZE] = CONTROL_EMPTY;
+	}
+	else
+	{
+		group.control[slot % GROUP_SIZE] = CONTROL_ERASED;
+		++m_erased;
 	}
 
-	if (node->key != key)
-		return false;
-
-	int freeNodeIdx = *pointingIdx;
-	*pointingIdx = node->next;
-
-	DELETE_PLACEMENT(node);
-	m_size--;
+	const u32 index = group.slots[slot % GROUP_SIZE];
+	DELETE_PLACEMENT(m_table + index);
+	--m_size;
 
-	if(m_size > 0 && freeNodeIdx != m_size)
+	if (index != m_size)
 	{
-		//fill up hole in m_table
+		//fill up hole in m_table, moved node's slot is known so no key is hashed or compared
 		HashNode& lastNode = m_table[m_size];
-		unsigned lastNodeBucketIdx = GetIndex(lastNode.key);
-		pointingIdx = &m_buckets[lastNodeBucketIdx];
-		while(m_table[*pointingIdx].key != lastNode.key)
-		{
-			pointingIdx = &(m_table[*pointingIdx].next);
-		}
-
-		*pointingIdx = freeNodeIdx;
-
-		NEW_PLACEMENT(node, HashNode)(Utils::Move(lastNode));
-		//DELETE_PLACEMENT(&lastNode);
+		const u32 lastSlot = m_nodeSlots[m_size];
+		m_groups[lastSlot / GROUP_SIZE].slots[lastSlot % GROUP_SIZE] = index;
+		m_nodeSlots[index] = lastSlot;
+		NEW_PLACEMENT(m_table + index, HashNode)(Utils::Move(lastNode));
+		DELETE_PLACEMENT(&lastNode);
 	}
 
 	return true;
 }
 
 
-template<class KeyType, class ValueType, class Hasher>
-void HashMap<KeyType, ValueType, Hasher>::Rehash(unsigned bucketSize)
+template<class KeyType, class ValueType, class Hasher, class AllocatorType>
+void HashMap<KeyType, ValueType, Hasher, AllocatorType>::Rehash(unsigned bucketSize)
 {
-	ASSERT(bucketSize > m_bucketSize);
-
-	int* oldBuckets = m_buckets;
-	unsigned oldBucketSize = m_bucketSize;
-	HashNode* oldTable = m_table;
-	unsigned oldSize = m_size;
-
-	m_bucketSize = bucketSize;
-	m_size = 0;
-	void* data = m_allocator.Allocate(bucketSize * (sizeof(int) + sizeof(HashNode)) + alignof(HashNode), alignof(int));
-	m_buckets = static_cast<int*>(data);
-	m_table = static_cast<HashNode*>(AlignPointer(m_buckets + bucketSize, alignof(HashNode)));
-
-	for (unsigned i = 0; i < m_bucketSize; ++i)
-	{
-		m_buckets[i] = INVALID_INDEX;
-	}
-	for (unsigned i = 0; i < oldSize; ++i)
-	{
-		HashNode& node = oldTable[i];
-		unsigned idx = GetIndex(node.key);
-		Insert(idx, node.key, node.value);
-	}
-
-	if (oldBuckets != nullptr)
-		m_allocator.Deallocate(oldBuckets);
+	unsigned slotCount = INITIAL_SIZE;
+	while (slotCount < bucketSize || GetMaxLoad(slotCount) <= m_size)
+		slotCount *= ENLARGE_MULTIPLIER;
+	Rebuild(slotCount);
 }
 
 
-template<class KeyType, class ValueType, class Hasher>
-size_t HashMap<KeyType, ValueType, Hasher>::GetBucketsSize() const { return m_bucketSize; }
+template<class KeyType, class ValueType, class Hasher, class AllocatorType>
+size_t HashMap<KeyType, ValueType, Hasher, AllocatorType>::GetBucketsSize() const { return m_slotCount; }
 
-template<class KeyType, class ValueType, class Hasher>
-size_t HashMap<KeyType, ValueType, Hasher>::GetSize() const { return m_size; }
+template<class KeyType, class ValueType, class Hasher, class AllocatorType>
+size_t HashMap<KeyType, ValueType, Hasher, AllocatorType>::GetSize() const { return m_size; }
 
 
-template<class KeyType, class ValueType, class Hasher>
-ValueType* HashMap<KeyType, ValueType, Hasher>::Insert(unsigned bucketIdx, const KeyType& key, const ValueType& value)
+template<class KeyType, class ValueType, class Hasher, class AllocatorType>
+unsigned HashMap<KeyType, ValueType, Hasher, AllocatorType>::GetMaxLoad(unsigned slotCount)
 {
-	ASSERT(m_size < m_bucketSize);
+	return (unsigned)((u64)slotCount * MAX_FACTOR / 100);
+}
 
-	if (m_buckets[bucketIdx] == INVALID_INDEX)
-	{
-		HashNode* newNode = NEW_PLACEMENT(m_table + m_size, HashNode)(key, value);
-		m_buckets[bucketIdx] = m_size++;
-		return &newNode->value;
-	}
+template<class KeyType, class ValueType, class Hasher, class AllocatorType>
+i8 HashMap<KeyType, ValueType, Hasher, AllocatorType>::GetControl(u32 hash)
+{
+	return (i8)(hash & 0x7f);
+}
 
-	HashNode* node = &m_table[m_buckets[bucketIdx]];
-	while (node->key != key && node->next != INVALID_INDEX)
-	{
-		node = &m_table[node->next];
-	}
 
-	if (node->key == key)
+//groups are probed in triangular sequence, which visits every group once for power of two group count
+template<class KeyType, class ValueType, class Hasher, class AllocatorType>
+unsigned HashMap<KeyType, ValueType, Hasher, AllocatorType>::FindSlot(const KeyType& key, u32 hash) const
+{
+	const unsigned groupMask = m_slotCount / GROUP_SIZE - 1;
+	const i8 control = GetControl(hash);
+	unsigned group = (hash >> 7) & groupMask;
+	for (unsigned step = 1;; ++step)
 	{
-		return nullptr;
+		const Group& groupData = m_groups[group];
+		for (u32 matches = HashMapInternal::MatchGroup(groupData.control, control); matches != 0; matches &= matches - 1)
+		{
+			const unsigned index = LowestBitIndex(matches);
+			if (m_table[groupData.slots[index]].key == key)
+				return group * GROUP_SIZE + index;
+		}
+		if (HashMapInternal::MatchGroup(groupData.control, CONTROL_EMPTY) != 0)
+			return (unsigned)INVALID_INDEX;
+		group = (group + step) & groupMask;
 	}
-	else
+}
+
+template<class KeyType, class ValueType, class Hasher, class AllocatorType>
+unsigned HashMap<KeyType, ValueType, Hasher, AllocatorType>::FindFreeSlot(u32 hash) const
+{
+	const unsigned groupMask = m_slotCount / GROUP_SIZE - 1;
+	unsigned group = (hash >> 7) & groupMask;
+	for (unsigned step = 1;; ++step)
 	{
-		HashNode* newNode = NEW_PLACEMENT(m_table + m_size, HashNode)(key, value);
-		node->next = m_size++;
-		return &newNode->value;
+		const u32 free = HashMapInternal::MatchGroupFree(m_groups[group].control);
+		if (free != 0)
+			return group * GROUP_SIZE + LowestBitIndex(free);
+		group = (group + step) & groupMask;
 	}
 }
 
 
-template<class KeyType, class ValueType, class Hasher>
-unsigned HashMap<KeyType, ValueType, Hasher>::GetIndex(const KeyType& key) const
+//nodes only move when capacity changes, slots are rebuilt from them without comparing any keys
+template<class KeyType, class ValueType, class Hasher, class AllocatorType>
+void HashMap<KeyType, ValueType, Hasher, AllocatorType>::Rebuild(unsigned slotCount)
 {
-	auto hash = Hasher::get(key);
-	return hash % m_bucketSize;
-}
+	ASSERT(slotCount >= GROUP_SIZE && (slotCount & (slotCount - 1)) == 0);
+	ASSERT(GetMaxLoad(slotCount) > m_size);
 
-template<class KeyType, class ValueType, class Hasher>
-typename HashMap<KeyType, ValueType, Hasher>::HashNode* HashMap<KeyType, ValueType, Hasher>::GetNode(unsigned index)
-{
-	ASSERT(index < m_bucketSize);
-	return &m_table[index];
+	if (slotCount != m_slotCount)
+	{
+		const unsigned nodeCapacity = GetMaxLoad(slotCount);
+		const unsigned groupCount = slotCount / GROUP_SIZE;
+		const size_t alignment = Max((size_t)GROUP_SIZE, alignof(HashNode));
+		void* data = m_allocator.Allocate(groupCount * sizeof(Group) + nodeCapacity * (sizeof(u32) + sizeof(HashNode)) + alignof(HashNode), alignment);
+		Group* groups = static_cast<Group*>(data);
+		u32* nodeSlots = reinterpret_cast<u32*>(groups + groupCount);
+		HashNode* table = static_cast<HashNode*>(AlignPointer(nodeSlots + nodeCapacity, alignof(HashNode)));
+
+		for (unsigned i = 0; i < m_size; ++i)
+		{
+			NEW_PLACEMENT(table + i, HashNode)(Utils::Move(m_table[i]));
+			DELETE_PLACEMENT(m_table + i);
+		}
+
+		if (m_groups != nullptr)
+			m_allocator.Deallocate(m_groups);
+		m_groups = groups;
+		m_nodeSlots = nodeSlots;
+		m_table = table;
+		m_slotCount = slotCount;
+	}
+
+	for (unsigned i = 0; i < m_slotCount / GROUP_SIZE; ++i)
+		memory::Set(m_groups[i].control, (u8)CONTROL_EMPTY, GROUP_SIZE);
+	m_erased = 0;
+	for (unsigned i = 0; i < m_size; ++i)
+	{
+		const u32 hash = Hasher::get(m_table[i].key);
+		const unsigned slot = FindFreeSlot(hash);
+		m_groups[slot / GROUP_SIZE].control[slot % GROUP_SIZE] = GetControl(hash);
+		m_groups[slot / GROUP_SIZE].slots[slot % GROUP_SIZE] = i;
+		m_nodeSlots[i] = slot;
+	}
 }
 
 
-template<class KeyType, class ValueType, class Hasher>
-inline typename HashMap<KeyType, ValueType, Hasher>::HashNode* begin(HashMap<KeyType, ValueType, Hasher>& a)
+template<class KeyType, class ValueType, class Hasher, class AllocatorType>
+inline typename HashMap<KeyType, ValueType, Hasher, AllocatorType>::HashNode* begin(HashMap<KeyType, ValueType, Hasher, AllocatorType>& a)
 {
 	return a.Begin();
 }
 
 
-template<class KeyType, class ValueType, class Hasher>
-inline typename HashMap<KeyType, ValueType, Hasher>::HashNode* end(HashMap<KeyType, ValueType, Hasher>& a)
+template<class KeyType, class ValueType, class Hasher, class AllocatorType>
+inline typename HashMap<KeyType, ValueType, Hasher, AllocatorType>::HashNode* end(HashMap<KeyType, ValueType, Hasher, AllocatorType>& a)
 {
 	return a.End();
 }
 
 
-template<class KeyType, class ValueType, class Hasher>
-inline typename const HashMap<KeyType, ValueType, Hasher>::HashNode* begin(const HashMap<KeyType, ValueType, Hasher>& a)
+template<class KeyType, class ValueType, class Hasher, class AllocatorType>
+inline const typename HashMap<KeyType, ValueType, Hasher, AllocatorType>::HashNode* begin(const HashMap<KeyType, ValueType, Hasher, AllocatorType>& a)
 {
 	return a.Begin();
 }
 
 
-template<class KeyType, class ValueType, class Hasher>
-inline typename const HashMap<KeyType, ValueType, Hasher>::HashNode* end(const HashMap<KeyType, ValueType, Hasher>& a)
+template<class KeyType, class ValueType, class Hasher, class AllocatorType>
+inline const typename HashMap<KeyType, ValueType, Hasher, AllocatorType>::HashNode* end(const HashMap<KeyType, ValueType, Hasher, AllocatorType>& a)
 {
 	return a.End();
 }
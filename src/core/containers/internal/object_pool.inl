@@ -2,14 +2,14 @@ namespace Veng
 {
 
 
-template<class Type>
-ObjectPool<Type>::ObjectPool(Allocator& allocator)
+template<class Type, class AllocatorType>
+ObjectPool<Type, AllocatorType>::ObjectPool(AllocatorType& allocator)
 	: m_allocator(allocator)
 {
 }
 
-template<class Type>
-ObjectPool<Type>::ObjectPool(ObjectPool&& other)
+template<class Type, class AllocatorType>
+ObjectPool<Type, AllocatorType>::ObjectPool(ObjectPool&& other)
 	: m_allocator(other.m_allocator)
 	, m_batches(other.m_batches)
 	, m_size(other.m_size)
@@ -20,8 +20,8 @@ ObjectPool<Type>::ObjectPool(ObjectPool&& other)
 	other.m_batchCount = 0;
 }
 
-template<class Type>
-ObjectPool<Type>& ObjectPool<Type>::operator=(ObjectPool&& other)
+template<class Type, class AllocatorType>
+ObjectPool<Type, AllocatorType>& ObjectPool<Type, AllocatorType>::operator=(ObjectPool&& other)
 {
 	Batch* batches = m_batches;
 	size_t size = m_size;
@@ -39,8 +39,8 @@ ObjectPool<Type>& ObjectPool<Type>::operator=(ObjectPool&& other)
 	return *this;
 }
 
-template<class Type>
-ObjectPool<Type>::~ObjectPool()
+template<class Type, class AllocatorType>
+ObjectPool<Type, AllocatorType>::~ObjectPool()
 {
 	while (m_batches != nullptr)
 	{
@@ -51,8 +51,8 @@ ObjectPool<Type>::~ObjectPool()
 }
 
 
-template<class Type>
-Type* ObjectPool<Type>::GetObject()
+template<class Type, class AllocatorType>
+Type* ObjectPool<Type, AllocatorType>::GetObject()
 {
 	Batch* batch = m_batches;
 	while (batch != nullptr)
@@ -81,8 +81,8 @@ Type* ObjectPool<Type>::GetObject()
 	return result;
 }
 
-template<class Type>
-void ObjectPool<Type>::ReturnObject(Type* object)
+template<class Type, class AllocatorType>
+void ObjectPool<Type, AllocatorType>::ReturnObject(Type* object)
 {
 	Batch* batch = m_batches;
 	while (batch != nullptr)
@@ -106,8 +106,8 @@ void ObjectPool<Type>::ReturnObject(Type* object)
 }
 
 
-template<class Type>
-void ObjectPool<Type>::Compact()
+template<class Type, class AllocatorType>
+void ObjectPool<Type, AllocatorType>::Compact()
 {
 	Batch** prevNext = &m_batches;
 	Batch* batch;
@@ -127,8 +127,8 @@ void ObjectPool<Type>::Compact()
 	}
 }
 
-template<class Type>
-void ObjectPool<Type>::Reserve(size_t capacity)
+template<class Type, class AllocatorType>
+void ObjectPool<Type, AllocatorType>::Reserve(size_t capacity)
 {
 	if (capacity < GetCapacity())
 		return;
@@ -139,15 +139,15 @@ void ObjectPool<Type>::Reserve(size_t capacity)
 }
 
 
-template<class Type>
-size_t ObjectPool<Type>::GetSize() const { return m_size; }
+template<class Type, class AllocatorType>
+size_t ObjectPool<Type, AllocatorType>::GetSize() const { return m_size; }
 
-template<class Type>
-size_t ObjectPool<Type>::GetCapacity() const { return m_batchCount * BATCH_SIZE; }
+template<class Type, class AllocatorType>
+size_t ObjectPool<Type, AllocatorType>::GetCapacity() const { return m_batchCount * BATCH_SIZE; }
 
 
-template<class Type>
-void ObjectPool<Type>::Enlarge()
+template<class Type, class AllocatorType>
+void ObjectPool<Type, AllocatorType>::Enlarge()
 {
 	Batch* batch;
 	if (m_batches == nullptr)
@@ -0,0 +1,224 @@
+namespace Veng
+{
+
+
+template<class Type, class AllocatorType>
+SlotMap<Type, AllocatorType>::SlotMap(AllocatorType& allocator)
+	: m_values(allocator)
+	, m_valueSlots(allocator)
+	, m_slots(allocator)
+{
+}
+
+template<class Type, class AllocatorType>
+SlotMap<Type, AllocatorType>::SlotMap(SlotMap&& other)
+	: m_values(Utils::Move(other.m_values))
+	, m_valueSlots(Utils::Move(other.m_valueSlots))
+	, m_slots(Utils::Move(other.m_slots))
+	, m_freeHead(other.m_freeHead)
+	, m_freeTail(other.m_freeTail)
+{
+	other.m_freeHead = NO_SLOT;
+	other.m_freeTail = NO_SLOT;
+}
+
+template<class Type, class AllocatorType>
+SlotMap<Type, AllocatorType>& SlotMap<Type, AllocatorType>::operator =(SlotMap&& other)
+{
+	m_values = Utils::Move(other.m_values);
+	m_valueSlots = Utils::Move(other.m_valueSlots);
+	m_slots = Utils::Move(other.m_slots);
+
+	const u32 freeHead = m_freeHead;
+	const u32 freeTail = m_freeTail;
+	m_freeHead = other.m_freeHead;
+	m_freeTail = other.m_freeTail;
+	other.m_freeHead = freeHead;
+	other.m_freeTail = freeTail;
+
+	return *this;
+}
+
+
+template<class Type, class AllocatorType>
+u32 SlotMap<Type, AllocatorType>::Add(const Type& value)
+{
+	return Emplace(value);
+}
+
+template<class Type, class AllocatorType>
+u32 SlotMap<Type, AllocatorType>::Add(Type&& value)
+{
+	return Emplace(Utils::Move(value));
+}
+
+template<class Type, class AllocatorType>
+template<class... Args>
+u32 SlotMap<Type, AllocatorType>::Emplace(Args&&... args)
+{
+	const u32 slotIndex = AllocateSlot();
+	Slot& slot = m_slots[slotIndex];
+	slot.value = (u32)m_values.GetSize();
+	m_values.EmplaceBack(Utils::Forward<Args>(args)...);
+	m_valueSlots.PushBack(slotIndex);
+	return (slot.generation << INDEX_BITS) | slotIndex;
+}
+
+
+template<class Type, class AllocatorType>
+void SlotMap<Type, AllocatorType>::Remove(u32 handle)
+{
+	ASSERT2(IsValid(handle), "Invalid or already removed handle");
+	const u32 slotIndex = GetSlotIndex(handle);
+	Slot& slot = m_slots[slotIndex];
+
+	//last value takes place of removed one, its slot has to follow it
+	const u32 valueIndex = slot.value;
+	const u32 lastSlot = m_valueSlots.PopBack();
+	m_values.Erase((size_t)valueIndex);
+	if (valueIndex < m_values.GetSize())
+	{
+		m_valueSlots[valueIndex] = lastSlot;
+		m_slots[lastSlot].value = valueIndex;
+	}
+
+	slot.generation = (slot.generation + 1) & GENERATION_MASK;
+	slot.value = NO_SLOT;
+	if (m_freeTail == NO_SLOT)
+		m_freeHead = slotIndex;
+	else
+		m_slots[m_freeTail].value = slotIndex;
+	m_freeTail = slotIndex;
+}
+
+//handles from before stay invalid, slots keep their generations
+template<class Type, class AllocatorType>
+void SlotMap<Type, AllocatorType>::Clear()
+{
+	while (m_values.GetSize() > 0)
+	{
+		const u32 slotIndex = m_valueSlots[m_values.GetSize() - 1];
+		Remove((m_slots[slotIndex].generation << INDEX_BITS) | slotIndex);
+	}
+}
+
+
+template<class Type, class AllocatorType>
+bool SlotMap<Type, AllocatorType>::IsValid(u32 handle) const
+{
+	const u32 slotIndex = GetSlotIndex(handle);
+	return slotIndex < m_slots.GetSize()
+		&& m_slots[slotIndex].generation == (handle >> INDEX_BITS)
+		&& m_slots[slotIndex].value < m_values.GetSize()
+		&& m_valueSlots[m_slots[slotIndex].value] == slotIndex;
+}
+
+template<class Type, class AllocatorType>
+Type& SlotMap<Type, AllocatorType>::Get(u32 handle)
+{
+	ASSERT2(IsValid(handle), "Invalid or already removed handle");
+	return m_values[m_slots[GetSlotIndex(handle)].value];
+}
+
+template<class Type, class AllocatorType>
+const Type& SlotMap<Type, AllocatorType>::Get(u32 handle) const
+{
+	ASSERT2(IsValid(handle), "Invalid or already removed handle");
+	return m_values[m_slots[GetSlotIndex(handle)].value];
+}
+
+
+template<class Type, class AllocatorType>
+Type* SlotMap<Type, AllocatorType>::Begin() { return m_values.Begin(); }
+
+template<class Type, class AllocatorType>
+Type* SlotMap<Type, AllocatorType>::End() { return m_values.End(); }
+
+template<class Type, class AllocatorType>
+const Type* SlotMap<Type, AllocatorType>::Begin() const { return m_values.Begin(); }
+
+template<class Type, class AllocatorType>
+const Type* SlotMap<Type, AllocatorType>::End() const { return m_values.End(); }
+
+template<class Type, class AllocatorType>
+u32 SlotMap<Type, AllocatorType>::GetHandle(size_t index) const
+{
+	const u32 slotIndex = m_valueSlots[index];
+	return (m_slots[slotIndex].generation << INDEX_BITS) | slotIndex;
+}
+
+
+template<class Type, class AllocatorType>
+void SlotMap<Type, AllocatorType>::Reserve(size_t capacity)
+{
+	m_values.Reserve(capacity);
+	m_valueSlots.Reserve(capacity);
+	m_slots.Reserve(capacity);
+}
+
+
+template<class Type, class AllocatorType>
+size_t SlotMap<Type, AllocatorType>::GetSize() const { return m_values.GetSize(); }
+
+template<class Type, class AllocatorType>
+size_t SlotMap<Type, AllocatorType>::GetCapacity() const { return m_values.GetCapacity(); }
+
+
+template<class Type, class AllocatorType>
+u32 SlotMap<Type, AllocatorType>::AllocateSlot()
+{
+	if (m_freeHead != NO_SLOT)
+	{
+		const u32 slotIndex = m_freeHead;
+		m_freeHead = m_slots[slotIndex].value;
+		if (m_freeHead == NO_SLOT)
+			m_freeTail = NO_SLOT;
+		return slotIndex;
+	}
+
+	ASSERT2(m_slots.GetSize() <= INDEX_MASK, "Too many slots");
+	Slot& slot = m_slots.PushBack();
+	slot.generation = 0;
+	slot.value = NO_SLOT;
+	return (u32)m_slots.GetSize() - 1;
+}
+
+template<class Type, class AllocatorType>
+u32 SlotMap<Type, AllocatorType>::GetSlotIndex(u32 handle) const
+{
+	return handle & INDEX_MASK;
+}
+
+
+// hack to make interface clear
+
+
+template<class Type, class AllocatorType>
+inline Type* begin(SlotMap<Type, AllocatorType>& a)
+{
+	return a.Begin();
+}
+
+
+template<class Type, class AllocatorType>
+inline Type* end(SlotMap<Type, AllocatorType>& a)
+{
+	return a.End();
+}
+
+
+template<class Type, class AllocatorType>
+inline const Type* begin(const SlotMap<Type, AllocatorType>& a)
+{
+	return a.Begin();
+}
+
+
+template<class Type, class AllocatorType>
+inline const Type* end(const SlotMap<Type, AllocatorType>& a)
+{
+	return a.End();
+}
+
+
+}
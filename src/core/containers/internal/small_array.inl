@@ -0,0 +1,281 @@
+namespace Veng
+{
+
+
+template<class Type, size_t InlineCapacity, class AllocatorType>
+SmallArray<Type, InlineCapacity, AllocatorType>::SmallArray(AllocatorType& allocator)
+	: m_allocator(allocator)
+	, m_data(GetInline())
+{
+	static_assert(InlineCapacity > 0, "Use Array for arrays without inline storage");
+}
+
+template<class Type, size_t InlineCapacity, class AllocatorType>
+SmallArray<Type, InlineCapacity, AllocatorType>::SmallArray(SmallArray&& other)
+	: m_allocator(other.m_allocator)
+	, m_data(GetInline())
+{
+	TakeFrom(other);
+}
+
+template<class Type, size_t InlineCapacity, class AllocatorType>
+SmallArray<Type, InlineCapacity, AllocatorType>& SmallArray<Type, InlineCapacity, AllocatorType>::operator =(SmallArray&& other)
+{
+	if (&other == this)
+		return *this;
+
+	Clear();
+	if (!IsInline())
+	{
+		m_allocator.Deallocate(m_data);
+		m_data = GetInline();
+		m_capacity = InlineCapacity;
+	}
+
+	ASSERT2(&m_allocator == &other.m_allocator, "Heap block can't move between allocators");
+	TakeFrom(other);
+	return *this;
+}
+
+template<class Type, size_t InlineCapacity, class AllocatorType>
+SmallArray<Type, InlineCapacity, AllocatorType>::~SmallArray()
+{
+	Clear();
+	if (!IsInline())
+		m_allocator.Deallocate(m_data);
+}
+
+
+template<class Type, size_t InlineCapacity, class AllocatorType>
+void SmallArray<Type, InlineCapacity, AllocatorType>::Clear()
+{
+	for (size_t i = 0; i < m_size; ++i)
+	{
+		DELETE_PLACEMENT(m_data + i);
+	}
+	m_size = 0;
+}
+
+
+template<class Type, size_t InlineCapacity, class AllocatorType>
+Type* SmallArray<Type, InlineCapacity, AllocatorType>::Begin() { return m_data; }
+
+template<class Type, size_t InlineCapacity, class AllocatorType>
+Type* SmallArray<Type, InlineCapacity, AllocatorType>::End() { return m_data + m_size; }
+
+template<class Type, size_t InlineCapacity, class AllocatorType>
+const Type* SmallArray<Type, InlineCapacity, AllocatorType>::Begin() const { return m_data; }
+
+template<class Type, size_t InlineCapacity, class AllocatorType>
+const Type* SmallArray<Type, InlineCapacity, AllocatorType>::End() const { return m_data + m_size; }
+
+
+template<class Type, size_t InlineCapacity, class AllocatorType>
+Type& SmallArray<Type, InlineCapacity, AllocatorType>::PushBack()
+{
+	if (m_size == m_capacity)
+		Enlarge();
+
+	NEW_PLACEMENT(m_data + m_size, Type)();
+
+	return m_data[m_size++];
+}
+
+template<class Type, size_t InlineCapacity, class AllocatorType>
+Type& SmallArray<Type, InlineCapacity, AllocatorType>::PushBack(const Type& value)
+{
+	if (m_size == m_capacity)
+		Enlarge();
+
+	NEW_PLACEMENT(m_data + m_size, Type)(value);
+
+	return m_data[m_size++];
+}
+
+template<class Type, size_t InlineCapacity, class AllocatorType>
+Type& SmallArray<Type, InlineCapacity, AllocatorType>::PushBack(Type&& value)
+{
+	if (m_size == m_capacity)
+		Enlarge();
+
+	NEW_PLACEMENT(m_data + m_size, Type)(Utils::Move(value));
+
+	return m_data[m_size++];
+}
+
+template<class Type, size_t InlineCapacity, class AllocatorType>
+template<class... Args>
+Type& SmallArray<Type, InlineCapacity, AllocatorType>::EmplaceBack(Args&&... args)
+{
+	if (m_size == m_capacity)
+		Enlarge();
+
+	return *(Type*)NEW_PLACEMENT(m_data + m_size++, Type)(Utils::Forward<Args>(args)...);
+}
+
+
+template<class Type, size_t InlineCapacity, class AllocatorType>
+Type SmallArray<Type, InlineCapacity, AllocatorType>::PopBack()
+{
+	ASSERT(m_size > 0);
+	m_size--;
+	Type result(Utils::Move(m_data[m_size]));
+	DELETE_PLACEMENT(m_data + m_size);
+	return result;
+}
+
+template<class Type, size_t InlineCapacity, class AllocatorType>
+void SmallArray<Type, InlineCapacity, AllocatorType>::Erase(size_t index)
+{
+	ASSERT2(index < m_size, "Index out of bounds");
+	DELETE_PLACEMENT(m_data + index);
+
+	m_size--;
+
+	if (index < m_size)
+		memory::Relocate(m_data + index, m_data + m_size, 1);
+}
+
+template<class Type, size_t InlineCapacity, class AllocatorType>
+void SmallArray<Type, InlineCapacity, AllocatorType>::EraseOrdered(size_t index)
+{
+	ASSERT2(index < m_size, "Index out of bounds");
+	DELETE_PLACEMENT(m_data + index);
+	memory::Relocate(m_data + index, m_data + index + 1, m_size - index - 1);
+	m_size--;
+}
+
+
+template<class Type, size_t InlineCapacity, class AllocatorType>
+bool SmallArray<Type, InlineCapacity, AllocatorType>::Find(const Type& value, size_t& index) const
+{
+	for (size_t i = 0; i < m_size; ++i)
+	{
+		if (m_data[i] == value)
+		{
+			index = i;
+			return true;
+		}
+	}
+	return false;
+}
+
+
+template<class Type, size_t InlineCapacity, class AllocatorType>
+const Type& SmallArray<Type, InlineCapacity, AllocatorType>::operator[](size_t index) const
+{
+	ASSERT2(index < m_size, "Index out of bounds");
+	return m_data[index];
+}
+
+template<class Type, size_t InlineCapacity, class AllocatorType>
+Type& SmallArray<Type, InlineCapacity, AllocatorType>::operator[](size_t index)
+{
+	ASSERT2(index < m_size, "Index out of bounds");
+	return m_data[index];
+}
+
+
+template<class Type, size_t InlineCapacity, class AllocatorType>
+void SmallArray<Type, InlineCapacity, AllocatorType>::Reserve(size_t capacity)
+{
+	if (capacity <= m_capacity) return;
+
+	//inline storage can't be reallocated, only heap block can
+	if constexpr (memory::IsTriviallyRelocatable<Type>::value)
+	{
+		if (!IsInline())
+		{
+			m_data = static_cast<Type*>(m_allocator.Reallocate(m_data, capacity * sizeof(Type), alignof(Type)));
+			ASSERT(m_data != nullptr);
+			m_capacity = capacity;
+			return;
+		}
+	}
+
+	Type* newData = static_cast<Type*>(m_allocator.Allocate(capacity * sizeof(Type), alignof(Type)));
+	memory::Relocate(newData, m_data, m_size);
+
+	if (!IsInline())
+		m_allocator.Deallocate(m_data);
+	m_data = newData;
+	m_capacity = capacity;
+}
+
+
+template<class Type, size_t InlineCapacity, class AllocatorType>
+size_t SmallArray<Type, InlineCapacity, AllocatorType>::GetSize() const { return m_size; }
+
+template<class Type, size_t InlineCapacity, class AllocatorType>
+size_t SmallArray<Type, InlineCapacity, AllocatorType>::GetCapacity() const { return m_capacity; }
+
+template<class Type, size_t InlineCapacity, class AllocatorType>
+bool SmallArray<Type, InlineCapacity, AllocatorType>::IsInline() const
+{
+	return m_data == reinterpret_cast<const Type*>(m_inline);
+}
+
+
+template<class Type, size_t InlineCapacity, class AllocatorType>
+Type* SmallArray<Type, InlineCapacity, AllocatorType>::GetInline()
+{
+	return reinterpret_cast<Type*>(m_inline);
+}
+
+template<class Type, size_t InlineCapacity, class AllocatorType>
+void SmallArray<Type, InlineCapacity, AllocatorType>::Enlarge()
+{
+	Reserve(m_capacity * ENLARGE_MULTIPLIER);
+}
+
+template<class Type, size_t InlineCapacity, class AllocatorType>
+void SmallArray<Type, InlineCapacity, AllocatorType>::TakeFrom(SmallArray& other)
+{
+	if (other.IsInline())
+	{
+		memory::Relocate(m_data, other.m_data, other.m_size);
+	}
+	else
+	{
+		m_data = other.m_data;
+		m_capacity = other.m_capacity;
+		other.m_data = other.GetInline();
+		other.m_capacity = InlineCapacity;
+	}
+	m_size = other.m_size;
+	other.m_size = 0;
+}
+
+
+// hack to make interface clear
+
+
+template<class Type, size_t InlineCapacity, class AllocatorType>
+inline Type* begin(SmallArray<Type, InlineCapacity, AllocatorType>& a)
+{
+	return a.Begin();
+}
+
+
+template<class Type, size_t InlineCapacity, class AllocatorType>
+inline Type* end(SmallArray<Type, InlineCapacity, AllocatorType>& a)
+{
+	return a.End();
+}
+
+
+template<class Type, size_t InlineCapacity, class AllocatorType>
+inline const Type* begin(const SmallArray<Type, InlineCapacity, AllocatorType>& a)
+{
+	return a.Begin();
+}
+
+
+template<class Type, size_t InlineCapacity, class AllocatorType>
+inline const Type* end(const SmallArray<Type, InlineCapacity, AllocatorType>& a)
+{
+	return a.End();
+}
+
+
+}
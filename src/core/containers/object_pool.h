@@ -7,11 +7,11 @@ namespace Veng
 {
 
 
-template<class Type>
+template<class Type, class AllocatorType = Allocator>
 class ObjectPool final
 {
 public:
-	explicit ObjectPool(Allocator& allocator);
+	explicit ObjectPool(AllocatorType& allocator);
 	ObjectPool(ObjectPool&) = delete;
 	ObjectPool(ObjectPool&& other);
 	ObjectPool& operator =(ObjectPool&) = delete;
@@ -54,7 +54,7 @@ private:
 	void Enlarge();
 
 private:
-	Allocator& m_allocator;
+	AllocatorType& m_allocator;
 	Batch* m_batches = nullptr;
 	size_t m_size = 0;
 	size_t m_batchCount = 0;
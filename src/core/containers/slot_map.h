@@ -0,0 +1,84 @@
+#pragma once
+
+#include "core/int.h"
+#include "core/allocator.h"
+#include "core/asserts.h"
+#include "core/utility.h"
+#include "core/containers/array.h"
+
+
+namespace Veng
+{
+
+
+//values are kept dense for iteration, handles go through slots which remember where value is; removal moves
+//last value into the hole. Handle holds slot index and slot's generation, which changes whenever slot is freed,
+//so stale handle never reaches value added later. First value added to empty map gets handle 0
+template<class Type, class AllocatorType = Allocator>
+class SlotMap final
+{
+public:
+	explicit SlotMap(AllocatorType& allocator);
+	SlotMap(SlotMap&) = delete;
+	SlotMap(SlotMap&& other);
+	SlotMap& operator =(SlotMap&) = delete;
+	SlotMap& operator =(SlotMap&& other);
+
+	u32 Add(const Type& value);
+	u32 Add(Type&& value);
+	template<class... Args>
+	u32 Emplace(Args&&... args);
+
+	void Remove(u32 handle);
+	void Clear();
+
+	bool IsValid(u32 handle) const;
+	Type& Get(u32 handle);
+	const Type& Get(u32 handle) const;
+
+	//live values in no particular order, any removal can reorder them
+	Type* Begin();
+	Type* End();
+	const Type* Begin() const;
+	const Type* End() const;
+	//handle of value at given position between Begin and End
+	u32 GetHandle(size_t index) const;
+
+	void Reserve(size_t capacity);
+
+	size_t GetSize() const;
+	size_t GetCapacity() const;
+
+private:
+	enum : u32
+	{
+		INDEX_BITS = 20,
+		INDEX_MASK = (1U << INDEX_BITS) - 1,
+		GENERATION_MASK = (1U << (32 - INDEX_BITS)) - 1,
+		NO_SLOT = 0xffffffff,
+	};
+
+	struct Slot
+	{
+		u32 generation;
+		u32 value;//index of value while slot is used, next free slot otherwise
+	};
+
+private:
+	u32 AllocateSlot();
+	u32 GetSlotIndex(u32 handle) const;
+
+private:
+	Array<Type, AllocatorType> m_values;
+	Array<u32, AllocatorType> m_valueSlots;//slot of each value
+	Array<Slot, AllocatorType> m_slots;
+	//freed slots are reused oldest first, so generations of single slot wear out slowly
+	u32 m_freeHead = NO_SLOT;
+	u32 m_freeTail = NO_SLOT;
+};
+
+
+}
+
+
+#include "internal/slot_map.inl"
@@ -0,0 +1,81 @@
+#pragma once
+
+#include "core/allocator.h"
+#include "core/asserts.h"
+#include "core/utility.h"
+#include "core/memory.h"
+
+
+namespace Veng
+{
+
+
+//first InlineCapacity elements live inside the array itself, allocator is used only once it grows past them;
+//moving array with inline elements moves elements, so pointers to them don't survive move
+template<class Type, size_t InlineCapacity, class AllocatorType = Allocator>
+class SmallArray final
+{
+public:
+	explicit SmallArray(AllocatorType& allocator);
+	SmallArray(SmallArray&) = delete;
+	SmallArray(SmallArray&& other);
+	SmallArray& operator =(SmallArray&) = delete;
+	SmallArray& operator =(SmallArray&& other);
+	~SmallArray();
+
+	void Clear();
+
+	Type* Begin();
+	Type* End();
+	const Type* Begin() const;
+	const Type* End() const;
+
+	Type& PushBack();
+	Type& PushBack(const Type& value);
+	Type& PushBack(Type&& value);
+
+	template<class... Args>
+	Type& EmplaceBack(Args&&... args);
+
+	Type PopBack();
+
+	//moves last element into erased one
+	void Erase(size_t index);
+	void EraseOrdered(size_t index);
+
+	bool Find(const Type& value, size_t& index) const;
+
+	const Type& operator[](size_t index) const;
+	Type& operator[](size_t index);
+
+	void Reserve(size_t capacity);
+
+	size_t GetSize() const;
+	size_t GetCapacity() const;
+	bool IsInline() const;
+
+private:
+	enum
+	{
+		ENLARGE_MULTIPLIER = 2,
+	};
+
+private:
+	Type* GetInline();
+	void Enlarge();
+	//takes other's heap block or relocates its inline elements, other ends empty and inline
+	void TakeFrom(SmallArray& other);
+
+private:
+	AllocatorType& m_allocator;
+	size_t m_capacity = InlineCapacity;
+	size_t m_size = 0;
+	Type* m_data;
+	alignas(Type) u8 m_inline[InlineCapacity * sizeof(Type)];
+};
+
+
+}
+
+
+#include "internal/small_array.inl"
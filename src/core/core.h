@@ -4,6 +4,9 @@
 #ifdef _WIN32
 #	define FORCE_ALIGNMENT(x) __declspec(align(x))
 #	define FORCE_INLINE __forceinline
+#elif defined(__GNUC__)
+#	define FORCE_ALIGNMENT(x) __attribute__((aligned(x)))
+#	define FORCE_INLINE inline __attribute__((always_inline))
 #else
 #	error Platform not supported
 #endif
@@ -1,7 +1,11 @@
 #include "engine.h"
 
+#include "allocators.h"
 #include "file/file_system.h"
 #include "input/input_system.h"
+#include "system_scheduler.h"
+#include "threading/jobs.h"
+#include "threading/task.h"
 #include "resource/resource_manager.h"
 #include "resource/resource_management.h"
 #include "string.h"
@@ -26,12 +30,19 @@ class EngineImpl : public Engine
 public:
 	EngineImpl(Allocator& allocator)
 		: m_allocator(allocator)
+		, m_frameAllocator(m_allocator)
+		, m_taskAllocator(m_allocator)
 		, m_systems(m_allocator)
 		, m_worlds(m_allocator)
 	{
+		m_taskAllocator.SetDebugName("Tasks");
+		SetTaskAllocator(&m_taskAllocator);
+		m_jobSystem = JobSystem::Create(m_allocator);
+		m_systemScheduler = NEW_OBJECT(m_allocator, SystemScheduler)(m_allocator, *m_jobSystem);
 		m_fileSystem = FileSystem::Create(m_allocator);
 		m_inputSystem = InputSystem::Create(m_allocator);
 		m_resourceManager = ResourceManagement::Create(m_allocator);
+		m_frameAllocator.SetDebugName("Frame");
 	}
 
 	~EngineImpl()
@@ -39,6 +50,9 @@ public:
 		ResourceManagement::Destroy(m_resourceManager, m_allocator);
 		InputSystem::Destroy(m_inputSystem, m_allocator);
 		FileSystem::Destroy(m_fileSystem, m_allocator);
+		DELETE_OBJECT(m_allocator, m_systemScheduler);
+		JobSystem::Destroy(m_jobSystem, m_allocator);
+		SetTaskAllocator(nullptr);
 	}
 
 
@@ -209,6 +223,21 @@ public:
 		return m_systems.Begin();
 	}
 
+	void SetParallelSystemUpdate(bool parallel) override
+	{
+		m_systemScheduler->SetParallel(parallel);
+	}
+
+	const SystemTiming* GetSystemTimings(size_t& count) const override
+	{
+		return m_systemScheduler->GetTimings(count);
+	}
+
+	float GetSystemCriticalPathTime() const override
+	{
+		return m_systemScheduler->GetCriticalPathTime();
+	}
+
 
 	bool AddResourceManager(ResourceManager& manager) override
 	{
@@ -233,20 +262,47 @@ public:
 
 	void Update(float deltaTime) override
 	{
-		for (System* plugin : m_systems)
-		{
-			plugin->Update(deltaTime);
-		}
+		m_frameAllocator.NewFrame();
+		NewAllocatorStatsFrame();
+
+		m_systemScheduler->Update(m_systems.Begin(), m_systems.GetSize(), deltaTime);
+		UpdateWorlds(deltaTime);
+		for (World& world : m_worlds)
+			world.PlaybackCommands(m_frameAllocator);
 		m_fileSystem->Update(deltaTime);
 		m_inputSystem->Update(deltaTime);
 	}
 
+	//scenes are updated after all systems, world by world
+	void UpdateWorlds(float deltaTime)
+	{
+		for (World& world : m_worlds)
+		{
+			for (System* system : m_systems)
+			{
+				Scene* scene = system->GetScene(world.GetId());
+				if (scene != nullptr)
+					scene->Update(deltaTime);
+			}
+		}
+	}
+
 
 	Allocator& GetAllocator() const override
 	{
 		return m_allocator;
 	}
 
+	FrameAllocator& GetFrameAllocator() override
+	{
+		return m_frameAllocator;
+	}
+
+	JobSystem& GetJobSystem() const override
+	{
+		return *m_jobSystem;
+	}
+
 
 	FileSystem* GetFileSystem() const override
 	{
@@ -261,6 +317,10 @@ public:
 
 private:
 	Allocator& m_allocator;
+	FrameAllocator m_frameAllocator;
+	ProxyAllocator m_taskAllocator;//coroutine frames
+	JobSystem* m_jobSystem;
+	SystemScheduler* m_systemScheduler;
 	FileSystem* m_fileSystem;
 	InputSystem* m_inputSystem;
 	ResourceManagement* m_resourceManager;
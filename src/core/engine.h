@@ -11,7 +11,9 @@ namespace Veng
 {
 
 class FileSystem;
+class FrameAllocator;
 class InputSystem;
+class JobSystem;
 class ResourceManager;
 class ResourceManagement;
 
@@ -39,6 +41,10 @@ public:
 	virtual System* GetSystem(const char* name) const = 0;
 	virtual size_t GetSystemCount() const = 0;
 	virtual System* const* GetSystems() const = 0;
+	//systems are updated concurrently on job system by default, serial update keeps registration order
+	virtual void SetParallelSystemUpdate(bool parallel) = 0;
+	virtual const SystemTiming* GetSystemTimings(size_t& count) const = 0;
+	virtual float GetSystemCriticalPathTime() const = 0;
 
 	virtual bool AddResourceManager(ResourceManager& manager) = 0;
 	virtual bool RemoveResourceManager(ResourceType type) = 0;
@@ -48,6 +54,8 @@ public:
 	virtual void Update(float deltaTime) = 0;
 
 	virtual Allocator& GetAllocator() const = 0;
+	virtual FrameAllocator& GetFrameAllocator() = 0;
+	virtual JobSystem& GetJobSystem() const = 0;
 
 	virtual FileSystem* GetFileSystem() const = 0;
 	virtual InputSystem* GetInputSystem() const = 0;
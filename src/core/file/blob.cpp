@@ -106,6 +106,12 @@ static void Reallocate(Allocator& allocator, u8*& ptr, size_t& size)
 	}
 
 	size_t newSize = size * 2;
+	if (allocator.TryExpand(ptr, newSize))
+	{
+		size = newSize;
+		return;
+	}
+
 	u8* newPtr = (u8*)allocator.Allocate(newSize, alignof(u8));
 	memory::Move(newPtr, ptr, size);
 	size = newSize;
@@ -18,8 +18,6 @@ public:
 
 	bool Read(void* data, size_t size);
 	template<typename T> bool Read(T& value);
-	template<> bool Read(String& value);
-	template<> bool Read(Path& value);
 
 	void Skip(size_t size);
 	size_t GetSize() const;
@@ -42,12 +40,12 @@ template<typename T> bool InputBlob::Read(T& value)
 	return Read(&value, sizeof(T));
 }
 
-template<> bool InputBlob::Read(String& value)
+template<> inline bool InputBlob::Read(String& value)
 {
 	return ReadString(value);
 }
 
-template<> bool InputBlob::Read(Path& value)
+template<> inline bool InputBlob::Read(Path& value)
 {
 	char buffer[Path::BUFFER_LENGTH];
 	if (ReadString(buffer, Path::BUFFER_LENGTH)) {
@@ -71,12 +69,8 @@ public:
 	void WriteAtPos(const void* data, size_t size, size_t pos);
 
 	template<typename T> void Write(const T& value);
-	template<> void Write(const char* const& value);
-	template<> void Write(const String& value);
-	template<> void Write(const Path& value);
 
 	template<typename T> void WriteAtPos(const T& value, size_t pos);
-	template<> void WriteAtPos(const String& value, size_t pos) { return; }
 
 	size_t GetSize() const;
 	size_t GetPosition() const;
@@ -97,17 +91,17 @@ template<typename T> void OutputBlob::Write(const T& value)
 	Write(&value, sizeof(T));
 }
 
-template<> void OutputBlob::Write(const char* const& value)
+template<> inline void OutputBlob::Write(const char* const& value)
 {
 	WriteString(value);
 }
 
-template<> void OutputBlob::Write(const String& value)
+template<> inline void OutputBlob::Write(const String& value)
 {
 	WriteString(value.Cstr());
 }
 
-template<> void OutputBlob::Write(const Path& value)
+template<> inline void OutputBlob::Write(const Path& value)
 {
 	WriteString(value.GetPath());
 }
@@ -117,4 +111,9 @@ template<typename T> void OutputBlob::WriteAtPos(const T& value, size_t pos)
 	WriteAtPos(&value, sizeof(T), pos);
 }
 
+template<> inline void OutputBlob::WriteAtPos(const String& value, size_t pos)
+{
+	return;
+}
+
 }
\ No newline at end of file
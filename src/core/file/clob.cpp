@@ -228,6 +228,12 @@ static void Reallocate(Allocator& allocator, char*& ptr, size_t& size)
 	}
 
 	size_t newSize = size * 2;
+	if (allocator.TryExpand(ptr, newSize))
+	{
+		size = newSize;
+		return;
+	}
+
 	char* newPtr = (char*)allocator.Allocate(newSize, alignof(char));
 	memory::Move(newPtr, ptr, size);
 	size = newSize;
@@ -317,6 +323,17 @@ void OutputClob::Write(u32 value)
 	m_position += writtenChars;
 }
 
+void OutputClob::Write(u64 value)
+{
+	const size_t MAX_LENGTH = 24;
+	if (m_position + MAX_LENGTH >= m_size)
+		Reallocate(m_allocator, m_data, m_size);
+
+	int writtenChars = snprintf(m_data + m_position, MAX_LENGTH, "%llu", (unsigned long long)value);
+	ASSERT(writtenChars > 0 && writtenChars < MAX_LENGTH);
+	m_position += writtenChars;
+}
+
 void OutputClob::WriteHex(u32 value)
 {
 	const size_t MAX_LENGTH = 20;
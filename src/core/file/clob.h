@@ -47,6 +47,7 @@ public:
 	void WriteLine(const char* data);
 	void Write(i32 value);
 	void Write(u32 value);
+	void Write(u64 value);
 	void WriteHex(u32 value);
 	void Write(float value);
 	size_t GetSize() const;
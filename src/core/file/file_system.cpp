@@ -10,8 +10,36 @@ namespace Veng
 {
 
 
+FileReadAwaiter::FileReadAwaiter(FileSystem& fileSystem, fileHandle file, void* buffer, size_t size)
+	: m_fileSystem(fileSystem)
+	, m_file(file)
+	, m_buffer(buffer)
+	, m_size(size)
+{
+}
+
+
+bool FileReadAwaiter::await_suspend(std::coroutine_handle<> coroutine)
+{
+	m_coroutine = coroutine;
+	Function<void(fileHandle)> callback;
+	callback.Bind<FileReadAwaiter, &FileReadAwaiter::Completed>(this);
+	return m_fileSystem.Read(m_file, m_buffer, m_size, callback);//coroutine continues right away when read can't start
+}
 
 
+void FileReadAwaiter::Completed(fileHandle file)
+{
+	m_result = true;
+	m_coroutine.resume();
+}
+
+
+FileReadAwaiter FileSystem::ReadAsync(fileHandle handle, void* buffer, size_t size)
+{
+	return FileReadAwaiter(*this, handle, buffer, size);
+}
+
 
 struct File
 {
@@ -5,6 +5,8 @@
 #include "path.h"
 #include "core/function.h"
 
+#include <coroutine>
+
 
 namespace Veng
 {
@@ -62,6 +64,32 @@ enum class fileHandle : u64 {};
 const fileHandle INVALID_FILE_HANDLE = (fileHandle)0;
 
 
+class FileSystem;
+
+
+//awaitable read, suspended coroutine is resumed from FileSystem::Update; await result is false when read failed
+class FileReadAwaiter
+{
+public:
+	FileReadAwaiter(FileSystem& fileSystem, fileHandle file, void* buffer, size_t size);
+
+	bool await_ready() const { return false; }
+	bool await_suspend(std::coroutine_handle<> coroutine);
+	bool await_resume() const { return m_result; }
+
+private:
+	void Completed(fileHandle file);
+
+private:
+	FileSystem& m_fileSystem;
+	fileHandle m_file;
+	void* m_buffer;
+	size_t m_size;
+	std::coroutine_handle<> m_coroutine;
+	bool m_result = false;
+};
+
+
 class FileSystem
 {
 public:
@@ -77,6 +105,8 @@ public:
 	virtual bool Read(fileHandle handle, void* buffer, size_t size, Function<void(fileHandle)> callback) = 0;
 	virtual bool Write(fileHandle handle, void* data, size_t size, Function<void(fileHandle)> callback) = 0;
 
+	FileReadAwaiter ReadAsync(fileHandle handle, void* buffer, size_t size);
+
 	virtual void SetPosition(fileHandle handle, MoveMethod method, size_t position) = 0;
 	virtual size_t GetPosition(fileHandle handle) const  = 0;
 
@@ -12,7 +12,7 @@
 namespace Veng
 {
 
-template<class Type> class Array;
+template<class Type, class AllocatorType> class Array;
 class String;
 
 
@@ -91,7 +91,7 @@ public:
 	virtual void ShowCursor(bool show) = 0;
 
 	virtual bool IsDeviceActive(inputDeviceID id) const = 0;
-	virtual const Array<InputEvent>& GetInputEventBuffer() const = 0;
+	virtual const Array<InputEvent, Allocator>& GetInputEventBuffer() const = 0;
 };
 
 
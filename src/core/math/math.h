@@ -1,5 +1,10 @@
 #pragma once
 
+#include "core/int.h"
+#if defined(_MSC_VER)
+#	include <intrin.h>
+#endif
+
 
 namespace Veng
 {
@@ -18,6 +23,30 @@ Type Max(Type v1, Type v2)
 }
 
 
+//index of lowest/highest set bit, mask must not be zero; inline, allocators ask on every allocation
+inline u32 LowestBitIndex(u32 mask)
+{
+#if defined(_MSC_VER)
+	unsigned long index;
+	_BitScanForward(&index, mask);
+	return (u32)index;
+#else
+	return (u32)__builtin_ctz(mask);
+#endif
+}
+
+inline u32 HighestBitIndex(u64 mask)
+{
+#if defined(_MSC_VER)
+	unsigned long index;
+	_BitScanReverse64(&index, mask);
+	return (u32)index;
+#else
+	return 63 - (u32)__builtin_clzll(mask);
+#endif
+}
+
+
 float copysignf(float num, float sign);
 
 
@@ -27,6 +27,11 @@ void Set(void* destination, unsigned char value, size_t size)
 	memset(destination, value, size);
 }
 
+int Compare(const void* source1, const void* source2, size_t size)
+{
+	return memcmp(source1, source2, size);
+}
+
 void Swap(void* source1, void* source2, size_t size)
 {
 	char* src1 = (char*)source1;
@@ -1,5 +1,8 @@
 #pragma once
 
+#include "core/allocator.h"
+#include "core/utility.h"
+
 
 namespace Veng
 {
@@ -15,10 +18,51 @@ void Move(void* destination, const void* source, size_t size);
 
 void Set(void* destination, unsigned char value, size_t size);
 
+int Compare(const void* source1, const void* source2, size_t size);
+
 void Swap(void* source1, void* source2, size_t size);
 
 
+//object of such type can be moved to other address by copying its bytes, old copy is then dropped without destructor;
+//specialize for types which don't point into themselves, but aren't trivially copyable
+template<class Type>
+struct IsTriviallyRelocatable
+{
+	static constexpr bool value = __is_trivially_copyable(Type);
+};
+
+
+//ranges can overlap, destination is uninitialized before and source is destroyed after
+template<class Type>
+void Relocate(Type* destination, Type* source, size_t count)
+{
+	if (destination == source || count == 0)
+		return;
+
+	if constexpr (IsTriviallyRelocatable<Type>::value)
+	{
+		Move(destination, source, count * sizeof(Type));
+	}
+	else if (destination < source)
+	{
+		for (size_t i = 0; i < count; ++i)
+		{
+			NEW_PLACEMENT(destination + i, Type)(Utils::Move(source[i]));
+			DELETE_PLACEMENT(source + i);
+		}
+	}
+	else
+	{
+		for (size_t i = count; i > 0; --i)
+		{
+			NEW_PLACEMENT(destination + i - 1, Type)(Utils::Move(source[i - 1]));
+			DELETE_PLACEMENT(source + i - 1);
+		}
+	}
 }
 
 
-}
\ No newline at end of file
+}
+
+
+}
@@ -0,0 +1,137 @@
+#include "../os_utils.h"
+
+#include "core/asserts.h"
+
+#include <sys/mman.h>
+#include <unistd.h>
+#include <execinfo.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+
+//process, file dialog and mouse cursor functions are not implemented on this platform yet
+
+
+namespace Veng
+{
+
+
+namespace os
+{
+
+
+void GetWorkingDir(char* path, size_t maxLen)
+{
+	if (getcwd(path, maxLen) == nullptr && maxLen > 0)
+		path[0] = '\0';
+}
+
+
+void LogDebugString(const char* str)
+{
+	fputs(str, stderr);
+}
+
+
+SystemInfo GetSystemInfo()
+{
+	long pageSize = sysconf(_SC_PAGESIZE);
+	long processors = sysconf(_SC_NPROCESSORS_ONLN);
+
+	SystemInfo info;
+#if defined(__x86_64__)
+	info.processorArchitecture = SystemInfo::ProcessorArchitecture::AMD64;
+#elif defined(__aarch64__)
+	info.processorArchitecture = SystemInfo::ProcessorArchitecture::ARM64;
+#elif defined(__arm__)
+	info.processorArchitecture = SystemInfo::ProcessorArchitecture::ARM;
+#elif defined(__i386__)
+	info.processorArchitecture = SystemInfo::ProcessorArchitecture::Intel;
+#else
+	info.processorArchitecture = SystemInfo::ProcessorArchitecture::Unknown;
+#endif
+	info.pageSize = (u32)pageSize;
+	info.minimumAddress = (void*)pageSize;
+	info.maximumAddress = nullptr;
+	info.activeProcessorMask = (processors >= 32) ? 0xffffffff : (u32)((1u << processors) - 1);
+	info.numberOfProcessors = (u32)processors;
+	info.allocationGranularity = (u32)pageSize;//mmap has no coarser granularity than page
+	return info;
+}
+
+
+u64 GetTimerValue()
+{
+	timespec time;
+	clock_gettime(CLOCK_MONOTONIC, &time);
+	return (u64)time.tv_sec * 1000000000 + (u64)time.tv_nsec;
+}
+
+u64 GetTimerFrequency()
+{
+	return 1000000000;
+}
+
+
+void* ReserveMemory(size_t size)
+{
+	void* ptr = mmap(nullptr, size, PROT_NONE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+	if (ptr == MAP_FAILED)
+	{
+		ASSERT2(false, "mmap failed");
+		return nullptr;
+	}
+	return ptr;
+}
+
+bool CommitMemory(void* ptr, size_t size, bool hugePages)
+{
+	if (mprotect(ptr, size, PROT_READ | PROT_WRITE) != 0)
+	{
+		ASSERT2(false, "mprotect failed");
+		return false;
+	}
+#if defined(MADV_HUGEPAGE)
+	if (hugePages)
+		madvise(ptr, size, MADV_HUGEPAGE);//only a hint, fails silently when THP are disabled
+#endif
+	return true;
+}
+
+bool DecommitMemory(void* ptr, size_t size)
+{
+	//give physical pages back to system and keep range reserved
+	if (madvise(ptr, size, MADV_DONTNEED) != 0)
+		return false;
+	return mprotect(ptr, size, PROT_NONE) == 0;
+}
+
+bool ReleaseMemory(void* ptr, size_t size)
+{
+	return munmap(ptr, size) == 0;
+}
+
+
+u32 GetCallStack(u32 framesToSkip, u32 framesToCapture, void** callstack)
+{
+	static const u32 MAX_FRAMES = 128;
+	void* frames[MAX_FRAMES];
+	u32 total = framesToSkip + framesToCapture + 1;//+1 for this function
+	if (total > MAX_FRAMES)
+		total = MAX_FRAMES;
+
+	int count = backtrace(frames, (int)total);
+	u32 skip = framesToSkip + 1;
+	if ((u32)count <= skip)
+		return 0;
+
+	u32 captured = (u32)count - skip;
+	memcpy(callstack, frames + skip, captured * sizeof(void*));
+	return captured;
+}
+
+
+}
+
+
+}
@@ -59,6 +59,19 @@ int CallProcess(const char* appPath, char* args);
 SystemInfo GetSystemInfo();
 
 
+//monotonic high resolution counter, GetTimerFrequency returns ticks per second
+u64 GetTimerValue();
+u64 GetTimerFrequency();
+
+
+//reserves address space only, memory has to be committed before use
+void* ReserveMemory(size_t size);
+//hugePages is only a hint, regular pages are used when huge pages are not available
+bool CommitMemory(void* ptr, size_t size, bool hugePages);
+bool DecommitMemory(void* ptr, size_t size);
+bool ReleaseMemory(void* ptr, size_t size);
+
+
 //custom template, custom filter, multiselect | are not supported
 bool ShowOpenFileDialog(FileDialogData& data);
 
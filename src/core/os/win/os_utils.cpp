@@ -163,6 +163,57 @@ SystemInfo GetSystemInfo()
 }
 
 
+u64 GetTimerValue()
+{
+	LARGE_INTEGER value;
+	::QueryPerformanceCounter(&value);
+	return (u64)value.QuadPart;
+}
+
+u64 GetTimerFrequency()
+{
+	LARGE_INTEGER frequency;
+	::QueryPerformanceFrequency(&frequency);
+	return (u64)frequency.QuadPart;
+}
+
+
+void* ReserveMemory(size_t size)
+{
+	void* ptr = ::VirtualAlloc(NULL, size, MEM_RESERVE, PAGE_NOACCESS);
+	if (ptr == NULL)
+	{
+		DWORD errId = ::GetLastError();
+		LogErrorMessage(errId);
+		ASSERT2(false, "VirtualAlloc failed");
+	}
+	return ptr;
+}
+
+bool CommitMemory(void* ptr, size_t size, bool hugePages)
+{
+	//large pages need SeLockMemoryPrivilege and can't be committed into already reserved range, regular pages are used
+	if (::VirtualAlloc(ptr, size, MEM_COMMIT, PAGE_READWRITE) == NULL)
+	{
+		DWORD errId = ::GetLastError();
+		LogErrorMessage(errId);
+		ASSERT2(false, "VirtualAlloc failed");
+		return false;
+	}
+	return true;
+}
+
+bool DecommitMemory(void* ptr, size_t size)
+{
+	return ::VirtualFree(ptr, size, MEM_DECOMMIT) != FALSE;
+}
+
+bool ReleaseMemory(void* ptr, size_t size)
+{
+	return ::VirtualFree(ptr, 0, MEM_RELEASE) != FALSE;
+}
+
+
 bool ShowOpenFileDialog(FileDialogData& data)
 {
 	const size_t MAX_FILTER = 1024 + 1;
@@ -11,4 +11,17 @@ namespace Veng
 ResourceType::ResourceType(const char* name) : hash(crc32_string(name)) {}
 
 
+bool ResourceAwaiter::await_ready() const
+{
+	return m_resource.GetState() != Resource::State::Loading;
+}
+
+void ResourceAwaiter::await_suspend(std::coroutine_handle<> coroutine)
+{
+	m_coroutine = coroutine;
+	m_next = m_resource.m_waiters;
+	m_resource.m_waiters = this;
+}
+
+
 }
\ No newline at end of file
@@ -3,6 +3,8 @@
 #include "core/int.h"
 #include "core/file/path.h"
 
+#include <coroutine>
+
 #include "core/file/file.h"///////////////////////////////////////////////////////////Resource depends on file system :-/
 
 
@@ -25,9 +27,32 @@ enum class resourceHandle : u64 {};
 const resourceHandle INVALID_RESOURCE_HANDLE = (resourceHandle)0;
 
 
+class Resource;
+
+
+//suspends coroutine until resource is Ready or Failure, waiters are resumed by resource's manager
+class ResourceAwaiter
+{
+	friend class ResourceManager;
+
+public:
+	explicit ResourceAwaiter(Resource& resource) : m_resource(resource) {}
+
+	bool await_ready() const;
+	void await_suspend(std::coroutine_handle<> coroutine);
+	void await_resume() const {}
+
+private:
+	Resource& m_resource;
+	std::coroutine_handle<> m_coroutine;
+	ResourceAwaiter* m_next = nullptr;
+};
+
+
 class Resource
 {
 	friend class ResourceManager;
+	friend class ResourceAwaiter;
 
 public:
 	enum class State : u8
@@ -46,12 +71,14 @@ public:
 	void SetState(State state) { m_state = state; }
 	ResourceType GetType() const { return m_type; }
 
+	ResourceAwaiter WaitForLoad() { return ResourceAwaiter(*this); }
+
 private:
 	Path m_path;
-	fileHandle m_fileHandle = INVALID_FILE_HANDLE;
 	ResourceType m_type;
 	State m_state = State::Empty;
 	volatile u32 m_refCount = 0;
+	ResourceAwaiter* m_waiters = nullptr;
 };
 
 
@@ -3,8 +3,7 @@
 #include "resource_manager.h"
 
 #include "core/allocators.h"
-#include "core/containers/array.h"
-#include "core/containers/hash_map.h"
+#include "core/containers/concurrent_hash_map.h"
 
 
 namespace Veng
@@ -26,7 +25,6 @@ public:
 	ResourceManagementImpl(Allocator& allocator)
 		: m_allocator(allocator)
 		, m_managers(m_allocator)
-		, m_dependencyAsyncOps(allocator)
 	{}
 
 	~ResourceManagementImpl()
@@ -35,12 +33,7 @@ public:
 
 	bool RegisterManager(ResourceType type, ResourceManager* manager)
 	{
-		ResourceManager** res;
-		if (m_managers.Find(type, res))
-			return false;
-
-		m_managers.Insert(type, manager);
-		return true;
+		return m_managers.Insert(type, manager);
 	}
 
 
@@ -52,34 +45,23 @@ public:
 
 	ResourceManager* GetManager(ResourceType type) const override
 	{
-		ResourceManager** res;
-		if (!m_managers.Find(type, res))
+		ResourceManager* manager;
+		if (!m_managers.Find(type, manager))
 		{
 			ASSERT2(false, "Manager of requested type is not registered.");
 			return nullptr;
 		}
 
-		return *res;
+		return manager;
 	}
 
 
-	resourceHandle LoadResource(ResourceType requestedType, ResourceType resourceType, const Path& path) override
+	resourceHandle LoadResource(ResourceType resourceType, const Path& path) override
 	{
 		ResourceManager* manager = GetManager(resourceType);
 		if (manager != nullptr)
 		{
-			ResourceManager* parentManager = GetManager(requestedType);
-			resourceHandle resHandle = manager->Load(path);
-			Resource* resource = manager->GetResource(resHandle);
-			if(resource->GetState() == Resource::State::Ready || resource->GetState() == Resource::State::Failure)
-			{
-				return resHandle;
-			}
-			else
-			{
-				DependencyAsyncOp& asyncOp = m_dependencyAsyncOps.PushBack({ parentManager, resourceType, resHandle });
-				return asyncOp.childHandle;
-			}
+			return manager->Load(path);
 		}
 		else
 		{
@@ -105,32 +87,6 @@ public:
 	}
 
 
-	void ResourceLoaded(ResourceType resourceType, resourceHandle handle) override
-	{
-		StackAllocator<4096> allocator;
-		Array<DependencyAsyncOp> loaded(allocator);
-
-		for (size_t i = 0; i < m_dependencyAsyncOps.GetSize();)
-		{
-			DependencyAsyncOp& asyncOp = m_dependencyAsyncOps[i];
-			if (asyncOp.childType == resourceType && asyncOp.childHandle == handle)
-			{
-				loaded.PushBack(asyncOp);
-				m_dependencyAsyncOps.Erase((unsigned)i);
-			}
-			else
-			{
-				i++;
-			}
-		}
-
-		for (DependencyAsyncOp& asyncOp : loaded)
-		{
-			asyncOp.parent->ChildResourceLoaded(handle, resourceType);
-		}
-	}
-
-
 	Resource* GetResource(ResourceType resourceType, resourceHandle handle) override
 	{
 		ResourceManager* manager = GetManager(resourceType);
@@ -146,18 +102,9 @@ public:
 	}
 
 
-private:
-	struct DependencyAsyncOp
-	{
-		ResourceManager* parent;
-		ResourceType childType;
-		resourceHandle childHandle;
-	};
-
 private:
 	Allocator& m_allocator;
-	HashMap<ResourceType, ResourceManager*> m_managers;
-	Array<DependencyAsyncOp> m_dependencyAsyncOps;
+	ConcurrentHashMap<ResourceType, ResourceManager*> m_managers;
 };
 
 
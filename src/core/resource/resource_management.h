@@ -24,9 +24,8 @@ public:
 	virtual ResourceManager* GetManager(ResourceType type) const = 0;
 
 
-	virtual resourceHandle LoadResource(ResourceType requestedType, ResourceType resourceType, const Path& path) override = 0;
+	virtual resourceHandle LoadResource(ResourceType resourceType, const Path& path) override = 0;
 	virtual bool UnloadResource(ResourceType resourceType, resourceHandle handle) override = 0;
-	virtual void ResourceLoaded(ResourceType resourceType, resourceHandle handle) override = 0;
 	virtual Resource* GetResource(ResourceType resourceType, resourceHandle handle) override = 0;
 };
 
@@ -12,7 +12,6 @@ ResourceManager::ResourceManager(ResourceType type, Allocator& allocator, FileSy
 	: m_allocator(allocator)
 	, m_type(type)
 	, m_fileSystem(fileSystem)
-	, m_asyncOps(m_allocator)
 	, m_resources(m_allocator)
 	, m_depManager(depManager)
 {
@@ -21,26 +20,31 @@ ResourceManager::ResourceManager(ResourceType type, Allocator& allocator, FileSy
 
 ResourceManager::~ResourceManager()
 {
-	for (auto& tmp : m_asyncOps)
-		ASSERT2(false, "Async operation on file in process");
-	for (auto& node : m_resources)
-		ASSERT2(false, "Resource not released");
+	ASSERT2(m_loadingCount == 0, "Resource is still loading");
+	ASSERT2(m_resources.GetSize() == 0, "Resource not released");
 }
 
 
 resourceHandle ResourceManager::Load(const Path& path)
 {
-	Resource** item;
-	if (!m_resources.Find(path.GetHash(), item))
+	Resource* item;
+	if (m_resources.Find(path.GetHash(), item))
 	{
-		Resource* res = CreateResource();
-		item = m_resources.Insert(path.GetHash(), res);
-		LoadResource(path, *item);
+		item->m_refCount++;
+		return GetResourceHandle(item);
 	}
 
-	(*item)->m_refCount++;
+	//reference is taken before load starts, load can finish right away
+	Resource* resource = CreateResource();
+	m_resources.Insert(path.GetHash(), resource);
+	resource->m_path = path;
+	resource->m_state = Resource::State::Loading;
+	resource->m_refCount++;
 
-	return GetResourceHandle(*item);
+	++m_loadingCount;
+	LoadResource(resource).StartDetached();
+
+	return GetResourceHandle(resource);
 }
 
 
@@ -48,19 +52,16 @@ void ResourceManager::Unload(resourceHandle handle)
 {
 	Resource* resource = GetResource(handle);
 
-	if (resource->GetState() == Resource::State::Loading)
-		m_asyncOps.Erase(resource->m_fileHandle);
-
 	Path::Hash hash = resource->m_path.GetHash();
-	Resource** item;
+	Resource* item;
 	if (m_resources.Find(hash, item))
 	{
-		ASSERT(resource == *item);
+		ASSERT(resource == item);
 		if (0 == --resource->m_refCount)
 		{
-			//if(resource->GetState() == Resource::State::Ready)
-				DestroyResource(*item);
 			m_resources.Erase(hash);
+			if (resource->GetState() != Resource::State::Loading)
+				DestroyResource(resource);//loading resource is destroyed when its load finishes
 		}
 	}
 	else
@@ -76,12 +77,12 @@ void ResourceManager::Reload(resourceHandle handle)
 	ASSERT2(resource->GetState() != Resource::State::Loading, "Resource is still loading");
 
 	Path::Hash hash = resource->m_path.GetHash();
-	Resource** item;
+	Resource* item;
 	if (m_resources.Find(hash, item))
 	{
-		ASSERT(resource == *item);
+		ASSERT(resource == item);
 		if (resource->GetState() == Resource::State::Ready)
-			ReloadResource(*item);
+			ReloadResource(item);
 	}
 	else
 	{
@@ -102,7 +103,7 @@ resourceHandle ResourceManager::GetResourceHandle(Resource* resource) const
 }
 
 
-void ResourceManager::LoadResource(const Path& path, Resource* resource)
+Task<> ResourceManager::LoadResource(Resource* resource)
 {
 	const FileMode mode{
 		FileMode::Access::Read,
@@ -111,52 +112,60 @@ void ResourceManager::LoadResource(const Path& path, Resource* resource)
 		FileMode::FlagNone
 	};
 
-	resource->m_path = path;
-	resource->m_state = Resource::State::Loading;
-
-	if (!m_fileSystem.OpenFile(resource->m_fileHandle, path, mode))
+	fileHandle file;
+	if (m_fileSystem.OpenFile(file, resource->m_path, mode))
 	{
-		resource->m_state = Resource::State::Failure;
-		Log(LogType::Error, "File \"%s\" not found", path.GetPath());
-		return;
+		const size_t size = m_fileSystem.GetSize(file);
+		void* buffer = m_allocator.Allocate(size, alignof(char));
+
+		const bool read = co_await m_fileSystem.ReadAsync(file, buffer, size);
+		m_fileSystem.CloseFile(file);
+
+		if (read)
+		{
+			InputBlob blob(static_cast<char*>(buffer), size);
+			co_await ResourceLoaded(GetResourceHandle(resource), blob);
+			if (resource->m_state == Resource::State::Loading)
+				resource->m_state = Resource::State::Ready;
+		}
+		else
+		{
+			resource->m_state = Resource::State::Failure;
+			Log(LogType::Error, "File \"%s\" read failed", resource->m_path.GetPath());
+		}
+
+		m_allocator.Deallocate(buffer);
 	}
-	ResourceAsyncOp tmp;
-	tmp.bufferSize = m_fileSystem.GetSize(resource->m_fileHandle);
-	tmp.buffer = m_allocator.Allocate(tmp.bufferSize, alignof(char));
-	tmp.handle = GetResourceHandle(resource);
-	Function<void(fileHandle)> f;
-	f.Bind<ResourceManager, &ResourceManager::FileSystemCallback>(this);
-	if (!m_fileSystem.Read(resource->m_fileHandle, tmp.buffer, tmp.bufferSize, f))
+	else
 	{
 		resource->m_state = Resource::State::Failure;
-		Log(LogType::Error, "File \"%s\" read failed", path.GetPath());
-		m_fileSystem.CloseFile(resource->m_fileHandle);
-		return;
+		Log(LogType::Error, "File \"%s\" not found", resource->m_path.GetPath());
 	}
 
-	m_asyncOps.Insert(resource->m_fileHandle, tmp);
+	FinishLoading(resource);
 }
 
 
-void ResourceManager::FileSystemCallback(fileHandle handle)
+void ResourceManager::FinishLoading(Resource* resource)
 {
-	ResourceAsyncOp* tmp;
-	if (m_asyncOps.Find(handle, tmp))
-	{
-		Resource* resource = GetResource(tmp->handle);
-		m_fileSystem.CloseFile(resource->m_fileHandle);
-		resource->m_fileHandle = INVALID_FILE_HANDLE;
+	--m_loadingCount;
 
-		InputBlob blob(static_cast<char*>(tmp->buffer), tmp->bufferSize);
-
-		ResourceLoaded(tmp->handle, blob);
-
-		m_allocator.Deallocate(tmp->buffer);
-		ASSERT(m_asyncOps.Erase(handle));
+	//nobody can wait for resource without reference to it
+	if (resource->m_refCount == 0)
+	{
+		ASSERT(resource->m_waiters == nullptr);
+		DestroyResource(resource);
+		return;
 	}
-	else
+
+	//resumed waiter can be destroyed by its own completion, next one has to be read before
+	ResourceAwaiter* waiter = resource->m_waiters;
+	resource->m_waiters = nullptr;
+	while (waiter != nullptr)
 	{
-		ASSERT2(false, "No ResourceAsyncOp exists for fileHandle returned by callback");
+		ResourceAwaiter* next = waiter->m_next;
+		waiter->m_coroutine.resume();
+		waiter = next;
 	}
 }
 
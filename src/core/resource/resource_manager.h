@@ -1,8 +1,9 @@
 #pragma once
 
 #include "core/allocator.h"
-#include "core/containers/hash_map.h"
+#include "core/containers/concurrent_hash_map.h"
 #include "core/file/file_system.h"
+#include "core/threading/task.h"
 
 #include "resource.h"
 #include "dependency_manager.h"
@@ -15,16 +16,6 @@ class InputBlob;
 class DependencyManager;
 
 
-template<>
-struct HashFunc<fileHandle>
-{
-	static u32 get(const fileHandle& key)
-	{
-		return static_cast<u32>(key) * 37;
-	}
-};
-
-
 class ResourceManager
 {
 	friend class ResourceManagementImpl;
@@ -50,32 +41,24 @@ protected:
 	virtual void DestroyResource(Resource* resource) = 0;
 	virtual void ReloadResource(Resource* resource) = 0;
 
-	virtual void ResourceLoaded(resourceHandle handle, InputBlob& data) = 0;
-	virtual void ChildResourceLoaded(resourceHandle handle, ResourceType type) { }
+	//data stays valid until returned task finishes, resource becomes Ready then unless task set its state
+	virtual Task<> ResourceLoaded(resourceHandle handle, InputBlob& data) = 0;
 
 	const FileSystem& GetFileSystem() const { return m_fileSystem; }
 
 private:
-	void LoadResource(const Path& path, Resource* resource);
-	void FileSystemCallback(fileHandle handle);
+	Task<> LoadResource(Resource* resource);
+	void FinishLoading(Resource* resource);
 
 protected:
 	Allocator& m_allocator;
-	HashMap<Path::Hash, Resource*> m_resources;
+	ConcurrentHashMap<Path::Hash, Resource*> m_resources;//lookups from any thread, ref counts still change on main one
 	DependencyManager* m_depManager;
 	ResourceType m_type;
 
-private:
-	struct ResourceAsyncOp
-	{
-		void* buffer;
-		size_t bufferSize;
-		resourceHandle handle;
-	};
-
 private:
 	FileSystem& m_fileSystem;
-	HashMap<fileHandle, ResourceAsyncOp> m_asyncOps;
+	u32 m_loadingCount = 0;
 };
 
 
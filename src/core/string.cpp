@@ -185,22 +185,21 @@ const char& String::operator[](unsigned index) const
 String& String::Cat(const char* str)
 {
 	if (str != nullptr && str[0] != '\0')
-	{
-		size_t strLen = string::Length(str);
-		char* newData = (char*)m_allocator.Allocate(m_size + strLen + 1, sizeof(char));
-		string::Copy(newData, m_data, m_size);
-		string::Copy(newData + m_size, str, strLen);
-		m_size += strLen;
-		newData[m_size] = '\0';
-		m_allocator.Deallocate(m_data);
-		m_data = newData;
-	}
+		Cat(str, (unsigned)string::Length(str));
 	return *this;
 }
 
 
 String& String::Cat(const char* str, unsigned length)
 {
+	if (m_data != nullptr && m_allocator.TryExpand(m_data, m_size + length + 1))
+	{
+		string::Copy(m_data + m_size, str, length);
+		m_size += length;
+		m_data[m_size] = '\0';
+		return *this;
+	}
+
 	char* newData = (char*)m_allocator.Allocate(m_size + length + 1, sizeof(char));
 	string::Copy(newData, m_data, m_size);
 	string::Copy(newData + m_size, str, length);
@@ -2,6 +2,7 @@
 
 #include "core.h"
 #include "allocator.h"
+#include "asserts.h"
 
 
 namespace Veng
@@ -88,7 +89,7 @@ public:
 		: StaticInputBuffer(other.m_data)
 	{
 		size_t len = string::Length(str);
-		Add(str, len)
+		Add(str, len);
 	}
 
 	~StaticInputBuffer() {}
@@ -58,6 +58,18 @@ public:
 
 	virtual void Clear() = 0;
 	virtual void Update(float deltaTime) = 0;
+
+	//batches from command buffer playback, entities are sorted and unique; override to merge them at once
+	virtual void AddComponents(const ComponentBase& component, const Entity* entities, size_t count)
+	{
+		for (size_t i = 0; i < count; ++i)
+			component.Create(*this, entities[i]);
+	}
+	virtual void RemoveComponents(const ComponentBase& component, const Entity* entities, size_t count)
+	{
+		for (size_t i = 0; i < count; ++i)
+			component.Destroy(*this, entities[i]);
+	}
 };
 
 
@@ -70,6 +82,37 @@ public:
 };
 
 
+//data system reads or writes in Update, systems without conflicting access are updated concurrently
+typedef u32 SystemDataFlags;
+enum SystemDataBits : SystemDataFlags
+{
+	SystemData_None = 0,
+	SystemData_Worlds = 1 << 0,//entities and world list
+	SystemData_Transforms = 1 << 1,
+	SystemData_RenderScene = 1 << 2,
+	SystemData_Resources = 1 << 3,
+	SystemData_Input = 1 << 4,
+	SystemData_All = 0xffffffff,
+};
+
+struct SystemAccess
+{
+	SystemDataFlags read = SystemData_All;
+	SystemDataFlags write = SystemData_All;
+	bool mainThread = true;//Update has to run on thread which calls Engine::Update, e.g. because it uses bgfx api
+};
+
+
+//duration of system's last Update, times are in milliseconds from start of frame's system updates
+struct SystemTiming
+{
+	const char* name;
+	float start;
+	float duration;
+	bool criticalPath;//part of longest chain of dependent updates which bounded the frame
+};
+
+
 class System
 {
 public:
@@ -83,6 +126,8 @@ public:
 
 	virtual void Update(float deltaTime) = 0;
 	virtual const char* GetName() const = 0;
+	//default access conflicts with every system, so such system is updated alone in registration order
+	virtual SystemAccess GetAccess() const { return SystemAccess(); }
 
 	virtual Scene* GetScene(worldId world) const = 0;
 	virtual const ComponentBase** GetComponents(uint& count) const = 0;
@@ -0,0 +1,226 @@
+#include "system_scheduler.h"
+
+#include "core/threading/os_utils.h"
+#include "core/os/os_utils.h"
+
+
+namespace Veng
+{
+
+
+static bool AccessConflicts(const SystemAccess& a, const SystemAccess& b)
+{
+	return (a.write & (b.read | b.write)) != 0 || (b.write & a.read) != 0;
+}
+
+
+SystemScheduler::SystemScheduler(Allocator& allocator, JobSystem& jobSystem)
+	: m_jobSystem(jobSystem)
+	, m_nodes(allocator)
+	, m_successors(allocator)
+	, m_timings(allocator)
+{
+}
+
+
+void SystemScheduler::Update(System* const* systems, size_t count, float deltaTime)
+{
+	m_deltaTime = deltaTime;
+	BuildGraph(systems, count);
+
+	m_frameStart = os::GetTimerValue();
+	const bool parallel = m_parallel && m_jobSystem.GetWorkerCount() > 0;
+	if (parallel)
+		UpdateParallel();
+	else
+		UpdateSerial();
+
+	CollectTimings(!parallel);
+}
+
+
+void SystemScheduler::SetParallel(bool parallel)
+{
+	m_parallel = parallel;
+}
+
+bool SystemScheduler::IsParallel() const
+{
+	return m_parallel;
+}
+
+
+const SystemTiming* SystemScheduler::GetTimings(size_t& count) const
+{
+	count = m_timings.GetSize();
+	return m_timings.Begin();
+}
+
+float SystemScheduler::GetCriticalPathTime() const
+{
+	return m_criticalPathTime;
+}
+
+
+//access can change between frames, graph is rebuilt every update; edges only go from earlier to later registered system
+void SystemScheduler::BuildGraph(System* const* systems, size_t count)
+{
+	m_nodes.Clear();
+	m_successors.Clear();
+
+	for (size_t i = 0; i < count; ++i)
+	{
+		Node& node = m_nodes.PushBack();
+		node.scheduler = this;
+		node.system = systems[i];
+		node.access = systems[i]->GetAccess();
+		node.successorCount = 0;
+		node.dependencyCount = 0;
+		node.criticalPredecessor = -1;
+		node.start = 0;
+		node.end = 0;
+	}
+
+	for (size_t i = 0; i < count; ++i)
+	{
+		Node& node = m_nodes[i];
+		node.firstSuccessor = (u32)m_successors.GetSize();
+		for (size_t j = i + 1; j < count; ++j)
+		{
+			if (AccessConflicts(node.access, m_nodes[j].access))
+			{
+				m_successors.PushBack((u32)j);
+				++node.successorCount;
+				++m_nodes[j].dependencyCount;
+			}
+		}
+	}
+
+	for (Node& node : m_nodes)
+		node.pendingDependencies.value = (i32)node.dependencyCount;
+}
+
+
+void SystemScheduler::UpdateSerial()
+{
+	for (Node& node : m_nodes)
+	{
+		node.start = os::GetTimerValue();
+		node.system->Update(m_deltaTime);
+		node.end = os::GetTimerValue();
+	}
+}
+
+
+//main thread systems run on calling thread in registration order, the rest as jobs once their dependencies finish;
+//while main thread system waits for its dependencies, calling thread executes queued jobs
+void SystemScheduler::UpdateParallel()
+{
+	JobCounter counter;
+	m_counter = &counter;
+
+	for (Node& node : m_nodes)
+	{
+		if (!node.access.mainThread && node.dependencyCount == 0)
+			RunNodeJob(node);
+	}
+
+	for (Node& node : m_nodes)
+	{
+		if (!node.access.mainThread)
+			continue;
+
+		m_jobSystem.Wait(&node.pendingDependencies);
+		UpdateNode(node);
+	}
+	m_jobSystem.Wait(&counter);
+
+	m_counter = nullptr;
+}
+
+
+void SystemScheduler::RunNodeJob(Node& node)
+{
+	Job job;
+	job.function = &NodeJob;
+	job.data = &node;
+	m_jobSystem.Run(&job, 1, m_counter);
+}
+
+
+//successors are queued before job finishes, so counter can't drop to zero while graph is still running;
+//main thread successors are waited for by UpdateParallel on their pending counter
+void SystemScheduler::UpdateNode(Node& node)
+{
+	node.start = os::GetTimerValue();
+	node.system->Update(m_deltaTime);
+	node.end = os::GetTimerValue();
+
+	for (u32 i = 0; i < node.successorCount; ++i)
+	{
+		Node& successor = m_nodes[m_successors[node.firstSuccessor + i]];
+		if (AtomicAdd(&successor.pendingDependencies.value, -1) == 1 && !successor.access.mainThread)
+			RunNodeJob(successor);
+	}
+}
+
+
+void SystemScheduler::NodeJob(void* data)
+{
+	Node& node = *static_cast<Node*>(data);
+	node.scheduler->UpdateNode(node);
+}
+
+
+void SystemScheduler::HoldBack(u32 predecessor, Node& node)
+{
+	if (node.criticalPredecessor == -1 || m_nodes[predecessor].end > m_nodes[node.criticalPredecessor].end)
+		node.criticalPredecessor = (i32)predecessor;
+}
+
+
+void SystemScheduler::CollectTimings(bool serial)
+{
+	//node's start was held back by dependency which finished last; nodes updated on calling thread also wait
+	//for the one updated there before them, even without any dependency between them
+	i32 previousOnCaller = -1;
+	for (size_t i = 0; i < m_nodes.GetSize(); ++i)
+	{
+		Node& node = m_nodes[i];
+		if (serial || node.access.mainThread)
+		{
+			if (previousOnCaller != -1)
+				HoldBack((u32)previousOnCaller, node);
+			previousOnCaller = (i32)i;
+		}
+
+		for (u32 s = 0; s < node.successorCount; ++s)
+			HoldBack((u32)i, m_nodes[m_successors[node.firstSuccessor + s]]);
+	}
+
+	const float ticksToMs = 1000.0f / (float)os::GetTimerFrequency();
+	m_timings.Clear();
+	i32 last = -1;
+	for (size_t i = 0; i < m_nodes.GetSize(); ++i)
+	{
+		const Node& node = m_nodes[i];
+		SystemTiming& timing = m_timings.PushBack();
+		timing.name = node.system->GetName();
+		timing.start = (float)(node.start - m_frameStart) * ticksToMs;
+		timing.duration = (float)(node.end - node.start) * ticksToMs;
+		timing.criticalPath = false;
+
+		if (last == -1 || node.end > m_nodes[last].end)
+			last = (i32)i;
+	}
+
+	m_criticalPathTime = 0.0f;
+	for (i32 i = last; i != -1; i = m_nodes[i].criticalPredecessor)
+	{
+		m_timings[i].criticalPath = true;
+		m_criticalPathTime += m_timings[i].duration;
+	}
+}
+
+
+}
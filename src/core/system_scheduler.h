@@ -0,0 +1,71 @@
+#pragma once
+
+#include "core/system.h"
+#include "core/containers/array.h"
+#include "core/threading/jobs.h"
+
+
+namespace Veng
+{
+
+//updates systems as dependency graph built from their declared access, systems with conflicting access
+//keep registration order, so results don't depend on worker count
+class SystemScheduler final
+{
+public:
+	SystemScheduler(Allocator& allocator, JobSystem& jobSystem);
+	SystemScheduler(SystemScheduler&) = delete;
+	SystemScheduler& operator =(SystemScheduler&) = delete;
+
+	void Update(System* const* systems, size_t count, float deltaTime);
+
+	//serial update runs systems one by one in registration order on calling thread
+	void SetParallel(bool parallel);
+	bool IsParallel() const;
+
+	//timings of last Update, in registration order
+	const SystemTiming* GetTimings(size_t& count) const;
+	//sum of update durations on critical path, in milliseconds
+	float GetCriticalPathTime() const;
+
+private:
+	struct Node
+	{
+		SystemScheduler* scheduler;
+		System* system;
+		SystemAccess access;
+		u32 firstSuccessor;
+		u32 successorCount;
+		u32 dependencyCount;
+		JobCounter pendingDependencies;//decreased by predecessors as they finish, node can run at zero
+		i32 criticalPredecessor;//dependency which finished last, -1 for none
+		u64 start;
+		u64 end;
+	};
+
+private:
+	void BuildGraph(System* const* systems, size_t count);
+	void UpdateSerial();
+	void UpdateParallel();
+	void UpdateNode(Node& node);
+	void RunNodeJob(Node& node);
+	//node's critical predecessor becomes given one if that finished later than current one
+	void HoldBack(u32 predecessor, Node& node);
+	void CollectTimings(bool serial);
+
+	static void NodeJob(void* data);
+
+private:
+	JobSystem& m_jobSystem;
+	Array<Node> m_nodes;
+	Array<u32> m_successors;
+	Array<SystemTiming> m_timings;
+	JobCounter* m_counter = nullptr;
+	u64 m_frameStart = 0;
+	float m_criticalPathTime = 0.0f;
+	float m_deltaTime = 0.0f;
+	bool m_parallel = true;
+};
+
+
+}
@@ -0,0 +1,387 @@
+#include "jobs.h"
+
+#include "threads.h"
+#include "os_utils.h"
+#include "core/allocator.h"
+#include "core/asserts.h"
+#include "core/containers/circular_buffer.h"
+#include "core/math/math.h"
+#include "core/os/os_utils.h"
+
+
+namespace Veng
+{
+
+
+struct QueuedJob
+{
+	Job job;
+	JobCounter* counter;
+};
+
+
+//Chase-Lev deque, owner pushes and pops at bottom, other threads steal from top
+class alignas(64) JobQueue
+{
+public:
+	static const i64 CAPACITY = 4096;
+
+public:
+	bool Push(const QueuedJob& job)
+	{
+		const i64 bottom = AtomicLoad(&m_bottom, MemoryOrder::Relaxed);
+		if (bottom - AtomicLoad(&m_top, MemoryOrder::Acquire) >= CAPACITY)
+			return false;
+
+		m_jobs[bottom & (CAPACITY - 1)] = job;
+		AtomicStore(&m_bottom, bottom + 1, MemoryOrder::Release);//job has to be visible before thieves can see new bottom
+		return true;
+	}
+
+	bool Pop(QueuedJob& job)
+	{
+		const i64 bottom = AtomicLoad(&m_bottom, MemoryOrder::Relaxed) - 1;
+		AtomicStore(&m_bottom, bottom, MemoryOrder::Relaxed);
+		MemoryFence();//reservation of bottom has to be visible before top is read
+		const i64 top = AtomicLoad(&m_top, MemoryOrder::Relaxed);
+
+		if (top > bottom)
+		{
+			AtomicStore(&m_bottom, bottom + 1, MemoryOrder::Relaxed);
+			return false;
+		}
+
+		job = m_jobs[bottom & (CAPACITY - 1)];
+		if (top != bottom)
+			return true;
+
+		//last job, thieves compete for it too
+		const bool taken = AtomicCompareExchange64(&m_top, top + 1, top) == top;
+		AtomicStore(&m_bottom, bottom + 1, MemoryOrder::Relaxed);
+		return taken;
+	}
+
+	bool Steal(QueuedJob& job)
+	{
+		const i64 top = AtomicLoad(&m_top, MemoryOrder::Acquire);
+		MemoryFence();
+		const i64 bottom = AtomicLoad(&m_bottom, MemoryOrder::Acquire);
+		if (top >= bottom)
+			return false;
+
+		job = m_jobs[top & (CAPACITY - 1)];
+		return AtomicCompareExchange64(&m_top, top + 1, top) == top;
+	}
+
+	bool IsEmpty() const
+	{
+		return AtomicLoad(&m_top, MemoryOrder::Relaxed) >= AtomicLoad(&m_bottom, MemoryOrder::Relaxed);
+	}
+
+private:
+	volatile i64 m_top = 0;
+	alignas(64) volatile i64 m_bottom = 0;
+	alignas(64) QueuedJob m_jobs[CAPACITY];
+};
+
+
+class JobSystemImpl;
+
+struct Worker
+{
+	JobQueue queue;
+	JobSystemImpl* system = nullptr;
+	threadHandle thread = nullptr;
+	u32 index = 0;
+	u32 random = 0;
+};
+
+
+static thread_local Worker* s_worker = nullptr;
+
+
+struct ParallelForData
+{
+	ParallelForFunction function;
+	void* data;
+	size_t begin;
+	size_t end;
+	size_t grain;
+	i32 chunkCount;
+	volatile i32 nextChunk;
+};
+
+//every job takes chunks until none are left, so busy workers don't hold ranges others could process
+static void ParallelForJob(void* data)
+{
+	ParallelForData& parallelFor = *static_cast<ParallelForData*>(data);
+	for (;;)
+	{
+		const i32 chunk = AtomicAdd(&parallelFor.nextChunk, 1);
+		if (chunk >= parallelFor.chunkCount)
+			return;
+
+		const size_t rangeBegin = parallelFor.begin + chunk * parallelFor.grain;
+		parallelFor.function(parallelFor.data, rangeBegin, Min(rangeBegin + parallelFor.grain, parallelFor.end));
+	}
+}
+
+
+class JobSystemImpl : public JobSystem
+{
+public:
+	static const size_t INJECTED_CAPACITY = 1024;
+
+	JobSystemImpl(Allocator& allocator, u32 workerCount)
+		: m_allocator(allocator)
+		, m_workerCount(workerCount)
+		, m_injected(allocator, INJECTED_CAPACITY)
+	{
+		ASSERT2(s_worker == nullptr, "Only one job system can run on a thread");
+
+		//index 0 belongs to thread which created job system
+		m_workers = static_cast<Worker*>(m_allocator.Allocate((m_workerCount + 1) * sizeof(Worker), alignof(Worker)));
+		for (u32 i = 0; i <= m_workerCount; ++i)
+		{
+			Worker* worker = NEW_PLACEMENT(m_workers + i, Worker)();
+			worker->system = this;
+			worker->index = i;
+			worker->random = 0x9e3779b9 * (i + 1);
+		}
+
+		s_worker = &m_workers[0];
+		for (u32 i = 1; i <= m_workerCount; ++i)
+			m_workers[i].thread = StartThread(&WorkerMain, &m_workers[i]);
+	}
+
+	~JobSystemImpl() override
+	{
+		ASSERT2(s_worker == &m_workers[0], "Job system has to be destroyed by thread which created it");
+
+		AtomicStore(&m_exit, 1);
+		m_semaphore.Signal((i32)m_workerCount);
+		for (u32 i = 1; i <= m_workerCount; ++i)
+			JoinThread(m_workers[i].thread);
+
+		for (u32 i = 0; i <= m_workerCount; ++i)
+		{
+			ASSERT2(m_workers[i].queue.IsEmpty(), "Job system destroyed with pending jobs");
+			DELETE_PLACEMENT(m_workers + i);
+		}
+		ASSERT2(m_injected.IsEmpty(), "Job system destroyed with pending jobs");
+		m_allocator.Deallocate(m_workers);
+		s_worker = nullptr;
+	}
+
+
+	void Run(const Job* jobs, size_t count, JobCounter* counter) override
+	{
+		Worker* worker = GetOwnWorker();
+
+		if (count == 0)
+			return;
+
+		if (counter != nullptr)
+			AtomicAdd(&counter->value, (i32)count);
+
+		for (size_t i = 0; i < count; ++i)
+		{
+			const QueuedJob queued = { jobs[i], counter };
+			const bool pushed = (worker != nullptr) ? worker->queue.Push(queued) : m_injected.Push(queued);
+			if (!pushed)
+				Execute(queued);//queue is full, run it right away rather than wait for space
+		}
+
+		MemoryFence();
+		const i32 sleeping = AtomicLoad(&m_sleeping);
+		if (sleeping > 0)
+			m_semaphore.Signal(Min(sleeping, (i32)count));
+	}
+
+	void Wait(JobCounter* counter) override
+	{
+		Worker* worker = GetOwnWorker();
+		u32 random = 0x9e3779b9 * (GetThreadIndex() + 1);
+
+		while (AtomicLoad(&counter->value, MemoryOrder::Acquire) > 0)
+		{
+			QueuedJob job;
+			const bool found = (worker != nullptr) ? GetJob(*worker, job) : StealJob(nullptr, random, job);
+			if (found)
+				Execute(job);
+			else
+				CpuRelax();
+		}
+	}
+
+	void ParallelFor(size_t begin, size_t end, size_t grain, ParallelForFunction function, void* data) override
+	{
+		if (begin >= end)
+			return;
+
+		grain = Max(grain, (size_t)1);
+		const size_t chunkCount = (end - begin + grain - 1) / grain;
+		ASSERT2(chunkCount < 0x7fffffff, "Too many chunks, use bigger grain");
+		if (chunkCount == 1)
+		{
+			function(data, begin, end);
+			return;
+		}
+
+		ParallelForData parallelFor;
+		parallelFor.function = function;
+		parallelFor.data = data;
+		parallelFor.begin = begin;
+		parallelFor.end = end;
+		parallelFor.grain = grain;
+		parallelFor.chunkCount = (i32)chunkCount;
+		parallelFor.nextChunk = 0;
+
+		//calling thread is one of the executors
+		Job jobs[MAX_WORKERS];
+		const size_t jobCount = Min(chunkCount - 1, (size_t)m_workerCount);
+		for (size_t i = 0; i < jobCount; ++i)
+		{
+			jobs[i].function = &ParallelForJob;
+			jobs[i].data = &parallelFor;
+		}
+
+		JobCounter counter;
+		Run(jobs, jobCount, &counter);
+		ParallelForJob(&parallelFor);
+		Wait(&counter);
+	}
+
+	u32 GetWorkerCount() const override
+	{
+		return m_workerCount;
+	}
+
+private:
+	static u32 WorkerMain(void* data)
+	{
+		Worker* worker = static_cast<Worker*>(data);
+		s_worker = worker;
+		worker->system->WorkerLoop(*worker);
+		s_worker = nullptr;
+		return 0;
+	}
+
+	void WorkerLoop(Worker& worker)
+	{
+		static const u32 SPIN_COUNT = 64;
+
+		u32 idleSpins = 0;
+		while (AtomicLoad(&m_exit, MemoryOrder::Relaxed) == 0)
+		{
+			QueuedJob job;
+			if (GetJob(worker, job))
+			{
+				Execute(job);
+				idleSpins = 0;
+				continue;
+			}
+
+			if (++idleSpins < SPIN_COUNT)
+			{
+				CpuRelax();
+				continue;
+			}
+
+			//check for jobs again after announcing sleep, Run reads sleeping count after pushing
+			AtomicAdd(&m_sleeping, 1);
+			if (!HasJobs() && AtomicLoad(&m_exit) == 0)
+				m_semaphore.Wait();
+			AtomicAdd(&m_sleeping, -1);
+			idleSpins = 0;
+		}
+	}
+
+	//null for threads outside of this job system
+	Worker* GetOwnWorker() const
+	{
+		Worker* worker = s_worker;
+		return (worker != nullptr && worker->system == this) ? worker : nullptr;
+	}
+
+	bool GetJob(Worker& worker, QueuedJob& job)
+	{
+		if (worker.queue.Pop(job))
+			return true;
+
+		return StealJob(&worker, worker.random, job);
+	}
+
+	//injected jobs go first, there is no owner which would pop them
+	bool StealJob(const Worker* thief, u32& random, QueuedJob& job)
+	{
+		if (m_injected.Pop(job))
+			return true;
+
+		//xorshift, so thieves don't all start with the same victim
+		random ^= random << 13;
+		random ^= random >> 17;
+		random ^= random << 5;
+
+		const u32 count = m_workerCount + 1;
+		const u32 first = random % count;
+		for (u32 i = 0; i < count; ++i)
+		{
+			Worker& victim = m_workers[(first + i) % count];
+			if (&victim != thief && victim.queue.Steal(job))
+				return true;
+		}
+		return false;
+	}
+
+	bool HasJobs() const
+	{
+		if (!m_injected.IsEmpty())
+			return true;
+
+		for (u32 i = 0; i <= m_workerCount; ++i)
+		{
+			if (!m_workers[i].queue.IsEmpty())
+				return true;
+		}
+		return false;
+	}
+
+	void Execute(const QueuedJob& job)
+	{
+		job.job.function(job.job.data);
+		if (job.counter != nullptr)
+			AtomicAdd(&job.counter->value, -1);
+	}
+
+private:
+	Allocator& m_allocator;
+	u32 m_workerCount;
+	Worker* m_workers = nullptr;
+	MPMCQueue<QueuedJob> m_injected;//jobs run from threads outside of job system
+	Semaphore m_semaphore;
+	volatile i32 m_sleeping = 0;
+	volatile i32 m_exit = 0;
+};
+
+
+JobSystem* JobSystem::Create(Allocator& allocator, u32 workerCount)
+{
+	if (workerCount == DEFAULT_WORKER_COUNT)
+	{
+		const u32 processors = os::GetSystemInfo().numberOfProcessors;
+		workerCount = (processors > 1) ? processors - 1 : 0;
+	}
+	workerCount = Min(workerCount, MAX_WORKERS);
+
+	return NEW_OBJECT(allocator, JobSystemImpl)(allocator, workerCount);
+}
+
+
+void JobSystem::Destroy(JobSystem* system, Allocator& allocator)
+{
+	DELETE_OBJECT(allocator, system);
+}
+
+
+}
@@ -0,0 +1,65 @@
+#pragma once
+
+#include "core/int.h"
+
+
+namespace Veng
+{
+
+class Allocator;
+
+
+struct Job
+{
+	void (*function)(void* data) = nullptr;
+	void* data = nullptr;
+};
+
+
+struct JobCounter
+{
+	volatile i32 value = 0;
+};
+
+
+typedef void (*ParallelForFunction)(void* data, size_t begin, size_t end);
+
+
+//work stealing scheduler; threads outside of it can run and wait on jobs too, their jobs go to shared queue
+//and while waiting they only take jobs, they never own any
+class JobSystem
+{
+public:
+	static const u32 MAX_WORKERS = 48;
+	static const u32 DEFAULT_WORKER_COUNT = ~0u;//one worker per core besides calling thread
+
+	//zero workerCount creates no workers, calling thread then runs every job while it waits
+	static JobSystem* Create(Allocator& allocator, u32 workerCount = DEFAULT_WORKER_COUNT);
+	static void Destroy(JobSystem* system, Allocator& allocator);
+
+public:
+	virtual ~JobSystem() {}
+
+	//counter is increased by count and decreased as jobs finish, it can be null or shared by several calls
+	virtual void Run(const Job* jobs, size_t count, JobCounter* counter) = 0;
+	//executes other jobs until counter drops to zero
+	virtual void Wait(JobCounter* counter) = 0;
+
+	//splits [begin, end) into ranges of grain elements, calling thread takes part and returns when all are done
+	virtual void ParallelFor(size_t begin, size_t end, size_t grain, ParallelForFunction function, void* data) = 0;
+
+	virtual u32 GetWorkerCount() const = 0;
+};
+
+
+template<class FunctionType>
+void ParallelFor(JobSystem& jobSystem, size_t begin, size_t end, size_t grain, FunctionType function)
+{
+	jobSystem.ParallelFor(begin, end, grain, [](void* data, size_t rangeBegin, size_t rangeEnd)
+	{
+		(*static_cast<FunctionType*>(data))(rangeBegin, rangeEnd);
+	}, &function);
+}
+
+
+}
@@ -0,0 +1,194 @@
+#include "../os_utils.h"
+
+#include "core/asserts.h"
+
+#include <pthread.h>
+#include <sched.h>
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#include <limits.h>
+
+
+namespace Veng
+{
+
+
+void CpuRelax()
+{
+#if defined(__x86_64__) || defined(__i386__)
+	__builtin_ia32_pause();
+#elif defined(__aarch64__)
+	asm volatile("yield");
+#endif
+}
+
+void YieldThread()
+{
+	sched_yield();
+}
+
+
+//builtins want constant order, release and acq_rel are not valid for loads nor acquire for stores
+#define ATOMIC_LOAD(source, order) \
+	switch (order) \
+	{ \
+		case MemoryOrder::Relaxed: return __atomic_load_n(source, __ATOMIC_RELAXED); \
+		case MemoryOrder::Acquire: return __atomic_load_n(source, __ATOMIC_ACQUIRE); \
+		default: return __atomic_load_n(source, __ATOMIC_SEQ_CST); \
+	}
+
+#define ATOMIC_STORE(destination, value, order) \
+	switch (order) \
+	{ \
+		case MemoryOrder::Relaxed: __atomic_store_n(destination, value, __ATOMIC_RELAXED); break; \
+		case MemoryOrder::Release: __atomic_store_n(destination, value, __ATOMIC_RELEASE); break; \
+		default: __atomic_store_n(destination, value, __ATOMIC_SEQ_CST); break; \
+	}
+
+
+i32 AtomicLoad(const volatile i32* source, MemoryOrder order)
+{
+	ATOMIC_LOAD(source, order);
+}
+
+i64 AtomicLoad(const volatile i64* source, MemoryOrder order)
+{
+	ATOMIC_LOAD(source, order);
+}
+
+void* AtomicLoad(void* const volatile* source, MemoryOrder order)
+{
+	ATOMIC_LOAD(source, order);
+}
+
+void AtomicStore(volatile i32* destination, const i32 value, MemoryOrder order)
+{
+	ATOMIC_STORE(destination, value, order);
+}
+
+void AtomicStore(volatile i64* destination, const i64 value, MemoryOrder order)
+{
+	ATOMIC_STORE(destination, value, order);
+}
+
+void AtomicStore(void* volatile* destination, void* value, MemoryOrder order)
+{
+	ATOMIC_STORE(destination, value, order);
+}
+
+#undef ATOMIC_LOAD
+#undef ATOMIC_STORE
+
+
+i32 AtomicAdd(volatile i32* addend, const i32 value)
+{
+	return __atomic_fetch_add(addend, value, __ATOMIC_SEQ_CST);
+}
+
+i64 AtomicAdd(volatile i64* addend, const i64 value)
+{
+	return __atomic_fetch_add(addend, value, __ATOMIC_SEQ_CST);
+}
+
+
+i32 AtomicExchange(volatile i32* destination, const i32 value)
+{
+	return __atomic_exchange_n(destination, value, __ATOMIC_SEQ_CST);
+}
+
+i64 AtomicExchange(volatile i64* destination, const i64 value)
+{
+	return __atomic_exchange_n(destination, value, __ATOMIC_SEQ_CST);
+}
+
+void* AtomicExchange(void* volatile* destination, void* value)
+{
+	return __atomic_exchange_n(destination, value, __ATOMIC_SEQ_CST);
+}
+
+
+i32 AtomicCompareExchange(volatile i32* destination, const i32 exchange, const i32 comperand)
+{
+	i32 expected = comperand;
+	__atomic_compare_exchange_n(destination, &expected, exchange, false, __ATOMIC_SEQ_CST, __ATOMIC_SEQ_CST);
+	return expected;
+}
+
+i64 AtomicCompareExchange64(volatile i64* destination, const i64 exchange, const i64 comperand)
+{
+	i64 expected = comperand;
+	__atomic_compare_exchange_n(destination, &expected, exchange, false, __ATOMIC_SEQ_CST, __ATOMIC_SEQ_CST);
+	return expected;
+}
+
+void* AtomicCompareExchangePointer(void* volatile* destination, void* exchange, void* comperand)
+{
+	void* expected = comperand;
+	__atomic_compare_exchange_n(destination, &expected, exchange, false, __ATOMIC_SEQ_CST, __ATOMIC_SEQ_CST);
+	return expected;
+}
+
+
+void MemoryFence()
+{
+	__atomic_thread_fence(__ATOMIC_SEQ_CST);
+}
+
+
+void FutexWait(volatile i32* address, const i32 expected)
+{
+	//EAGAIN when value already differs and EINTR are both fine, callers recheck their condition
+	syscall(SYS_futex, address, FUTEX_WAIT_PRIVATE, expected, nullptr, nullptr, 0);
+}
+
+void FutexWakeOne(volatile i32* address)
+{
+	syscall(SYS_futex, address, FUTEX_WAKE_PRIVATE, 1, nullptr, nullptr, 0);
+}
+
+void FutexWakeAll(volatile i32* address)
+{
+	syscall(SYS_futex, address, FUTEX_WAKE_PRIVATE, INT_MAX, nullptr, nullptr, 0);
+}
+
+
+struct ThreadStart
+{
+	ThreadFunction function;
+	void* data;
+	volatile i32 started;
+};
+
+static void* ThreadMain(void* arg)
+{
+	ThreadStart* start = static_cast<ThreadStart*>(arg);
+	ThreadFunction function = start->function;
+	void* data = start->data;
+	AtomicStore(&start->started, 1, MemoryOrder::Release);//start lives on stack of StartThread
+
+	return (void*)(uintptr)function(data);
+}
+
+threadHandle StartThread(ThreadFunction function, void* data)
+{
+	ThreadStart start = { function, data, 0 };
+	pthread_t thread;
+	if (pthread_create(&thread, nullptr, &ThreadMain, &start) != 0)
+	{
+		ASSERT2(false, "Thread was not created");
+		return nullptr;
+	}
+
+	while (AtomicLoad(&start.started, MemoryOrder::Acquire) == 0)
+		sched_yield();
+	return (threadHandle)thread;
+}
+
+void JoinThread(threadHandle thread)
+{
+	pthread_join((pthread_t)thread, nullptr);
+}
+
+
+}
@@ -8,12 +8,54 @@ namespace Veng
 
 
 void CpuRelax();//TODO: function call is overkill
+//gives rest of time slice to other threads, for waits which can outlast spinning
+void YieldThread();
 
 
+enum class MemoryOrder : u32
+{
+	Relaxed,
+	Acquire,
+	Release,
+	AcquireRelease,
+	SequentiallyConsistent,
+};
+
+
+//read-modify-write operations are sequentially consistent and return previous value
+i32 AtomicLoad(const volatile i32* source, MemoryOrder order = MemoryOrder::SequentiallyConsistent);
+i64 AtomicLoad(const volatile i64* source, MemoryOrder order = MemoryOrder::SequentiallyConsistent);
+void* AtomicLoad(void* const volatile* source, MemoryOrder order = MemoryOrder::SequentiallyConsistent);
+
+void AtomicStore(volatile i32* destination, const i32 value, MemoryOrder order = MemoryOrder::SequentiallyConsistent);
+void AtomicStore(volatile i64* destination, const i64 value, MemoryOrder order = MemoryOrder::SequentiallyConsistent);
+void AtomicStore(void* volatile* destination, void* value, MemoryOrder order = MemoryOrder::SequentiallyConsistent);
+
+i32 AtomicAdd(volatile i32* addend, const i32 value);
+i64 AtomicAdd(volatile i64* addend, const i64 value);
+
+i32 AtomicExchange(volatile i32* destination, const i32 value);
+i64 AtomicExchange(volatile i64* destination, const i64 value);
+void* AtomicExchange(void* volatile* destination, void* value);
+
 i32 AtomicCompareExchange(volatile i32* destination, const i32 exchange, const i32 comperand);
+i64 AtomicCompareExchange64(volatile i64* destination, const i64 exchange, const i64 comperand);
+void* AtomicCompareExchangePointer(void* volatile* destination, void* exchange, void* comperand);
+
+void MemoryFence();//full barrier, no load or store is reordered across it
+
+
+//blocks while value at address equals expected, may return spuriously
+void FutexWait(volatile i32* address, const i32 expected);
+void FutexWakeOne(volatile i32* address);
+void FutexWakeAll(volatile i32* address);
+
 
+typedef void* threadHandle;
+typedef u32(*ThreadFunction)(void* data);
 
-//other atomics
+threadHandle StartThread(ThreadFunction function, void* data);
+void JoinThread(threadHandle thread);//waits until thread finishes and releases its handle
 
 
 }
@@ -0,0 +1,45 @@
+#include "task.h"
+
+
+
+namespace Veng
+{
+
+
+static Allocator* s_taskAllocator = nullptr;
+
+
+void SetTaskAllocator(Allocator* allocator)
+{
+	ASSERT2(allocator == nullptr || s_taskAllocator == nullptr, "Task allocator is already set");
+	s_taskAllocator = allocator;
+}
+
+Allocator& GetTaskAllocator()
+{
+	ASSERT2(s_taskAllocator != nullptr, "Task allocator is not set, tasks can run only while engine exists");
+	return *s_taskAllocator;
+}
+
+
+namespace TaskInternal
+{
+
+static const size_t FRAME_ALIGNMENT = 16;//same guarantee as global new gives
+
+
+void* PromiseBase::operator new(size_t size)
+{
+	return GetTaskAllocator().Allocate(size, FRAME_ALIGNMENT);
+}
+
+void PromiseBase::operator delete(void* ptr)
+{
+	GetTaskAllocator().Deallocate(ptr);
+}
+
+
+}
+
+
+}
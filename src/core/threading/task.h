@@ -0,0 +1,176 @@
+#pragma once
+
+#include "core/allocator.h"
+#include "core/asserts.h"
+#include "core/utility.h"
+
+#include <coroutine>
+
+
+namespace Veng
+{
+
+
+//coroutine frames can't use global new, they are allocated from this one; engine sets its own allocator
+//for its lifetime, so frames show up in its stats and leak checks
+void SetTaskAllocator(Allocator* allocator);
+Allocator& GetTaskAllocator();
+
+
+template<class Type>
+class Task;
+
+
+namespace TaskInternal
+{
+
+struct PromiseBase
+{
+	struct FinalAwaiter
+	{
+		bool await_ready() noexcept { return false; }
+
+		//symmetric transfer to awaiting coroutine, so long chains of completed tasks don't grow stack
+		template<class PromiseType>
+		std::coroutine_handle<> await_suspend(std::coroutine_handle<PromiseType> handle) noexcept
+		{
+			PromiseBase& promise = handle.promise();
+			if (promise.continuation)
+				return promise.continuation;
+			if (promise.detached)
+				handle.destroy();
+			return std::noop_coroutine();
+		}
+
+		void await_resume() noexcept {}
+	};
+
+	static void* operator new(size_t size);
+	static void operator delete(void* ptr);
+
+	std::suspend_always initial_suspend() noexcept { return {}; }
+	FinalAwaiter final_suspend() noexcept { return {}; }
+	void unhandled_exception() { ASSERT2(false, "Exceptions are not supported in tasks"); }
+
+	std::coroutine_handle<> continuation;
+	bool detached = false;
+};
+
+
+template<class Type>
+struct PromiseResult
+{
+	PromiseResult() {}
+	~PromiseResult()
+	{
+		if (hasValue)
+			DELETE_PLACEMENT(reinterpret_cast<Type*>(storage));
+	}
+
+	template<class ValueType>
+	void return_value(ValueType&& value)
+	{
+		NEW_PLACEMENT(storage, Type)(Utils::Forward<ValueType>(value));
+		hasValue = true;
+	}
+
+	Type TakeResult()
+	{
+		ASSERT2(hasValue, "Task has no result");
+		return Utils::Move(*reinterpret_cast<Type*>(storage));
+	}
+
+	alignas(Type) u8 storage[sizeof(Type)];
+	bool hasValue = false;
+};
+
+template<>
+struct PromiseResult<void>
+{
+	void return_void() {}
+	void TakeResult() {}
+};
+
+}
+
+
+//lazily started coroutine, runs when awaited or started and owns its frame unless detached
+template<class Type = void>
+class Task final
+{
+public:
+	struct promise_type : TaskInternal::PromiseBase, TaskInternal::PromiseResult<Type>
+	{
+		Task get_return_object() { return Task(std::coroutine_handle<promise_type>::from_promise(*this)); }
+	};
+
+	struct Awaiter
+	{
+		bool await_ready() const { return handle.done(); }
+
+		std::coroutine_handle<> await_suspend(std::coroutine_handle<> awaiting)
+		{
+			handle.promise().continuation = awaiting;
+			return handle;
+		}
+
+		Type await_resume() { return handle.promise().TakeResult(); }
+
+		std::coroutine_handle<promise_type> handle;
+	};
+
+public:
+	Task() = default;
+	Task(Task&) = delete;
+	Task(Task&& other) : m_handle(other.m_handle) { other.m_handle = nullptr; }
+	Task& operator =(Task&) = delete;
+	Task& operator =(Task&& other)
+	{
+		std::coroutine_handle<promise_type> handle = m_handle;
+		m_handle = other.m_handle;
+		other.m_handle = handle;
+		return *this;
+	}
+
+	~Task()
+	{
+		ASSERT2(!m_handle || m_handle.done() || !m_handle.promise().continuation, "Task destroyed while it's awaited");
+		if (m_handle)
+			m_handle.destroy();
+	}
+
+	//runs task until its first suspension, owner has to keep it alive until it's done
+	void Start()
+	{
+		ASSERT2(m_handle && !m_handle.done(), "Task is empty or already finished");
+		m_handle.resume();
+	}
+
+	//runs task until its first suspension, frame is released when task finishes
+	void StartDetached()
+	{
+		ASSERT2(m_handle && !m_handle.done(), "Task is empty or already finished");
+		std::coroutine_handle<promise_type> handle = m_handle;
+		m_handle = nullptr;
+		handle.promise().detached = true;
+		handle.resume();
+	}
+
+	bool IsValid() const { return (bool)m_handle; }
+	bool IsDone() const { return m_handle && m_handle.done(); }
+
+	Awaiter operator co_await() &&
+	{
+		ASSERT2(m_handle, "Empty task can't be awaited");
+		return Awaiter{ m_handle };
+	}
+
+private:
+	explicit Task(std::coroutine_handle<promise_type> handle) : m_handle(handle) {}
+
+private:
+	std::coroutine_handle<promise_type> m_handle;
+};
+
+
+}
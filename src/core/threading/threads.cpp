@@ -1,6 +1,9 @@
 #include "threads.h"
 
 #include "os_utils.h"
+#include "core/asserts.h"
+
+#include <cstdlib>
 
 
 namespace Veng
@@ -10,6 +13,77 @@ const i32 FREE = 0;
 const i32 LOCKED = 1;
 
 
+static_assert(MAX_THREADS == 64, "Indexes taken by running threads are bits of one i64");
+static volatile i64 s_usedIndexes = 0;
+static thread_local bool s_threadExited = false;
+
+namespace ThreadsInternal
+{
+constinit thread_local i32 s_threadIndex = -1;
+}
+using ThreadsInternal::s_threadIndex;
+
+
+static void ReleaseThreadIndex(i32 index)
+{
+	const i64 bit = (i64)1 << index;
+	i64 used = AtomicLoad(&s_usedIndexes, MemoryOrder::Relaxed);
+	for (;;)
+	{
+		const i64 previous = AtomicCompareExchange64(&s_usedIndexes, used & ~bit, used);
+		if (previous == used)
+			return;
+		used = previous;
+	}
+}
+
+//destroyed when thread exits, hands thread's index over to threads started later
+struct ThreadIndexOwner
+{
+	~ThreadIndexOwner()
+	{
+		if (s_threadIndex != -1)
+			ReleaseThreadIndex(s_threadIndex);
+		s_threadIndex = -1;
+		s_threadExited = true;
+	}
+};
+
+static thread_local ThreadIndexOwner s_threadIndexOwner;
+
+
+u32 ThreadsInternal::AcquireThreadIndex()
+{
+	i64 used = AtomicLoad(&s_usedIndexes, MemoryOrder::Relaxed);
+	for (;;)
+	{
+		//every per-thread array would overflow, there is no way to go on
+		if (used == -1)
+		{
+			ASSERT2(false, "Too many threads");
+			abort();
+		}
+
+		i32 index = 0;
+		while ((used & ((i64)1 << index)) != 0)
+			++index;
+
+		const i64 previous = AtomicCompareExchange64(&s_usedIndexes, used | ((i64)1 << index), used);
+		if (previous == used)
+		{
+			s_threadIndex = index;
+			break;
+		}
+		used = previous;
+	}
+
+	//thread which already exited keeps its index, owner can't be constructed again
+	if (!s_threadExited)
+		(void)&s_threadIndexOwner;
+	return (u32)s_threadIndex;
+}
+
+
 SpinLock::SpinLock()
 	: m_lock(FREE)
 {}
@@ -21,7 +95,7 @@ void SpinLock::Lock()
 {
 	for (;;)
 	{
-		if (m_lock == FREE && AtomicCompareExchange(&m_lock, LOCKED, FREE) == FREE)
+		if (AtomicLoad(&m_lock, MemoryOrder::Relaxed) == FREE && AtomicCompareExchange(&m_lock, LOCKED, FREE) == FREE)
 			break;
 		CpuRelax();
 	}
@@ -29,7 +103,165 @@ void SpinLock::Lock()
 
 void SpinLock::Unlock()
 {
-	m_lock = FREE;
+	AtomicStore(&m_lock, FREE, MemoryOrder::Release);
+}
+
+
+//short critical sections are usually over before thread would even get parked
+static const u32 SPIN_COUNT = 64;
+
+
+static const i32 CONTENDED = 2;//locked and some thread may be parked
+
+Mutex::Mutex()
+	: m_state(FREE)
+{}
+
+Mutex::~Mutex()
+{}
+
+void Mutex::Lock()
+{
+	for (u32 i = 0; i < SPIN_COUNT; ++i)
+	{
+		if (AtomicLoad(&m_state, MemoryOrder::Relaxed) == FREE && AtomicCompareExchange(&m_state, LOCKED, FREE) == FREE)
+			return;
+		CpuRelax();
+	}
+
+	//once parked, lock is always taken as contended, so unlock can't miss anyone
+	while (AtomicExchange(&m_state, CONTENDED) != FREE)
+		FutexWait(&m_state, CONTENDED);
+}
+
+void Mutex::Unlock()
+{
+	if (AtomicExchange(&m_state, FREE) == CONTENDED)
+		FutexWakeOne(&m_state);
+}
+
+
+static const i32 RW_WRITER = 1 << 30;
+static const i32 RW_WRITER_WAITING = 1 << 29;
+static const i32 RW_READERS_MASK = RW_WRITER_WAITING - 1;
+
+RWLock::RWLock()
+	: m_state(0)
+	, m_waiters(0)
+{}
+
+RWLock::~RWLock()
+{}
+
+void RWLock::Lock()
+{
+	for (u32 spin = 0;; ++spin)
+	{
+		const i32 state = AtomicLoad(&m_state, MemoryOrder::Relaxed);
+		if ((state & (RW_WRITER | RW_READERS_MASK)) == 0)
+		{
+			//clears waiting flag, writers which are still waiting set it again
+			if (AtomicCompareExchange(&m_state, RW_WRITER, state) == state)
+				return;
+			continue;
+		}
+
+		if (spin < SPIN_COUNT)
+		{
+			CpuRelax();
+			continue;
+		}
+
+		if ((state & RW_WRITER_WAITING) == 0 && AtomicCompareExchange(&m_state, state | RW_WRITER_WAITING, state) != state)
+			continue;
+		Park(state | RW_WRITER_WAITING);
+	}
+}
+
+void RWLock::Unlock()
+{
+	AtomicAdd(&m_state, -RW_WRITER);
+	if (AtomicLoad(&m_waiters) > 0)
+		FutexWakeAll(&m_state);
+}
+
+void RWLock::LockShared()
+{
+	for (u32 spin = 0;; ++spin)
+	{
+		const i32 state = AtomicLoad(&m_state, MemoryOrder::Relaxed);
+		if ((state & (RW_WRITER | RW_WRITER_WAITING)) == 0)
+		{
+			if (AtomicCompareExchange(&m_state, state + 1, state) == state)
+				return;
+			continue;
+		}
+
+		if (spin < SPIN_COUNT)
+			CpuRelax();
+		else
+			Park(state);
+	}
+}
+
+void RWLock::UnlockShared()
+{
+	const i32 state = AtomicAdd(&m_state, -1) - 1;
+	if ((state & RW_READERS_MASK) == 0 && AtomicLoad(&m_waiters) > 0)
+		FutexWakeAll(&m_state);
+}
+
+//waiter count is raised before futex compares state, so whoever changes state afterwards sees it
+void RWLock::Park(i32 state)
+{
+	AtomicAdd(&m_waiters, 1);
+	FutexWait(&m_state, state);
+	AtomicAdd(&m_waiters, -1);
+}
+
+
+Semaphore::Semaphore(i32 initialCount)
+	: m_count(initialCount)
+	, m_waiters(0)
+{}
+
+Semaphore::~Semaphore()
+{}
+
+void Semaphore::Signal(i32 count)
+{
+	AtomicAdd(&m_count, count);
+	if (AtomicLoad(&m_waiters) > 0)
+	{
+		if (count == 1)
+			FutexWakeOne(&m_count);
+		else
+			FutexWakeAll(&m_count);
+	}
+}
+
+void Semaphore::Wait()
+{
+	for (u32 spin = 0;; ++spin)
+	{
+		const i32 count = AtomicLoad(&m_count, MemoryOrder::Relaxed);
+		if (count > 0)
+		{
+			if (AtomicCompareExchange(&m_count, count - 1, count) == count)
+				return;
+			continue;
+		}
+
+		if (spin < SPIN_COUNT)
+		{
+			CpuRelax();
+			continue;
+		}
+
+		AtomicAdd(&m_waiters, 1);
+		FutexWait(&m_count, count);
+		AtomicAdd(&m_waiters, -1);
+	}
 }
 
 
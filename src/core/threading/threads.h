@@ -7,6 +7,26 @@ namespace Veng
 {
 
 
+const u32 MAX_THREADS = 64;
+
+namespace ThreadsInternal
+{
+
+extern constinit thread_local i32 s_threadIndex;//-1 until thread asks for its index first time
+u32 AcquireThreadIndex();
+
+}
+
+//returns small index of calling thread, assigned on first call and unique among running threads; index of
+//exited thread is given to thread which asks later, so at most MAX_THREADS threads may use it at once.
+//Inline since per-thread counters ask on every update
+inline u32 GetThreadIndex()
+{
+	const i32 index = ThreadsInternal::s_threadIndex;
+	return (index >= 0) ? (u32)index : ThreadsInternal::AcquireThreadIndex();
+}
+
+
 class SpinLock
 {
 public:
@@ -25,6 +45,69 @@ private:
 };
 
 
+//spins briefly, then parks thread in kernel until lock is released
+class Mutex
+{
+public:
+	Mutex();
+	Mutex(Mutex&) = delete;
+	Mutex(Mutex&&) = delete;
+	Mutex& operator=(Mutex&) = delete;
+	Mutex& operator=(Mutex&&) = delete;
+	~Mutex();
+
+	void Lock();
+	void Unlock();
+
+private:
+	volatile i32 m_state;
+};
+
+
+//writers take precedence, readers don't enter while writer waits
+class RWLock
+{
+public:
+	RWLock();
+	RWLock(RWLock&) = delete;
+	RWLock(RWLock&&) = delete;
+	RWLock& operator=(RWLock&) = delete;
+	RWLock& operator=(RWLock&&) = delete;
+	~RWLock();
+
+	void Lock();
+	void Unlock();
+	void LockShared();
+	void UnlockShared();
+
+private:
+	void Park(i32 state);
+
+private:
+	volatile i32 m_state;
+	volatile i32 m_waiters;
+};
+
+
+class Semaphore
+{
+public:
+	explicit Semaphore(i32 initialCount = 0);
+	Semaphore(Semaphore&) = delete;
+	Semaphore(Semaphore&&) = delete;
+	Semaphore& operator=(Semaphore&) = delete;
+	Semaphore& operator=(Semaphore&&) = delete;
+	~Semaphore();
+
+	void Signal(i32 count = 1);
+	void Wait();
+
+private:
+	volatile i32 m_count;
+	volatile i32 m_waiters;
+};
+
+
 template<class LockType>
 class ScopeLock
 {
@@ -41,6 +124,22 @@ private:
 };
 
 
+template<class LockType>
+class SharedScopeLock
+{
+public:
+	SharedScopeLock(LockType& lock);
+	SharedScopeLock(SharedScopeLock&) = delete;
+	SharedScopeLock(SharedScopeLock&&) = delete;
+	SharedScopeLock& operator=(SharedScopeLock&) = delete;
+	SharedScopeLock& operator=(SharedScopeLock&&) = delete;
+	~SharedScopeLock();
+
+private:
+	LockType& m_lock;
+};
+
+
 template<class LockType>
 ScopeLock<LockType>::ScopeLock(LockType& lock)
 	: m_lock(lock)
@@ -55,4 +154,18 @@ ScopeLock<LockType>::~ScopeLock()
 }
 
 
+template<class LockType>
+SharedScopeLock<LockType>::SharedScopeLock(LockType& lock)
+	: m_lock(lock)
+{
+	m_lock.LockShared();
+}
+
+template<class LockType>
+SharedScopeLock<LockType>::~SharedScopeLock()
+{
+	m_lock.UnlockShared();
+}
+
+
 }
\ No newline at end of file
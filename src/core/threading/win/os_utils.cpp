@@ -2,6 +2,8 @@
 
 #include <core/os/win/simple_windows.h>
 
+#include "core/asserts.h"
+
 
 namespace Veng
 {
@@ -12,6 +14,81 @@ void CpuRelax()
 	YieldProcessor();
 }
 
+void YieldThread()
+{
+	SwitchToThread();
+}
+
+
+//aligned loads and stores are atomic on x64, loads have acquire and stores release semantics in hardware,
+//volatile keeps compiler from reordering them; only sequentially consistent store needs locked instruction
+
+i32 AtomicLoad(const volatile i32* source, MemoryOrder order)
+{
+	return *source;
+}
+
+i64 AtomicLoad(const volatile i64* source, MemoryOrder order)
+{
+	return *source;
+}
+
+void* AtomicLoad(void* const volatile* source, MemoryOrder order)
+{
+	return *source;
+}
+
+void AtomicStore(volatile i32* destination, const i32 value, MemoryOrder order)
+{
+	if (order == MemoryOrder::SequentiallyConsistent)
+		InterlockedExchange(reinterpret_cast<volatile LONG*>(destination), value);
+	else
+		*destination = value;
+}
+
+void AtomicStore(volatile i64* destination, const i64 value, MemoryOrder order)
+{
+	if (order == MemoryOrder::SequentiallyConsistent)
+		InterlockedExchange64(reinterpret_cast<volatile LONG64*>(destination), value);
+	else
+		*destination = value;
+}
+
+void AtomicStore(void* volatile* destination, void* value, MemoryOrder order)
+{
+	if (order == MemoryOrder::SequentiallyConsistent)
+		InterlockedExchangePointer(destination, value);
+	else
+		*destination = value;
+}
+
+
+i32 AtomicAdd(volatile i32* addend, const i32 value)
+{
+	return InterlockedExchangeAdd(reinterpret_cast<volatile LONG*>(addend), value);
+}
+
+i64 AtomicAdd(volatile i64* addend, const i64 value)
+{
+	return InterlockedExchangeAdd64(reinterpret_cast<volatile LONG64*>(addend), value);
+}
+
+
+i32 AtomicExchange(volatile i32* destination, const i32 value)
+{
+	return InterlockedExchange(reinterpret_cast<volatile LONG*>(destination), value);
+}
+
+i64 AtomicExchange(volatile i64* destination, const i64 value)
+{
+	return InterlockedExchange64(reinterpret_cast<volatile LONG64*>(destination), value);
+}
+
+void* AtomicExchange(void* volatile* destination, void* value)
+{
+	return InterlockedExchangePointer(destination, value);
+}
+
 
 i32 AtomicCompareExchange(volatile i32* destination, const i32 exchange, const i32 comperand)
 {
@@ -22,5 +99,55 @@ i32 AtomicCompareExchange(volatile i32* destination, const i32 exchange, const i
 	);
 }
 
+i64 AtomicCompareExchange64(volatile i64* destination, const i64 exchange, const i64 comperand)
+{
+	return InterlockedCompareExchange64(
+		reinterpret_cast<volatile LONG64*>(destination),
+		exchange,
+		comperand
+	);
+}
+
+void* AtomicCompareExchangePointer(void* volatile* destination, void* exchange, void* comperand)
+{
+	return InterlockedCompareExchangePointer(destination, exchange, comperand);
+}
+
+
+void MemoryFence()
+{
+	MemoryBarrier();
+}
+
+
+void FutexWait(volatile i32* address, const i32 expected)
+{
+	WaitOnAddress(address, const_cast<i32*>(&expected), sizeof(i32), INFINITE);
+}
+
+void FutexWakeOne(volatile i32* address)
+{
+	WakeByAddressSingle(const_cast<i32*>(address));
+}
+
+void FutexWakeAll(volatile i32* address)
+{
+	WakeByAddressAll(const_cast<i32*>(address));
+}
+
+
+threadHandle StartThread(ThreadFunction function, void* data)
+{
+	HANDLE thread = ::CreateThread(nullptr, 0, reinterpret_cast<LPTHREAD_START_ROUTINE>(function), data, 0, nullptr);
+	ASSERT2(thread != nullptr, "Thread was not created");
+	return thread;
+}
+
+void JoinThread(threadHandle thread)
+{
+	WaitForSingleObject(thread, INFINITE);
+	CloseHandle(thread);
+}
+
 
 }
@@ -39,6 +39,15 @@ inline constexpr typename RemoveReference<Type>::type&& Move(Type&& arg)
 }
 
 
+template<class Type>
+inline void Swap(Type& a, Type& b)
+{
+	Type tmp = Move(a);
+	a = Move(b);
+	b = Move(tmp);
+}
+
+
 }
 
 
@@ -0,0 +1,77 @@
+#include "entity_commands.h"
+
+
+namespace Veng
+{
+
+
+EntityCommandBuffer::EntityCommandBuffer(Allocator& allocator, u32 thread)
+	: m_commands(allocator)
+	, m_transforms(allocator)
+	, m_thread(thread)
+{
+}
+
+
+//thread is part of provisional id, so entity created by one buffer can be used in commands of another
+Entity EntityCommandBuffer::CreateEntity()
+{
+	const Entity entity = (Entity)(PROVISIONAL_ENTITY_BIT | ((u64)m_thread << 32) | m_createdCount);
+	++m_createdCount;
+	PushCommand(CommandType::CreateEntity, entity);
+	return entity;
+}
+
+void EntityCommandBuffer::DestroyEntity(Entity entity)
+{
+	PushCommand(CommandType::DestroyEntity, entity);
+}
+
+void EntityCommandBuffer::SetEntityTransform(Entity entity, const Transform& transform)
+{
+	Command& command = PushCommand(CommandType::SetTransform, entity);
+	command.transform = (u32)m_transforms.GetSize();
+	m_transforms.PushBack(transform);
+}
+
+void EntityCommandBuffer::AddComponent(const ComponentBase& component, Scene& scene, Entity entity)
+{
+	Command& command = PushCommand(CommandType::AddComponent, entity);
+	command.component = &component;
+	command.scene = &scene;
+}
+
+void EntityCommandBuffer::RemoveComponent(const ComponentBase& component, Scene& scene, Entity entity)
+{
+	Command& command = PushCommand(CommandType::RemoveComponent, entity);
+	command.component = &component;
+	command.scene = &scene;
+}
+
+
+void EntityCommandBuffer::Clear()
+{
+	m_commands.Clear();
+	m_transforms.Clear();
+	m_createdCount = 0;
+}
+
+bool EntityCommandBuffer::IsEmpty() const
+{
+	return m_commands.GetSize() == 0;
+}
+
+
+EntityCommandBuffer::Command& EntityCommandBuffer::PushCommand(CommandType type, Entity entity)
+{
+	Command& command = m_commands.PushBack();
+	command.type = type;
+	command.transform = 0;
+	command.entity = entity;
+	command.component = nullptr;
+	command.scene = nullptr;
+	return command;
+}
+
+
+}
@@ -0,0 +1,77 @@
+#pragma once
+
+#include "core/allocator.h"
+#include "core/containers/array.h"
+#include "core/entity.h"
+#include "core/math/matrix.h"
+
+
+namespace Veng
+{
+
+struct ComponentBase;
+class Scene;
+
+
+//id of entity created by command buffer, it can be used only in commands until they are played back
+static const u64 PROVISIONAL_ENTITY_BIT = 1ULL << 63;
+
+inline bool IsProvisionalEntity(Entity entity)
+{
+	return ((u64)entity & PROVISIONAL_ENTITY_BIT) != 0;
+}
+
+
+//structural changes recorded by one thread without touching world, World::PlaybackCommands applies them
+class EntityCommandBuffer final
+{
+public:
+	enum class CommandType : u8
+	{
+		CreateEntity,
+		DestroyEntity,
+		SetTransform,
+		AddComponent,
+		RemoveComponent,
+	};
+
+	struct Command
+	{
+		CommandType type;
+		u32 transform;//index to transforms
+		Entity entity;
+		const ComponentBase* component;
+		Scene* scene;
+	};
+
+public:
+	EntityCommandBuffer(Allocator& allocator, u32 thread);
+	EntityCommandBuffer(EntityCommandBuffer&) = delete;
+	EntityCommandBuffer& operator =(EntityCommandBuffer&) = delete;
+
+	Entity CreateEntity();
+	void DestroyEntity(Entity entity);
+	void SetEntityTransform(Entity entity, const Transform& transform);
+	void AddComponent(const ComponentBase& component, Scene& scene, Entity entity);
+	void RemoveComponent(const ComponentBase& component, Scene& scene, Entity entity);
+
+	void Clear();
+	bool IsEmpty() const;
+
+	u32 GetThread() const { return m_thread; }
+	u32 GetCreatedCount() const { return m_createdCount; }
+	const Array<Command>& GetCommands() const { return m_commands; }
+	const Transform& GetTransform(u32 index) const { return m_transforms[index]; }
+
+private:
+	Command& PushCommand(CommandType type, Entity entity);
+
+private:
+	Array<Command> m_commands;
+	Array<Transform> m_transforms;
+	u32 m_thread;
+	u32 m_createdCount = 0;
+};
+
+
+}
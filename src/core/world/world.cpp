@@ -1,9 +1,15 @@
 #include "world.h"
 
 #include "scene.h"
+#include "entity_commands.h"
+#include "core/system.h"
+#include "core/allocators.h"
+#include "core/algorithms/sort.h"
+#include "core/containers/small_array.h"
 #include "core/math/matrix.h"
 #include "core/utility.h"
 #include "core/file/blob.h"
+#include "core/threading/threads.h"
 
 
 namespace Veng
@@ -26,13 +32,24 @@ World::World(World&& world)
 	, m_id(world.m_id)
 	, m_entitiesTransform(Utils::Move(world.m_entitiesTransform))
 {
-
+	for (u32 i = 0; i < MAX_THREADS; ++i)
+	{
+		m_commandBuffers[i] = world.m_commandBuffers[i];
+		world.m_commandBuffers[i] = nullptr;
+	}
 }
 
 
 World::~World()
 {
-
+	for (EntityCommandBuffer* buffer : m_commandBuffers)
+	{
+		if (buffer != nullptr)
+		{
+			ASSERT2(buffer->IsEmpty(), "World destroyed with commands which were not played back");
+			DELETE_OBJECT(m_allocator, buffer);
+		}
+	}
 }
 
 
@@ -117,4 +134,180 @@ World::EntityIterator World::GetEntities() const
 }
 
 
+EntityCommandBuffer& World::GetCommandBuffer()
+{
+	//only owning thread ever writes its slot
+	const u32 thread = GetThreadIndex();
+	if (m_commandBuffers[thread] == nullptr)
+		m_commandBuffers[thread] = NEW_OBJECT(m_allocator, EntityCommandBuffer)(m_allocator, thread);
+	return *m_commandBuffers[thread];
+}
+
+
+struct ComponentCommand
+{
+	Scene* scene;
+	const ComponentBase* component;
+	Entity entity;
+	u32 order;//recording order, makes sort stable
+	bool add;
+	bool created;//entity created by the same playback, it has no components to remove yet
+};
+
+//component's type is its identity, several ComponentBase objects can describe the same component
+static bool SameComponent(const ComponentCommand& a, const ComponentCommand& b)
+{
+	return a.scene == b.scene && a.component->type == b.component->type;
+}
+
+static bool ComponentCommandLess(const ComponentCommand& a, const ComponentCommand& b)
+{
+	if (a.scene != b.scene)
+		return (uintptr)a.scene < (uintptr)b.scene;
+	if (a.component->type != b.component->type)
+		return a.component->type < b.component->type;
+	if (a.entity != b.entity)
+		return (u64)a.entity < (u64)b.entity;
+	return a.order < b.order;
+}
+
+//every run of the same scene and component goes to scene as one batch, entities are sorted and unique
+static void PlaybackComponentBatches(const ComponentCommand* commands, size_t count, bool add, SmallArray<Entity, 64, FrameAllocator>& batch)
+{
+	size_t first = 0;
+	while (first < count)
+	{
+		const ComponentCommand& group = commands[first];
+		batch.Clear();
+		size_t i = first;
+		for (; i < count && SameComponent(commands[i], group); ++i)
+		{
+			if (commands[i].add == add && (add || !commands[i].created))
+				batch.PushBack(commands[i].entity);
+		}
+
+		if (batch.GetSize() > 0)
+		{
+			if (add)
+				group.scene->AddComponents(*group.component, batch.Begin(), batch.GetSize());
+			else
+				group.scene->RemoveComponents(*group.component, batch.Begin(), batch.GetSize());
+		}
+		first = i;
+	}
+}
+
+//only last recorded command of each entity and component is applied, earlier ones are overridden by it;
+//removals go before additions, removal from entity created by this playback is dropped
+static void PlaybackComponentCommands(Array<ComponentCommand, FrameAllocator>& commands, SmallArray<Entity, 64, FrameAllocator>& batch)
+{
+	Sort(commands.Begin(), commands.End(), ComponentCommandLess);
+
+	size_t kept = 0;
+	for (size_t i = 0; i < commands.GetSize(); ++i)
+	{
+		const ComponentCommand& command = commands[i];
+		if (i + 1 < commands.GetSize() && SameComponent(command, commands[i + 1]) && command.entity == commands[i + 1].entity)
+			continue;
+		commands[kept++] = command;
+	}
+
+	PlaybackComponentBatches(commands.Begin(), kept, false, batch);
+	PlaybackComponentBatches(commands.Begin(), kept, true, batch);
+}
+
+
+void World::PlaybackCommands(FrameAllocator& scratch)
+{
+
+	u32 firstCreated[MAX_THREADS];
+	u32 createdCount = 0;
+	u32 commandCount = 0;
+	for (u32 i = 0; i < MAX_THREADS; ++i)
+	{
+		firstCreated[i] = createdCount;
+		if (m_commandBuffers[i] != nullptr)
+		{
+			createdCount += m_commandBuffers[i]->GetCreatedCount();
+			commandCount += (u32)m_commandBuffers[i]->GetCommands().GetSize();
+		}
+	}
+	if (commandCount == 0)
+		return;
+
+	//provisional ids are sequential per buffer, so creations in thread order map them to created array
+	Array<Entity, FrameAllocator> created(scratch);
+	created.Reserve(createdCount);
+	for (EntityCommandBuffer* buffer : m_commandBuffers)
+	{
+		if (buffer == nullptr)
+			continue;
+		for (const EntityCommandBuffer::Command& command : buffer->GetCommands())
+		{
+			if (command.type == EntityCommandBuffer::CommandType::CreateEntity)
+				created.PushBack(CreateEntity());
+		}
+	}
+
+	Array<ComponentCommand, FrameAllocator> componentCommands(scratch);
+	componentCommands.Reserve(commandCount - createdCount);
+	for (EntityCommandBuffer* buffer : m_commandBuffers)
+	{
+		if (buffer == nullptr)
+			continue;
+		for (const EntityCommandBuffer::Command& command : buffer->GetCommands())
+		{
+			switch (command.type)
+			{
+				case EntityCommandBuffer::CommandType::SetTransform:
+					GetEntityTransform(ResolveEntity(command.entity, created, firstCreated)) = buffer->GetTransform(command.transform);
+					break;
+				case EntityCommandBuffer::CommandType::AddComponent:
+				case EntityCommandBuffer::CommandType::RemoveComponent:
+				{
+					ComponentCommand& componentCommand = componentCommands.PushBack();
+					componentCommand.scene = command.scene;
+					componentCommand.component = command.component;
+					componentCommand.entity = ResolveEntity(command.entity, created, firstCreated);
+					componentCommand.order = (u32)componentCommands.GetSize();
+					componentCommand.add = command.type == EntityCommandBuffer::CommandType::AddComponent;
+					componentCommand.created = IsProvisionalEntity(command.entity);
+					break;
+				}
+				default:
+					break;
+			}
+		}
+	}
+
+	SmallArray<Entity, 64, FrameAllocator> batch(scratch);
+	PlaybackComponentCommands(componentCommands, batch);
+
+	for (EntityCommandBuffer* buffer : m_commandBuffers)
+	{
+		if (buffer == nullptr)
+			continue;
+		for (const EntityCommandBuffer::Command& command : buffer->GetCommands())
+		{
+			if (command.type == EntityCommandBuffer::CommandType::DestroyEntity)
+				DestroyEntity(ResolveEntity(command.entity, created, firstCreated));
+		}
+		buffer->Clear();
+	}
+}
+
+
+Entity World::ResolveEntity(Entity entity, const Array<Entity, FrameAllocator>& created, const u32* firstCreated) const
+{
+	if (!IsProvisionalEntity(entity))
+		return entity;
+
+	const u32 thread = (u32)(((u64)entity & ~PROVISIONAL_ENTITY_BIT) >> 32);
+	const u32 index = (u32)((u64)entity & 0xffffffff);
+	ASSERT2(thread < MAX_THREADS && m_commandBuffers[thread] != nullptr, "Invalid provisional entity");
+	ASSERT2(index < m_commandBuffers[thread]->GetCreatedCount(), "Provisional entity from already played back commands");
+	return created[firstCreated[thread] + index];
+}
+
+
 }
\ No newline at end of file
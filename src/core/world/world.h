@@ -3,6 +3,7 @@
 #include "core/allocator.h"
 #include "core/containers/array.h"
 #include "core/int.h"
+#include "core/threading/threads.h"
 
 #include "core/entity.h"
 
@@ -11,6 +12,8 @@ namespace Veng
 {
 
 struct Transform;
+class EntityCommandBuffer;
+class FrameAllocator;
 enum class worldId : u32 {};
 static const worldId INVALID_WORLD_ID = (worldId)-1;
 
@@ -60,6 +63,16 @@ public:
 	Transform& GetEntityTransform(Entity entity);
 	EntityIterator GetEntities() const;
 
+	//buffer of calling thread, it can record from any thread and never touches world until playback
+	EntityCommandBuffer& GetCommandBuffer();
+	//sync point, no thread may record meanwhile; creations go first, then component removals, additions
+	//and destructions, each sorted so scene gets one batch per component; when entity's component was both
+	//added and removed, only the last recorded command counts; temporaries live in scratch for rest of frame
+	void PlaybackCommands(FrameAllocator& scratch);
+
+private:
+	Entity ResolveEntity(Entity entity, const Array<Entity, FrameAllocator>& created, const u32* firstCreated) const;
+
 private:
 	struct EntityItem
 	{
@@ -77,6 +90,7 @@ private:
 	i64 m_unusedEntity = -1;
 	Array<EntityItem> m_entities;
 	Array<Transform> m_entitiesTransform;//TODO separate
+	EntityCommandBuffer* m_commandBuffers[MAX_THREADS] = {};//indexed by thread, created on first use
 };
 
 
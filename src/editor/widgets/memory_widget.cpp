@@ -112,6 +112,8 @@ void MemoryWidget::Render(EventQueue& queue)
 
 	if (m_selected != nullptr)
 	{
+		m_selected->UpdateDebugView();
+
 		ImVec2 pos = ImGui::GetCursorPos();
 		ImVec2 posDraw = pos + ImVec2(0, 2 * ImGui::GetTextLineHeight());
 		ImVec2 size = ImGui::GetContentRegionAvail();
@@ -120,14 +122,15 @@ void MemoryWidget::Render(EventQueue& queue)
 		size_t blockSize = m_selected->GetBlockSize();
 
 		size_t allocIdx = 0;
-		for (size_t i = 0, c = m_selected->GetBlocksSize(); i < c; ++i)
+		const size_t allocCount = m_selected->GetAllocationsSize();
+		for (size_t i = 0, c = m_selected->GetBlocksSize(); i < c && allocIdx < allocCount; ++i)
 		{
 			uintptr block = (uintptr)m_selected->GetBlocks()[i];
 			const AllocationDebugData* allocData = &m_selected->GetAllocations()[allocIdx];
 			uintptr allocStart = (uintptr)allocData->allocation;
 
 			size_t allocIdxPerBlock = 0;
-			while (block <= allocStart && allocStart < block + blockSize && allocIdx < m_selected->GetAllocationsSize())
+			while (block <= allocStart && allocStart < block + blockSize && allocIdx < allocCount)
 			{
 				size_t allocSize = m_selected->GetSize((void*)allocStart);
 				float start = (float)(allocStart - block) / blockSize * size.x;
@@ -143,8 +146,10 @@ void MemoryWidget::Render(EventQueue& queue)
 				ImGui::SetCursorPos(pos);
 				ImGui::PopID();
 
-				allocData = &m_selected->GetAllocations()[++allocIdx];
 				allocIdxPerBlock++;
+				if (++allocIdx == allocCount)
+					break;
+				allocData = &m_selected->GetAllocations()[allocIdx];
 				allocStart = (uintptr)allocData->allocation;
 			}
 		}
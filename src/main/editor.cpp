@@ -8,7 +8,12 @@
 #include "core/logs.h"
 #include "core/asserts.h"
 #include "core/file/blob.h"
+#include "core/file/clob.h"
 #include "core/containers/associative_array.h"
+#include "core/containers/array.h"
+#include "core/containers/small_array.h"
+#include "core/threading/threads.h"
+#include "core/threading/os_utils.h"
 
 #include "core/os/os_utils.h"
 
@@ -312,6 +317,43 @@ struct ImguiBgfxData
 	bgfx::UniformHandle textureUniform;
 };
 
+//copy of imgui draw data, imgui rebuilds its draw lists while render thread submits this
+struct ImguiPacket
+{
+	struct DrawList
+	{
+		u32 firstVertex;
+		u32 vertexCount;
+		u32 firstIndex;
+		u32 indexCount;
+		u32 firstCommand;
+		u32 commandCount;
+	};
+
+	struct Command
+	{
+		bgfx::FrameBufferHandle framebuffer;//invalid for font texture
+		u16 scissorX;
+		u16 scissorY;
+		u16 scissorWidth;
+		u16 scissorHeight;
+		u32 elemCount;
+	};
+
+	explicit ImguiPacket(Allocator& allocator)
+		: vertices(allocator)
+		, indices(allocator)
+		, drawLists(allocator)
+		, commands(allocator)
+	{}
+
+	Array<ImDrawVert> vertices;
+	Array<ImDrawIdx> indices;
+	Array<DrawList> drawLists;
+	Array<Command> commands;
+	WindowSize windowSize = { 0, 0 };
+};
+
 static bgfx::ProgramHandle LoadProgram(const Path& vertexPath, const Path& fragmentPath, Allocator& allocator)
 {
 	const FileMode fileMode{
@@ -373,7 +415,9 @@ public:
 		, m_inputKeyboardFilter(m_allocator)
 		, m_eventQueue(m_allocator)
 		, m_widgets(m_allocator)
+		, m_imguiPackets{ ImguiPacket(m_imguiAllocator), ImguiPacket(m_imguiAllocator) }
 	{
+		static_assert(RenderSystem::FRAME_PACKET_COUNT == 2, "Imgui packets are not initialized");
 		m_allocator.SetDebugName("Editor");
 		m_engineAllocator.SetDebugName("Engine");
 		m_imguiAllocator.SetDebugName("ImGui");
@@ -390,6 +434,10 @@ public:
 
 	void Deinit() override
 	{
+		//render thread has to be idle, bgfx objects are destroyed directly from now on
+		for (u32 i = 0; i < RenderSystem::FRAME_PACKET_COUNT; ++i)
+			m_freePackets.Wait();
+
 		DeinitWidgets();
 		DELETE_OBJECT(m_allocator, m_editorInterface);
 		DeinitEngine();//TODO: shut down engine gracefully
@@ -398,11 +446,16 @@ public:
 		DeinitRender();
 	}
 
+	//simulation of this frame runs while render thread submits previous one
 	void Update(float deltaTime) override
 	{
+		m_freePackets.Wait();
+		m_renderSystem->BeginFrame();
+
 		UpdateImguiInput(deltaTime);
 
 		m_engine->Update(deltaTime);
+		m_renderSystem->ExtractFrame();
 		m_eventQueue.FrameUpdate();
 
 		for(WidgetItem& widget : m_widgets)
@@ -411,9 +464,11 @@ public:
 		}
 		
 		UpdateImgui();
-		RenderImgui();
+		CopyImguiDrawData(m_imguiPackets[m_recordPacket]);
 
-		bgfx::frame();//flip buffers
+		m_renderSystem->EndFrame();
+		m_recordPacket = (m_recordPacket + 1) % RenderSystem::FRAME_PACKET_COUNT;
+		m_readyPackets.Signal();
 	}
 
 
@@ -421,10 +476,7 @@ public:
 	{
 		if (handle == m_app.GetMainWindowHandle())
 		{
-			m_windowSize = { width, height };
-			bgfx::reset(width, height, BGFX_RESET_VSYNC);
-			bgfx::setViewFrameBuffer(m_imguiBgfxData.viewId, BGFX_INVALID_HANDLE);
-			bgfx::setViewRect(m_imguiBgfxData.viewId, 0, 0, uint16_t(width), uint16_t(height));
+			m_windowSize = { width, height };//backbuffer is reset by render thread
 			ImGuiIO& io = ImGui::GetIO();
 			io.DisplaySize = ImVec2((float)width, (float)height);
 		}
@@ -671,6 +723,58 @@ public:
 	// RENDERING
 
 	void InitRender()
+	{
+		m_renderThread = StartThread(&RenderThreadFunction, this);
+		m_renderThreadInitialized.Wait();
+	}
+
+	void DeinitRender()
+	{
+		m_renderThreadExit = true;
+		m_readyPackets.Signal();
+		JoinThread(m_renderThread);
+	}
+
+	static u32 RenderThreadFunction(void* data)
+	{
+		static_cast<EditorAppImpl*>(data)->RenderThread();
+		return 0;
+	}
+
+	//render thread is bgfx api thread, only resource creation and destruction is allowed from other threads
+	void RenderThread()
+	{
+		InitBgfx();
+		m_renderThreadInitialized.Signal();
+
+		u32 submitPacket = 0;
+		for (;;)
+		{
+			m_readyPackets.Wait();
+			if (m_renderThreadExit)
+				break;
+
+			const ImguiPacket& imguiPacket = m_imguiPackets[submitPacket];
+			if (imguiPacket.windowSize.x != m_backbufferSize.x || imguiPacket.windowSize.y != m_backbufferSize.y)
+			{
+				m_backbufferSize = imguiPacket.windowSize;
+				bgfx::reset(m_backbufferSize.x, m_backbufferSize.y, BGFX_RESET_VSYNC);
+				bgfx::setViewFrameBuffer(m_imguiBgfxData.viewId, BGFX_INVALID_HANDLE);
+				bgfx::setViewRect(m_imguiBgfxData.viewId, 0, 0, uint16_t(m_backbufferSize.x), uint16_t(m_backbufferSize.y));
+			}
+
+			m_renderSystem->SubmitFrame();
+			RenderImgui(imguiPacket);
+			bgfx::frame();//flip buffers
+
+			submitPacket = (submitPacket + 1) % RenderSystem::FRAME_PACKET_COUNT;
+			m_freePackets.Signal();
+		}
+
+		bgfx::shutdown();
+	}
+
+	void InitBgfx()
 	{
 		windowHandle hwnd = m_app.GetMainWindowHandle();
 
@@ -692,11 +796,17 @@ public:
 		ASSERT(bgfx::init(bgfxInit));
 
 		bgfx::setDebug(BGFX_DEBUG_NONE);//TODO/////////////////////////////////////////
-	}
 
-	void DeinitRender()
-	{
-		bgfx::shutdown();
+		m_imguiBgfxData.viewId = ImGui::VIEW_ID;
+
+		bgfx::setViewName(m_imguiBgfxData.viewId, "ImGui");
+		bgfx::setViewMode(m_imguiBgfxData.viewId, bgfx::ViewMode::Sequential);
+		bgfx::setViewClear(m_imguiBgfxData.viewId
+			, BGFX_CLEAR_COLOR | BGFX_CLEAR_DEPTH
+			, ImGui::CLEAR_COLOR
+			, 1.0f
+			, 0
+		);
 	}
 
 	// IMGUI
@@ -737,17 +847,6 @@ public:
 		style.FrameRounding = ImGui::FRAME_ROUNDING;
 		style.WindowBorderSize = ImGui::WINDOW_BORDER_SIZE;
 
-		m_imguiBgfxData.viewId = ImGui::VIEW_ID;
-
-		bgfx::setViewName(m_imguiBgfxData.viewId, "ImGui");
-		bgfx::setViewMode(m_imguiBgfxData.viewId, bgfx::ViewMode::Sequential);
-		bgfx::setViewClear(m_imguiBgfxData.viewId
-			, BGFX_CLEAR_COLOR | BGFX_CLEAR_DEPTH
-			, ImGui::CLEAR_COLOR
-			, 1.0f
-			, 0
-		);
-
 		Path vsPath("shaders/compiled/imgui/imgui.vs");
 		Path fsPath("shaders/compiled/imgui/imgui.fs");
 		m_imguiBgfxData.program = LoadProgram(vsPath, fsPath, m_allocator);
@@ -891,6 +990,39 @@ public:
 						}
 					}
 				}
+				if (ImGui::MenuItem("Export allocator stats"))
+				{
+					Path path;
+					if (FileSaveDialog(path))
+					{
+						static const FileMode fileMode{
+							FileMode::Access::Write,
+							FileMode::ShareMode::ShareWrite,
+							FileMode::CreationDisposition::CreateAlways,
+							FileMode::FlagNone
+						};
+
+						nativeFileHandle fHandle;
+						if (FS::OpenFileSync(fHandle, path, fileMode))
+						{
+							OutputClob clob(m_allocator);
+							WriteAllocatorStats(clob);
+
+							if (!FS::WriteFileSync(fHandle, 0, clob.GetData(), clob.GetSize())) {
+								ASSERT(false);
+								Log(LogType::Error, "Could not write to allocator stats file");
+							}
+							if (!FS::CloseFileSync(fHandle)) {
+								ASSERT(false);
+								Log(LogType::Error, "Could not close allocator stats file");
+							}
+						}
+						else
+						{
+							Log(LogType::Error, "Could not open allocator stats file");
+						}
+					}
+				}
 				ImGui::EndMenu();
 			}
 			if (ImGui::BeginMenu("Widgets"))
@@ -962,55 +1094,80 @@ public:
 		m_inputBuffer.scroll = 0;
 	}
 
-	void RenderImgui()
+	void CopyImguiDrawData(ImguiPacket& packet)
 	{
+		packet.vertices.Clear();
+		packet.indices.Clear();
+		packet.drawLists.Clear();
+		packet.commands.Clear();
+		packet.windowSize = m_windowSize;
+
 		ImDrawData* drawData = ImGui::GetDrawData();
+		for (int32_t ii = 0, num = drawData->CmdListsCount; ii < num; ++ii)
+		{
+			const ImDrawList* drawList = drawData->CmdLists[ii];
+
+			ImguiPacket::DrawList& packetList = packet.drawLists.PushBack();
+			packetList.firstVertex = (u32)packet.vertices.GetSize();
+			packetList.vertexCount = (u32)drawList->VtxBuffer.size();
+			packetList.firstIndex = (u32)packet.indices.GetSize();
+			packetList.indexCount = (u32)drawList->IdxBuffer.size();
+			packetList.firstCommand = (u32)packet.commands.GetSize();
 
+			packet.vertices.Resize(packetList.firstVertex + packetList.vertexCount);
+			memory::Copy(packet.vertices.Begin() + packetList.firstVertex, drawList->VtxBuffer.begin(), packetList.vertexCount * sizeof(ImDrawVert));
+			packet.indices.Resize(packetList.firstIndex + packetList.indexCount);
+			memory::Copy(packet.indices.Begin() + packetList.firstIndex, drawList->IdxBuffer.begin(), packetList.indexCount * sizeof(ImDrawIdx));
+
+			for (const ImDrawCmd* cmd = drawList->CmdBuffer.begin(), *cmdEnd = drawList->CmdBuffer.end(); cmd != cmdEnd; ++cmd)
+			{
+				ASSERT2(cmd->UserCallback == nullptr, "Imgui user callbacks are not supported, they would run on render thread");
+
+				//texture id points to framebuffer handle owned by renderer, it's resolved now while it's valid
+				ImguiPacket::Command& command = packet.commands.PushBack();
+				command.framebuffer = (nullptr != cmd->TextureId) ? *(bgfx::FrameBufferHandle*)cmd->TextureId : bgfx::FrameBufferHandle(BGFX_INVALID_HANDLE);
+				command.scissorX = uint16_t(Max(cmd->ClipRect.x, 0.0f));
+				command.scissorY = uint16_t(Max(cmd->ClipRect.y, 0.0f));
+				command.scissorWidth = uint16_t(Min(cmd->ClipRect.z, 65535.0f) - command.scissorX);
+				command.scissorHeight = uint16_t(Min(cmd->ClipRect.w, 65535.0f) - command.scissorY);
+				command.elemCount = cmd->ElemCount;
+			}
+			packetList.commandCount = (u32)packet.commands.GetSize() - packetList.firstCommand;
+		}
+	}
+
+	void RenderImgui(const ImguiPacket& packet)
+	{
 		const bgfx::Caps* caps = bgfx::getCaps();
 		{
-			//float ortho[16];
-			//bx::mtxOrtho(ortho, 0.0f, (float)m_windowSize.x, (float)m_windowSize.y, 0.0f, 0.0f, 1000.0f, 0.0f, caps->homogeneousDepth);
-			//bgfx::setViewTransform(m_imguiBgfxData.viewId, nullptr, ortho);
-			//bgfx::setViewRect(m_imguiBgfxData.viewId, 0, 0, uint16_t(m_windowSize.x), uint16_t(m_windowSize.y));/////////////////////
-
 			Matrix44 mat;
-			mat.SetOrthogonal(0.0f, (float)m_windowSize.x, (float)m_windowSize.y, 0.0f, 0.0f, 1000.0f, 0.0f, caps->homogeneousDepth);
+			mat.SetOrthogonal(0.0f, (float)packet.windowSize.x, (float)packet.windowSize.y, 0.0f, 0.0f, 1000.0f, 0.0f, caps->homogeneousDepth);
 			bgfx::setViewTransform(m_imguiBgfxData.viewId, nullptr, &mat.m11);
 		}
 
 		// Render command lists
-		for (int32_t ii = 0, num = drawData->CmdListsCount; ii < num; ++ii)
+		for (const ImguiPacket::DrawList& drawList : packet.drawLists)
 		{
 			bgfx::TransientVertexBuffer tvb;
 			bgfx::TransientIndexBuffer tib;
 
-			const ImDrawList* drawList = drawData->CmdLists[ii];
-			uint32_t numVertices = (uint32_t)drawList->VtxBuffer.size();
-			uint32_t numIndices = (uint32_t)drawList->IdxBuffer.size();
-
-			if (!bgfx::checkAvailTransientBuffers(numVertices, m_imguiBgfxData.vertexDecl, numIndices))
+			if (!bgfx::checkAvailTransientBuffers(drawList.vertexCount, m_imguiBgfxData.vertexDecl, drawList.indexCount))
 			{
 				// not enough space in transient buffer just quit drawing the rest...
 				break;
 			}
 
-			bgfx::allocTransientVertexBuffer(&tvb, numVertices, m_imguiBgfxData.vertexDecl);
-			bgfx::allocTransientIndexBuffer(&tib, numIndices);
+			bgfx::allocTransientVertexBuffer(&tvb, drawList.vertexCount, m_imguiBgfxData.vertexDecl);
+			bgfx::allocTransientIndexBuffer(&tib, drawList.indexCount);
 
-			ImDrawVert* verts = (ImDrawVert*)tvb.data;
-			memory::Copy(verts, drawList->VtxBuffer.begin(), numVertices * sizeof(ImDrawVert));
-
-			ImDrawIdx* indices = (ImDrawIdx*)tib.data;
-			memory::Copy(indices, drawList->IdxBuffer.begin(), numIndices * sizeof(ImDrawIdx));
+			memory::Copy(tvb.data, packet.vertices.Begin() + drawList.firstVertex, drawList.vertexCount * sizeof(ImDrawVert));
+			memory::Copy(tib.data, packet.indices.Begin() + drawList.firstIndex, drawList.indexCount * sizeof(ImDrawIdx));
 
 			uint32_t offset = 0;
-			for (const ImDrawCmd* cmd = drawList->CmdBuffer.begin(), *cmdEnd = drawList->CmdBuffer.end(); cmd != cmdEnd; ++cmd)
+			for (u32 i = drawList.firstCommand; i < drawList.firstCommand + drawList.commandCount; ++i)
 			{
-				if (cmd->UserCallback)
-				{
-					cmd->UserCallback(drawList, cmd);
-				}
-				else if (0 != cmd->ElemCount)
+				const ImguiPacket::Command& cmd = packet.commands[i];
+				if (0 != cmd.elemCount)
 				{
 					uint64_t state = 0
 						| BGFX_STATE_WRITE_RGB
@@ -1020,37 +1177,32 @@ public:
 
 					bgfx::TextureHandle th = m_imguiBgfxData.textureFont;
 
-					if (nullptr != cmd->TextureId)
+					if (bgfx::isValid(cmd.framebuffer))
 					{
 						//TODO: image blending
 						//TODO: image lods
 						//TODO: image alpha
-						th = bgfx::getTexture(*(bgfx::FrameBufferHandle*)cmd->TextureId);
+						th = bgfx::getTexture(cmd.framebuffer);
 					}
 					else
 					{
 						state |= BGFX_STATE_BLEND_FUNC(BGFX_STATE_BLEND_SRC_ALPHA, BGFX_STATE_BLEND_INV_SRC_ALPHA);
 					}
 
-					const uint16_t xx = uint16_t(Max(cmd->ClipRect.x, 0.0f));
-					const uint16_t yy = uint16_t(Max(cmd->ClipRect.y, 0.0f));
-					bgfx::setScissor(xx, yy
-						, uint16_t(Min(cmd->ClipRect.z, 65535.0f) - xx)
-						, uint16_t(Min(cmd->ClipRect.w, 65535.0f) - yy)
-					);
-
+					bgfx::setScissor(cmd.scissorX, cmd.scissorY, cmd.scissorWidth, cmd.scissorHeight);
 					bgfx::setState(state);
 					bgfx::setTexture(0, m_imguiBgfxData.textureUniform, th);
-					bgfx::setVertexBuffer(0, &tvb, 0, numVertices);
-					bgfx::setIndexBuffer(&tib, offset, cmd->ElemCount);
+					bgfx::setVertexBuffer(0, &tvb, 0, drawList.vertexCount);
+					bgfx::setIndexBuffer(&tib, offset, cmd.elemCount);
 					bgfx::submit(m_imguiBgfxData.viewId, m_imguiBgfxData.program);
 				}
 
-				offset += cmd->ElemCount;
+				offset += cmd.elemCount;
 			}
 		}
 	}
 
+
 private:
 	struct WidgetItem
 	{
@@ -1074,7 +1226,7 @@ private:
 
 	//widgets
 	EventQueue m_eventQueue;
-	Array<WidgetItem> m_widgets;
+	SmallArray<WidgetItem, 32> m_widgets;
 
 	//bgfx for imgui
 	ImguiBgfxData m_imguiBgfxData;
@@ -1083,7 +1235,17 @@ private:
 	BGFXAllocator m_bgfxAllocator;
 	BGFXCallback m_bgfxCallback;
 
-	WindowSize m_windowSize = { 0, 0 };//doesn't need yet, should remove ?
+	WindowSize m_windowSize = { 0, 0 };
+
+	//render thread
+	threadHandle m_renderThread = nullptr;
+	Semaphore m_renderThreadInitialized;
+	Semaphore m_freePackets{ RenderSystem::FRAME_PACKET_COUNT };
+	Semaphore m_readyPackets;
+	ImguiPacket m_imguiPackets[RenderSystem::FRAME_PACKET_COUNT];
+	u32 m_recordPacket = 0;//main thread
+	WindowSize m_backbufferSize = { 0, 0 };//render thread
+	bool m_renderThreadExit = false;//published by signal of m_readyPackets
 
 };
 
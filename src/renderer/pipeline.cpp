@@ -62,10 +62,11 @@ public:
 			FileMode::FlagNone
 		};
 
+		TempScope tempScope;
 		nativeFileHandle fHandle;
 		ASSERT(FS::OpenFileSync(fHandle, path, fileMode));
 		size_t fileSize = FS::GetFileSize(fHandle);
-		u8* data = (u8*)m_allocator.Allocate(fileSize, alignof(u8));
+		u8* data = (u8*)tempScope.GetAllocator().Allocate(fileSize, alignof(u8));
 		size_t fileSizeRead = 0;
 		ASSERT(FS::ReadFileSync(fHandle, 0, data, fileSize, fileSizeRead));
 		ASSERT(fileSize == fileSizeRead);
@@ -73,7 +74,7 @@ public:
 
 		char errorBuffer[64] = { 0 };
 		JsonValue parsedJson;
-		ASSERT(JsonParseError((char*)data, &m_allocator, &parsedJson, errorBuffer));
+		ASSERT(JsonParseError((char*)data, &tempScope.GetAllocator(), &parsedJson, errorBuffer));
 		ASSERT(JsonIsObject(&parsedJson));
 
 		const JsonKeyValue* fbObj = JsonObjectCFind(&parsedJson, "framebuffers");
@@ -172,9 +173,6 @@ public:
 
 			cmd++;
 		}
-		JsonDeinit(&parsedJson);
-
-		m_allocator.Deallocate(data);
 	}
 
 	void Deinit() override
@@ -206,19 +204,13 @@ public:
 				}
 				case CommandType::RenderModels:
 				{
-					World* world = m_engine.GetWorld(cmd->world);
-					const RenderScene* scene = (RenderScene*)m_renderer.GetScene(cmd->world);
-					const RenderScene::CameraItem* cameraItem = scene->GetActiveCamera();
-					m_renderer.SetCamera(*world, cameraItem->entity);
-					m_renderer.RenderModels(*world);
+					m_renderer.SetCamera(cmd->world);
+					m_renderer.RenderModels(cmd->world);
 					break;
 				}
 				case CommandType::RenderDebug:
 				{
-					const RenderScene* scene = (RenderScene*)m_renderer.GetScene(worldId(0));
-					World* world = m_engine.GetWorld(worldId(0));
-					const RenderScene::CameraItem* cameraItem = scene->GetActiveCamera();
-					m_renderer.SetCamera(*world, cameraItem->entity);
+					m_renderer.SetCamera(worldId(0));
 					m_renderer.RenderDebug();
 					break;
 				}
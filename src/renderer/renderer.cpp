@@ -3,12 +3,14 @@
 #include "core/allocators.h"
 #include "core/engine.h"
 #include "core/containers/array.h"
-#include "core/containers/handle_array.h"
+#include "core/containers/slot_map.h"
 #include "core/containers/associative_array.h"
 #include "core/hashes.h"
 #include "core/logs.h"
 #include "core/file/path.h"
 #include "core/math/matrix.h"
+#include "core/threading/jobs.h"
+#include "core/threading/os_utils.h"
 
 #include "core/resource/resource_management.h"
 #include "resource_managers/shader_manager.h"
@@ -41,6 +43,10 @@ struct HashFunc<worldId>
 };
 
 
+//fewer draws per encoder don't pay for the job and encoder overhead
+static const u32 MIN_DRAWS_PER_ENCODER = 256;
+
+
 struct MeshData
 {
 	bgfx::VertexDecl vertex_decl;
@@ -88,6 +94,112 @@ struct DebugObject
 };
 
 
+//everything needed to submit one frame, render thread reads only this and never touches worlds, resources or render data
+struct FramePacket
+{
+	static const u32 NO_SCENE = 0xffffffff;
+
+	struct SceneView
+	{
+		worldId world;
+		bool hasCamera;
+		bool hasLight;
+		Matrix44 view;
+		Matrix44 proj;
+		Vector4 cameraPos;
+		Vector4 lightDir;
+		DirectionalLight light;
+		u32 firstDraw;
+		u32 drawCount;
+	};
+
+	struct DrawMaterial
+	{
+		bgfx::ProgramHandle program;
+		bgfx::UniformHandle textureUniforms[Material::MAX_TEXTURES];
+		bgfx::TextureHandle textures[Material::MAX_TEXTURES];
+		u8 textureCount;
+	};
+
+	struct Draw
+	{
+		Matrix44 transform;
+		bgfx::VertexBufferHandle vertexBuffer;
+		bgfx::IndexBufferHandle indexBuffer;
+		u32 material;
+	};
+
+	enum class CommandType : u8
+	{
+		SetFramebuffer,
+		SetCamera,
+		Clear,
+		RenderModels,
+		RenderDebug,
+	};
+
+	struct Command
+	{
+		CommandType type;
+		bgfx::ViewId view;
+		union
+		{
+			struct
+			{
+				bgfx::FrameBufferHandle handle;
+				u16 width;
+				u16 height;
+			} framebuffer;
+			u32 scene;
+		};
+	};
+
+	enum class DestroyType : u8
+	{
+		VertexBuffer,
+		IndexBuffer,
+		Uniform,
+		Texture,
+		Shader,
+		Program,
+		FrameBuffer,
+	};
+
+	struct DestroyedHandle
+	{
+		DestroyType type;
+		u16 handle;
+	};
+
+	explicit FramePacket(Allocator& allocator)
+		: scenes(allocator)
+		, materials(allocator)
+		, draws(allocator)
+		, commands(allocator)
+		, destroys(allocator)
+	{}
+
+	void Clear()
+	{
+		scenes.Clear();
+		materials.Clear();
+		draws.Clear();
+		commands.Clear();
+		destroys.Clear();
+		firstDebugDraw = 0;
+		debugDrawCount = 0;
+	}
+
+	Array<SceneView> scenes;
+	Array<DrawMaterial> materials;
+	Array<Draw> draws;
+	u32 firstDebugDraw = 0;
+	u32 debugDrawCount = 0;
+	Array<Command> commands;
+	Array<DestroyedHandle> destroys;
+};
+
+
 class RenderSceneImpl : public RenderScene
 {
 public:
@@ -150,6 +262,21 @@ public:
 		m_models.Erase(entity);
 	}
 
+	void AddComponents(const ComponentBase& component, const Entity* entities, size_t count) override
+	{
+		if (component.type != crc32_string("Model"))
+		{
+			RenderScene::AddComponents(component, entities, count);
+			return;
+		}
+
+		Array<ModelItem> items(m_allocator);
+		items.Reserve(count);
+		for (size_t i = 0; i < count; ++i)
+			items.PushBack(ModelItem{ entities[i], INVALID_RESOURCE_HANDLE });
+		m_models.BulkInsert(entities, items.Begin(), count);
+	}
+
 	bool HasModel(Entity entity) const override
 	{
 		ModelItem* model;
@@ -200,14 +327,30 @@ public:
 		u64 count;
 		serializer.Read(count);
 
+		//entities are written in key order already, so bulk insert only appends
+		Array<Entity> entities(m_allocator);
+		Array<ModelItem> items(m_allocator);
+		Array<bool> inserted(m_allocator);
+		entities.Reserve((size_t)count);
+		items.Reserve((size_t)count);
 		for (u64 i = 0; i < count; ++i)
 		{
 			Entity entity;
 			serializer.Read(entity);
-			ModelItem* item = m_models.Insert(entity, ModelItem{ entity });
 			Path resPath;
 			serializer.Read(resPath);
-			item->model = m_renderSystem.GetModelManager().Load(resPath);
+			entities.PushBack(entity);
+			items.PushBack(ModelItem{ entity, m_renderSystem.GetModelManager().Load(resPath) });
+		}
+		inserted.Resize(entities.GetSize());
+		if (m_models.BulkInsert(entities.Begin(), items.Begin(), entities.GetSize(), inserted.Begin()) == items.GetSize())
+			return;
+
+		//entity which already has model or repeats in stream keeps its first model, others were loaded for nothing
+		for (size_t i = 0; i < items.GetSize(); ++i)
+		{
+			if (!inserted[i])
+				m_renderSystem.GetModelManager().Unload(items[i].model);
 		}
 	}
 	
@@ -597,9 +740,12 @@ public:
 		, m_materialManager(m_allocator, *engine.GetFileSystem(), engine.GetResourceManagement())
 		, m_modelManager(m_allocator, *engine.GetFileSystem(), engine.GetResourceManagement())
 		, m_textureManager(m_allocator, *engine.GetFileSystem(), engine.GetResourceManagement())
+		, m_framePackets{ FramePacket(m_allocator), FramePacket(m_allocator) }
 	{
+		static_assert(FRAME_PACKET_COUNT == 2, "Frame packets are not initialized");
 		m_allocator.SetDebugName("Renderer");
 
+		//first value added to each map gets handle 0, which is invalid handle of its type
 		MeshData invalidMeshData;
 		invalidMeshData.vertexBufferHandle = BGFX_INVALID_HANDLE;
 		invalidMeshData.indexBufferHandle = BGFX_INVALID_HANDLE;
@@ -694,8 +840,6 @@ public:
 
 	void Update(float deltaTime) override
 	{
-		m_currentView = m_firstView - 1;//////
-
 		for (size_t i = m_debugMeshesStartDynamic; i < m_debugObjects.GetSize(); ++i)
 		{
 			DebugObject& dMesh = m_debugObjects[i];
@@ -714,6 +858,14 @@ public:
 
 	const char* GetName() const override { return "renderer"; }
 
+	SystemAccess GetAccess() const override
+	{
+		SystemAccess access;
+		access.read = SystemData_None;
+		access.write = SystemData_RenderScene | SystemData_Resources;//debug objects release their materials
+		return access;
+	}
+
 
 	Scene* GetScene(worldId world) const override
 	{
@@ -804,8 +956,8 @@ public:
 	void DestroyMeshData(meshRenderHandle handle) override
 	{
 		MeshData& data = m_meshData.Get((u32)handle);
-		bgfx::destroy(data.vertexBufferHandle);
-		bgfx::destroy(data.indexBufferHandle);
+		DestroyHandle(FramePacket::DestroyType::VertexBuffer, data.vertexBufferHandle);
+		DestroyHandle(FramePacket::DestroyType::IndexBuffer, data.indexBufferHandle);
 
 		m_meshData.Remove((u32)handle);
 	}
@@ -826,7 +978,7 @@ public:
 	{
 		MaterialData& data = m_materialData.Get((u32)handle);
 		for(int i = 0; i < data.textureCount; ++i)
-			bgfx::destroy(data.textureUniforms[i]);
+			DestroyHandle(FramePacket::DestroyType::Uniform, data.textureUniforms[i]);
 
 		m_materialData.Remove((u32)handle);
 	}
@@ -863,7 +1015,7 @@ public:
 	void DestroyTextureData(textureRenderHandle handle) override
 	{
 		TextureData& data = m_textureData.Get((u32)handle);
-		bgfx::destroy(data.handle);
+		DestroyHandle(FramePacket::DestroyType::Texture, data.handle);
 
 		m_textureData.Remove((u32)handle);
 	}
@@ -893,7 +1045,7 @@ public:
 	void DestroyShaderInternalData(shaderInternalRenderHandle handle) override
 	{
 		ShaderInternalData& data = m_shaderInternalData.Get((u32)handle);
-		bgfx::destroy(data.handle);
+		DestroyHandle(FramePacket::DestroyType::Shader, data.handle);
 
 		m_shaderInternalData.Remove((u32)handle);
 	}
@@ -903,8 +1055,8 @@ public:
 	{
 		ShaderData shaderData;
 
-		ShaderInternalData vs = m_shaderInternalData.Get((u64)vsHandle);
-		ShaderInternalData fs = m_shaderInternalData.Get((u64)fsHandle);
+		ShaderInternalData vs = m_shaderInternalData.Get((u32)vsHandle);
+		ShaderInternalData fs = m_shaderInternalData.Get((u32)fsHandle);
 
 		shaderData.handle = bgfx::createProgram(vs.handle, fs.handle, false);
 
@@ -923,7 +1075,7 @@ public:
 	{
 		ShaderData& data = m_shaderData.Get((u32)handle);
 
-		bgfx::destroy(data.handle);
+		DestroyHandle(FramePacket::DestroyType::Program, data.handle);
 
 		m_shaderData.Remove((u32)handle);
 	}
@@ -1032,10 +1184,10 @@ public:
 
 		for (FramebufferHandle handle : m_screenSizeFrameBuffers)
 		{
-			FrameBuffer& fb = m_framebuffers.Get((u16)handle);
+			FrameBuffer& fb = m_framebuffers.Get((u32)handle);
 			fb.width = width;
 			fb.height = height;
-			bgfx::destroy(fb.handle);
+			DestroyHandle(FramePacket::DestroyType::FrameBuffer, fb.handle);
 			bgfx::TextureHandle fbTextures[8];
 			u8 fbTexturesSize = 0;
 			if(fb.flags & FramebufferType_Color)
@@ -1077,12 +1229,12 @@ public:
 
 	void DestroyFramebuffer(FramebufferHandle handle) override
 	{
-		FrameBuffer& fb = m_framebuffers.Get((u16)handle);
+		FrameBuffer& fb = m_framebuffers.Get((u32)handle);
 		if (fb.screenSize)
 			m_screenSizeFrameBuffers.Erase(handle);
 
-		bgfx::destroy(fb.handle);
-		m_framebuffers.Remove((u16)handle);
+		DestroyHandle(FramePacket::DestroyType::FrameBuffer, fb.handle);
+		m_framebuffers.Remove((u32)handle);
 	}
 
 	void NewView() override
@@ -1092,17 +1244,192 @@ public:
 
 	void SetFramebuffer(FramebufferHandle handle) override
 	{
-		FrameBuffer& fb = m_framebuffers.Get((u16)handle);
-		bgfx::setViewFrameBuffer(m_currentView, fb.handle);
-		bgfx::setViewRect(m_currentView, 0, 0, uint16_t(fb.width), uint16_t(fb.height));
+		const FrameBuffer& fb = m_framebuffers.Get((u32)handle);
+		FramePacket::Command& command = PushCommand(FramePacket::CommandType::SetFramebuffer);
+		command.framebuffer.handle = fb.handle;
+		command.framebuffer.width = fb.width;
+		command.framebuffer.height = fb.height;
 	}
 
-	void SetCamera(World& world, Entity camera)
+	void SetCamera(worldId world) override
 	{
-		Matrix44 view;
-		Matrix44 proj;
-		RenderSceneImpl* scene = (RenderSceneImpl*)GetScene(world.GetId());
-		const RenderScene::CameraItem* cameraItem = scene->GetCameraData(camera);
+		const u32 scene = FindPacketScene(world);
+		if (scene == FramePacket::NO_SCENE)
+			return;
+
+		FramePacket::Command& command = PushCommand(FramePacket::CommandType::SetCamera);
+		command.scene = scene;
+	}
+
+	void Clear() override
+	{
+		PushCommand(FramePacket::CommandType::Clear);
+	}
+
+	void RenderModels(worldId world) override
+	{
+		const u32 scene = FindPacketScene(world);
+		if (scene == FramePacket::NO_SCENE)
+			return;
+
+		FramePacket::Command& command = PushCommand(FramePacket::CommandType::RenderModels);
+		command.scene = scene;
+	}
+
+	void RenderDebug() override
+	{
+		PushCommand(FramePacket::CommandType::RenderDebug);
+	}
+
+
+	void BeginFrame() override
+	{
+		ASSERT2(m_recordPacket == nullptr, "Frame packet is already recorded");
+		m_recordPacket = &m_framePackets[m_nextRecordPacket];
+		m_recordPacket->Clear();
+		m_currentView = m_firstView - 1;
+	}
+
+	void ExtractFrame() override
+	{
+		ASSERT2(m_recordPacket != nullptr, "Frame has to begin before extraction");
+		FramePacket& packet = *m_recordPacket;
+		ASSERT2(packet.scenes.GetSize() == 0, "Frame was already extracted");
+
+		for (const auto& item : m_scenes)
+			ExtractScene(packet, item.key, *item.value);
+
+		packet.firstDebugDraw = (u32)packet.draws.GetSize();
+		for (const DebugObject& dObject : m_debugObjects)
+		{
+			const Material* material = (Material*)m_materialManager.GetResource(dObject.mesh.material);
+			if (material->GetState() == Resource::State::Ready)
+				ExtractDraw(packet, dObject.transform.ToMatrix44(), dObject.mesh, *material);
+		}
+		packet.debugDrawCount = (u32)packet.draws.GetSize() - packet.firstDebugDraw;
+	}
+
+	void EndFrame() override
+	{
+		ASSERT2(m_recordPacket != nullptr, "Frame packet is not recorded");
+		m_recordPacket = nullptr;
+		m_nextRecordPacket = (m_nextRecordPacket + 1) % FRAME_PACKET_COUNT;
+	}
+
+	void SubmitFrame() override
+	{
+		const FramePacket& packet = m_framePackets[m_nextSubmitPacket];
+		m_nextSubmitPacket = (m_nextSubmitPacket + 1) % FRAME_PACKET_COUNT;
+		const FramePacket::SceneView* cameraScene = nullptr;
+
+		for (const FramePacket::Command& command : packet.commands)
+		{
+			switch (command.type)
+			{
+				case FramePacket::CommandType::SetFramebuffer:
+					bgfx::setViewFrameBuffer(command.view, command.framebuffer.handle);
+					bgfx::setViewRect(command.view, 0, 0, command.framebuffer.width, command.framebuffer.height);
+					break;
+				case FramePacket::CommandType::SetCamera:
+				{
+					const FramePacket::SceneView& scene = packet.scenes[command.scene];
+					cameraScene = &scene;
+					bgfx::setViewTransform(command.view, &scene.view.m11, &scene.proj.m11);
+					break;
+				}
+				case FramePacket::CommandType::Clear:
+					bgfx::setViewClear(command.view
+						, BGFX_CLEAR_COLOR | BGFX_CLEAR_DEPTH
+						, 0x803030ff
+						, 1.0f
+						, 0
+					);
+					break;
+				case FramePacket::CommandType::RenderModels:
+				{
+					const FramePacket::SceneView& scene = packet.scenes[command.scene];
+					SubmitDraws(packet, scene.firstDraw, scene.drawCount, command.view, BGFX_STATE_DEFAULT, cameraScene, &scene);
+					break;
+				}
+				case FramePacket::CommandType::RenderDebug:
+				{
+					const u64 state = BGFX_STATE_WRITE_RGB | BGFX_STATE_PT_LINES | BGFX_STATE_LINEAA | BGFX_STATE_BLEND_ALPHA;
+					SubmitDraws(packet, packet.firstDebugDraw, packet.debugDrawCount, command.view, state, cameraScene, nullptr);
+					break;
+				}
+				default:
+					ASSERT2(false, "Unknown frame packet command");
+					break;
+			}
+		}
+
+		//bgfx releases destroyed objects after frame is rendered, so draws above are still valid
+		for (const FramePacket::DestroyedHandle& destroyed : packet.destroys)
+		{
+			switch (destroyed.type)
+			{
+				case FramePacket::DestroyType::VertexBuffer: bgfx::destroy(bgfx::VertexBufferHandle{ destroyed.handle }); break;
+				case FramePacket::DestroyType::IndexBuffer: bgfx::destroy(bgfx::IndexBufferHandle{ destroyed.handle }); break;
+				case FramePacket::DestroyType::Uniform: bgfx::destroy(bgfx::UniformHandle{ destroyed.handle }); break;
+				case FramePacket::DestroyType::Texture: bgfx::destroy(bgfx::TextureHandle{ destroyed.handle }); break;
+				case FramePacket::DestroyType::Shader: bgfx::destroy(bgfx::ShaderHandle{ destroyed.handle }); break;
+				case FramePacket::DestroyType::Program: bgfx::destroy(bgfx::ProgramHandle{ destroyed.handle }); break;
+				case FramePacket::DestroyType::FrameBuffer: bgfx::destroy(bgfx::FrameBufferHandle{ destroyed.handle }); break;
+				default: ASSERT2(false, "Unknown destroyed handle type"); break;
+			}
+		}
+	}
+
+
+	void* GetNativeFrameBufferHandle(FramebufferHandle handle) override
+	{
+		return (void*)&(m_framebuffers.Get((u32)handle).handle);
+	}
+
+
+private:
+	FramePacket::Command& PushCommand(FramePacket::CommandType type)
+	{
+		ASSERT2(m_recordPacket != nullptr, "Render api has to be called between BeginFrame and EndFrame");
+		FramePacket::Command& command = m_recordPacket->commands.PushBack();
+		command.type = type;
+		command.view = m_currentView;
+		return command;
+	}
+
+	//command for world which wasn't extracted would read past packet's scenes, caller has to skip it
+	u32 FindPacketScene(worldId world) const
+	{
+		ASSERT2(m_recordPacket != nullptr, "Render api has to be called between BeginFrame and EndFrame");
+		const FramePacket& packet = *m_recordPacket;
+		for (size_t i = 0; i < packet.scenes.GetSize(); ++i)
+		{
+			if (packet.scenes[i].world == world)
+				return (u32)i;
+		}
+		ASSERT2(false, "World was not extracted to frame packet");
+		return FramePacket::NO_SCENE;
+	}
+
+	//object can still be used by packet which render thread submits, it's released after packet being recorded
+	template<class HandleType>
+	void DestroyHandle(FramePacket::DestroyType type, HandleType handle)
+	{
+		if (m_recordPacket != nullptr)
+			m_recordPacket->destroys.PushBack({ type, handle.idx });
+		else
+			bgfx::destroy(handle);
+	}
+
+	void ExtractScene(FramePacket& packet, worldId id, const RenderSceneImpl& scene)
+	{
+		World& world = *m_engine.GetWorld(id);
+		FramePacket::SceneView& sceneView = packet.scenes.PushBack();
+		sceneView.world = id;
+		sceneView.hasCamera = false;
+		sceneView.hasLight = false;
+
+		const RenderScene::CameraItem* cameraItem = scene.GetActiveCamera();
 		if (cameraItem != nullptr)
 		{
 			const Camera& cam = cameraItem->camera;
@@ -1110,120 +1437,143 @@ public:
 
 			if (cam.type == Camera::Type::Perspective)
 			{
-				proj.SetPerspective(cam.fov, cam.aspect, cam.nearPlane, cam.farPlane, bgfx::getCaps()->homogeneousDepth);
+				sceneView.proj.SetPerspective(cam.fov, cam.aspect, cam.nearPlane, cam.farPlane, bgfx::getCaps()->homogeneousDepth);
 			}
 			else if (cam.type == Camera::Type::Orthogonal)
 			{
 				float halfW = cam.screenWidth * 0.5f;
 				float halfH = cam.screenHeight * 0.5f;
-				proj.SetOrthogonal(-halfW, halfW, -halfH, halfH, cam.nearPlane, cam.farPlane, 0.0f, bgfx::getCaps()->homogeneousDepth);
+				sceneView.proj.SetOrthogonal(-halfW, halfW, -halfH, halfH, cam.nearPlane, cam.farPlane, 0.0f, bgfx::getCaps()->homogeneousDepth);
 			}
 
 			Vector4 eye = Vector4(camTrans.position, 1);
 			Vector4 at = Vector4(Quaternion::Multiply(camTrans.rotation, Vector3::AXIS_Z), 0) + eye;
-			view.SetLookAt(eye, at, Vector4::AXIS_Y);
+			sceneView.view.SetLookAt(eye, at, Vector4::AXIS_Y);
 			eye.w = (float)cam.type;
-
-			bgfx::setUniform(m_cameraPos, &eye);
+			sceneView.cameraPos = eye;
+			sceneView.hasCamera = true;
 		}
 
-		bgfx::setViewTransform(m_currentView, &view.m11, &proj.m11);
-	}
-
-	void Clear()
-	{
-		bgfx::setViewClear((bgfx::ViewId)m_currentView
-			, BGFX_CLEAR_COLOR | BGFX_CLEAR_DEPTH
-			, 0x803030ff
-			, 1.0f
-			, 0
-		);
-	}
-
-	void RenderModels(World& world)
-	{
-		const RenderSceneImpl* scene = (RenderSceneImpl*)GetScene(world.GetId());
-		if(scene->GetDirectionalLightsCount() > 0)
+		if (scene.GetDirectionalLightsCount() > 0)
 		{
-			const RenderScene::DirectionalLightItem* dirLight = scene->GetDirectionalLights();
-			Transform& dirLightTrans = world.GetEntityTransform(dirLight->entity);
-			Vector4 dir = Vector4(-dirLightTrans.position, 0);
-			dir.Normalize();
-			bgfx::setUniform(m_dirLightsDirs, &dir);
-			bgfx::setUniform(m_dirLightsColor, &dirLight->light);
+			const RenderScene::DirectionalLightItem* dirLight = scene.GetDirectionalLights();
+			const Transform& dirLightTrans = world.GetEntityTransform(dirLight->entity);
+			sceneView.lightDir = Vector4(-dirLightTrans.position, 0);
+			sceneView.lightDir.Normalize();
+			sceneView.light = dirLight->light;
+			sceneView.hasLight = true;
 		}
 
+		sceneView.firstDraw = (u32)packet.draws.GetSize();
 		size_t count;
-		const RenderSceneImpl::ModelItem* models = scene->GetModels(count);
+		const RenderSceneImpl::ModelItem* models = scene.GetModels(count);
 		for (size_t i = 0; i < count; ++i)
 		{
-
-			Transform& trans = world.GetEntityTransform(models[i].entity);
-			Matrix44 mtx = trans.ToMatrix44();
-			bgfx::setTransform(&mtx.m11);// Set model matrix for rendering.
-
 			if (models[i].model == INVALID_RESOURCE_HANDLE) continue; //TODO: can't do this comparsion
 			const Model* model = (Model*)m_modelManager.GetResource(models[i].model);
-			if (model->GetState() == Resource::State::Ready)
+			if (model->GetState() != Resource::State::Ready)
+				continue;
+
+			const Matrix44 mtx = world.GetEntityTransform(models[i].entity).ToMatrix44();
+			for (const Mesh& mesh : model->meshes)
 			{
-				for (const Mesh& mesh : model->meshes)
-				{
-					const Material* material = (Material*)m_materialManager.GetResource(mesh.material);
-					if (material->GetState() == Resource::State::Ready)
-					{
-						MeshData& meshData = m_meshData.Get((u64)mesh.renderDataHandle);
-						bgfx::setVertexBuffer(0, meshData.vertexBufferHandle);
-						bgfx::setIndexBuffer(meshData.indexBufferHandle);
-
-						MaterialData& materialData = m_materialData.Get((u64)material->renderDataHandle);
-						for(int i = 0; i < materialData.textureCount; ++i)
-						{
-							const Texture* texture = (Texture*)m_textureManager.GetResource(material->textures[i]);
-							TextureData& texData = m_textureData.Get((u64)texture->renderDataHandle);
-							bgfx::setTexture(i, materialData.textureUniforms[i], texData.handle);
-						}
-
-						uint64_t state = BGFX_STATE_DEFAULT;// BGFX_STATE_WRITE_RGB | BGFX_STATE_WRITE_A | BGFX_STATE_WRITE_Z | BGFX_STATE_MSAA;
-						bgfx::setState(state);
-
-						const Shader* shader = (Shader*)m_shaderManager.GetResource(material->shader);
-						ShaderData& shaderData = m_shaderData.Get((u64)shader->renderDataHandle);
-						bgfx::submit(m_currentView, shaderData.handle);
-					}
-				}
+				const Material* material = (Material*)m_materialManager.GetResource(mesh.material);
+				if (material->GetState() == Resource::State::Ready)
+					ExtractDraw(packet, mtx, mesh, *material);
 			}
 		}
+		sceneView.drawCount = (u32)packet.draws.GetSize() - sceneView.firstDraw;
 	}
 
-	void RenderDebug() override
+	void ExtractDraw(FramePacket& packet, const Matrix44& transform, const Mesh& mesh, const Material& material)
 	{
-		for (int i = 0; i < m_debugObjects.GetSize(); ++i)
+		//meshes of one model mostly share material, so only last one is reused
+		if (packet.materials.GetSize() == 0 || m_lastPacketMaterial != material.renderDataHandle)
 		{
-			const Mesh& mesh = m_debugObjects[i].mesh;
-			const Material* material = (Material*)m_materialManager.GetResource(mesh.material);
-			if (material->GetState() == Resource::State::Ready)
+			FramePacket::DrawMaterial& drawMaterial = packet.materials.PushBack();
+			const MaterialData& materialData = m_materialData.Get((u32)material.renderDataHandle);
+			drawMaterial.textureCount = materialData.textureCount;
+			for (int i = 0; i < materialData.textureCount; ++i)
 			{
-				Matrix44 transform = m_debugObjects[i].transform.ToMatrix44();
-				bgfx::setTransform(&transform);
-
-				MeshData& meshData = m_meshData.Get((u64)mesh.renderDataHandle);
-				bgfx::setVertexBuffer(0, meshData.vertexBufferHandle);
-				bgfx::setIndexBuffer(meshData.indexBufferHandle);
-
-				uint64_t state = BGFX_STATE_WRITE_RGB | BGFX_STATE_PT_LINES | BGFX_STATE_LINEAA | BGFX_STATE_BLEND_ALPHA;
-				bgfx::setState(state);
-
-				const Shader* shader = (Shader*)m_shaderManager.GetResource(material->shader);
-				ShaderData& shaderData = m_shaderData.Get((u64)shader->renderDataHandle);
-				bgfx::submit(m_currentView, shaderData.handle);
+				const Texture* texture = (Texture*)m_textureManager.GetResource(material.textures[i]);
+				drawMaterial.textureUniforms[i] = materialData.textureUniforms[i];
+				drawMaterial.textures[i] = m_textureData.Get((u32)texture->renderDataHandle).handle;
 			}
+			const Shader* shader = (Shader*)m_shaderManager.GetResource(material.shader);
+			drawMaterial.program = m_shaderData.Get((u32)shader->renderDataHandle).handle;
+			m_lastPacketMaterial = material.renderDataHandle;
 		}
-	}
 
+		const MeshData& meshData = m_meshData.Get((u32)mesh.renderDataHandle);
+		FramePacket::Draw& draw = packet.draws.PushBack();
+		draw.transform = transform;
+		draw.vertexBuffer = meshData.vertexBufferHandle;
+		draw.indexBuffer = meshData.indexBufferHandle;
+		draw.material = (u32)packet.materials.GetSize() - 1;
+	}
+
+	//draws are split into chunks recorded by workers, each through its own encoder; there are at most as many
+	//chunks as encoders, so chunk waiting for free encoder waits only for one which is about to end
+	void SubmitDraws(const FramePacket& packet
+		, u32 firstDraw
+		, u32 drawCount
+		, bgfx::ViewId view
+		, u64 state
+		, const FramePacket::SceneView* cameraScene
+		, const FramePacket::SceneView* lightScene)
+	{
+		const u32 maxChunks = Max((u32)bgfx::getCaps()->limits.maxEncoders, 1U);
+		const u32 chunkCount = Min(maxChunks, (drawCount + MIN_DRAWS_PER_ENCODER - 1) / MIN_DRAWS_PER_ENCODER);
+		const size_t grain = (chunkCount > 1) ? (drawCount + chunkCount - 1) / chunkCount : drawCount;
+
+		ParallelFor(m_engine.GetJobSystem(), firstDraw, firstDraw + drawCount, grain, [&](size_t begin, size_t end)
+		{
+			//render thread always gets its own encoder, workers get null while pool is exhausted
+			bgfx::Encoder* encoder = bgfx::begin();
+			while (encoder == nullptr)
+			{
+				CpuRelax();
+				encoder = bgfx::begin();
+			}
+			SubmitDrawRange(*encoder, packet, (u32)begin, (u32)end, view, state, cameraScene, lightScene);
+			bgfx::end(encoder);
+		});
+	}
+
+	//uniforms are recorded with next submit of the same encoder and draws of one view come from several
+	//encoders, so every draw carries its own camera and light
+	void SubmitDrawRange(bgfx::Encoder& encoder
+		, const FramePacket& packet
+		, u32 begin
+		, u32 end
+		, bgfx::ViewId view
+		, u64 state
+		, const FramePacket::SceneView* cameraScene
+		, const FramePacket::SceneView* lightScene)
+	{
+		const bool hasCamera = cameraScene != nullptr && cameraScene->hasCamera;
+		const bool hasLight = lightScene != nullptr && lightScene->hasLight;
+
+		for (u32 i = begin; i < end; ++i)
+		{
+			const FramePacket::Draw& draw = packet.draws[i];
+			const FramePacket::DrawMaterial& material = packet.materials[draw.material];
 
-	void* GetNativeFrameBufferHandle(FramebufferHandle handle) override
-	{
-		return (void*)&(m_framebuffers.Get((size_t)handle).handle);
+			if (hasCamera)
+				encoder.setUniform(m_cameraPos, &cameraScene->cameraPos);
+			if (hasLight)
+			{
+				encoder.setUniform(m_dirLightsDirs, &lightScene->lightDir);
+				encoder.setUniform(m_dirLightsColor, &lightScene->light);
+			}
+			encoder.setTransform(&draw.transform.m11);
+			encoder.setVertexBuffer(0, draw.vertexBuffer);
+			encoder.setIndexBuffer(draw.indexBuffer);
+			for (int t = 0; t < material.textureCount; ++t)
+				encoder.setTexture(t, material.textureUniforms[t], material.textures[t]);
+			encoder.setState(state);
+			encoder.submit(view, material.program);
+		}
 	}
 
 
@@ -1231,11 +1581,11 @@ private:
 	ProxyAllocator m_allocator;//must be first
 	Engine& m_engine;
 	HashMap<worldId, RenderSceneImpl*> m_scenes;
-	HandleArray<MeshData, u32> m_meshData;
-	HandleArray<MaterialData, u32> m_materialData;
-	HandleArray<TextureData, u32> m_textureData;
-	HandleArray<ShaderInternalData, u32> m_shaderInternalData;
-	HandleArray<ShaderData, u32> m_shaderData;
+	SlotMap<MeshData> m_meshData;
+	SlotMap<MaterialData> m_materialData;
+	SlotMap<TextureData> m_textureData;
+	SlotMap<ShaderInternalData> m_shaderInternalData;
+	SlotMap<ShaderData> m_shaderData;
 
 	ShaderInternalManager m_shaderInternalManager;
 	ShaderManager m_shaderManager;
@@ -1254,12 +1604,18 @@ private:
 	/////////////////////
 	bgfx::ViewId m_firstView = 1;//TODO
 	bgfx::ViewId m_currentView = m_firstView - 1;//TODO
-	HandleArray<FrameBuffer, u16> m_framebuffers;
+	SlotMap<FrameBuffer> m_framebuffers;
 	Array<FramebufferHandle> m_screenSizeFrameBuffers;
 
 	bgfx::UniformHandle m_cameraPos;
 	bgfx::UniformHandle m_dirLightsDirs;
 	bgfx::UniformHandle m_dirLightsColor;
+
+	FramePacket m_framePackets[FRAME_PACKET_COUNT];
+	FramePacket* m_recordPacket = nullptr;//main thread
+	u32 m_nextRecordPacket = 0;//main thread
+	u32 m_nextSubmitPacket = 0;//render thread
+	materialRenderHandle m_lastPacketMaterial = INVALID_MATERIAL_RENDER_HANDLE;
 };
 
 
@@ -26,8 +26,8 @@ class ModelManager;
 class TextureManager;
 
 
-enum class FramebufferHandle : u16 {};
-const FramebufferHandle INVALID_FRAMEBUFFER_HANDLE = (FramebufferHandle)0xffff;
+enum class FramebufferHandle : u32 {};
+const FramebufferHandle INVALID_FRAMEBUFFER_HANDLE = (FramebufferHandle)0xffffffff;
 
 typedef u8 FramebufferTypeFlags;
 enum FramebufferTypeBits : FramebufferTypeFlags
@@ -103,6 +103,9 @@ public:
 
 class RenderSystem : public System
 {
+public:
+	static const u32 FRAME_PACKET_COUNT = 2;
+
 public:
 	static RenderSystem* Create(Engine& engine);
 	static void Destroy(RenderSystem* system);
@@ -137,15 +140,24 @@ public:
 
 	virtual Engine& GetEngine() const = 0;
 
-	//render api
+	//frame packets, main thread records frame into one while render thread submits previous one;
+	//bgfx objects destroyed while packet is recorded are released after that packet is submitted
+	virtual void BeginFrame() = 0;
+	//snapshots all scenes, should be called at end of simulation
+	virtual void ExtractFrame() = 0;
+	virtual void EndFrame() = 0;
+	//render thread only, submits oldest recorded packet
+	virtual void SubmitFrame() = 0;
+
+	//render api, recorded into current frame packet
 	virtual FramebufferHandle CreateFrameBuffer(int width, int height, bool screenSize, FramebufferTypeFlags flags) = 0;
 	virtual void DestroyFramebuffer(FramebufferHandle handle) = 0;
 
 	virtual void NewView() = 0;
 	virtual void SetFramebuffer(FramebufferHandle handle) = 0;
-	virtual void SetCamera(World& world, Entity camera) = 0;
+	virtual void SetCamera(worldId world) = 0;//active camera of world
 	virtual void Clear() = 0;
-	virtual void RenderModels(World& world) = 0;
+	virtual void RenderModels(worldId world) = 0;
 	virtual void RenderDebug() = 0;
 
 	virtual void* GetNativeFrameBufferHandle(FramebufferHandle handle) = 0;
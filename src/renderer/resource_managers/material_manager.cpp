@@ -1,5 +1,6 @@
 #include "material_manager.h"
 
+#include "core/allocators.h"
 #include "core/file/blob.h"
 #include "core/string.h"
 #include "core/logs.h"
@@ -19,7 +20,6 @@ static ResourceType TEXTURE_TYPE("texture");
 
 MaterialManager::MaterialManager(Allocator& allocator, FileSystem& fileSystem, DependencyManager* depManager)
 	: ResourceManager(Material::RESOURCE_TYPE, allocator, fileSystem, depManager)
-	, m_loadingOp(m_allocator)
 {
 
 }
@@ -77,26 +77,32 @@ void MaterialManager::ReloadResource(Resource* resource)
 }
 
 
-void MaterialManager::ResourceLoaded(resourceHandle handle, InputBlob& data)
+Task<> MaterialManager::ResourceLoaded(resourceHandle handle, InputBlob& data)
 {
 	Material* material = static_cast<Material*>(GetResource(handle));
-	LoadingOp op;
-	op.material = handle;
+	LoadMaterial(material, data);
 
+	//shader and textures are all loading already, awaiting them in turn takes as long as slowest of them
+	co_await GetResource(material->shader)->WaitForLoad();
+	for (int i = 0; i < material->textureCount; ++i)
+		co_await GetResource(material->textures[i])->WaitForLoad();
+}
+
+
+//temp scope can't span suspension of coroutine, json is parsed and child loads started before it
+void MaterialManager::LoadMaterial(Material* material, InputBlob& data)
+{
+	TempScope tempScope;
 	char errorBuffer[64] = { 0 };
 	JsonValue parsedJson;
-	ASSERT(JsonParseError((char*)data.GetData(), &m_allocator, &parsedJson, errorBuffer));
+	ASSERT(JsonParseError((char*)data.GetData(), &tempScope.GetAllocator(), &parsedJson, errorBuffer));
 	ASSERT(JsonIsObject(&parsedJson));
 
 	JsonKeyValue* shader = JsonObjectFind(&parsedJson, "shader");
 	ASSERT(shader != nullptr && JsonIsString(&shader->value));
 	Path shaderPath(JsonGetString(&shader->value));
 
-	material->shader = m_depManager->LoadResource(Material::RESOURCE_TYPE, SHADER_TYPE, shaderPath);
-	op.shader = material->shader;
-	Resource* shaderRes = GetResource(material->shader);
-	if(shaderRes->GetState() == Resource::State::Ready || shaderRes->GetState() == Resource::State::Failure)
-		op.shaderLoaded = true;
+	material->shader = m_depManager->LoadResource(SHADER_TYPE, shaderPath);
 
 	JsonKeyValue* textures = JsonObjectFind(&parsedJson, "textures");
 	if (textures != nullptr)
@@ -118,68 +124,13 @@ void MaterialManager::ResourceLoaded(resourceHandle handle, InputBlob& data)
 
 			ASSERT(JsonIsString(&val->value));
 			const Path path(JsonGetString(&val->value));
-			material->textures[idx] = m_depManager->LoadResource(Material::RESOURCE_TYPE, TEXTURE_TYPE, path);
-			op.textures[idx] = material->textures[idx];
-			op.textureCount++;
-			Resource* textureRes = GetResource(material->textures[idx]);
-			if (textureRes->GetState() != Resource::State::Ready && textureRes->GetState() != Resource::State::Failure)
-				op.texturesToLoad |= 1 << idx;
+			material->textures[idx] = m_depManager->LoadResource(TEXTURE_TYPE, path);
 
 			val++;
 		}
 	}
 
-	JsonDeinit(&parsedJson);
-
 	material->renderDataHandle = m_renderSystem->CreateMaterialData(*material);
-
-	if(!LoadingOpCompleted(op))
-		m_loadingOp.PushBack(op);
-	else
-		FinalizeMaterial(material);
-}
-
-
-void MaterialManager::ChildResourceLoaded(resourceHandle handle, ResourceType type)
-{
-	for (size_t i = 0; i < m_loadingOp.GetSize(); ++i)
-	{
-		LoadingOp& op = m_loadingOp[i];
-
-		if (type == SHADER_TYPE)
-		{
-			if (op.shader == handle)
-				op.shaderLoaded = 1;
-		}
-		else if (type == TEXTURE_TYPE)
-		{
-			for (size_t i = 0; i < op.textureCount; ++i)
-			{
-				if (op.textures[i] == handle)
-					op.texturesToLoad &= ~(1 << i);
-			}
-		}
-
-		if (LoadingOpCompleted(op))
-		{
-			Material* material = static_cast<Material*>(GetResource(op.material));
-			FinalizeMaterial(material);
-			m_loadingOp.Erase(i--);
-		}
-	}
-}
-
-
-void MaterialManager::FinalizeMaterial(Material* material)
-{
-	material->SetState(Resource::State::Ready);
-	m_depManager->ResourceLoaded(Material::RESOURCE_TYPE, GetResourceHandle(material));
-}
-
-
-bool MaterialManager::LoadingOpCompleted(const LoadingOp& op)
-{
-	return (op.shaderLoaded && op.texturesToLoad == 0);
 }
 
 
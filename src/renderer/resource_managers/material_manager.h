@@ -3,7 +3,6 @@
 #include "core/resource/resource_manager.h"
 #include "material.h"
 
-#include "core/containers/array.h"
 
 
 namespace Veng
@@ -23,31 +22,16 @@ public:
 
 	void SetRenderSystem(RenderSystem* renderSystem);
 
-private:
-	struct LoadingOp
-	{
-		resourceHandle material;
-		resourceHandle shader;
-		resourceHandle textures[Material::MAX_TEXTURES];
-		u8 textureCount = 0;
-		u8 shaderLoaded = 0;
-		u8 texturesToLoad = 0;//TODO: ^ merge to one bitflag field
-	};
-
 private:
 	Resource* CreateResource() override;
 	void DestroyResource(Resource* resource) override;
 	void ReloadResource(Resource* resource) override;
-	void ResourceLoaded(resourceHandle handle, InputBlob& data) override;
-	void ChildResourceLoaded(resourceHandle handle, ResourceType type) override;
-
-	void FinalizeMaterial(Material* material);
+	Task<> ResourceLoaded(resourceHandle handle, InputBlob& data) override;
 
-	static bool LoadingOpCompleted(const LoadingOp& op);
+	void LoadMaterial(Material* material, InputBlob& data);
 
 private:
 	RenderSystem* m_renderSystem;
-	Array<LoadingOp> m_loadingOp;
 };
 
 
@@ -1,7 +1,7 @@
 #pragma once
 
 #include "core/resource/resource.h"
-#include "core/containers/array.h"
+#include "core/containers/small_array.h"
 
 #include "material.h"
 
@@ -40,7 +40,9 @@ struct Model : public Resource
 		, meshes(allocator)
 	{}
 
-	Array<Mesh> meshes;
+	//most models have few meshes, they then live inside model itself with no heap block of their own; access
+	//still goes through array's data pointer, but it points next to the model
+	SmallArray<Mesh, 4> meshes;
 	//LODs
 	//Bones
 	//Skins
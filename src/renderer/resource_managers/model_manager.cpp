@@ -1,5 +1,6 @@
 #include "model_manager.h"
 
+#include "core/allocators.h"
 #include "core/file/blob.h"
 #include "core/parsing/json.h"
 
@@ -70,16 +71,29 @@ void ModelManager::ReloadResource(Resource* resource)
 }
 
 
-void ModelManager::ResourceLoaded(resourceHandle handle, InputBlob& data)
+Task<> ModelManager::ResourceLoaded(resourceHandle handle, InputBlob& data)
 {
 	Model* model = static_cast<Model*>(GetResource(handle));
-	
+	LoadModel(model, data);
+
+	for (const Mesh& mesh : model->meshes)
+	{
+		if (mesh.material != INVALID_RESOURCE_HANDLE)
+			co_await GetResource(mesh.material)->WaitForLoad();
+	}
+}
+
+
+//temp scope can't span suspension of coroutine, mesh data are parsed and material loads started before it
+void ModelManager::LoadModel(Model* model, InputBlob& data)
+{
 	Mesh& mesh = model->meshes.PushBack();
 	mesh.type = Mesh::PrimitiveType::Triangles;//todo: read from mesh
 
+	TempScope tempScope;
 	char errorBuffer[64] = { 0 };
 	JsonValue parsedJson;
-	ASSERT(JsonParseError((char*)data.GetData(), &m_allocator, &parsedJson, errorBuffer));
+	ASSERT(JsonParseError((char*)data.GetData(), &tempScope.GetAllocator(), &parsedJson, errorBuffer));
 	ASSERT(JsonIsObject(&parsedJson));
 
 
@@ -241,38 +255,11 @@ void ModelManager::ResourceLoaded(resourceHandle handle, InputBlob& data)
 		ASSERT(JsonIsString(&material->value));
 		const char* materialRawStr = JsonGetString(&material->value);
 		Path materialPath(materialRawStr);
-		mesh.material = m_depManager->LoadResource(Model::RESOURCE_TYPE, MATERIAL_TYPE, materialPath);
-		Resource* material = GetResource(mesh.material);
-		if(material->GetState() == Resource::State::Ready || material->GetState() == Resource::State::Failure)
-		{
-			FinalizeModel(model);
-		}
+		mesh.material = m_depManager->LoadResource(MATERIAL_TYPE, materialPath);
 	}
 
-	JsonDeinit(&parsedJson);
-
 	mesh.renderDataHandle = m_renderSystem->CreateMeshData(mesh);
 }
 
 
-void ModelManager::ChildResourceLoaded(resourceHandle handle, ResourceType type)
-{
-	for (auto& res : m_resources)
-	{
-		Model* model = static_cast<Model*>(res.value);
-		if (model->meshes[0].material == handle)
-		{
-			FinalizeModel(model);
-		}
-	}
-}
-
-
-void ModelManager::FinalizeModel(Model* model)
-{
-	model->SetState(Resource::State::Ready);
-	m_depManager->ResourceLoaded(Model::RESOURCE_TYPE, GetResourceHandle(model));
-}
-
-
 }
\ No newline at end of file
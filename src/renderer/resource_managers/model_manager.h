@@ -25,10 +25,9 @@ private:
 	Resource* CreateResource() override;
 	void DestroyResource(Resource* resource) override;
 	void ReloadResource(Resource* resource) override;
-	void ResourceLoaded(resourceHandle handle, InputBlob& data) override;
-	void ChildResourceLoaded(resourceHandle handle, ResourceType type) override;
+	Task<> ResourceLoaded(resourceHandle handle, InputBlob& data) override;
 
-	void FinalizeModel(Model* model);
+	void LoadModel(Model* model, InputBlob& data);
 
 private:
 	RenderSystem* m_renderSystem;
@@ -1,6 +1,7 @@
 #include "shader_manager.h"
 
 #include "core/memory.h"
+#include "core/allocators.h"
 #include "core/file/blob.h"
 #include "core/file/file_system.h"
 #include "core/asserts.h"
@@ -156,13 +157,12 @@ void ShaderInternalManager::ReloadResource(Resource* resource)
 }
 
 
-void ShaderInternalManager::ResourceLoaded(resourceHandle handle, InputBlob& data)
+Task<> ShaderInternalManager::ResourceLoaded(resourceHandle handle, InputBlob& data)
 {
 	ShaderInternal* shaderInt = static_cast<ShaderInternal*>(GetResource(handle));
 
 	shaderInt->renderDataHandle = m_renderSystem->CreateShaderInternalData(data);
-
-	m_depManager->ResourceLoaded(ShaderInternal::RESOURCE_TYPE, handle);
+	co_return;
 }
 
 
@@ -173,7 +173,6 @@ ResourceType Shader::RESOURCE_TYPE("shader");
 
 ShaderManager::ShaderManager(Allocator& allocator, FileSystem& fileSystem, DependencyManager* depManager)
 	: ResourceManager(Shader::RESOURCE_TYPE, allocator, fileSystem, depManager)
-	, m_loadingOp(allocator)
 {
 
 }
@@ -227,13 +226,28 @@ void ShaderManager::ReloadResource(Resource* resource)
 }
 
 
-void ShaderManager::ResourceLoaded(resourceHandle handle, InputBlob& data)
+Task<> ShaderManager::ResourceLoaded(resourceHandle handle, InputBlob& data)
 {
 	Shader* shader = static_cast<Shader*>(ResourceManager::GetResource(handle));
+	LoadShader(shader, data);
+
+	//both stages are already loading, waiting for them one after other doesn't serialize their loads
+	ShaderInternal* vs = static_cast<ShaderInternal*>(m_depManager->GetResource(ShaderInternal::RESOURCE_TYPE, shader->vsHandle));
+	ShaderInternal* fs = static_cast<ShaderInternal*>(m_depManager->GetResource(ShaderInternal::RESOURCE_TYPE, shader->fsHandle));
+	co_await vs->WaitForLoad();
+	co_await fs->WaitForLoad();
+
+	shader->renderDataHandle = m_renderSystem->CreateShaderData(vs->renderDataHandle, fs->renderDataHandle);
+}
+
 
+//temp scope can't span suspension of coroutine, json is parsed and child loads started before it
+void ShaderManager::LoadShader(Shader* shader, InputBlob& data)
+{
+	TempScope tempScope;
 	char errorBuffer[64] = { 0 };
 	JsonValue parsedJson;
-	ASSERT(JsonParseError((char*)data.GetData(), &m_allocator, &parsedJson, errorBuffer));
+	ASSERT(JsonParseError((char*)data.GetData(), &tempScope.GetAllocator(), &parsedJson, errorBuffer));
 	ASSERT(JsonIsObject(&parsedJson));
 
 	JsonKeyValue* varyings = JsonObjectFind(&parsedJson, "varyings");
@@ -318,73 +332,14 @@ void ShaderManager::ResourceLoaded(resourceHandle handle, InputBlob& data)
 	ASSERT(fShader != nullptr && JsonIsString(&fShader->value));
 	Path fsPath(JsonGetString(&fShader->value));
 
-	JsonDeinit(&parsedJson);
-
-
-	LoadingOp op;
-	op.shader = handle;
 
 	Path vOutPath;
 	ASSERT(CompileShader(GetFileSystem(), vsPath, vOutPath));
-	shader->vsHandle = m_depManager->LoadResource(Shader::RESOURCE_TYPE, ShaderInternal::RESOURCE_TYPE, vOutPath);
-	op.vsHandle = shader->vsHandle;
-	Resource* vRes = GetResource(shader->vsHandle);
-	if(vRes->GetState() != Resource::State::Ready && vRes->GetState() != Resource::State::Failure)
-		op.shadersToLoad |= LoadingOp::Shader_Vertex;
+	shader->vsHandle = m_depManager->LoadResource(ShaderInternal::RESOURCE_TYPE, vOutPath);
 
 	Path fOutPath;
 	ASSERT(CompileShader(GetFileSystem(), fsPath, fOutPath));
-	shader->fsHandle = m_depManager->LoadResource(Shader::RESOURCE_TYPE, ShaderInternal::RESOURCE_TYPE, fOutPath);
-	op.fsHandle = shader->fsHandle;
-	Resource* fRes = GetResource(shader->fsHandle);
-	if(fRes->GetState() != Resource::State::Ready && fRes->GetState() != Resource::State::Failure)
-		op.shadersToLoad |= LoadingOp::Shader_Fragment;
-
-	if(!LoadingOpCompleted(op))
-		m_loadingOp.PushBack(op);
-	else
-		FinalizeShader(shader);
-}
-
-
-void ShaderManager::ChildResourceLoaded(resourceHandle handle, ResourceType type)
-{
-	for(size_t i = 0; i < m_loadingOp.GetSize(); ++i)
-	{
-		LoadingOp& op = m_loadingOp[i];
-
-		if(op.vsHandle == handle)
-			op.shadersToLoad &= ~LoadingOp::Shader_Vertex;
-		else if(op.fsHandle == handle)
-			op.shadersToLoad &= ~LoadingOp::Shader_Fragment;
-
-
-		if(LoadingOpCompleted(op))
-		{
-			Shader* shader = static_cast<Shader*>(GetResource(op.shader));
-			FinalizeShader(shader);
-			m_loadingOp.Erase(i--);
-		}
-	}
-}
-
-
-void ShaderManager::FinalizeShader(Shader* shader)
-{
-	const Resource* vsRes = m_depManager->GetResource(ShaderInternal::RESOURCE_TYPE, static_cast<resourceHandle>(shader->vsHandle));
-	const Resource* fsRes = m_depManager->GetResource(ShaderInternal::RESOURCE_TYPE, static_cast<resourceHandle>(shader->fsHandle));
-	const ShaderInternal* vs = static_cast<const ShaderInternal*>(vsRes);
-	const ShaderInternal* fs = static_cast<const ShaderInternal*>(fsRes);
-	
-	shader->renderDataHandle = m_renderSystem->CreateShaderData(vs->renderDataHandle, fs->renderDataHandle);
-
-	m_depManager->ResourceLoaded(Shader::RESOURCE_TYPE, GetResourceHandle(shader));
-}
-
-
-bool ShaderManager::LoadingOpCompleted(const LoadingOp& op)
-{
-	return (op.shadersToLoad == LoadingOp::Shader_None);
+	shader->fsHandle = m_depManager->LoadResource(ShaderInternal::RESOURCE_TYPE, fOutPath);
 }
 
 
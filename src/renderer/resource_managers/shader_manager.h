@@ -27,7 +27,7 @@ private:
 	Resource* CreateResource() override;
 	void DestroyResource(Resource* resource) override;
 	void ReloadResource(Resource* resource) override;
-	void ResourceLoaded(resourceHandle handle, InputBlob& data) override;
+	Task<> ResourceLoaded(resourceHandle handle, InputBlob& data) override;
 
 private:
 	RenderSystem* m_renderSystem;
@@ -48,35 +48,16 @@ public:
 
 	void SetRenderSystem(RenderSystem* renderSystem);
 
-private:
-	struct LoadingOp
-	{
-		enum ShaderBits : u8
-		{
-			Shader_None = 0,
-			Shader_Vertex = 1 << 0,
-			Shader_Fragment = 1 << 1,
-		};
-		resourceHandle shader;
-		resourceHandle vsHandle;
-		resourceHandle fsHandle;
-		u8 shadersToLoad = Shader_None;
-	};
-
 private:
 	Resource* CreateResource() override;
 	void DestroyResource(Resource* resource) override;
 	void ReloadResource(Resource* resource) override;
-	void ResourceLoaded(resourceHandle handle, InputBlob& data) override;
-	void ChildResourceLoaded(resourceHandle handle, ResourceType type) override;
-
-	void FinalizeShader(Shader* shader);
+	Task<> ResourceLoaded(resourceHandle handle, InputBlob& data) override;
 
-	static bool LoadingOpCompleted(const LoadingOp& op);
+	void LoadShader(Shader* shader, InputBlob& data);
 
 private:
 	RenderSystem* m_renderSystem;
-	Array<LoadingOp> m_loadingOp;
 };
 
 
@@ -98,7 +98,7 @@ void TextureManager::ReloadResource(Resource* resource)
 }
 
 
-void TextureManager::ResourceLoaded(resourceHandle handle, InputBlob& data)
+Task<> TextureManager::ResourceLoaded(resourceHandle handle, InputBlob& data)
 {
 	Texture* texture = static_cast<Texture*>(GetResource(handle));
 
@@ -115,9 +115,7 @@ void TextureManager::ResourceLoaded(resourceHandle handle, InputBlob& data)
 	texture->data = imageData;
 
 	texture->renderDataHandle = m_renderSystem->CreateTextureData(*texture);
-
-	texture->SetState(Resource::State::Ready);
-	m_depManager->ResourceLoaded(Texture::RESOURCE_TYPE, GetResourceHandle(texture));
+	co_return;
 }
 
 
@@ -25,7 +25,7 @@ private:
 	Resource* CreateResource() override;
 	void DestroyResource(Resource* resource) override;
 	void ReloadResource(Resource* resource) override;
-	void ResourceLoaded(resourceHandle handle, InputBlob& data) override;
+	Task<> ResourceLoaded(resourceHandle handle, InputBlob& data) override;
 
 private:
 	RenderSystem* m_renderSystem;
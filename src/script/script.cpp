@@ -85,7 +85,13 @@ public:
 	void Clear() override {}
 
 	void Update(float deltaTime) override
-	{}
+	{
+		for (ScriptItem& script : m_scripts)
+		{
+			if (script.active)//TODO: change from map to array and keep inactive on end ?
+				script.script->Update(deltaTime);
+		}
+	}
 
 
 	void AddScript(Entity entity) override
@@ -171,17 +177,16 @@ public:
 
 	void DeserializeScripts(InputBlob& serializer)
 	{
-		StackAllocator<128> allocator;
-
 		u64 count;
 		serializer.Read(count);
 		for (u64 i = 0; i < count; ++i)
 		{
+			TempScope tempScope;
 			Entity entity;
 			serializer.Read(entity);
 			ScriptItem* script = m_scripts.Insert(entity, { entity });
 			serializer.Read(script->active);
-			String className(allocator);
+			String className(tempScope.GetAllocator());
 			serializer.Read(className);
 			ScriptData data;
 			string::Copy(data.className, className.Cstr(), 64);
@@ -346,15 +351,7 @@ public:
 
 	void Update(float deltaTime) override
 	{
-		for (auto& sceneNode : m_scenes)
-		{
-			const ScriptItem* scripts = sceneNode.value->GetScripts();
-			for (int i = 0; i < sceneNode.value->GetScriptsCount(); ++i)
-			{
-				if(scripts[i].active)//TODO: change from map to array and keep inactive on end ?
-					scripts[i].script->Update(deltaTime);
-			}
-		}
+		//scripts are updated by their scenes, per world
 
 		// DUMMY GAMEPLAY SCRIPT
 		Quaternion rot = Quaternion::IDENTITY;
@@ -372,6 +369,16 @@ public:
 
 	const char* GetName() const override { return "script"; }
 
+	//script code runs in scene update, system itself only looks up its world
+	SystemAccess GetAccess() const override
+	{
+		SystemAccess access;
+		access.read = SystemData_Worlds;
+		access.write = SystemData_None;
+		access.mainThread = false;
+		return access;
+	}
+
 	Scene* GetScene(worldId world) const override
 	{
 		ScriptSceneImpl** scene;